@@ -103,8 +103,14 @@ typedef struct SDL_AudioSpec {
 #define AUDIO_S16LSB	0x8010	/**< Signed 16-bit samples */
 #define AUDIO_U16MSB	0x1010	/**< As above, but big-endian byte order */
 #define AUDIO_S16MSB	0x9010	/**< As above, but big-endian byte order */
+#define AUDIO_S32LSB	0x8020	/**< Signed 32-bit samples */
+#define AUDIO_S32MSB	0x9020	/**< As above, but big-endian byte order */
+#define AUDIO_F32LSB	0x8120	/**< 32-bit floating point samples, -1.0 to 1.0 */
+#define AUDIO_F32MSB	0x9120	/**< As above, but big-endian byte order */
 #define AUDIO_U16	AUDIO_U16LSB
 #define AUDIO_S16	AUDIO_S16LSB
+#define AUDIO_S32	AUDIO_S32LSB
+#define AUDIO_F32	AUDIO_F32LSB
 
 /**
  *  @name Native audio byte ordering
@@ -113,9 +119,13 @@ typedef struct SDL_AudioSpec {
 #if SDL_BYTEORDER == SDL_LIL_ENDIAN
 #define AUDIO_U16SYS	AUDIO_U16LSB
 #define AUDIO_S16SYS	AUDIO_S16LSB
+#define AUDIO_S32SYS	AUDIO_S32LSB
+#define AUDIO_F32SYS	AUDIO_F32LSB
 #else
 #define AUDIO_U16SYS	AUDIO_U16MSB
 #define AUDIO_S16SYS	AUDIO_S16MSB
+#define AUDIO_S32SYS	AUDIO_S32MSB
+#define AUDIO_F32SYS	AUDIO_F32MSB
 #endif
 /*@}*/
 
@@ -173,6 +183,12 @@ extern DECLSPEC char * SDLCALL SDL_AudioDriverName(char *namebuf, int maxlen);
  * may modify the requested size of the audio buffer, you should allocate
  * any local mixing buffers after you open the audio device.
  *
+ * If the driver can't play 32-bit samples (AUDIO_S32 or AUDIO_F32), the
+ * device is opened with 16-bit samples instead, and 'obtained' says so.
+ *
+ * The buffer is filled with silence before each call to the callback,
+ * unless SDL_SetAudioCallbackFills() says the callback writes all of it.
+ *
  * @sa SDL_AudioSpec
  */
 extern DECLSPEC int SDLCALL SDL_OpenAudio(SDL_AudioSpec *desired, SDL_AudioSpec *obtained);
@@ -195,6 +211,88 @@ extern DECLSPEC SDL_audiostatus SDLCALL SDL_GetAudioStatus(void);
  */
 extern DECLSPEC void SDLCALL SDL_PauseAudio(int pause_on);
 
+/**
+ * Ask for at most 'ms' milliseconds between the callback filling a buffer
+ * and that buffer being heard, for devices opened after this call.  The
+ * callback buffer (spec.samples) is shrunk until two of them fit, and the
+ * driver queues as little as it can.  0 restores the defaults.
+ */
+extern DECLSPEC void SDLCALL SDL_SetAudioLatency(int ms);
+
+/**
+ * Say whether the callback writes every byte of the buffer it is passed,
+ * for devices opened after this call.  If 'fills' is non-zero, the buffer
+ * isn't cleared to silence before each call, only while the audio is
+ * paused.  It is cleared by default.
+ */
+extern DECLSPEC void SDLCALL SDL_SetAudioCallbackFills(int fills);
+
+/**
+ * Returns the latency of the open device in milliseconds: how long a
+ * buffer written by the callback waits before it is heard.  Returns -1
+ * if the audio device isn't open.
+ */
+extern DECLSPEC int SDLCALL SDL_GetAudioLatency(void);
+
+/**
+ * Returns the number of times the device ran out of audio data since it
+ * was opened, if the driver can tell (ALSA, PulseAudio and OSS 4).
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_GetAudioUnderruns(void);
+
+/**
+ * This function opens the audio input device, from the same driver as
+ * SDL_OpenAudio(), and can be used with or without the output device.
+ * The parameters are the same as for SDL_OpenAudio(), except that the
+ * callback is passed the data that was recorded instead of filling it.
+ * The callback is called from a separate thread, and must not keep
+ * the pointer it was passed: when no conversion is needed, it points
+ * into the driver's own buffer.
+ *
+ * If the callback is NULL, recorded data is queued for the application
+ * to read with SDL_ReadAudioCapture() instead.
+ *
+ * Recording starts paused, call SDL_PauseAudioCapture(0) to start it.
+ *
+ * @return This function returns 0 if successful, or -1 if the driver
+ *         can't record or the device couldn't be opened.
+ */
+extern DECLSPEC int SDLCALL SDL_OpenAudioCapture(SDL_AudioSpec *desired, SDL_AudioSpec *obtained);
+
+/**
+ * This function pauses and unpauses recording.  Data recorded while
+ * paused is thrown away.
+ */
+extern DECLSPEC void SDLCALL SDL_PauseAudioCapture(int pause_on);
+
+/**
+ * Read up to 'len' bytes of recorded data, if the capture device was
+ * opened without a callback.  This doesn't wait for data: it returns
+ * what has been recorded so far.  Data that isn't read in time is
+ * dropped, so that no more than 8 buffers (spec.size) are queued.
+ *
+ * @return The number of bytes read, or -1 if there was an error.
+ */
+extern DECLSPEC int SDLCALL SDL_ReadAudioCapture(void *buf, int len);
+
+/**
+ * @name Audio Capture Locks
+ * These work like SDL_LockAudio() and SDL_UnlockAudio(), but for the
+ * capture callback, which runs in its own thread under its own lock.
+ * During a LockAudioCapture/UnlockAudioCapture pair, you can be
+ * guaranteed that the capture callback is not running.  SDL_LockAudio()
+ * doesn't stop it.
+ */
+/*@{*/
+extern DECLSPEC void SDLCALL SDL_LockAudioCapture(void);
+extern DECLSPEC void SDLCALL SDL_UnlockAudioCapture(void);
+/*@}*/
+
+/**
+ * This function shuts down recording and closes the audio input device.
+ */
+extern DECLSPEC void SDLCALL SDL_CloseAudioCapture(void);
+
 /**
  * This function loads a WAVE from the data source, automatically freeing
  * that source if 'freesrc' is non-zero.  For example, to load a WAVE file,
@@ -223,6 +321,50 @@ extern DECLSPEC SDL_AudioSpec * SDLCALL SDL_LoadWAV_RW(SDL_RWops *src, int frees
  */
 extern DECLSPEC void SDLCALL SDL_FreeWAV(Uint8 *audio_buf);
 
+/**
+ * A WAVE file that is read a piece at a time, instead of loaded whole.
+ * ADPCM data is decoded one block at a time as it's read, so the memory
+ * used doesn't depend on the length of the file.
+ */
+typedef struct SDL_WAVStream SDL_WAVStream;
+
+/**
+ * This function opens a WAVE from the data source for reading, which is
+ * closed with the stream if 'freesrc' is non-zero.  The data source must
+ * stay open and positioned where the stream left it until the stream is
+ * closed.  'spec' is filled in as by SDL_LoadWAV_RW().
+ *
+ * @return The stream, or NULL if the data source isn't a WAVE we can read.
+ */
+extern DECLSPEC SDL_WAVStream * SDLCALL SDL_OpenWAV_RW(SDL_RWops *src, int freesrc, SDL_AudioSpec *spec);
+
+/** Convenience function -- opens a WAV file for streaming */
+#define SDL_OpenWAV(file, spec) \
+	SDL_OpenWAV_RW(SDL_RWFromFile(file, "rb"),1, spec)
+
+/**
+ * Read up to 'frames' sample frames in the format given by SDL_OpenWAV_RW().
+ *
+ * @return The number of sample frames read, which is 0 at the end of the
+ *         data, or -1 if there was an error.
+ */
+extern DECLSPEC int SDLCALL SDL_ReadWAV(SDL_WAVStream *wav, void *buf, int frames);
+
+/**
+ * Move to sample frame 'frame', counting from the start of the data.
+ *
+ * @return This function returns 0, or -1 if there was an error.
+ */
+extern DECLSPEC int SDLCALL SDL_SeekWAV(SDL_WAVStream *wav, Uint32 frame);
+
+/** Returns the sample frame the next read starts at */
+extern DECLSPEC Uint32 SDLCALL SDL_TellWAV(SDL_WAVStream *wav);
+
+/** Returns the number of sample frames in the stream */
+extern DECLSPEC Uint32 SDLCALL SDL_WAVLength(SDL_WAVStream *wav);
+
+extern DECLSPEC void SDLCALL SDL_CloseWAV(SDL_WAVStream *wav);
+
 /**
  * This function takes a source format and rate and a destination format
  * and rate, and initializes the 'cvt' structure with information needed
@@ -243,9 +385,70 @@ extern DECLSPEC int SDLCALL SDL_BuildAudioCVT(SDL_AudioCVT *cvt,
  * The data conversion may expand the size of the audio data, so the buffer
  * cvt->buf should be allocated after the cvt structure is initialized by
  * SDL_BuildAudioCVT(), and should be cvt->len*cvt->len_mult bytes long.
+ *
+ * Each buffer is converted on its own, so converting a sound in pieces
+ * this way clicks where a rate conversion filter restarts at each piece.
+ * Use an SDL_AudioStream for that.
  */
 extern DECLSPEC int SDLCALL SDL_ConvertAudio(SDL_AudioCVT *cvt);
 
+/**
+ * An audio stream converts data the same way as SDL_ConvertAudio(), but
+ * takes input in chunks of any size and hands out converted data in
+ * chunks of any size.  Partial sample frames and the sample rate
+ * converter state carry over between calls, and converted data is kept
+ * in an internal buffer until it is read.
+ */
+typedef struct SDL_AudioStream SDL_AudioStream;
+
+/**
+ * Create an audio stream converting from the source format to the
+ * destination format.
+ *
+ * @return The new stream, or NULL if there was an error.
+ */
+extern DECLSPEC SDL_AudioStream * SDLCALL SDL_NewAudioStream(
+		Uint16 src_format, Uint8 src_channels, int src_rate,
+		Uint16 dst_format, Uint8 dst_channels, int dst_rate);
+
+/**
+ * Add 'len' bytes of source data to the stream.
+ *
+ * @return This function returns 0, or -1 if there was an error.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioStreamPut(SDL_AudioStream *stream,
+						const void *buf, int len);
+
+/**
+ * Read up to 'len' bytes of converted data from the stream.
+ *
+ * @return The number of bytes read, which is less than 'len' only if
+ *         the stream runs out of converted data.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioStreamGet(SDL_AudioStream *stream,
+						void *buf, int len);
+
+/**
+ * Returns the number of converted bytes that can be read from the stream.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioStreamAvailable(SDL_AudioStream *stream);
+
+/**
+ * The rate converter holds back a few frames of input until it sees what
+ * follows them.  At the end of the source data, call this function to
+ * push them through, followed by silence.
+ *
+ * @return This function returns 0, or -1 if there was an error.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioStreamFlush(SDL_AudioStream *stream);
+
+/**
+ * Throw away all data in the stream, as if it was just created.
+ */
+extern DECLSPEC void SDLCALL SDL_AudioStreamClear(SDL_AudioStream *stream);
+
+extern DECLSPEC void SDLCALL SDL_FreeAudioStream(SDL_AudioStream *stream);
+
 
 #define SDL_MIX_MAXVOLUME 128
 /**
@@ -257,12 +460,73 @@ extern DECLSPEC int SDLCALL SDL_ConvertAudio(SDL_AudioCVT *cvt);
  */
 extern DECLSPEC void SDLCALL SDL_MixAudio(Uint8 *dst, const Uint8 *src, Uint32 len, int volume);
 
+/**
+ * A voice mixer plays many sounds at once.  All voices are summed in a
+ * single pass at full precision and clipped once, which is faster and
+ * sounds better than calling SDL_MixAudio() for each sound.
+ *
+ * The mixer is run by calling SDL_MixVoices() from the audio callback.
+ * The other mixer functions queue their changes for the next call of
+ * SDL_MixVoices() and never wait for it, so they may be called from
+ * one other thread without SDL_LockAudio().
+ */
+typedef struct SDL_AudioMixer SDL_AudioMixer;
+
+/** The sound a voice plays, and how */
+typedef struct SDL_AudioVoice {
+	const Uint8 *buf;	/**< Samples in the mixer's audio format */
+	Uint32 len;		/**< Length of buf in bytes */
+	Uint8 channels;		/**< 1, or the mixer's number of channels */
+	Uint32 loop_start;	/**< First sample frame of the loop */
+	Uint32 loop_end;	/**< Frame after the loop, or 0 to play once */
+	int volume;		/**< 0 - SDL_MIX_MAXVOLUME */
+	int pan;		/**< -128 (left) - 128 (right), 0 is centered */
+	Uint32 rate;		/**< Playback rate, 0x10000 (or 0) is the normal rate */
+} SDL_AudioVoice;
+
+/**
+ * Create a mixer with 'voices' voices, producing audio in the format,
+ * channels and buffer size of 'spec' (usually the obtained spec).
+ * The 32-bit formats are mixed at 16-bit precision.
+ *
+ * @return The new mixer, or NULL if there was an error.
+ */
+extern DECLSPEC SDL_AudioMixer * SDLCALL SDL_CreateAudioMixer(const SDL_AudioSpec *spec, int voices);
+extern DECLSPEC void SDLCALL SDL_FreeAudioMixer(SDL_AudioMixer *mixer);
+
+/**
+ * Fill 'stream' with 'len' bytes of the voices mixed together.  This
+ * is meant to be called from the audio callback.
+ */
+extern DECLSPEC void SDLCALL SDL_MixVoices(SDL_AudioMixer *mixer, Uint8 *stream, int len);
+
+/**
+ * Start playing a sound on a voice, or on the first idle voice if
+ * 'voice' is -1.  The sound data must stay valid while it is playing.
+ *
+ * @return The voice used, or -1 if there was an error.
+ */
+extern DECLSPEC int SDLCALL SDL_PlayVoice(SDL_AudioMixer *mixer, int voice, const SDL_AudioVoice *sound);
+
+/** Stop a voice.  Returns 0, or -1 if there was an error. */
+extern DECLSPEC int SDLCALL SDL_StopVoice(SDL_AudioMixer *mixer, int voice);
+
+/** Change the volume and pan of a voice.  Returns 0, or -1 on error. */
+extern DECLSPEC int SDLCALL SDL_SetVoiceVolume(SDL_AudioMixer *mixer, int voice, int volume, int pan);
+
+/** Change the playback rate of a voice.  Returns 0, or -1 on error. */
+extern DECLSPEC int SDLCALL SDL_SetVoiceRate(SDL_AudioMixer *mixer, int voice, Uint32 rate);
+
+/** Returns 1 if the voice is playing, or will be on the next mix */
+extern DECLSPEC int SDLCALL SDL_VoicePlaying(SDL_AudioMixer *mixer, int voice);
+
 /**
  * @name Audio Locks
  * The lock manipulated by these functions protects the callback function.
  * During a LockAudio/UnlockAudio pair, you can be guaranteed that the
  * callback function is not running.  Do not call these from the callback
- * function or you will cause deadlock.
+ * function or you will cause deadlock.  The callback of the capture
+ * device has its own lock, see SDL_LockAudioCapture().
  */
 /*@{*/
 extern DECLSPEC void SDLCALL SDL_LockAudio(void);
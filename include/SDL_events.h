@@ -289,6 +289,14 @@ extern DECLSPEC int SDLCALL SDL_PollEvent(SDL_Event *event);
  */
 extern DECLSPEC int SDLCALL SDL_WaitEvent(SDL_Event *event);
 
+/** Waits up to 'timeout' milliseconds for the next available event, returning
+ *  1, or 0 if the timeout elapsed or there was an error while waiting for
+ *  events.  A negative timeout waits indefinitely, like SDL_WaitEvent().
+ *  If 'event' is not NULL, the next event is removed from the queue and
+ *  stored in that area.
+ */
+extern DECLSPEC int SDLCALL SDL_WaitEventTimeout(SDL_Event *event, int timeout);
+
 /** Add an event to the event queue.
  *  This function returns 0 on success, or -1 if the event queue was full
  *  or there was some other error.
@@ -39,7 +39,11 @@ extern "C" {
 /** This is the OS scheduler timeslice, in milliseconds */
 #define SDL_TIMESLICE		10
 
-/** This is the maximum resolution of the SDL timer on all platforms */
+/** This is the maximum resolution of the SDL timer on all platforms.
+ *  Timers created with SDL_AddTimer() round their interval up to it,
+ *  unless the SDL_TIMER_RESOLUTION environment variable asks for a finer
+ *  resolution in milliseconds.
+ */
 #define TIMER_RESOLUTION	10	/**< Experimentally determined */
 
 /**
@@ -51,6 +55,26 @@ extern DECLSPEC Uint32 SDLCALL SDL_GetTicks(void);
 /** Wait a specified number of milliseconds before returning */
 extern DECLSPEC void SDLCALL SDL_Delay(Uint32 ms);
 
+#ifdef SDL_HAS_64BIT_TYPE
+/**
+ * Get the number of nanoseconds since the SDL library initialization.
+ * This uses a monotonic clock where the platform has one, but the actual
+ * resolution may be as coarse as SDL_GetTicks().
+ */
+extern DECLSPEC Uint64 SDLCALL SDL_GetTicksNS(void);
+
+/** Wait a specified number of nanoseconds before returning */
+extern DECLSPEC void SDLCALL SDL_DelayNS(Uint64 ns);
+
+/**
+ * Wait until SDL_GetTicksNS() reaches 'deadline' before returning.
+ * Sleeping towards an absolute deadline doesn't accumulate drift, which
+ * makes it suited to pacing frames: add the frame period to the previous
+ * deadline each time.
+ */
+extern DECLSPEC void SDLCALL SDL_DelayUntilNS(Uint64 deadline);
+#endif /* SDL_HAS_64BIT_TYPE */
+
 /** Function prototype for the timer callback function */
 typedef Uint32 (SDLCALL *SDL_TimerCallback)(Uint32 interval);
 
@@ -399,6 +399,27 @@ extern DECLSPEC void SDLCALL SDL_UpdateRects
  */
 extern DECLSPEC void SDLCALL SDL_UpdateRect
 		(SDL_Surface *screen, Sint32 x, Sint32 y, Uint32 w, Uint32 h);
+
+/** Counters kept while SDL_UpdateRects() merges rectangles */
+typedef struct SDL_UpdateStats {
+	Uint32 frames;			/**< Updates that were merged */
+	Uint64 pixels_requested;	/**< Area of the rectangles passed in,
+					     overlapping pixels once for
+					     each rectangle */
+	Uint64 pixels_updated;		/**< Area passed on to the driver,
+					     which doesn't overlap */
+	Uint32 full_updates;		/**< Updates done as the full screen */
+} SDL_UpdateStats;
+
+/**
+ * Fills in 'stats' with the counters for the current screen size, so
+ * the pixels saved are pixels_requested - pixels_updated.  The counters
+ * start again when the screen size changes.
+ *
+ * Returns 0, or -1 if the video driver doesn't merge rectangles or no
+ * update has been merged yet.
+ */
+extern DECLSPEC int SDLCALL SDL_GetUpdateStats(SDL_UpdateStats *stats);
 /*@}*/
 
 /**
@@ -755,6 +776,51 @@ extern DECLSPEC int SDLCALL SDL_LowerBlit
 			(SDL_Surface *src, SDL_Rect *srcrect,
 			 SDL_Surface *dst, SDL_Rect *dstrect);
 
+/**
+ * This function returns the name of the low level routine that blits
+ * 'src' onto 'dst' with their current formats and flags, or NULL if the
+ * two surfaces can't be blitted.
+ *
+ * The generic C routines are named "BlitNtoN", "BlitNtoNPixelAlpha" and
+ * so on.  RLE encoded sources report "SDL_RLEBlit" or "SDL_RLEAlphaBlit",
+ * and accelerated blits report "hardware".  The names are meant for
+ * benchmarks and debugging, and may change between releases.
+ */
+extern DECLSPEC const char * SDLCALL SDL_GetBlitName
+			(SDL_Surface *src, SDL_Surface *dst);
+
+/** One of the blits done by SDL_BlitSurfaces() */
+typedef struct SDL_BlitEntry {
+	SDL_Surface *src;
+	SDL_Rect srcrect;	/**< The part of 'src' to blit */
+	SDL_Rect dstrect;	/**< Where it goes, clipped on return */
+} SDL_BlitEntry;
+
+/**
+ * This function does a batch of blits onto one destination surface, as if
+ * SDL_BlitSurface() were called for each entry in turn, but with the
+ * clipping done for all of them up front and the destination locked once
+ * for the software blits.  This pays off for tile maps and sprites, where
+ * the fixed cost of SDL_BlitSurface() outweighs blitting a few pixels.
+ *
+ * The blits are done in array order, so later entries draw over earlier
+ * ones.  Consecutive entries with the same source share its setup, so
+ * grouping entries by source where they don't overlap helps.
+ *
+ * Unlike SDL_BlitSurface(), every entry needs a source rectangle.  On
+ * return each 'dstrect' holds the area that was drawn, with a zero width
+ * and height if it was clipped away.  If 'dirty' isn't NULL, it must have
+ * room for 'numblits' rectangles, and the areas drawn are also packed into
+ * it, ready for SDL_UpdateRects(), with the count stored in 'numdirty'.
+ *
+ * The return values are the same as for SDL_BlitSurface().  If a blit
+ * fails, the ones after it are not done and no dirty rectangles are
+ * returned.
+ */
+extern DECLSPEC int SDLCALL SDL_BlitSurfaces
+			(SDL_BlitEntry *blits, int numblits, SDL_Surface *dst,
+			 SDL_Rect *dirty, int *numdirty);
+
 /**
  * This function performs a fast fill of the given rectangle with 'color'
  * The given rectangle is clipped to the destination surface clip area
@@ -941,6 +1007,27 @@ extern DECLSPEC SDL_GrabMode SDLCALL SDL_WM_GrabInput(SDL_GrabMode mode);
 /** @internal Not in public API at the moment - do not use! */
 extern DECLSPEC int SDLCALL SDL_SoftStretch(SDL_Surface *src, SDL_Rect *srcrect,
                                     SDL_Surface *dst, SDL_Rect *dstrect);
+
+/** Filters for SDL_SoftStretchFilter() */
+typedef enum {
+	SDL_STRETCH_NEAREST = 0,	/**< Nearest pixel, no filtering */
+	SDL_STRETCH_BILINEAR,		/**< Blend the nearest 2x2 pixels */
+	SDL_STRETCH_BOX			/**< Average the pixels each one covers */
+} SDL_StretchFilter;
+
+/**
+ * Performs a stretch blit from 'srcrect' in 'src' to 'dstrect' in 'dst',
+ * converting to the destination format on the way.  NULL rectangles
+ * mean the whole surface.  Bilinear filtering is meant for scaling up,
+ * box filtering for scaling down.  The destination can't be palettized
+ * unless both surfaces have the same format and 'filter' is
+ * SDL_STRETCH_NEAREST.  No clipping is done.
+ *
+ * @return 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_SoftStretchFilter(SDL_Surface *src, SDL_Rect *srcrect,
+                                    SDL_Surface *dst, SDL_Rect *dstrect,
+                                    SDL_StretchFilter filter);
                     
 /* Ends C function definitions when using C++ */
 #ifdef __cplusplus
@@ -117,9 +117,24 @@ static AudioBootStrap *bootstrap[] = {
 };
 SDL_AudioDevice *current_audio = NULL;
 
+/* The recording device, from the same driver as current_audio */
+static SDL_AudioDevice *current_capture = NULL;
+
+/* Recorded data is dropped when the application hasn't read this many
+   buffers of it with SDL_ReadAudioCapture() */
+#define CAPTURE_MAXQUEUE	8
+
+/* The latency for the next device opened, from SDL_SetAudioLatency() */
+static int audio_latency_ms = 0;
+
+/* Whether the callback of the next device opened writes its whole
+   buffer, from SDL_SetAudioCallbackFills() */
+static int audio_callback_fills = 0;
+
 /* Various local functions */
 int SDL_AudioInit(const char *driver_name);
 void SDL_AudioQuit(void);
+static void SDL_ShutdownAudioDevice(SDL_AudioDevice *audio);
 
 /* The general mixing thread function */
 int SDLCALL SDL_RunAudio(void *audiop)
@@ -130,6 +145,7 @@ int SDLCALL SDL_RunAudio(void *audiop)
 	void  *udata;
 	void (SDLCALL *fill)(void *userdata,Uint8 *stream, int len);
 	int    silence;
+	SDL_AudioCVT convert;
 
 	/* Perform any thread setup */
 	if ( audio->ThreadInit ) {
@@ -141,7 +157,10 @@ int SDLCALL SDL_RunAudio(void *audiop)
 	fill  = audio->spec.callback;
 	udata = audio->spec.userdata;
 
-	if ( audio->convert.needed ) {
+	if ( audio->stream ) {
+		silence = audio->stream_silence;
+		stream_len = audio->stream_len;
+	} else if ( audio->convert.needed ) {
 		if ( audio->convert.src_format == AUDIO_U8 ) {
 			silence = 0x80;
 		} else {
@@ -153,6 +172,11 @@ int SDLCALL SDL_RunAudio(void *audiop)
 		stream_len = audio->spec.size;
 	}
 
+	/* The callback writes to the device buffer, which is converted there */
+	if ( audio->convert_in_place ) {
+		SDL_memcpy(&convert, &audio->convert, sizeof(convert));
+	}
+
 #ifdef __OS2__
         /* Increase the priority of this thread to make sure that
            the audio will be continuous all the time! */
@@ -177,8 +201,41 @@ int SDLCALL SDL_RunAudio(void *audiop)
 	/* Loop, filling the audio buffers */
 	while ( audio->enabled ) {
 
+		/* Run the callback as often as the rate conversion needs */
+		if ( audio->stream ) {
+			stream = audio->GetAudioBuf(audio);
+			if ( stream == NULL ) {
+				stream = audio->fake_stream;
+			}
+			while ( SDL_AudioStreamAvailable(audio->stream) <
+			        (int)audio->spec.size ) {
+				if ( audio->paused || ! audio->callback_fills ) {
+					SDL_memset(audio->stream_buf, silence,
+					           stream_len);
+				}
+				if ( ! audio->paused ) {
+					SDL_mutexP(audio->mixer_lock);
+					(*fill)(udata, audio->stream_buf, stream_len);
+					SDL_mutexV(audio->mixer_lock);
+				}
+				if ( SDL_AudioStreamPut(audio->stream,
+				             audio->stream_buf, stream_len) < 0 ) {
+					break;
+				}
+			}
+			SDL_AudioStreamGet(audio->stream, stream, audio->spec.size);
+
+			if ( stream != audio->fake_stream ) {
+				audio->PlayAudio(audio);
+				audio->WaitAudio(audio);
+			} else {
+				SDL_Delay((audio->spec.samples*1000)/audio->spec.freq);
+			}
+			continue;
+		}
+
 		/* Fill the current buffer with sound */
-		if ( audio->convert.needed ) {
+		if ( audio->convert.needed && ! audio->convert_in_place ) {
 			if ( audio->convert.buf ) {
 				stream = audio->convert.buf;
 			} else {
@@ -191,7 +248,9 @@ int SDLCALL SDL_RunAudio(void *audiop)
 			}
 		}
 
-		SDL_memset(stream, silence, stream_len);
+		if ( audio->paused || ! audio->callback_fills ) {
+			SDL_memset(stream, silence, stream_len);
+		}
 
 		if ( ! audio->paused ) {
 			SDL_mutexP(audio->mixer_lock);
@@ -200,7 +259,10 @@ int SDLCALL SDL_RunAudio(void *audiop)
 		}
 
 		/* Convert the audio if necessary */
-		if ( audio->convert.needed ) {
+		if ( audio->convert_in_place ) {
+			convert.buf = stream;
+			SDL_ConvertAudio(&convert);
+		} else if ( audio->convert.needed ) {
 			SDL_ConvertAudio(&audio->convert);
 			stream = audio->GetAudioBuf(audio);
 			if ( stream == NULL ) {
@@ -236,6 +298,78 @@ int SDLCALL SDL_RunAudio(void *audiop)
 	return(0);
 }
 
+/* The recording thread function */
+int SDLCALL SDL_RunAudioCapture(void *audiop)
+{
+	SDL_AudioDevice *audio = (SDL_AudioDevice *)audiop;
+	Uint8 *stream;
+	int    stream_len;
+	void  *udata;
+	void (SDLCALL *fill)(void *userdata,Uint8 *stream, int len);
+	int    excess;
+
+	/* Perform any thread setup */
+	if ( audio->ThreadInit ) {
+		audio->ThreadInit(audio);
+	}
+	audio->threadid = SDL_ThreadID();
+
+	fill  = audio->spec.callback;
+	udata = audio->spec.userdata;
+
+	/* Loop, reading the audio buffers */
+	while ( audio->enabled ) {
+		stream = audio->RecordAudio(audio);
+		if ( stream == NULL ) {
+			SDL_Delay((audio->spec.samples*1000)/audio->spec.freq);
+			continue;
+		}
+		stream_len = audio->spec.size;
+
+		/* Keep the device running, but throw the data away */
+		if ( audio->paused ) {
+			continue;
+		}
+
+		/* Rate conversion, and reading with SDL_ReadAudioCapture() */
+		if ( audio->stream ) {
+			SDL_mutexP(audio->mixer_lock);
+			SDL_AudioStreamPut(audio->stream, stream, stream_len);
+			if ( fill ) {
+				while ( SDL_AudioStreamAvailable(audio->stream) >=
+				        audio->stream_len ) {
+					SDL_AudioStreamGet(audio->stream,
+					       audio->stream_buf, audio->stream_len);
+					(*fill)(udata, audio->stream_buf,
+					        audio->stream_len);
+				}
+			} else {
+				excess = SDL_AudioStreamAvailable(audio->stream) -
+				         CAPTURE_MAXQUEUE * audio->stream_len;
+				while ( excess > 0 ) {
+					excess -= SDL_AudioStreamGet(audio->stream,
+					  audio->stream_buf, SDL_min(excess,
+					                   audio->stream_len));
+				}
+			}
+			SDL_mutexV(audio->mixer_lock);
+			continue;
+		}
+
+		/* The callback gets the driver's buffer unless it's converted */
+		if ( audio->convert.needed ) {
+			SDL_memcpy(audio->convert.buf, stream, stream_len);
+			SDL_ConvertAudio(&audio->convert);
+			stream = audio->convert.buf;
+			stream_len = audio->convert.len_cvt;
+		}
+		SDL_mutexP(audio->mixer_lock);
+		(*fill)(udata, stream, stream_len);
+		SDL_mutexV(audio->mixer_lock);
+	}
+	return(0);
+}
+
 static void SDL_LockAudio_Default(SDL_AudioDevice *audio)
 {
 	if ( audio->thread && (SDL_ThreadID() == audio->threadid) ) {
@@ -255,6 +389,7 @@ static void SDL_UnlockAudio_Default(SDL_AudioDevice *audio)
 static Uint16 SDL_ParseAudioFormat(const char *string)
 {
 	Uint16 format = 0;
+	int bits;
 
 	switch (*string) {
 	    case 'U':
@@ -265,17 +400,33 @@ static Uint16 SDL_ParseAudioFormat(const char *string)
 		++string;
 		format |= 0x8000;
 		break;
+	    case 'F':
+		++string;
+		format |= 0x8100;
+		break;
 	    default:
 		return 0;
 	}
-	switch (SDL_atoi(string)) {
+	bits = SDL_atoi(string);
+	switch (bits) {
 	    case 8:
+		if ( format & 0x0100 ) {
+			return 0;
+		}
 		string += 1;
 		format |= 8;
 		break;
 	    case 16:
+		if ( format & 0x0100 ) {
+			return 0;
+		}
+		/* Fall through */
+	    case 32:
+		if ( (bits == 32) && !(format & 0x8000) ) {
+			return 0;	/* there's no unsigned 32-bit format */
+		}
 		string += 2;
-		format |= 16;
+		format |= bits;
 		if ( SDL_strcmp(string, "LSB") == 0
 #if SDL_BYTEORDER == SDL_LIL_ENDIAN
 		     || SDL_strcmp(string, "SYS") == 0
@@ -374,6 +525,7 @@ int SDL_AudioInit(const char *driver_name)
 #endif
 		}
 	}
+	SDL_InitResamplerCache();
 	current_audio = audio;
 	if ( current_audio ) {
 		current_audio->name = bootstrap[i]->name;
@@ -394,26 +546,11 @@ char *SDL_AudioDriverName(char *namebuf, int maxlen)
 	return(NULL);
 }
 
-int SDL_OpenAudio(SDL_AudioSpec *desired, SDL_AudioSpec *obtained)
+/* Fill in the parts of the spec the application left to us */
+static int SDL_DefaultAudioSpec(SDL_AudioSpec *desired)
 {
-	SDL_AudioDevice *audio;
 	const char *env;
 
-	/* Start up the audio driver, if necessary */
-	if ( ! current_audio ) {
-		if ( (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) ||
-		     (current_audio == NULL) ) {
-			return(-1);
-		}
-	}
-	audio = current_audio;
-
-	if (audio->opened) {
-		SDL_SetError("Audio device is already opened");
-		return(-1);
-	}
-
-	/* Verify some parameters */
 	if ( desired->freq == 0 ) {
 		env = SDL_getenv("SDL_AUDIO_FREQUENCY");
 		if ( env ) {
@@ -469,6 +606,42 @@ int SDL_OpenAudio(SDL_AudioSpec *desired, SDL_AudioSpec *obtained)
 		}
 		desired->samples = power2;
 	}
+	if ( audio_latency_ms > 0 ) {
+		/* Two callback buffers have to fit in the latency */
+		int samples = (desired->freq / 1000) * audio_latency_ms / 2;
+		int power2 = 16;
+		while ( power2*2 <= samples ) {
+			power2 *= 2;
+		}
+		if ( desired->samples > power2 ) {
+			desired->samples = power2;
+		}
+	}
+	return(0);
+}
+
+int SDL_OpenAudio(SDL_AudioSpec *desired, SDL_AudioSpec *obtained)
+{
+	SDL_AudioDevice *audio;
+
+	/* Start up the audio driver, if necessary */
+	if ( ! current_audio ) {
+		if ( (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) ||
+		     (current_audio == NULL) ) {
+			return(-1);
+		}
+	}
+	audio = current_audio;
+
+	if (audio->opened) {
+		SDL_SetError("Audio device is already opened");
+		return(-1);
+	}
+
+	/* Verify some parameters */
+	if ( SDL_DefaultAudioSpec(desired) < 0 ) {
+		return(-1);
+	}
 	if ( desired->callback == NULL ) {
 		SDL_SetError("SDL_OpenAudio() passed a NULL callback");
 		return(-1);
@@ -492,16 +665,36 @@ int SDL_OpenAudio(SDL_AudioSpec *desired, SDL_AudioSpec *obtained)
 	/* Open the audio subsystem */
 	SDL_memcpy(&audio->spec, desired, sizeof(audio->spec));
 	audio->convert.needed = 0;
+	audio->convert_in_place = 0;
+	audio->stream = NULL;
+	audio->callback_fills = audio_callback_fills;
+	audio->latency_ms = audio_latency_ms;
+	audio->latency_frames = 0;
+	audio->underruns = 0;
 	audio->enabled = 1;
 	audio->paused  = 1;
 
 	audio->opened = audio->OpenAudio(audio, &audio->spec)+1;
 
+	/* Not every driver knows the 32-bit formats, so fall back to 16-bit
+	   samples and convert them */
+	if ( ! audio->opened && ((desired->format & 0xFF) == 32) ) {
+		SDL_memcpy(&audio->spec, desired, sizeof(audio->spec));
+		audio->spec.format = AUDIO_S16SYS;
+		SDL_CalculateAudioSpec(&audio->spec);
+		audio->opened = audio->OpenAudio(audio, &audio->spec)+1;
+	}
+
 	if ( ! audio->opened ) {
 		SDL_CloseAudio();
 		return(-1);
 	}
 
+	/* Drivers that don't say are assumed to double buffer */
+	if ( audio->latency_frames == 0 ) {
+		audio->latency_frames = 2 * audio->spec.samples;
+	}
+
 	/* If the audio driver changes the buffer size, accept it */
 	if ( audio->spec.samples != desired->samples ) {
 		desired->samples = audio->spec.samples;
@@ -522,25 +715,58 @@ int SDL_OpenAudio(SDL_AudioSpec *desired, SDL_AudioSpec *obtained)
 	} else if ( desired->freq != audio->spec.freq ||
                     desired->format != audio->spec.format ||
 	            desired->channels != audio->spec.channels ) {
-		/* Build an audio conversion block */
-		if ( SDL_BuildAudioCVT(&audio->convert,
-			desired->format, desired->channels,
-					desired->freq,
-			audio->spec.format, audio->spec.channels,
-					audio->spec.freq) < 0 ) {
-			SDL_CloseAudio();
-			return(-1);
-		}
-		if ( audio->convert.needed ) {
-			audio->convert.len = (int) ( ((double) audio->spec.size) /
-                                          audio->convert.len_ratio );
-			audio->convert.buf =(Uint8 *)SDL_AllocAudioMem(
-			   audio->convert.len*audio->convert.len_mult);
-			if ( audio->convert.buf == NULL ) {
+		/* A rate change goes through an audio stream, which keeps
+		   the resampler state from one buffer to the next */
+		if ( desired->freq != audio->spec.freq ) {
+			audio->stream = SDL_NewAudioStream(
+				desired->format, desired->channels, desired->freq,
+				audio->spec.format, audio->spec.channels,
+				audio->spec.freq);
+			if ( audio->stream == NULL ) {
+				SDL_CloseAudio();
+				return(-1);
+			}
+			audio->stream_len = desired->size;
+			audio->stream_silence = desired->silence;
+			audio->stream_format = desired->format;
+			audio->stream_buf = (Uint8 *)SDL_AllocAudioMem(
+			   audio->stream_len);
+			if ( audio->stream_buf == NULL ) {
 				SDL_CloseAudio();
 				SDL_OutOfMemory();
 				return(-1);
 			}
+		} else {
+			/* Build an audio conversion block */
+			if ( SDL_BuildAudioCVT(&audio->convert,
+				desired->format, desired->channels,
+						desired->freq,
+				audio->spec.format, audio->spec.channels,
+						audio->spec.freq) < 0 ) {
+				SDL_CloseAudio();
+				return(-1);
+			}
+			if ( audio->convert.needed ) {
+				audio->convert.len = (int) ( ((double) audio->spec.size) /
+				                        audio->convert.len_ratio );
+				/* If the conversion fits in the device buffer,
+				   the audio thread has the callback write there and
+				   converts it in place, without another buffer.
+				   Drivers that call the callback use convert.buf. */
+				if ( (audio->opened == 1) &&
+				     (audio->convert.len*audio->convert.len_mult <=
+				      (int)audio->spec.size) ) {
+					audio->convert_in_place = 1;
+				} else {
+					audio->convert.buf =(Uint8 *)SDL_AllocAudioMem(
+					   audio->convert.len*audio->convert.len_mult);
+					if ( audio->convert.buf == NULL ) {
+						SDL_CloseAudio();
+						SDL_OutOfMemory();
+						return(-1);
+					}
+				}
+			}
 		}
 	}
 
@@ -594,6 +820,221 @@ void SDL_PauseAudio (int pause_on)
 	}
 }
 
+void SDL_SetAudioLatency(int ms)
+{
+	audio_latency_ms = (ms > 0) ? ms : 0;
+}
+
+void SDL_SetAudioCallbackFills(int fills)
+{
+	audio_callback_fills = (fills != 0);
+}
+
+int SDL_GetAudioLatency(void)
+{
+	SDL_AudioDevice *audio = current_audio;
+
+	if ( !audio || !audio->opened || (audio->spec.freq <= 0) ) {
+		return(-1);
+	}
+	return((int)(((double)audio->latency_frames * 1000.0) /
+	             audio->spec.freq + 0.5));
+}
+
+Uint32 SDL_GetAudioUnderruns(void)
+{
+	SDL_AudioDevice *audio = current_audio;
+
+	if ( !audio || !audio->opened ) {
+		return(0);
+	}
+	return(audio->underruns);
+}
+
+int SDL_OpenAudioCapture(SDL_AudioSpec *desired, SDL_AudioSpec *obtained)
+{
+	SDL_AudioDevice *audio;
+	int i;
+
+	/* Start up the audio driver, if necessary */
+	if ( ! current_audio ) {
+		if ( (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) ||
+		     (current_audio == NULL) ) {
+			return(-1);
+		}
+	}
+	if ( current_capture ) {
+		SDL_SetError("Audio capture device is already opened");
+		return(-1);
+	}
+	if ( current_audio->RecordAudio == NULL ) {
+		SDL_SetError("The %s audio driver can't record",
+		             current_audio->name);
+		return(-1);
+	}
+
+	/* Verify some parameters */
+	if ( SDL_DefaultAudioSpec(desired) < 0 ) {
+		return(-1);
+	}
+	SDL_CalculateAudioSpec(desired);
+
+	/* Recording uses a device of its own from the same driver */
+	for ( i=0; bootstrap[i]; ++i ) {
+		if ( SDL_strcmp(bootstrap[i]->name, current_audio->name) == 0 ) {
+			break;
+		}
+	}
+	audio = bootstrap[i]->create(0);
+	if ( audio == NULL ) {
+		return(-1);
+	}
+	audio->name = current_audio->name;
+	audio->iscapture = 1;
+	current_capture = audio;
+
+	/* Create a semaphore for locking the recorded data */
+	audio->mixer_lock = SDL_CreateMutex();
+	if ( audio->mixer_lock == NULL ) {
+		SDL_SetError("Couldn't create mixer lock");
+		SDL_CloseAudioCapture();
+		return(-1);
+	}
+
+	/* Open the input device */
+	SDL_memcpy(&audio->spec, desired, sizeof(audio->spec));
+	audio->convert.needed = 0;
+	audio->stream = NULL;
+	audio->enabled = 1;
+	audio->paused  = 1;
+
+	audio->opened = audio->OpenAudio(audio, &audio->spec)+1;
+	if ( ! audio->opened && ((desired->format & 0xFF) == 32) ) {
+		SDL_memcpy(&audio->spec, desired, sizeof(audio->spec));
+		audio->spec.format = AUDIO_S16SYS;
+		SDL_CalculateAudioSpec(&audio->spec);
+		audio->opened = audio->OpenAudio(audio, &audio->spec)+1;
+	}
+	if ( ! audio->opened ) {
+		SDL_CloseAudioCapture();
+		return(-1);
+	}
+	if ( audio->spec.samples != desired->samples ) {
+		desired->samples = audio->spec.samples;
+		SDL_CalculateAudioSpec(desired);
+	}
+
+	/* Without a callback, recorded data is queued until it's read,
+	   through an audio stream that also converts it */
+	if ( obtained != NULL ) {
+		SDL_memcpy(obtained, &audio->spec, sizeof(audio->spec));
+		desired = obtained;
+	}
+	if ( (desired->callback == NULL) ||
+	     (desired->freq != audio->spec.freq) ) {
+		audio->stream = SDL_NewAudioStream(
+			audio->spec.format, audio->spec.channels,
+			audio->spec.freq,
+			desired->format, desired->channels, desired->freq);
+		if ( audio->stream == NULL ) {
+			SDL_CloseAudioCapture();
+			return(-1);
+		}
+		audio->stream_len = desired->size;
+		audio->stream_buf = (Uint8 *)SDL_AllocAudioMem(
+		   audio->stream_len);
+		if ( audio->stream_buf == NULL ) {
+			SDL_CloseAudioCapture();
+			SDL_OutOfMemory();
+			return(-1);
+		}
+	} else if ( (desired->format != audio->spec.format) ||
+	            (desired->channels != audio->spec.channels) ) {
+		if ( SDL_BuildAudioCVT(&audio->convert,
+			audio->spec.format, audio->spec.channels,
+					audio->spec.freq,
+			desired->format, desired->channels,
+					desired->freq) < 0 ) {
+			SDL_CloseAudioCapture();
+			return(-1);
+		}
+		if ( audio->convert.needed ) {
+			audio->convert.len = audio->spec.size;
+			audio->convert.buf = (Uint8 *)SDL_AllocAudioMem(
+			   audio->convert.len*audio->convert.len_mult);
+			if ( audio->convert.buf == NULL ) {
+				SDL_CloseAudioCapture();
+				SDL_OutOfMemory();
+				return(-1);
+			}
+		}
+	}
+
+	/* Start the recording thread */
+#if (defined(__WIN32__) && !defined(_WIN32_WCE)) && !defined(HAVE_LIBC) && !defined(__SYMBIAN32__)
+#undef SDL_CreateThread
+	audio->thread = SDL_CreateThread(SDL_RunAudioCapture, audio, NULL, NULL);
+#else
+	audio->thread = SDL_CreateThread(SDL_RunAudioCapture, audio);
+#endif
+	if ( audio->thread == NULL ) {
+		SDL_CloseAudioCapture();
+		SDL_SetError("Couldn't create audio capture thread");
+		return(-1);
+	}
+	return(0);
+}
+
+void SDL_PauseAudioCapture(int pause_on)
+{
+	SDL_AudioDevice *audio = current_capture;
+
+	if ( audio ) {
+		audio->paused = pause_on;
+	}
+}
+
+int SDL_ReadAudioCapture(void *buf, int len)
+{
+	SDL_AudioDevice *audio = current_capture;
+
+	if ( !audio || audio->spec.callback || !audio->stream ) {
+		SDL_SetError("Audio capture device isn't open for reading");
+		return(-1);
+	}
+	SDL_mutexP(audio->mixer_lock);
+	len = SDL_AudioStreamGet(audio->stream, buf, len);
+	SDL_mutexV(audio->mixer_lock);
+	return(len);
+}
+
+void SDL_LockAudioCapture(void)
+{
+	SDL_AudioDevice *audio = current_capture;
+
+	/* The capture callback runs under the capture device's own lock */
+	if ( audio ) {
+		SDL_LockAudio_Default(audio);
+	}
+}
+
+void SDL_UnlockAudioCapture(void)
+{
+	SDL_AudioDevice *audio = current_capture;
+
+	if ( audio ) {
+		SDL_UnlockAudio_Default(audio);
+	}
+}
+
+void SDL_CloseAudioCapture(void)
+{
+	if ( current_capture ) {
+		SDL_ShutdownAudioDevice(current_capture);
+		current_capture = NULL;
+	}
+}
+
 void SDL_LockAudio (void)
 {
 	SDL_AudioDevice *audio = current_audio;
@@ -619,45 +1060,70 @@ void SDL_CloseAudio (void)
 	SDL_QuitSubSystem(SDL_INIT_AUDIO);
 }
 
-void SDL_AudioQuit(void)
+/* Stop the thread and the driver, and free the device */
+static void SDL_ShutdownAudioDevice(SDL_AudioDevice *audio)
 {
-	SDL_AudioDevice *audio = current_audio;
-
-	if ( audio ) {
-		audio->enabled = 0;
-		if ( audio->thread != NULL ) {
-			SDL_WaitThread(audio->thread, NULL);
-		}
-		if ( audio->mixer_lock != NULL ) {
-			SDL_DestroyMutex(audio->mixer_lock);
-		}
-		if ( audio->fake_stream != NULL ) {
-			SDL_FreeAudioMem(audio->fake_stream);
+	audio->enabled = 0;
+	if ( audio->thread != NULL ) {
+		SDL_WaitThread(audio->thread, NULL);
+	}
+	if ( audio->mixer_lock != NULL ) {
+		SDL_DestroyMutex(audio->mixer_lock);
+	}
+	if ( audio->fake_stream != NULL ) {
+		SDL_FreeAudioMem(audio->fake_stream);
+	}
+	if ( audio->convert.needed ) {
+		SDL_FreeAudioMem(audio->convert.buf);
+	}
+	if ( audio->stream ) {
+		SDL_FreeAudioStream(audio->stream);
+		if ( audio->stream_buf ) {
+			SDL_FreeAudioMem(audio->stream_buf);
 		}
-		if ( audio->convert.needed ) {
-			SDL_FreeAudioMem(audio->convert.buf);
+	}
+	if ( audio->opened ) {
+		audio->CloseAudio(audio);
+		audio->opened = 0;
+	}
+	/* Free the driver data */
+	audio->free(audio);
+}
 
-		}
-		if ( audio->opened ) {
-			audio->CloseAudio(audio);
-			audio->opened = 0;
-		}
-		/* Free the driver data */
-		audio->free(audio);
+void SDL_AudioQuit(void)
+{
+	SDL_CloseAudioCapture();
+	if ( current_audio ) {
+		SDL_ShutdownAudioDevice(current_audio);
 		current_audio = NULL;
 	}
+	SDL_QuitResamplerCache();
 }
 
-#define NUM_FORMATS	6
+#define NUM_FORMATS	10
 static int format_idx;
 static int format_idx_sub;
 static Uint16 format_list[NUM_FORMATS][NUM_FORMATS] = {
- { AUDIO_U8, AUDIO_S8, AUDIO_S16LSB, AUDIO_S16MSB, AUDIO_U16LSB, AUDIO_U16MSB },
- { AUDIO_S8, AUDIO_U8, AUDIO_S16LSB, AUDIO_S16MSB, AUDIO_U16LSB, AUDIO_U16MSB },
- { AUDIO_S16LSB, AUDIO_S16MSB, AUDIO_U16LSB, AUDIO_U16MSB, AUDIO_U8, AUDIO_S8 },
- { AUDIO_S16MSB, AUDIO_S16LSB, AUDIO_U16MSB, AUDIO_U16LSB, AUDIO_U8, AUDIO_S8 },
- { AUDIO_U16LSB, AUDIO_U16MSB, AUDIO_S16LSB, AUDIO_S16MSB, AUDIO_U8, AUDIO_S8 },
- { AUDIO_U16MSB, AUDIO_U16LSB, AUDIO_S16MSB, AUDIO_S16LSB, AUDIO_U8, AUDIO_S8 },
+ { AUDIO_U8, AUDIO_S8, AUDIO_S16LSB, AUDIO_S16MSB, AUDIO_U16LSB, AUDIO_U16MSB,
+   AUDIO_S32LSB, AUDIO_S32MSB, AUDIO_F32LSB, AUDIO_F32MSB },
+ { AUDIO_S8, AUDIO_U8, AUDIO_S16LSB, AUDIO_S16MSB, AUDIO_U16LSB, AUDIO_U16MSB,
+   AUDIO_S32LSB, AUDIO_S32MSB, AUDIO_F32LSB, AUDIO_F32MSB },
+ { AUDIO_S16LSB, AUDIO_S16MSB, AUDIO_U16LSB, AUDIO_U16MSB, AUDIO_U8, AUDIO_S8,
+   AUDIO_S32LSB, AUDIO_S32MSB, AUDIO_F32LSB, AUDIO_F32MSB },
+ { AUDIO_S16MSB, AUDIO_S16LSB, AUDIO_U16MSB, AUDIO_U16LSB, AUDIO_U8, AUDIO_S8,
+   AUDIO_S32MSB, AUDIO_S32LSB, AUDIO_F32MSB, AUDIO_F32LSB },
+ { AUDIO_U16LSB, AUDIO_U16MSB, AUDIO_S16LSB, AUDIO_S16MSB, AUDIO_U8, AUDIO_S8,
+   AUDIO_S32LSB, AUDIO_S32MSB, AUDIO_F32LSB, AUDIO_F32MSB },
+ { AUDIO_U16MSB, AUDIO_U16LSB, AUDIO_S16MSB, AUDIO_S16LSB, AUDIO_U8, AUDIO_S8,
+   AUDIO_S32MSB, AUDIO_S32LSB, AUDIO_F32MSB, AUDIO_F32LSB },
+ { AUDIO_S32LSB, AUDIO_S32MSB, AUDIO_F32LSB, AUDIO_F32MSB, AUDIO_S16LSB,
+   AUDIO_S16MSB, AUDIO_U16LSB, AUDIO_U16MSB, AUDIO_U8, AUDIO_S8 },
+ { AUDIO_S32MSB, AUDIO_S32LSB, AUDIO_F32MSB, AUDIO_F32LSB, AUDIO_S16MSB,
+   AUDIO_S16LSB, AUDIO_U16MSB, AUDIO_U16LSB, AUDIO_U8, AUDIO_S8 },
+ { AUDIO_F32LSB, AUDIO_F32MSB, AUDIO_S32LSB, AUDIO_S32MSB, AUDIO_S16LSB,
+   AUDIO_S16MSB, AUDIO_U16LSB, AUDIO_U16MSB, AUDIO_U8, AUDIO_S8 },
+ { AUDIO_F32MSB, AUDIO_F32LSB, AUDIO_S32MSB, AUDIO_S32LSB, AUDIO_S16MSB,
+   AUDIO_S16LSB, AUDIO_U16MSB, AUDIO_U16LSB, AUDIO_U8, AUDIO_S8 },
 };
 
 Uint16 SDL_FirstAudioFormat(Uint16 format)
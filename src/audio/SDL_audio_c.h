@@ -32,3 +32,11 @@ extern void SDL_CalculateAudioSpec(SDL_AudioSpec *spec);
 
 /* The actual mixing thread function */
 extern int SDLCALL SDL_RunAudio(void *audiop);
+
+/* The recording thread function */
+extern int SDLCALL SDL_RunAudioCapture(void *audiop);
+
+/* Set up and free the resamplers SDL_ConvertAudio() keeps between calls,
+   setting up also reads the resampling quality */
+extern void SDL_InitResamplerCache(void);
+extern void SDL_QuitResamplerCache(void);
@@ -24,6 +24,106 @@
 /* Functions for audio drivers to perform runtime conversion of audio format */
 
 #include "SDL_audio.h"
+#include "SDL_thread.h"
+#include "SDL_audio_c.h"
+#include "SDL_resample_c.h"
+#include "SDL_fusedcvt_c.h"
+
+
+/* The channel filters work on 32-bit samples in native byte order, which
+   BuildAudioCVT arranges by converting to that order first */
+static void SDL_ConvertMono32(SDL_AudioCVT *cvt, Uint16 format)
+{
+	int i;
+
+	if ( format & 0x0100 ) {
+		float *src, *dst;
+
+		src = (float *)cvt->buf;
+		dst = (float *)cvt->buf;
+		for ( i=cvt->len_cvt/8; i; --i ) {
+			*dst = (src[0] + src[1]) * 0.5f;
+			src += 2;
+			dst += 1;
+		}
+	} else {
+		Sint32 *src, *dst;
+
+		src = (Sint32 *)cvt->buf;
+		dst = (Sint32 *)cvt->buf;
+		for ( i=cvt->len_cvt/8; i; --i ) {
+			*dst = (src[0] / 2) + (src[1] / 2);
+			src += 2;
+			dst += 1;
+		}
+	}
+}
+
+/* Keep the first 'keep' of every 'stride' samples */
+static void SDL_ConvertStrip32(SDL_AudioCVT *cvt, int keep, int stride)
+{
+	int i, c;
+	Uint32 *src, *dst;
+
+	src = (Uint32 *)cvt->buf;
+	dst = (Uint32 *)cvt->buf;
+	for ( i=cvt->len_cvt/(4*stride); i; --i ) {
+		for ( c = 0; c < keep; ++c ) {
+			dst[c] = src[c];
+		}
+		src += stride;
+		dst += keep;
+	}
+}
+
+/* Spread stereo over 4 or 6 channels, like the 8 and 16 bit versions */
+static void SDL_ConvertSurround32(SDL_AudioCVT *cvt, Uint16 format,
+                                  int channels)
+{
+	int i;
+
+	if ( format & 0x0100 ) {
+		float *src, *dst, lf, rf, ce;
+
+		src = (float *)(cvt->buf+cvt->len_cvt);
+		dst = (float *)(cvt->buf+cvt->len_cvt*(channels/2));
+		for ( i=cvt->len_cvt/8; i; --i ) {
+			dst -= channels;
+			src -= 2;
+			lf = src[0];
+			rf = src[1];
+			ce = (lf + rf) * 0.5f;
+			dst[0] = lf;
+			dst[1] = rf;
+			dst[2] = lf - ce;
+			dst[3] = rf - ce;
+			if ( channels == 6 ) {
+				dst[4] = ce;
+				dst[5] = ce;
+			}
+		}
+	} else {
+		Sint32 *src, *dst, lf, rf, ce;
+
+		src = (Sint32 *)(cvt->buf+cvt->len_cvt);
+		dst = (Sint32 *)(cvt->buf+cvt->len_cvt*(channels/2));
+		for ( i=cvt->len_cvt/8; i; --i ) {
+			dst -= channels;
+			src -= 2;
+			lf = src[0];
+			rf = src[1];
+			ce = (lf / 2) + (rf / 2);
+			dst[0] = lf;
+			dst[1] = rf;
+			dst[2] = lf - ce;
+			dst[3] = rf - ce;
+			if ( channels == 6 ) {
+				dst[4] = ce;
+				dst[5] = ce;
+			}
+		}
+	}
+}
 
 
 /* Effectively mix right and left channels into a single channel */
@@ -35,7 +135,9 @@ void SDLCALL SDL_ConvertMono(SDL_AudioCVT *cvt, Uint16 format)
 #ifdef DEBUG_CONVERT
 	fprintf(stderr, "Converting to mono\n");
 #endif
-	switch (format&0x8018) {
+	if ( (format & 0xFF) == 32 ) {
+		SDL_ConvertMono32(cvt, format);
+	} else switch (format&0x8018) {
 
 		case AUDIO_U8: {
 			Uint8 *src, *dst;
@@ -142,7 +244,9 @@ void SDLCALL SDL_ConvertStrip(SDL_AudioCVT *cvt, Uint16 format)
 #ifdef DEBUG_CONVERT
 	fprintf(stderr, "Converting down to stereo\n");
 #endif
-	switch (format&0x8018) {
+	if ( (format & 0xFF) == 32 ) {
+		SDL_ConvertStrip32(cvt, 2, 6);
+	} else switch (format&0x8018) {
 
 		case AUDIO_U8: {
 			Uint8 *src, *dst;
@@ -258,7 +362,9 @@ void SDLCALL SDL_ConvertStrip_2(SDL_AudioCVT *cvt, Uint16 format)
 #ifdef DEBUG_CONVERT
 	fprintf(stderr, "Converting 6 down to quad\n");
 #endif
-	switch (format&0x8018) {
+	if ( (format & 0xFF) == 32 ) {
+		SDL_ConvertStrip32(cvt, 2, 4);
+	} else switch (format&0x8018) {
 
 		case AUDIO_U8: {
 			Uint8 *src, *dst;
@@ -372,7 +478,18 @@ void SDLCALL SDL_ConvertStereo(SDL_AudioCVT *cvt, Uint16 format)
 #ifdef DEBUG_CONVERT
 	fprintf(stderr, "Converting to stereo\n");
 #endif
-	if ( (format & 0xFF) == 16 ) {
+	if ( (format & 0xFF) == 32 ) {
+		Uint32 *src, *dst;
+
+		src = (Uint32 *)(cvt->buf+cvt->len_cvt);
+		dst = (Uint32 *)(cvt->buf+cvt->len_cvt*2);
+		for ( i=cvt->len_cvt/4; i; --i ) {
+			dst -= 2;
+			src -= 1;
+			dst[0] = src[0];
+			dst[1] = src[0];
+		}
+	} else if ( (format & 0xFF) == 16 ) {
 		Uint16 *src, *dst;
 
 		src = (Uint16 *)(cvt->buf+cvt->len_cvt);
@@ -410,7 +527,9 @@ void SDLCALL SDL_ConvertSurround(SDL_AudioCVT *cvt, Uint16 format)
 #ifdef DEBUG_CONVERT
 	fprintf(stderr, "Converting stereo to surround\n");
 #endif
-	switch (format&0x8018) {
+	if ( (format & 0xFF) == 32 ) {
+		SDL_ConvertSurround32(cvt, format, 6);
+	} else switch (format&0x8018) {
 
 		case AUDIO_U8: {
 			Uint8 *src, *dst, lf, rf, ce;
@@ -587,7 +706,9 @@ void SDLCALL SDL_ConvertSurround_4(SDL_AudioCVT *cvt, Uint16 format)
 #ifdef DEBUG_CONVERT
 	fprintf(stderr, "Converting stereo to quad\n");
 #endif
-	switch (format&0x8018) {
+	if ( (format & 0xFF) == 32 ) {
+		SDL_ConvertSurround32(cvt, format, 4);
+	} else switch (format&0x8018) {
 
 		case AUDIO_U8: {
 			Uint8 *src, *dst, lf, rf, ce;
@@ -798,7 +919,7 @@ void SDLCALL SDL_Convert8(SDL_AudioCVT *cvt, Uint16 format)
 		src += 2;
 		dst += 1;
 	}
-	format = ((format & ~0x9010) | AUDIO_U8);
+	format = ((format & ~0x1010) | AUDIO_U8);
 	cvt->len_cvt /= 2;
 	if ( cvt->filters[++cvt->filter_index] ) {
 		cvt->filters[cvt->filter_index](cvt, format);
@@ -856,6 +977,242 @@ void SDLCALL SDL_ConvertEndian(SDL_AudioCVT *cvt, Uint16 format)
 	}
 }
 
+/* Toggle endianness of 32-bit samples */
+void SDLCALL SDL_ConvertEndian32(SDL_AudioCVT *cvt, Uint16 format)
+{
+	int i;
+	Uint8 *data, tmp;
+
+#ifdef DEBUG_CONVERT
+	fprintf(stderr, "Converting audio endianness\n");
+#endif
+	data = cvt->buf;
+	for ( i=cvt->len_cvt/4; i; --i ) {
+		tmp = data[0];
+		data[0] = data[3];
+		data[3] = tmp;
+		tmp = data[1];
+		data[1] = data[2];
+		data[2] = tmp;
+		data += 4;
+	}
+	format = (format ^ 0x1000);
+	if ( cvt->filters[++cvt->filter_index] ) {
+		cvt->filters[cvt->filter_index](cvt, format);
+	}
+}
+
+/* The format SDL_ConvertFormat32() produces for 'dst_format': the 32-bit
+   formats in native byte order, so the channel and rate filters can work
+   on them directly, and the others as they are */
+static Uint16 SDL_ConvertTarget(Uint16 dst_format)
+{
+	if ( (dst_format & 0xFF) == 32 ) {
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+		dst_format &= ~0x1000;
+#else
+		dst_format |= 0x1000;
+#endif
+	}
+	return(dst_format);
+}
+
+/* Load 'n' samples as signed 32-bit values */
+static void SDL_LoadSamples32(const Uint8 *src, Uint16 format,
+                              Sint32 *dst, int n)
+{
+	union { Uint32 u; float f; } bits;
+	int i;
+
+	switch (format) {
+	    case AUDIO_U8:
+		for ( i = 0; i < n; ++i ) {
+			dst[i] = (Sint32)((Uint32)(src[i] ^ 0x80) << 24);
+		}
+		break;
+	    case AUDIO_S8:
+		for ( i = 0; i < n; ++i ) {
+			dst[i] = (Sint32)((Uint32)src[i] << 24);
+		}
+		break;
+	    case AUDIO_U16LSB:
+		for ( i = 0; i < n; ++i, src += 2 ) {
+			dst[i] = (Sint32)((Uint32)(src[0] |
+			                  ((src[1] ^ 0x80) << 8)) << 16);
+		}
+		break;
+	    case AUDIO_S16LSB:
+		for ( i = 0; i < n; ++i, src += 2 ) {
+			dst[i] = (Sint32)(((Uint32)src[1] << 24) | (src[0] << 16));
+		}
+		break;
+	    case AUDIO_U16MSB:
+		for ( i = 0; i < n; ++i, src += 2 ) {
+			dst[i] = (Sint32)((Uint32)(src[1] |
+			                  ((src[0] ^ 0x80) << 8)) << 16);
+		}
+		break;
+	    case AUDIO_S16MSB:
+		for ( i = 0; i < n; ++i, src += 2 ) {
+			dst[i] = (Sint32)(((Uint32)src[0] << 24) | (src[1] << 16));
+		}
+		break;
+	    case AUDIO_S32LSB:
+		for ( i = 0; i < n; ++i, src += 4 ) {
+			dst[i] = (Sint32)(((Uint32)src[3] << 24) |
+			                  (src[2] << 16) | (src[1] << 8) | src[0]);
+		}
+		break;
+	    case AUDIO_S32MSB:
+		for ( i = 0; i < n; ++i, src += 4 ) {
+			dst[i] = (Sint32)(((Uint32)src[0] << 24) |
+			                  (src[1] << 16) | (src[2] << 8) | src[3]);
+		}
+		break;
+	    case AUDIO_F32LSB:
+	    case AUDIO_F32MSB:
+		for ( i = 0; i < n; ++i, src += 4 ) {
+			if ( format == AUDIO_F32MSB ) {
+				bits.u = ((Uint32)src[0] << 24) |
+				         (src[1] << 16) | (src[2] << 8) | src[3];
+			} else {
+				bits.u = ((Uint32)src[3] << 24) |
+				         (src[2] << 16) | (src[1] << 8) | src[0];
+			}
+			/* Clip to the integer range, NaN included */
+			if ( bits.f >= 1.0f ) {
+				dst[i] = 0x7FFFFFFF;
+			} else if ( bits.f > -1.0f ) {
+				dst[i] = (Sint32)(bits.f * 2147483648.0f);
+			} else {
+				dst[i] = (Sint32)0x80000000;
+			}
+		}
+		break;
+	}
+}
+
+/* Store 'n' signed 32-bit values as samples in 'format' */
+static void SDL_StoreSamples32(const Sint32 *src, Uint8 *dst,
+                               Uint16 format, int n)
+{
+	union { Uint32 u; float f; } bits;
+	Uint32 sample;
+	int i;
+
+	switch (format) {
+	    case AUDIO_U8:
+		for ( i = 0; i < n; ++i ) {
+			dst[i] = (Uint8)((src[i] >> 24) + 0x80);
+		}
+		break;
+	    case AUDIO_S8:
+		for ( i = 0; i < n; ++i ) {
+			dst[i] = (Uint8)(src[i] >> 24);
+		}
+		break;
+	    case AUDIO_U16LSB:
+	    case AUDIO_S16LSB:
+		for ( i = 0; i < n; ++i, dst += 2 ) {
+			sample = (Uint32)src[i] >> 16;
+			if ( !(format & 0x8000) ) {
+				sample ^= 0x8000;
+			}
+			dst[0] = (Uint8)sample;
+			dst[1] = (Uint8)(sample >> 8);
+		}
+		break;
+	    case AUDIO_U16MSB:
+	    case AUDIO_S16MSB:
+		for ( i = 0; i < n; ++i, dst += 2 ) {
+			sample = (Uint32)src[i] >> 16;
+			if ( !(format & 0x8000) ) {
+				sample ^= 0x8000;
+			}
+			dst[0] = (Uint8)(sample >> 8);
+			dst[1] = (Uint8)sample;
+		}
+		break;
+	    case AUDIO_S32LSB:
+	    case AUDIO_S32MSB:
+	    case AUDIO_F32LSB:
+	    case AUDIO_F32MSB:
+		for ( i = 0; i < n; ++i, dst += 4 ) {
+			if ( format & 0x0100 ) {
+				bits.f = (float)src[i] * (1.0f / 2147483648.0f);
+				sample = bits.u;
+			} else {
+				sample = (Uint32)src[i];
+			}
+			if ( format & 0x1000 ) {
+				dst[0] = (Uint8)(sample >> 24);
+				dst[1] = (Uint8)(sample >> 16);
+				dst[2] = (Uint8)(sample >> 8);
+				dst[3] = (Uint8)sample;
+			} else {
+				dst[0] = (Uint8)sample;
+				dst[1] = (Uint8)(sample >> 8);
+				dst[2] = (Uint8)(sample >> 16);
+				dst[3] = (Uint8)(sample >> 24);
+			}
+		}
+		break;
+	}
+}
+
+/* Convert between a 32-bit format and any other in one pass, instead of
+   separate endian, sign and size passes.  The samples go through a small
+   buffer on the stack, a block at a time, front to back when the data
+   shrinks and back to front when it grows.
+ */
+#define CONVERT_BLOCK	256
+void SDLCALL SDL_ConvertFormat32(SDL_AudioCVT *cvt, Uint16 format)
+{
+	Sint32 block[CONVERT_BLOCK];
+	Uint16 dst_format;
+	int src_size, dst_size;
+	int samples, done, n;
+
+	dst_format = SDL_ConvertTarget(cvt->dst_format);
+#ifdef DEBUG_CONVERT
+	fprintf(stderr, "Converting audio format 0x%.4x to 0x%.4x\n",
+	        format, dst_format);
+#endif
+	src_size = (format & 0xFF) / 8;
+	dst_size = (dst_format & 0xFF) / 8;
+	samples = cvt->len_cvt / src_size;
+	if ( (format ^ dst_format) == 0x1000 ) {
+		/* Same format in the other byte order, keep every bit */
+		SDL_ConvertEndian32(cvt, format);
+		return;
+	}
+	if ( dst_size > src_size ) {
+		for ( done = samples; done > 0; done -= n ) {
+			n = (done < CONVERT_BLOCK) ? done : CONVERT_BLOCK;
+			SDL_LoadSamples32(cvt->buf+(done-n)*src_size, format,
+			                  block, n);
+			SDL_StoreSamples32(block, cvt->buf+(done-n)*dst_size,
+			                   dst_format, n);
+		}
+	} else {
+		for ( done = 0; done < samples; done += n ) {
+			n = samples - done;
+			if ( n > CONVERT_BLOCK ) {
+				n = CONVERT_BLOCK;
+			}
+			SDL_LoadSamples32(cvt->buf+done*src_size, format,
+			                  block, n);
+			SDL_StoreSamples32(block, cvt->buf+done*dst_size,
+			                   dst_format, n);
+		}
+	}
+	format = dst_format;
+	cvt->len_cvt = samples * dst_size;
+	if ( cvt->filters[++cvt->filter_index] ) {
+		cvt->filters[cvt->filter_index](cvt, format);
+	}
+}
+
 /* Convert rate up by multiple of 2 */
 void SDLCALL SDL_RateMUL2(SDL_AudioCVT *cvt, Uint16 format)
 {
@@ -1300,6 +1657,204 @@ void SDLCALL SDL_RateSLOW(SDL_AudioCVT *cvt, Uint16 format)
 	}
 }
 
+/* Recover the rate pair from cvt->rate_incr (src_rate / dst_rate).
+   The continued fraction expansion finds the exact pair for any two
+   rates that fit, in lowest terms, in RESAMPLE_MAXRATE. */
+#define RESAMPLE_MAXRATE	1000000
+static void SDL_RateFraction(double ratio, int *src_rate, int *dst_rate)
+{
+	double x, err;
+	int i, a, h0, h1, h2, k0, k1, k2;
+
+	h0 = 0; h1 = 1;
+	k0 = 1; k1 = 0;
+	x = ratio;
+	for ( i = 0; i < 32; ++i ) {
+		a = (int)x;
+		h2 = a*h1 + h0;
+		k2 = a*k1 + k0;
+		if ( (h2 > RESAMPLE_MAXRATE) || (k2 > RESAMPLE_MAXRATE) ) {
+			break;
+		}
+		h0 = h1; h1 = h2;
+		k0 = k1; k1 = k2;
+		err = (double)h1/k1 - ratio;
+		if ( (err < 1e-12*ratio) && (err > -1e-12*ratio) ) {
+			break;
+		}
+		x = 1.0 / (x - a);
+	}
+	*src_rate = h1;
+	*dst_rate = k1;
+}
+
+/* Building a resampler's filter tables costs several times more than
+   converting a buffer with them, so SDL_ConvertAudio() keeps the last
+   few resamplers it used while the audio subsystem is initialized.
+*/
+#define NUM_CACHED_RESAMPLERS	4
+
+static struct {
+	SDL_AudioResampler *resampler;
+	Uint16 format;
+	int channels;
+	int src_rate;
+	int dst_rate;
+	int quality;
+} resampler_cache[NUM_CACHED_RESAMPLERS];
+static int resampler_next = 0;
+static SDL_mutex *resampler_lock = NULL;
+
+void SDL_InitResamplerCache(void)
+{
+	SDL_ReadResampleQuality();
+	if ( resampler_lock == NULL ) {
+		resampler_lock = SDL_CreateMutex();
+	}
+}
+
+void SDL_QuitResamplerCache(void)
+{
+	int i;
+
+	for ( i = 0; i < NUM_CACHED_RESAMPLERS; ++i ) {
+		SDL_FreeResampler(resampler_cache[i].resampler);
+		resampler_cache[i].resampler = NULL;
+	}
+	if ( resampler_lock ) {
+		SDL_DestroyMutex(resampler_lock);
+		resampler_lock = NULL;
+	}
+}
+
+/* Take a matching resampler out of the cache, or create one */
+static SDL_AudioResampler *SDL_GetResampler(Uint16 format, int channels,
+                                            int src_rate, int dst_rate,
+                                            int quality)
+{
+	SDL_AudioResampler *resampler = NULL;
+	int i;
+
+	if ( resampler_lock && (SDL_mutexP(resampler_lock) == 0) ) {
+		for ( i = 0; i < NUM_CACHED_RESAMPLERS; ++i ) {
+			if ( resampler_cache[i].resampler &&
+			     (resampler_cache[i].format == format) &&
+			     (resampler_cache[i].channels == channels) &&
+			     (resampler_cache[i].src_rate == src_rate) &&
+			     (resampler_cache[i].dst_rate == dst_rate) &&
+			     (resampler_cache[i].quality == quality) ) {
+				resampler = resampler_cache[i].resampler;
+				resampler_cache[i].resampler = NULL;
+				break;
+			}
+		}
+		SDL_mutexV(resampler_lock);
+	}
+	if ( resampler ) {
+		SDL_ResetResampler(resampler);
+	} else {
+		resampler = SDL_CreateResampler(format, channels,
+		                                src_rate, dst_rate, quality);
+	}
+	return(resampler);
+}
+
+/* Put a resampler back in the cache, replacing the oldest if it's full */
+static void SDL_PutResampler(SDL_AudioResampler *resampler, Uint16 format,
+                             int channels, int src_rate, int dst_rate,
+                             int quality)
+{
+	int i;
+
+	if ( resampler_lock && (SDL_mutexP(resampler_lock) == 0) ) {
+		for ( i = 0; i < NUM_CACHED_RESAMPLERS; ++i ) {
+			if ( resampler_cache[i].resampler == NULL ) {
+				break;
+			}
+		}
+		if ( i == NUM_CACHED_RESAMPLERS ) {
+			i = resampler_next;
+			resampler_next = (i + 1) % NUM_CACHED_RESAMPLERS;
+			SDL_FreeResampler(resampler_cache[i].resampler);
+		}
+		resampler_cache[i].resampler = resampler;
+		resampler_cache[i].format = format;
+		resampler_cache[i].channels = channels;
+		resampler_cache[i].src_rate = src_rate;
+		resampler_cache[i].dst_rate = dst_rate;
+		resampler_cache[i].quality = quality;
+		SDL_mutexV(resampler_lock);
+	} else {
+		SDL_FreeResampler(resampler);
+	}
+}
+
+/* Rate conversion by any ratio, treating each buffer as a whole sound
+   with silence before and after it.  The output is in step with the
+   input, and ends with the last of it. */
+static void SDL_RateResample_cN(SDL_AudioCVT *cvt, Uint16 format,
+                                int channels)
+{
+	SDL_AudioResampler *resampler;
+	int src_rate, dst_rate, quality;
+	int framesize, in_frames, out_frames, used, written;
+	Uint8 *src;
+
+	SDL_RateFraction(cvt->rate_incr, &src_rate, &dst_rate);
+	quality = SDL_GetResampleQuality();
+	resampler = SDL_GetResampler(format, channels,
+	                             src_rate, dst_rate, quality);
+	if ( resampler ) {
+		framesize = ((format & 0xFF) / 8) * channels;
+		in_frames = cvt->len_cvt / framesize;
+		out_frames = SDL_ResamplerOutputFrames(resampler, in_frames);
+
+		/* When the data grows, move it to the end of the buffer so
+		   the output never overtakes the input still to be read */
+		src = cvt->buf;
+		if ( out_frames > in_frames ) {
+			src = cvt->buf + cvt->len*cvt->len_mult -
+			      in_frames*framesize;
+			SDL_memmove(src, cvt->buf, in_frames*framesize);
+		}
+		/* Make up for the filter delay at the start, and drain
+		   the filter into the rest of the output at the end */
+		used = SDL_ResamplePrime(resampler, src, in_frames);
+		in_frames -= used;
+		written = SDL_Resample(resampler, src + used*framesize,
+		                       &in_frames, cvt->buf, out_frames);
+		written += SDL_ResampleFlush(resampler,
+		                             cvt->buf + written*framesize,
+		                             out_frames - written);
+		cvt->len_cvt = written * framesize;
+		SDL_PutResampler(resampler, format, channels,
+		                 src_rate, dst_rate, quality);
+	}
+	if ( cvt->filters[++cvt->filter_index] ) {
+		cvt->filters[cvt->filter_index](cvt, format);
+	}
+}
+
+void SDLCALL SDL_RateResample(SDL_AudioCVT *cvt, Uint16 format)
+{
+	SDL_RateResample_cN(cvt, format, 1);
+}
+
+void SDLCALL SDL_RateResample_c2(SDL_AudioCVT *cvt, Uint16 format)
+{
+	SDL_RateResample_cN(cvt, format, 2);
+}
+
+void SDLCALL SDL_RateResample_c4(SDL_AudioCVT *cvt, Uint16 format)
+{
+	SDL_RateResample_cN(cvt, format, 4);
+}
+
+void SDLCALL SDL_RateResample_c6(SDL_AudioCVT *cvt, Uint16 format)
+{
+	SDL_RateResample_cN(cvt, format, 6);
+}
+
 int SDL_ConvertAudio(SDL_AudioCVT *cvt)
 {
 	/* Make sure there's data to convert */
@@ -1328,6 +1883,11 @@ int SDL_BuildAudioCVT(SDL_AudioCVT *cvt,
 	Uint16 src_format, Uint8 src_channels, int src_rate,
 	Uint16 dst_format, Uint8 dst_channels, int dst_rate)
 {
+	Uint16 work_format;
+	Uint8 in_channels;
+	int rate_steps;
+	SDL_AudioFilter fused;
+
 /*printf("Build format %04x->%04x, channels %u->%u, rate %d->%d\n",
 		src_format, dst_format, src_channels, dst_channels, src_rate, dst_rate);*/
 	/* Start off with no conversion necessary */
@@ -1336,38 +1896,61 @@ int SDL_BuildAudioCVT(SDL_AudioCVT *cvt,
 	cvt->filters[0] = NULL;
 	cvt->len_mult = 1;
 	cvt->len_ratio = 1.0;
+	in_channels = src_channels;
+	rate_steps = 0;
+
+	work_format = dst_format;
+	if ( ((src_format & 0xFF) == 32) || ((dst_format & 0xFF) == 32) ) {
+		/* One pass to the destination format, in native byte order
+		   if the channel or rate filters have to work on it */
+		if ( (src_format != dst_format) ||
+		     (src_channels != dst_channels) ||
+		     ((src_rate/100) != (dst_rate/100)) ) {
+			work_format = SDL_ConvertTarget(dst_format);
+		}
+		if ( src_format != work_format ) {
+			cvt->filters[cvt->filter_index++] =
+						SDL_ConvertFormat32;
+			if ( (work_format & 0xFF) > (src_format & 0xFF) ) {
+				cvt->len_mult *= (work_format & 0xFF) /
+				                 (src_format & 0xFF);
+			}
+			cvt->len_ratio *= (double)(work_format & 0xFF) /
+			                  (src_format & 0xFF);
+		}
+	} else {
+		/* First filter:  Endian conversion from src to dst */
+		if ( (src_format & 0x1000) != (dst_format & 0x1000)
+		     && ((src_format & 0xff) == 16) && ((dst_format & 0xff) == 16)) {
+			cvt->filters[cvt->filter_index++] = SDL_ConvertEndian;
+		}
 
-	/* First filter:  Endian conversion from src to dst */
-	if ( (src_format & 0x1000) != (dst_format & 0x1000)
-	     && ((src_format & 0xff) == 16) && ((dst_format & 0xff) == 16)) {
-		cvt->filters[cvt->filter_index++] = SDL_ConvertEndian;
-	}
-	
-	/* Second filter: Sign conversion -- signed/unsigned */
-	if ( (src_format & 0x8000) != (dst_format & 0x8000) ) {
-		cvt->filters[cvt->filter_index++] = SDL_ConvertSign;
-	}
+		/* Second filter: Sign conversion -- signed/unsigned */
+		if ( (src_format & 0x8000) != (dst_format & 0x8000) ) {
+			cvt->filters[cvt->filter_index++] = SDL_ConvertSign;
+		}
 
-	/* Next filter:  Convert 16 bit <--> 8 bit PCM */
-	if ( (src_format & 0xFF) != (dst_format & 0xFF) ) {
-		switch (dst_format&0x10FF) {
-			case AUDIO_U8:
-				cvt->filters[cvt->filter_index++] =
-							 SDL_Convert8;
-				cvt->len_ratio /= 2;
-				break;
-			case AUDIO_U16LSB:
-				cvt->filters[cvt->filter_index++] =
-							SDL_Convert16LSB;
-				cvt->len_mult *= 2;
-				cvt->len_ratio *= 2;
-				break;
-			case AUDIO_U16MSB:
-				cvt->filters[cvt->filter_index++] =
-							SDL_Convert16MSB;
-				cvt->len_mult *= 2;
-				cvt->len_ratio *= 2;
-				break;
+		/* Next filter:  Convert 16 bit <--> 8 bit PCM */
+		if ( (src_format & 0xFF) != (dst_format & 0xFF) ) {
+			switch (dst_format&0x10FF) {
+				case AUDIO_U8:
+					cvt->filters[cvt->filter_index++] =
+								 SDL_Convert8;
+					cvt->len_ratio /= 2;
+					break;
+				case AUDIO_U16LSB:
+					cvt->filters[cvt->filter_index++] =
+								SDL_Convert16LSB;
+					cvt->len_mult *= 2;
+					cvt->len_ratio *= 2;
+					break;
+				case AUDIO_U16MSB:
+					cvt->filters[cvt->filter_index++] =
+								SDL_Convert16MSB;
+					cvt->len_mult *= 2;
+					cvt->len_ratio *= 2;
+					break;
+			}
 		}
 	}
 
@@ -1468,32 +2051,47 @@ int SDL_BuildAudioCVT(SDL_AudioCVT *cvt,
 		}
 		/* If hi_rate = lo_rate*2^x then conversion is easy */
 		while ( ((lo_rate*2)/100) <= (hi_rate/100) ) {
-			cvt->filters[cvt->filter_index++] = rate_cvt;
-			cvt->len_mult *= len_mult;
 			lo_rate *= 2;
-			cvt->len_ratio *= len_ratio;
-		}
-		/* We may need a slow conversion here to finish up */
-		if ( (lo_rate/100) != (hi_rate/100) ) {
-#if 1
-			/* The problem with this is that if the input buffer is
-			   say 1K, and the conversion rate is say 1.1, then the
-			   output buffer is 1.1K, which may not be an acceptable
-			   buffer size for the audio driver (not a power of 2)
-			*/
-			/* For now, punt and hope the rate distortion isn't great.
-			*/
-#else
-			if ( src_rate < dst_rate ) {
-				cvt->rate_incr = (double)lo_rate/hi_rate;
-				cvt->len_mult *= 2;
-				cvt->len_ratio /= cvt->rate_incr;
-			} else {
-				cvt->rate_incr = (double)hi_rate/lo_rate;
-				cvt->len_ratio *= cvt->rate_incr;
+		}
+		if ( ((lo_rate/100) == (hi_rate/100)) &&
+		     ((work_format & 0xFF) != 32) ) {
+			lo_rate = (src_rate > dst_rate) ? dst_rate : src_rate;
+			while ( ((lo_rate*2)/100) <= (hi_rate/100) ) {
+				cvt->filters[cvt->filter_index++] = rate_cvt;
+				cvt->len_mult *= len_mult;
+				lo_rate *= 2;
+				cvt->len_ratio *= len_ratio;
+				rate_steps += (src_rate > dst_rate) ? -1 : 1;
 			}
-			cvt->filters[cvt->filter_index++] = SDL_RateSLOW;
-#endif
+		} else {
+			/* Otherwise filter for the exact ratio in one pass */
+			switch (src_channels) {
+				case 1: rate_cvt = SDL_RateResample; break;
+				case 2: rate_cvt = SDL_RateResample_c2; break;
+				case 4: rate_cvt = SDL_RateResample_c4; break;
+				case 6: rate_cvt = SDL_RateResample_c6; break;
+				default: return -1;
+			}
+			cvt->rate_incr = (double)src_rate/dst_rate;
+			cvt->len_mult *= (dst_rate+src_rate-1)/src_rate;
+			cvt->len_ratio *= (double)dst_rate/src_rate;
+			cvt->filters[cvt->filter_index++] = rate_cvt;
+		}
+	}
+
+	/* Put 32-bit samples back in the requested byte order */
+	if ( work_format != dst_format ) {
+		cvt->filters[cvt->filter_index++] = SDL_ConvertEndian32;
+	}
+
+	/* Do the whole chain in one pass if there's a kernel for it */
+	if ( (cvt->filter_index > 1) && (cvt->rate_incr == 0.0) ) {
+		fused = SDL_FusedAudioFilter(src_format, in_channels,
+		                             dst_format, dst_channels, rate_steps);
+		if ( fused ) {
+			cvt->filters[0] = fused;
+			cvt->filter_index = 1;
+			cvt->rate_incr = SDL_FusedRateIncr(rate_steps);
 		}
 	}
 
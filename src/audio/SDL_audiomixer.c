@@ -0,0 +1,530 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* A mixer for many voices at once
+
+   Each voice is added into a buffer of 32 bit sums at 16 bit precision
+   scaled by the volume, and the sums are clipped and converted to the
+   output format once at the end.  32 bit samples are mixed at 16 bit
+   precision too.
+
+   The control thread never touches the voices directly.  It puts
+   commands in a ring buffer, which SDL_MixVoices() empties before each
+   mix.  Each index of the ring is only written by one side, so no lock
+   is needed, just a memory barrier between writing a command and
+   publishing it.
+*/
+
+#include "SDL_audio.h"
+
+#if defined(__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 1)))
+#define SDL_MixerBarrier()	__sync_synchronize()
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define SDL_MixerBarrier()	_ReadWriteBarrier()
+#else
+#define SDL_MixerBarrier()
+#endif
+
+/* The number of commands that can wait for the next mix */
+#define MIXER_COMMANDS	256
+
+/* The number of sample frames mixed at a time */
+#define MIXER_CHUNK	1024
+
+enum {
+	MIXER_PLAY,
+	MIXER_STOP,
+	MIXER_VOLUME,
+	MIXER_RATE
+};
+
+typedef struct SDL_MixerCommand {
+	int type;
+	int voice;
+	Uint32 serial;
+	SDL_AudioVoice sound;
+} SDL_MixerCommand;
+
+typedef struct SDL_MixerVoice {
+	SDL_AudioVoice sound;
+	Uint32 frames;
+	Uint32 pos;
+	Uint32 frac;
+	int gain, left, right;	/* 0 - SDL_MIX_MAXVOLUME */
+	int playing;
+	Uint32 serial;		/* of the play command being carried out */
+
+	/* Play commands queued for the voice, and the last one finished.
+	   The voice is idle when they are equal. */
+	Uint32 started;
+	volatile Uint32 finished;
+} SDL_MixerVoice;
+
+struct SDL_AudioMixer {
+	Uint16 format;
+	int channels;
+	int framesize;
+
+	int numvoices;
+	SDL_MixerVoice *voices;
+
+	SDL_MixerCommand commands[MIXER_COMMANDS];
+	volatile Uint32 command_head;	/* written by the control thread */
+	volatile Uint32 command_tail;	/* written by the mixing thread */
+
+	Sint32 *sums;
+};
+
+/* 32 bit float samples in either byte order */
+static float SDL_MixerLoadFloat(const Uint8 *p, Uint16 format)
+{
+	union { Uint32 u; float f; } x;
+
+	if ( format & 0x1000 ) {
+		x.u = ((Uint32)p[0] << 24) | ((Uint32)p[1] << 16) |
+		      ((Uint32)p[2] << 8) | p[3];
+	} else {
+		x.u = ((Uint32)p[3] << 24) | ((Uint32)p[2] << 16) |
+		      ((Uint32)p[1] << 8) | p[0];
+	}
+	return(x.f);
+}
+
+static void SDL_MixerStore32(Uint8 *p, Uint16 format, Uint32 sample)
+{
+	if ( format & 0x1000 ) {
+		p[0] = (Uint8)(sample >> 24);
+		p[1] = (Uint8)(sample >> 16);
+		p[2] = (Uint8)(sample >> 8);
+		p[3] = (Uint8)sample;
+	} else {
+		p[0] = (Uint8)sample;
+		p[1] = (Uint8)(sample >> 8);
+		p[2] = (Uint8)(sample >> 16);
+		p[3] = (Uint8)(sample >> 24);
+	}
+}
+
+/* Read one sample as a signed 16 bit value */
+static __inline__ int SDL_MixerRead(const Uint8 *p, Uint16 format)
+{
+	float f;
+
+	switch (format) {
+	    case AUDIO_U8:
+		return (p[0] - 128) << 8;
+	    case AUDIO_S8:
+		return ((Sint8)p[0]) << 8;
+	    case AUDIO_U16LSB:
+		return (p[0] | (p[1] << 8)) - 32768;
+	    case AUDIO_U16MSB:
+		return ((p[0] << 8) | p[1]) - 32768;
+	    case AUDIO_S16LSB:
+		return (Sint16)(p[0] | (p[1] << 8));
+	    case AUDIO_S16MSB:
+		return (Sint16)((p[0] << 8) | p[1]);
+	    case AUDIO_S32LSB:
+		return (Sint16)(p[2] | (p[3] << 8));
+	    case AUDIO_S32MSB:
+		return (Sint16)((p[0] << 8) | p[1]);
+	    case AUDIO_F32LSB:
+	    case AUDIO_F32MSB:
+		f = SDL_MixerLoadFloat(p, format) * 32768.0f;
+		if ( f >= 32767.0f ) {
+			return 32767;
+		} else if ( f <= -32768.0f ) {
+			return -32768;
+		}
+		return (int)f;
+	}
+	return 0;
+}
+
+static void SDL_MixerGains(SDL_MixerVoice *v)
+{
+	int volume = v->sound.volume;
+	int pan = v->sound.pan;
+
+	if ( volume < 0 ) {
+		volume = 0;
+	} else if ( volume > SDL_MIX_MAXVOLUME ) {
+		volume = SDL_MIX_MAXVOLUME;
+	}
+	if ( pan < -128 ) {
+		pan = -128;
+	} else if ( pan > 128 ) {
+		pan = 128;
+	}
+	v->gain = volume;
+	v->left = (pan > 0) ? (volume * (128 - pan)) / 128 : volume;
+	v->right = (pan < 0) ? (volume * (128 + pan)) / 128 : volume;
+}
+
+static void SDL_MixerApply(SDL_AudioMixer *mixer, SDL_MixerCommand *cmd)
+{
+	SDL_MixerVoice *v = &mixer->voices[cmd->voice];
+
+	switch (cmd->type) {
+	    case MIXER_PLAY:
+		v->sound = cmd->sound;
+		v->frames = v->sound.len / (mixer->framesize /
+		            mixer->channels * v->sound.channels);
+		if ( (v->sound.loop_end > v->frames) ||
+		     (v->sound.loop_start >= v->sound.loop_end) ) {
+			v->sound.loop_end = 0;
+		}
+		v->pos = 0;
+		v->frac = 0;
+		SDL_MixerGains(v);
+		v->playing = 1;
+		v->serial = cmd->serial;
+		break;
+	    case MIXER_STOP:
+		if ( v->playing ) {
+			v->playing = 0;
+			v->finished = v->serial;
+		}
+		break;
+	    case MIXER_VOLUME:
+		v->sound.volume = cmd->sound.volume;
+		v->sound.pan = cmd->sound.pan;
+		SDL_MixerGains(v);
+		break;
+	    case MIXER_RATE:
+		v->sound.rate = cmd->sound.rate;
+		break;
+	}
+}
+
+/* Add 'frames' frames of a voice to the sums */
+static void SDL_MixerAdd(SDL_AudioMixer *mixer, SDL_MixerVoice *v,
+                         Sint32 *sums, int frames)
+{
+	const Uint16 format = mixer->format;
+	const int channels = mixer->channels;
+	const int samplesize = (format & 0xFF) / 8;
+	const int stride = samplesize * v->sound.channels;
+	const Uint32 end = v->sound.loop_end ? v->sound.loop_end : v->frames;
+	const Uint32 rate = v->sound.rate;
+	const Uint8 *frame;
+	int a, b, c, sample = 0;
+
+	while ( frames-- ) {
+		if ( v->pos >= end ) {
+			if ( v->sound.loop_end == 0 ) {
+				v->playing = 0;
+				v->finished = v->serial;
+				return;
+			}
+			v->pos = v->sound.loop_start + (v->pos - end) %
+			         (end - v->sound.loop_start);
+		}
+		frame = v->sound.buf + v->pos * stride;
+		for ( c = 0; c < channels; ++c ) {
+			/* Mono voices go to all channels */
+			if ( c < v->sound.channels ) {
+				a = SDL_MixerRead(frame + c * samplesize, format);
+				if ( v->frac ) {
+					if ( v->pos+1 < end ) {
+						b = SDL_MixerRead(frame + stride +
+						      c * samplesize, format);
+					} else if ( v->sound.loop_end ) {
+						b = SDL_MixerRead(v->sound.buf +
+						      v->sound.loop_start * stride +
+						      c * samplesize, format);
+					} else {
+						b = a;
+					}
+					a += ((b - a) * (int)(v->frac >> 1)) >> 15;
+				}
+				sample = a;
+			}
+			if ( (channels == 2) && (c == 1) ) {
+				*sums++ += sample * v->right;
+			} else if ( channels == 2 ) {
+				*sums++ += sample * v->left;
+			} else {
+				*sums++ += sample * v->gain;
+			}
+		}
+		v->frac += rate;
+		v->pos += v->frac >> 16;
+		v->frac &= 0xFFFF;
+	}
+}
+
+/* Clip the sums and write them in the output format */
+static void SDL_MixerOutput(SDL_AudioMixer *mixer, const Sint32 *sums,
+                            Uint8 *stream, int samples)
+{
+	union { Uint32 u; float f; } x;
+	Sint32 sample;
+
+	while ( samples-- ) {
+		sample = *sums++ / SDL_MIX_MAXVOLUME;
+		if ( sample > 32767 ) {
+			sample = 32767;
+		} else if ( sample < -32768 ) {
+			sample = -32768;
+		}
+		switch (mixer->format) {
+		    case AUDIO_U8:
+			*stream++ = (Uint8)((sample >> 8) + 128);
+			break;
+		    case AUDIO_S8:
+			*stream++ = (Uint8)(sample >> 8);
+			break;
+		    case AUDIO_U16LSB:
+			sample += 32768;
+			/* fall through */
+		    case AUDIO_S16LSB:
+			stream[0] = (Uint8)sample;
+			stream[1] = (Uint8)(sample >> 8);
+			stream += 2;
+			break;
+		    case AUDIO_U16MSB:
+			sample += 32768;
+			/* fall through */
+		    case AUDIO_S16MSB:
+			stream[0] = (Uint8)(sample >> 8);
+			stream[1] = (Uint8)sample;
+			stream += 2;
+			break;
+		    case AUDIO_S32LSB:
+		    case AUDIO_S32MSB:
+			SDL_MixerStore32(stream, mixer->format,
+			                 (Uint32)sample << 16);
+			stream += 4;
+			break;
+		    case AUDIO_F32LSB:
+		    case AUDIO_F32MSB:
+			x.f = (float)sample / 32768.0f;
+			SDL_MixerStore32(stream, mixer->format, x.u);
+			stream += 4;
+			break;
+		}
+	}
+}
+
+SDL_AudioMixer *SDL_CreateAudioMixer(const SDL_AudioSpec *spec, int voices)
+{
+	SDL_AudioMixer *mixer;
+
+	switch (spec->format) {
+	    case AUDIO_U8:
+	    case AUDIO_S8:
+	    case AUDIO_U16LSB:
+	    case AUDIO_S16LSB:
+	    case AUDIO_U16MSB:
+	    case AUDIO_S16MSB:
+	    case AUDIO_S32LSB:
+	    case AUDIO_S32MSB:
+	    case AUDIO_F32LSB:
+	    case AUDIO_F32MSB:
+		break;
+	    default:
+		SDL_SetError("Unsupported audio format");
+		return(NULL);
+	}
+	if ( (spec->channels == 0) || (voices <= 0) ) {
+		SDL_SetError("Invalid audio mixer parameters");
+		return(NULL);
+	}
+
+	mixer = (SDL_AudioMixer *)SDL_malloc(sizeof(*mixer));
+	if ( mixer == NULL ) {
+		SDL_OutOfMemory();
+		return(NULL);
+	}
+	SDL_memset(mixer, 0, sizeof(*mixer));
+	mixer->format = spec->format;
+	mixer->channels = spec->channels;
+	mixer->framesize = ((spec->format & 0xFF) / 8) * spec->channels;
+	mixer->numvoices = voices;
+	mixer->voices = (SDL_MixerVoice *)SDL_malloc(
+	                        voices * sizeof(*mixer->voices));
+	mixer->sums = (Sint32 *)SDL_malloc(
+	                        MIXER_CHUNK * spec->channels * sizeof(Sint32));
+	if ( (mixer->voices == NULL) || (mixer->sums == NULL) ) {
+		SDL_OutOfMemory();
+		SDL_FreeAudioMixer(mixer);
+		return(NULL);
+	}
+	SDL_memset(mixer->voices, 0, voices * sizeof(*mixer->voices));
+	return(mixer);
+}
+
+void SDL_FreeAudioMixer(SDL_AudioMixer *mixer)
+{
+	if ( mixer ) {
+		if ( mixer->voices ) {
+			SDL_free(mixer->voices);
+		}
+		if ( mixer->sums ) {
+			SDL_free(mixer->sums);
+		}
+		SDL_free(mixer);
+	}
+}
+
+void SDL_MixVoices(SDL_AudioMixer *mixer, Uint8 *stream, int len)
+{
+	SDL_MixerVoice *v;
+	Uint32 head;
+	int frames, chunk, i;
+
+	/* Carry out the queued commands */
+	head = mixer->command_head;
+	SDL_MixerBarrier();
+	while ( mixer->command_tail != head ) {
+		SDL_MixerApply(mixer,
+		     &mixer->commands[mixer->command_tail % MIXER_COMMANDS]);
+		SDL_MixerBarrier();
+		mixer->command_tail = mixer->command_tail + 1;
+	}
+
+	frames = len / mixer->framesize;
+	while ( frames > 0 ) {
+		chunk = frames;
+		if ( chunk > MIXER_CHUNK ) {
+			chunk = MIXER_CHUNK;
+		}
+		SDL_memset(mixer->sums, 0,
+		           chunk * mixer->channels * sizeof(Sint32));
+		for ( i = 0; i < mixer->numvoices; ++i ) {
+			v = &mixer->voices[i];
+			if ( v->playing ) {
+				SDL_MixerAdd(mixer, v, mixer->sums, chunk);
+			}
+		}
+		SDL_MixerOutput(mixer, mixer->sums, stream,
+		                chunk * mixer->channels);
+		stream += chunk * mixer->framesize;
+		frames -= chunk;
+	}
+}
+
+/* Queue a command for the next mix */
+static int SDL_MixerQueue(SDL_AudioMixer *mixer, int type, int voice,
+                          Uint32 serial, const SDL_AudioVoice *sound)
+{
+	SDL_MixerCommand *cmd;
+	Uint32 head = mixer->command_head;
+
+	if ( (voice < 0) || (voice >= mixer->numvoices) ) {
+		SDL_SetError("Invalid voice");
+		return(-1);
+	}
+	if ( (head - mixer->command_tail) >= MIXER_COMMANDS ) {
+		SDL_SetError("Too many audio mixer commands waiting");
+		return(-1);
+	}
+	cmd = &mixer->commands[head % MIXER_COMMANDS];
+	cmd->type = type;
+	cmd->voice = voice;
+	cmd->serial = serial;
+	if ( sound ) {
+		cmd->sound = *sound;
+	}
+	SDL_MixerBarrier();
+	mixer->command_head = head + 1;
+	return(0);
+}
+
+int SDL_PlayVoice(SDL_AudioMixer *mixer, int voice, const SDL_AudioVoice *sound)
+{
+	SDL_MixerVoice *v;
+	SDL_AudioVoice play;
+
+	if ( (sound->buf == NULL) ||
+	     ((sound->channels != 1) &&
+	      (sound->channels != mixer->channels)) ) {
+		SDL_SetError("Invalid voice parameters");
+		return(-1);
+	}
+	if ( voice == -1 ) {
+		for ( voice = 0; voice < mixer->numvoices; ++voice ) {
+			if ( ! SDL_VoicePlaying(mixer, voice) ) {
+				break;
+			}
+		}
+		if ( voice == mixer->numvoices ) {
+			SDL_SetError("No free voices");
+			return(-1);
+		}
+	}
+	if ( (voice < 0) || (voice >= mixer->numvoices) ) {
+		SDL_SetError("Invalid voice");
+		return(-1);
+	}
+	/* A voice that never advanced would hold its slot for ever */
+	play = *sound;
+	if ( play.rate == 0 ) {
+		play.rate = 0x10000;
+	}
+	v = &mixer->voices[voice];
+	if ( SDL_MixerQueue(mixer, MIXER_PLAY, voice,
+	                    v->started + 1, &play) < 0 ) {
+		return(-1);
+	}
+	++v->started;
+	return(voice);
+}
+
+int SDL_StopVoice(SDL_AudioMixer *mixer, int voice)
+{
+	if ( (voice < 0) || (voice >= mixer->numvoices) ) {
+		SDL_SetError("Invalid voice");
+		return(-1);
+	}
+	return SDL_MixerQueue(mixer, MIXER_STOP, voice, 0, NULL);
+}
+
+int SDL_SetVoiceVolume(SDL_AudioMixer *mixer, int voice, int volume, int pan)
+{
+	SDL_AudioVoice sound;
+
+	sound.volume = volume;
+	sound.pan = pan;
+	return SDL_MixerQueue(mixer, MIXER_VOLUME, voice, 0, &sound);
+}
+
+int SDL_SetVoiceRate(SDL_AudioMixer *mixer, int voice, Uint32 rate)
+{
+	SDL_AudioVoice sound;
+
+	sound.rate = rate ? rate : 0x10000;
+	return SDL_MixerQueue(mixer, MIXER_RATE, voice, 0, &sound);
+}
+
+int SDL_VoicePlaying(SDL_AudioMixer *mixer, int voice)
+{
+	SDL_MixerVoice *v;
+
+	if ( (voice < 0) || (voice >= mixer->numvoices) ) {
+		return(0);
+	}
+	v = &mixer->voices[voice];
+	return (v->started != v->finished);
+}
@@ -0,0 +1,408 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Streaming audio conversion
+
+   Input goes through the SDL_AudioCVT filter chain for the format and
+   channel conversion, a chunk at a time, and then through a resampler
+   that keeps its state between calls.  The output is collected in a
+   ring buffer, which only grows when more data is put in than has been
+   read out.
+*/
+
+#include "SDL_audio.h"
+#include "SDL_resample_c.h"
+
+/* The largest number of input frames converted in one go */
+#define STREAM_CHUNK	1024
+
+/* The largest frame: 6 channels of 32 bit samples */
+#define STREAM_MAXFRAME	24
+
+struct SDL_AudioStream {
+	/* Format and channel conversion at the source rate */
+	SDL_AudioCVT cvt;
+	int src_framesize;
+	int mid_framesize;
+
+	/* Rate conversion, or NULL if the rates are the same */
+	SDL_AudioResampler *resampler;
+	Uint16 dst_format;
+	int dst_framesize;
+
+	/* The bytes of an incomplete input frame */
+	Uint8 partial[STREAM_MAXFRAME];
+	int partial_len;
+
+	/* Converted data waiting to be read */
+	Uint8 *fifo;
+	int fifo_size;
+	int fifo_head;
+	int fifo_count;
+};
+
+static int SDL_StreamFrameSize(Uint16 format, Uint8 channels)
+{
+	return(((format & 0xFF) / 8) * channels);
+}
+
+/* Make room for 'len' more bytes of output in the ring buffer */
+static int SDL_StreamReserve(SDL_AudioStream *stream, int len)
+{
+	Uint8 *fifo;
+	int size, first;
+
+	if ( (stream->fifo_size - stream->fifo_count) >= len ) {
+		return(0);
+	}
+	size = stream->fifo_size ? stream->fifo_size : 4096;
+	while ( size < (stream->fifo_count + len) ) {
+		size *= 2;
+	}
+	fifo = (Uint8 *)SDL_malloc(size);
+	if ( fifo == NULL ) {
+		SDL_OutOfMemory();
+		return(-1);
+	}
+
+	/* Move the waiting data to the start of the new buffer */
+	first = stream->fifo_size - stream->fifo_head;
+	if ( first > stream->fifo_count ) {
+		first = stream->fifo_count;
+	}
+	if ( first > 0 ) {
+		SDL_memcpy(fifo, stream->fifo + stream->fifo_head, first);
+	}
+	if ( first < stream->fifo_count ) {
+		SDL_memcpy(fifo + first, stream->fifo,
+		           stream->fifo_count - first);
+	}
+	SDL_free(stream->fifo);
+	stream->fifo = fifo;
+	stream->fifo_size = size;
+	stream->fifo_head = 0;
+	return(0);
+}
+
+/* Returns the free space following the data in the ring buffer */
+static Uint8 *SDL_StreamTail(SDL_AudioStream *stream, int *len)
+{
+	int tail;
+
+	tail = stream->fifo_head + stream->fifo_count;
+	if ( tail >= stream->fifo_size ) {
+		tail -= stream->fifo_size;
+		*len = stream->fifo_head - tail;
+	} else {
+		*len = stream->fifo_size - tail;
+	}
+	return(stream->fifo + tail);
+}
+
+/* Copy bytes into the ring buffer, which must have room for them */
+static void SDL_StreamCopy(SDL_AudioStream *stream, const Uint8 *data, int len)
+{
+	Uint8 *tail;
+	int room;
+
+	while ( len > 0 ) {
+		tail = SDL_StreamTail(stream, &room);
+		if ( room > len ) {
+			room = len;
+		}
+		SDL_memcpy(tail, data, room);
+		stream->fifo_count += room;
+		data += room;
+		len -= room;
+	}
+}
+
+/* Resample or copy converted frames into the ring buffer */
+static int SDL_StreamWrite(SDL_AudioStream *stream, const Uint8 *data, int len)
+{
+	Uint8 frame[STREAM_MAXFRAME];
+	Uint8 *tail;
+	int room, frames, used, written;
+
+	if ( stream->resampler == NULL ) {
+		if ( SDL_StreamReserve(stream, len) < 0 ) {
+			return(-1);
+		}
+		SDL_StreamCopy(stream, data, len);
+		return(0);
+	}
+
+	frames = len / stream->mid_framesize;
+	written = SDL_ResamplerOutputFrames(stream->resampler, frames);
+	if ( SDL_StreamReserve(stream, written*stream->dst_framesize) < 0 ) {
+		return(-1);
+	}
+	while ( frames > 0 ) {
+		used = frames;
+		tail = SDL_StreamTail(stream, &room);
+		if ( room < stream->dst_framesize ) {
+			/* Reads needn't end on a frame, so this one wraps */
+			written = SDL_Resample(stream->resampler, data, &used,
+			                       frame, 1);
+			SDL_StreamCopy(stream, frame,
+			               written * stream->dst_framesize);
+		} else {
+			written = SDL_Resample(stream->resampler, data, &used,
+			                   tail, room / stream->dst_framesize);
+			stream->fifo_count += written * stream->dst_framesize;
+		}
+		data += used * stream->mid_framesize;
+		frames -= used;
+		if ( !written && !used ) {
+			break;
+		}
+	}
+	return(0);
+}
+
+/* Convert whole input frames and add them to the stream */
+static int SDL_StreamConvert(SDL_AudioStream *stream, const Uint8 *data, int frames)
+{
+	int len;
+
+	if ( ! stream->cvt.needed ) {
+		return SDL_StreamWrite(stream, data,
+		                       frames * stream->src_framesize);
+	}
+	while ( frames > 0 ) {
+		len = frames;
+		if ( len > STREAM_CHUNK ) {
+			len = STREAM_CHUNK;
+		}
+		frames -= len;
+		len *= stream->src_framesize;
+
+		SDL_memcpy(stream->cvt.buf, data, len);
+		data += len;
+		stream->cvt.len = len;
+		SDL_ConvertAudio(&stream->cvt);
+		if ( SDL_StreamWrite(stream, stream->cvt.buf,
+		                     stream->cvt.len_cvt) < 0 ) {
+			return(-1);
+		}
+	}
+	return(0);
+}
+
+SDL_AudioStream *SDL_NewAudioStream(
+	Uint16 src_format, Uint8 src_channels, int src_rate,
+	Uint16 dst_format, Uint8 dst_channels, int dst_rate)
+{
+	SDL_AudioStream *stream;
+
+	if ( (src_rate <= 0) || (dst_rate <= 0) ) {
+		SDL_SetError("Invalid audio stream rate");
+		return(NULL);
+	}
+	stream = (SDL_AudioStream *)SDL_malloc(sizeof(*stream));
+	if ( stream == NULL ) {
+		SDL_OutOfMemory();
+		return(NULL);
+	}
+	SDL_memset(stream, 0, sizeof(*stream));
+	stream->src_framesize = SDL_StreamFrameSize(src_format, src_channels);
+	stream->mid_framesize = SDL_StreamFrameSize(dst_format, dst_channels);
+	stream->dst_framesize = stream->mid_framesize;
+	stream->dst_format = dst_format;
+	if ( (stream->src_framesize == 0) || (stream->dst_framesize == 0) ||
+	     (stream->src_framesize > STREAM_MAXFRAME) ) {
+		SDL_SetError("Invalid audio stream format");
+		SDL_free(stream);
+		return(NULL);
+	}
+
+	/* The rate is converted last, on fewer channels if they're mixed */
+	if ( SDL_BuildAudioCVT(&stream->cvt,
+	                       src_format, src_channels, src_rate,
+	                       dst_format, dst_channels, src_rate) < 0 ) {
+		SDL_free(stream);
+		return(NULL);
+	}
+	if ( stream->cvt.needed ) {
+		stream->cvt.buf = (Uint8 *)SDL_malloc(STREAM_CHUNK *
+			stream->src_framesize * stream->cvt.len_mult);
+		if ( stream->cvt.buf == NULL ) {
+			SDL_OutOfMemory();
+			SDL_FreeAudioStream(stream);
+			return(NULL);
+		}
+	}
+	if ( src_rate != dst_rate ) {
+		stream->resampler = SDL_CreateResampler(dst_format,
+			dst_channels, src_rate, dst_rate,
+			SDL_GetResampleQuality());
+		if ( stream->resampler == NULL ) {
+			SDL_FreeAudioStream(stream);
+			return(NULL);
+		}
+	}
+	return(stream);
+}
+
+int SDL_AudioStreamPut(SDL_AudioStream *stream, const void *buf, int len)
+{
+	const Uint8 *data = (const Uint8 *)buf;
+	int framesize = stream->src_framesize;
+	int frames;
+
+	/* Complete the frame left over from the last call */
+	if ( stream->partial_len ) {
+		int fill = framesize - stream->partial_len;
+		if ( fill > len ) {
+			fill = len;
+		}
+		SDL_memcpy(stream->partial + stream->partial_len, data, fill);
+		stream->partial_len += fill;
+		data += fill;
+		len -= fill;
+		if ( stream->partial_len < framesize ) {
+			return(0);
+		}
+		stream->partial_len = 0;
+		if ( SDL_StreamConvert(stream, stream->partial, 1) < 0 ) {
+			return(-1);
+		}
+	}
+
+	frames = len / framesize;
+	if ( SDL_StreamConvert(stream, data, frames) < 0 ) {
+		return(-1);
+	}
+	data += frames * framesize;
+	len -= frames * framesize;
+
+	/* Keep the start of an incomplete frame for next time */
+	if ( len > 0 ) {
+		SDL_memcpy(stream->partial, data, len);
+		stream->partial_len = len;
+	}
+	return(0);
+}
+
+int SDL_AudioStreamGet(SDL_AudioStream *stream, void *buf, int len)
+{
+	Uint8 *data = (Uint8 *)buf;
+	int total, first;
+
+	if ( len > stream->fifo_count ) {
+		len = stream->fifo_count;
+	}
+	total = len;
+	while ( len > 0 ) {
+		first = stream->fifo_size - stream->fifo_head;
+		if ( first > len ) {
+			first = len;
+		}
+		SDL_memcpy(data, stream->fifo + stream->fifo_head, first);
+		data += first;
+		len -= first;
+		stream->fifo_count -= first;
+		stream->fifo_head += first;
+		if ( stream->fifo_head == stream->fifo_size ) {
+			stream->fifo_head = 0;
+		}
+	}
+	if ( stream->fifo_count == 0 ) {
+		stream->fifo_head = 0;
+	}
+	return(total);
+}
+
+int SDL_AudioStreamAvailable(SDL_AudioStream *stream)
+{
+	return(stream->fifo_count);
+}
+
+int SDL_AudioStreamFlush(SDL_AudioStream *stream)
+{
+	Uint8 silence[STREAM_CHUNK];
+	int frames, len;
+
+	/* An incomplete frame can't be converted, so it's dropped */
+	stream->partial_len = 0;
+	if ( stream->resampler == NULL ) {
+		return(0);
+	}
+
+	/* Push the held back frames out with silence */
+	switch (stream->dst_format) {
+	    case AUDIO_U8:
+		SDL_memset(silence, 0x80, sizeof(silence));
+		break;
+	    case AUDIO_U16LSB:
+	    case AUDIO_U16MSB:
+		SDL_memset(silence, 0, sizeof(silence));
+		for ( len = 0; len < (int)sizeof(silence); len += 2 ) {
+			silence[len + (stream->dst_format == AUDIO_U16MSB ?
+			               0 : 1)] = 0x80;
+		}
+		break;
+	    default:
+		SDL_memset(silence, 0, sizeof(silence));
+		break;
+	}
+	frames = SDL_ResamplerDelay(stream->resampler);
+	while ( frames > 0 ) {
+		len = frames * stream->mid_framesize;
+		if ( len > (int)sizeof(silence) ) {
+			len = sizeof(silence) -
+			      sizeof(silence) % stream->mid_framesize;
+		}
+		if ( SDL_StreamWrite(stream, silence, len) < 0 ) {
+			return(-1);
+		}
+		frames -= len / stream->mid_framesize;
+	}
+	return(0);
+}
+
+void SDL_AudioStreamClear(SDL_AudioStream *stream)
+{
+	stream->partial_len = 0;
+	stream->fifo_head = 0;
+	stream->fifo_count = 0;
+	if ( stream->resampler ) {
+		SDL_ResetResampler(stream->resampler);
+	}
+}
+
+void SDL_FreeAudioStream(SDL_AudioStream *stream)
+{
+	if ( stream ) {
+		if ( stream->resampler ) {
+			SDL_FreeResampler(stream->resampler);
+		}
+		if ( stream->cvt.buf ) {
+			SDL_free(stream->cvt.buf);
+		}
+		if ( stream->fifo ) {
+			SDL_free(stream->fifo);
+		}
+		SDL_free(stream);
+	}
+}
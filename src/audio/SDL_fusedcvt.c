@@ -0,0 +1,232 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Single pass audio conversion kernels */
+
+#include "SDL_audio.h"
+#include "SDL_fusedcvt_c.h"
+
+/* The most rate doublings or halvings a kernel does */
+#define FUSED_MAXSTEPS	2
+
+/* Samples are loaded as signed 16-bit values, which hold any of the 8 and
+   16 bit formats exactly, and shifted down to 8 bits when the destination
+   is 8-bit.  That is the value the filter chain works on after its format
+   filters.
+ */
+#define LOAD_U8(p)	(((Sint32)(p)[0] - 0x80) * 256)
+#define LOAD_S8(p)	((Sint32)(Sint8)(p)[0] * 256)
+#define LOAD_S16LSB(p)	((Sint32)(Sint16)(((p)[1] << 8) | (p)[0]))
+#define LOAD_S16MSB(p)	((Sint32)(Sint16)(((p)[0] << 8) | (p)[1]))
+
+#define SIZE_U8		1
+#define SIZE_S8		1
+#define SIZE_S16LSB	2
+#define SIZE_S16MSB	2
+
+#define SHIFT_U8	8
+#define SHIFT_S8	8
+#define SHIFT_S16LSB	0
+#define SHIFT_S16MSB	0
+
+/* Mixing to mono averages in the destination format, so an unsigned sum
+   rounds down where a signed one rounds toward zero */
+#define AVERAGE_U8(a, b)	(((a) + (b)) >> 1)
+#define AVERAGE_S8(a, b)	(((a) + (b)) / 2)
+#define AVERAGE_S16LSB(a, b)	(((a) + (b)) / 2)
+#define AVERAGE_S16MSB(a, b)	(((a) + (b)) / 2)
+
+#define STORE_U8(p, s)		((p)[0] = (Uint8)((s) ^ 0x80))
+#define STORE_S8(p, s)		((p)[0] = (Uint8)(s))
+#define STORE_S16LSB(p, s)	((p)[0] = (Uint8)(s), (p)[1] = (Uint8)((s) >> 8))
+#define STORE_S16MSB(p, s)	((p)[0] = (Uint8)((s) >> 8), (p)[1] = (Uint8)(s))
+
+/* Work out how many times each input frame is repeated ('up') or how many
+   input frames each output frame skips ('down') */
+static void SDL_FusedRate(SDL_AudioCVT *cvt, int *up, int *down)
+{
+	*up = 1;
+	*down = 1;
+	if ( cvt->rate_incr > 1.0 ) {
+		*down = (int)(cvt->rate_incr + 0.5);
+	} else if ( cvt->rate_incr > 0.0 ) {
+		*up = (int)(1.0 / cvt->rate_incr + 0.5);
+	}
+}
+
+/* One kernel per format pair and channel layout.  Each output frame is
+   computed from one input frame, into locals, before it is stored, so the
+   loop runs front to back when the data shrinks and back to front when it
+   grows, like the filters it replaces.
+ */
+#define FUSED_KERNEL(name, SRC, DST, src_channels, dst_channels, FRAME) \
+static void SDLCALL name(SDL_AudioCVT *cvt, Uint16 format)		\
+{									\
+	const int src_frame = SIZE_##SRC * src_channels;		\
+	const int dst_frame = SIZE_##DST * dst_channels;		\
+	int up, down, frames, i, j;					\
+	const Uint8 *src;						\
+	Uint8 *dst;							\
+	Sint32 l, r;							\
+									\
+	SDL_FusedRate(cvt, &up, &down);					\
+	frames = cvt->len_cvt / (src_frame * down);			\
+	if ( up*dst_frame > down*src_frame ) {				\
+		src = cvt->buf + frames*down*src_frame;			\
+		dst = cvt->buf + frames*up*dst_frame;			\
+		for ( i = frames; i; --i ) {				\
+			src -= down*src_frame;				\
+			FRAME(SRC, DST)					\
+			for ( j = up; j; --j ) {			\
+				dst -= dst_frame;			\
+				STORE_##DST(dst, l);			\
+				if ( dst_channels == 2 ) {		\
+					STORE_##DST(dst+SIZE_##DST, r);	\
+				}					\
+			}						\
+		}							\
+	} else {							\
+		src = cvt->buf;						\
+		dst = cvt->buf;						\
+		for ( i = frames; i; --i ) {				\
+			FRAME(SRC, DST)					\
+			src += down*src_frame;				\
+			for ( j = up; j; --j ) {			\
+				STORE_##DST(dst, l);			\
+				if ( dst_channels == 2 ) {		\
+					STORE_##DST(dst+SIZE_##DST, r);	\
+				}					\
+				dst += dst_frame;			\
+			}						\
+		}							\
+	}								\
+	cvt->len_cvt = frames * up * dst_frame;				\
+	format = cvt->dst_format;					\
+	if ( cvt->filters[++cvt->filter_index] ) {			\
+		cvt->filters[cvt->filter_index](cvt, format);		\
+	}								\
+}
+
+#define FRAME_MONO(SRC, DST)						\
+	l = LOAD_##SRC(src) >> SHIFT_##DST;				\
+	r = l;
+#define FRAME_STEREO(SRC, DST)						\
+	l = LOAD_##SRC(src) >> SHIFT_##DST;				\
+	r = LOAD_##SRC(src+SIZE_##SRC) >> SHIFT_##DST;
+#define FRAME_DOWNMIX(SRC, DST)						\
+	l = LOAD_##SRC(src) >> SHIFT_##DST;				\
+	r = LOAD_##SRC(src+SIZE_##SRC) >> SHIFT_##DST;			\
+	l = AVERAGE_##DST(l, r);
+
+#define FUSED_KERNELS(SRC, DST)						\
+FUSED_KERNEL(SDL_Fused_##SRC##_##DST##_c1, SRC, DST, 1, 1, FRAME_MONO)	\
+FUSED_KERNEL(SDL_Fused_##SRC##_##DST##_c2, SRC, DST, 2, 2, FRAME_STEREO)	\
+FUSED_KERNEL(SDL_Fused_##SRC##_##DST##_c12, SRC, DST, 1, 2, FRAME_MONO)	\
+FUSED_KERNEL(SDL_Fused_##SRC##_##DST##_c21, SRC, DST, 2, 1, FRAME_DOWNMIX)
+
+FUSED_KERNELS(U8, U8)
+FUSED_KERNELS(U8, S8)
+FUSED_KERNELS(U8, S16LSB)
+FUSED_KERNELS(U8, S16MSB)
+FUSED_KERNELS(S8, U8)
+FUSED_KERNELS(S8, S8)
+FUSED_KERNELS(S8, S16LSB)
+FUSED_KERNELS(S8, S16MSB)
+FUSED_KERNELS(S16LSB, U8)
+FUSED_KERNELS(S16LSB, S8)
+FUSED_KERNELS(S16LSB, S16LSB)
+FUSED_KERNELS(S16LSB, S16MSB)
+FUSED_KERNELS(S16MSB, U8)
+FUSED_KERNELS(S16MSB, S8)
+FUSED_KERNELS(S16MSB, S16LSB)
+FUSED_KERNELS(S16MSB, S16MSB)
+
+#define FUSED_ENTRY(SRC, DST)						\
+	{ SDL_Fused_##SRC##_##DST##_c1, SDL_Fused_##SRC##_##DST##_c2,	\
+	  SDL_Fused_##SRC##_##DST##_c12, SDL_Fused_##SRC##_##DST##_c21 }
+
+static const Uint16 fused_formats[] = {
+	AUDIO_U8, AUDIO_S8, AUDIO_S16LSB, AUDIO_S16MSB
+};
+#define NUM_FUSED_FORMATS	(sizeof(fused_formats)/sizeof(fused_formats[0]))
+
+/* Indexed by source format, destination format and channel layout */
+static const SDL_AudioFilter fused_kernels[NUM_FUSED_FORMATS][NUM_FUSED_FORMATS][4] = {
+	{ FUSED_ENTRY(U8, U8), FUSED_ENTRY(U8, S8),
+	  FUSED_ENTRY(U8, S16LSB), FUSED_ENTRY(U8, S16MSB) },
+	{ FUSED_ENTRY(S8, U8), FUSED_ENTRY(S8, S8),
+	  FUSED_ENTRY(S8, S16LSB), FUSED_ENTRY(S8, S16MSB) },
+	{ FUSED_ENTRY(S16LSB, U8), FUSED_ENTRY(S16LSB, S8),
+	  FUSED_ENTRY(S16LSB, S16LSB), FUSED_ENTRY(S16LSB, S16MSB) },
+	{ FUSED_ENTRY(S16MSB, U8), FUSED_ENTRY(S16MSB, S8),
+	  FUSED_ENTRY(S16MSB, S16LSB), FUSED_ENTRY(S16MSB, S16MSB) },
+};
+
+static int SDL_FusedFormatIndex(Uint16 format)
+{
+	int i;
+
+	for ( i = 0; i < (int)NUM_FUSED_FORMATS; ++i ) {
+		if ( fused_formats[i] == format ) {
+			return(i);
+		}
+	}
+	return(-1);
+}
+
+SDL_AudioFilter SDL_FusedAudioFilter(Uint16 src_format, int src_channels,
+                                     Uint16 dst_format, int dst_channels,
+                                     int rate_steps)
+{
+	int src, dst, layout;
+
+	src = SDL_FusedFormatIndex(src_format);
+	dst = SDL_FusedFormatIndex(dst_format);
+	if ( (src < 0) || (dst < 0) ||
+	     (rate_steps > FUSED_MAXSTEPS) || (rate_steps < -FUSED_MAXSTEPS) ) {
+		return(NULL);
+	}
+	if ( (src_channels == 1) && (dst_channels == 1) ) {
+		layout = 0;
+	} else if ( (src_channels == 2) && (dst_channels == 2) ) {
+		layout = 1;
+	} else if ( (src_channels == 1) && (dst_channels == 2) ) {
+		layout = 2;
+	} else if ( (src_channels == 2) && (dst_channels == 1) ) {
+		layout = 3;
+	} else {
+		return(NULL);
+	}
+	return(fused_kernels[src][dst][layout]);
+}
+
+double SDL_FusedRateIncr(int rate_steps)
+{
+	if ( rate_steps > 0 ) {
+		return(1.0 / (1 << rate_steps));
+	}
+	if ( rate_steps < 0 ) {
+		return((double)(1 << -rate_steps));
+	}
+	return(0.0);
+}
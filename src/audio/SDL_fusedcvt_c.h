@@ -0,0 +1,47 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#ifndef _SDL_fusedcvt_c_h
+#define _SDL_fusedcvt_c_h
+
+/* Single pass conversion kernels, used by SDL_BuildAudioCVT() in place of
+   a chain of filters.  Each kernel converts the sample format, mono to or
+   from stereo, and doubles or halves the rate up to twice, giving exactly
+   the same output as the chain it replaces.
+*/
+
+#include "SDL_audio.h"
+
+typedef void (SDLCALL *SDL_AudioFilter)(SDL_AudioCVT *cvt, Uint16 format);
+
+/* Returns the kernel for the conversion, or NULL if there isn't one.
+   'rate_steps' is the number of times the rate is doubled, or halved if
+   negative.  The kernel finds the rate change in cvt->rate_incr, which
+   SDL_FusedRateIncr() computes.
+*/
+extern SDL_AudioFilter SDL_FusedAudioFilter(Uint16 src_format, int src_channels,
+                                            Uint16 dst_format, int dst_channels,
+                                            int rate_steps);
+extern double SDL_FusedRateIncr(int rate_steps);
+
+#endif /* _SDL_fusedcvt_c_h */
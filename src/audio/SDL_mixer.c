@@ -30,6 +30,8 @@
 #include "SDL_mixer_MMX.h"
 #include "SDL_mixer_MMX_VC.h"
 #include "SDL_mixer_m68k.h"
+#include "SDL_mixer_SSE2.h"
+#include "SDL_mixer_NEON.h"
 
 /* This table is used to add two sound values together and pin
  * the value to avoid overflow.  (used with permission from ARDI)
@@ -90,16 +92,85 @@ static const Uint8 mix8[] =
 #define ADJUST_VOLUME(s, v)	(s = (s*v)/SDL_MIX_MAXVOLUME)
 #define ADJUST_VOLUME_U8(s, v)	(s = (((s-128)*v)/SDL_MIX_MAXVOLUME)+128)
 
+/* 32-bit samples in either byte order */
+static Uint32 SDL_MixLoad32(const Uint8 *p, Uint16 format)
+{
+	if ( format & 0x1000 ) {
+		return(((Uint32)p[0] << 24) | ((Uint32)p[1] << 16) |
+		       ((Uint32)p[2] << 8) | p[3]);
+	}
+	return(((Uint32)p[3] << 24) | ((Uint32)p[2] << 16) |
+	       ((Uint32)p[1] << 8) | p[0]);
+}
+
+static void SDL_MixStore32(Uint8 *p, Uint16 format, Uint32 sample)
+{
+	if ( format & 0x1000 ) {
+		p[0] = (Uint8)(sample >> 24);
+		p[1] = (Uint8)(sample >> 16);
+		p[2] = (Uint8)(sample >> 8);
+		p[3] = (Uint8)sample;
+	} else {
+		p[0] = (Uint8)sample;
+		p[1] = (Uint8)(sample >> 8);
+		p[2] = (Uint8)(sample >> 16);
+		p[3] = (Uint8)(sample >> 24);
+	}
+}
+
+/* Mix as many whole blocks as the vector code for this CPU can handle,
+   returning the number of bytes done.  The results match the C code.
+ */
+static Uint32 SDL_MixAudio_SIMD(Uint8 *dst, const Uint8 *src, Uint32 len,
+                                int volume, Uint16 format)
+{
+	if ( (volume <= 0) || (volume > SDL_MIX_MAXVOLUME) ) {
+		return 0;
+	}
+#if SDL_SSE2_MIXERS
+	if ( SDL_HasSSE2() ) {
+		switch (format) {
+		    case AUDIO_U8:
+			return SDL_MixAudio_SSE2_U8(dst, src, len, volume);
+		    case AUDIO_S8:
+			return SDL_MixAudio_SSE2_S8(dst, src, len, volume);
+		    case AUDIO_S16LSB:
+			return SDL_MixAudio_SSE2_S16LSB(dst, src, len, volume);
+		    case AUDIO_S16MSB:
+			return SDL_MixAudio_SSE2_S16MSB(dst, src, len, volume);
+		}
+	}
+#endif
+#if SDL_NEON_MIXERS
+	if ( SDL_HasNEON() ) {
+		switch (format) {
+		    case AUDIO_U8:
+			return SDL_MixAudio_NEON_U8(dst, src, len, volume);
+		    case AUDIO_S8:
+			return SDL_MixAudio_NEON_S8(dst, src, len, volume);
+		    case AUDIO_S16LSB:
+			return SDL_MixAudio_NEON_S16LSB(dst, src, len, volume);
+		    case AUDIO_S16MSB:
+			return SDL_MixAudio_NEON_S16MSB(dst, src, len, volume);
+		}
+	}
+#endif
+	return 0;
+}
+
 void SDL_MixAudio (Uint8 *dst, const Uint8 *src, Uint32 len, int volume)
 {
 	Uint16 format;
+	Uint32 done;
 
 	if ( volume == 0 ) {
 		return;
 	}
 	/* Mix the user-level audio format */
 	if ( current_audio ) {
-		if ( current_audio->convert.needed ) {
+		if ( current_audio->stream ) {
+			format = current_audio->stream_format;
+		} else if ( current_audio->convert.needed ) {
 			format = current_audio->convert.src_format;
 		} else {
 			format = current_audio->spec.format;
@@ -108,6 +179,13 @@ void SDL_MixAudio (Uint8 *dst, const Uint8 *src, Uint32 len, int volume)
   		/* HACK HACK HACK */
 		format = AUDIO_S16;
 	}
+
+	/* The C code below mixes whatever is left over */
+	done = SDL_MixAudio_SIMD(dst, src, len, volume, format);
+	dst += done;
+	src += done;
+	len -= done;
+
 	switch (format) {
 
 		case AUDIO_U8: {
@@ -256,6 +334,58 @@ void SDL_MixAudio (Uint8 *dst, const Uint8 *src, Uint32 len, int volume)
 		}
 		break;
 
+		case AUDIO_S32LSB:
+		case AUDIO_S32MSB: {
+			Sint32 src1, src2;
+			const Sint32 max_audioval = 0x7FFFFFFF;
+			const Sint32 min_audioval = -max_audioval - 1;
+
+			len /= 4;
+			while ( len-- ) {
+				src1 = (Sint32)SDL_MixLoad32(src, format);
+				if ( volume != SDL_MIX_MAXVOLUME ) {
+					/* Keep the product in range */
+					src1 = (src1 / SDL_MIX_MAXVOLUME) * volume;
+				}
+				src2 = (Sint32)SDL_MixLoad32(dst, format);
+				src += 4;
+				if ( (src1 > 0) && (src2 > max_audioval - src1) ) {
+					src2 = max_audioval;
+				} else
+				if ( (src1 < 0) && (src2 < min_audioval - src1) ) {
+					src2 = min_audioval;
+				} else {
+					src2 += src1;
+				}
+				SDL_MixStore32(dst, format, (Uint32)src2);
+				dst += 4;
+			}
+		}
+		break;
+
+		case AUDIO_F32LSB:
+		case AUDIO_F32MSB: {
+			union { Uint32 u; float f; } src1, src2;
+			const float fvolume = (float)volume / SDL_MIX_MAXVOLUME;
+
+			len /= 4;
+			while ( len-- ) {
+				src1.u = SDL_MixLoad32(src, format);
+				src2.u = SDL_MixLoad32(dst, format);
+				src += 4;
+				src2.f += src1.f * fvolume;
+				if ( src2.f > 1.0f ) {
+					src2.f = 1.0f;
+				} else
+				if ( src2.f < -1.0f ) {
+					src2.f = -1.0f;
+				}
+				SDL_MixStore32(dst, format, src2.u);
+				dst += 4;
+			}
+		}
+		break;
+
 		default: /* If this happens... FIXME! */
 			SDL_SetError("SDL_MixAudio(): unknown audio format");
 			return;
@@ -0,0 +1,167 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* NEON versions of SDL_MixAudio
+
+   The C code scales each sample by volume/128 with an integer division,
+   which rounds towards zero, and then adds it to the destination,
+   clamping the sum.  Here the products are biased by 127 when they are
+   negative, so an arithmetic shift gives the same quotient, and the
+   clamping is done by the saturating adds.
+*/
+
+#include "SDL_audio.h"
+#include "SDL_mixer_NEON.h"
+
+#if SDL_NEON_MIXERS
+
+#include <arm_neon.h>
+
+/* (s * volume) / 128 for 16 signed 8 bit samples, volume < 128 */
+static __inline__ int8x16_t SDL_MixScale8(int8x16_t s, int8x8_t volume)
+{
+	int16x8_t lo, hi;
+
+	lo = vmull_s8(vget_low_s8(s), volume);
+	hi = vmull_s8(vget_high_s8(s), volume);
+	lo = vaddq_s16(lo, vreinterpretq_s16_u16(
+		vshrq_n_u16(vreinterpretq_u16_s16(vshrq_n_s16(lo, 15)), 9)));
+	hi = vaddq_s16(hi, vreinterpretq_s16_u16(
+		vshrq_n_u16(vreinterpretq_u16_s16(vshrq_n_s16(hi, 15)), 9)));
+	return vcombine_s8(vshrn_n_s16(lo, 7), vshrn_n_s16(hi, 7));
+}
+
+/* (s * volume) / 128 for 8 signed 16 bit samples */
+static __inline__ int16x8_t SDL_MixScale16(int16x8_t s, int16x4_t volume)
+{
+	int32x4_t lo, hi;
+
+	lo = vmull_s16(vget_low_s16(s), volume);
+	hi = vmull_s16(vget_high_s16(s), volume);
+	lo = vaddq_s32(lo, vreinterpretq_s32_u32(
+		vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(lo, 31)), 25)));
+	hi = vaddq_s32(hi, vreinterpretq_s32_u32(
+		vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(hi, 31)), 25)));
+	return vcombine_s16(vshrn_n_s32(lo, 7), vshrn_n_s32(hi, 7));
+}
+
+Uint32 SDL_MixAudio_NEON_U8(Uint8 *dst, const Uint8 *src, Uint32 len, int volume)
+{
+	const uint8x16_t bias = vdupq_n_u8(0x80);
+	const uint8x16_t max = vdupq_n_u8(0xFE);
+	const int8x8_t vol = vdup_n_s8((Sint8)(volume & 0x7F));
+	int8x16_t s, d;
+	Uint32 i;
+
+	/* Unsigned samples are mixed as signed ones, and then clamped to
+	   0xFE like the mix8 table does */
+	len &= ~15;
+	for ( i = 0; i < len; i += 16 ) {
+		s = vreinterpretq_s8_u8(veorq_u8(vld1q_u8(src+i), bias));
+		d = vreinterpretq_s8_u8(veorq_u8(vld1q_u8(dst+i), bias));
+		if ( volume < SDL_MIX_MAXVOLUME ) {
+			s = SDL_MixScale8(s, vol);
+		}
+		vst1q_u8(dst+i, vminq_u8(veorq_u8(
+			vreinterpretq_u8_s8(vqaddq_s8(d, s)), bias), max));
+	}
+	return len;
+}
+
+Uint32 SDL_MixAudio_NEON_S8(Uint8 *dst, const Uint8 *src, Uint32 len, int volume)
+{
+	const int8x8_t vol = vdup_n_s8((Sint8)(volume & 0x7F));
+	int8x16_t s, d;
+	Uint32 i;
+
+	len &= ~15;
+	for ( i = 0; i < len; i += 16 ) {
+		s = vreinterpretq_s8_u8(vld1q_u8(src+i));
+		d = vreinterpretq_s8_u8(vld1q_u8(dst+i));
+		if ( volume < SDL_MIX_MAXVOLUME ) {
+			s = SDL_MixScale8(s, vol);
+		}
+		vst1q_u8(dst+i, vreinterpretq_u8_s8(vqaddq_s8(d, s)));
+	}
+	return len;
+}
+
+Uint32 SDL_MixAudio_NEON_S16LSB(Uint8 *dst, const Uint8 *src, Uint32 len, int volume)
+{
+	const int16x4_t vol = vdup_n_s16((Sint16)volume);
+	uint8x16_t s8, d8;
+	int16x8_t s, d;
+	Uint32 i;
+
+	len &= ~15;
+	for ( i = 0; i < len; i += 16 ) {
+		s8 = vld1q_u8(src+i);
+		d8 = vld1q_u8(dst+i);
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+		s8 = vrev16q_u8(s8);
+		d8 = vrev16q_u8(d8);
+#endif
+		s = vreinterpretq_s16_u8(s8);
+		d = vreinterpretq_s16_u8(d8);
+		if ( volume < SDL_MIX_MAXVOLUME ) {
+			s = SDL_MixScale16(s, vol);
+		}
+		d8 = vreinterpretq_u8_s16(vqaddq_s16(d, s));
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+		d8 = vrev16q_u8(d8);
+#endif
+		vst1q_u8(dst+i, d8);
+	}
+	return len;
+}
+
+Uint32 SDL_MixAudio_NEON_S16MSB(Uint8 *dst, const Uint8 *src, Uint32 len, int volume)
+{
+	const int16x4_t vol = vdup_n_s16((Sint16)volume);
+	uint8x16_t s8, d8;
+	int16x8_t s, d;
+	Uint32 i;
+
+	len &= ~15;
+	for ( i = 0; i < len; i += 16 ) {
+		s8 = vld1q_u8(src+i);
+		d8 = vld1q_u8(dst+i);
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+		s8 = vrev16q_u8(s8);
+		d8 = vrev16q_u8(d8);
+#endif
+		s = vreinterpretq_s16_u8(s8);
+		d = vreinterpretq_s16_u8(d8);
+		if ( volume < SDL_MIX_MAXVOLUME ) {
+			s = SDL_MixScale16(s, vol);
+		}
+		d8 = vreinterpretq_u8_s16(vqaddq_s16(d, s));
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+		d8 = vrev16q_u8(d8);
+#endif
+		vst1q_u8(dst+i, d8);
+	}
+	return len;
+}
+
+#endif /* SDL_NEON_MIXERS */
@@ -0,0 +1,38 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* NEON versions of SDL_MixAudio, giving exactly the same results as the
+   C code.  Each mixes whole blocks of 16 bytes, and returns the number
+   of bytes it mixed, leaving the rest to the caller.
+   Assumes 0 < volume <= SDL_MIX_MAXVOLUME = 128
+*/
+
+#if defined(SDL_ASSEMBLY_ROUTINES) && \
+    (defined(__ARM_NEON__) || defined(__ARM_NEON))
+#define SDL_NEON_MIXERS	1
+
+extern Uint32 SDL_MixAudio_NEON_U8(Uint8 *dst, const Uint8 *src, Uint32 len, int volume);
+extern Uint32 SDL_MixAudio_NEON_S8(Uint8 *dst, const Uint8 *src, Uint32 len, int volume);
+extern Uint32 SDL_MixAudio_NEON_S16LSB(Uint8 *dst, const Uint8 *src, Uint32 len, int volume);
+extern Uint32 SDL_MixAudio_NEON_S16MSB(Uint8 *dst, const Uint8 *src, Uint32 len, int volume);
+#endif
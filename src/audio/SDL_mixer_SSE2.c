@@ -0,0 +1,150 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* SSE2 versions of SDL_MixAudio
+
+   The C code scales each sample by volume/128 with an integer division,
+   which rounds towards zero, and then adds it to the destination,
+   clamping the sum.  Here the products are biased by 127 when they are
+   negative, so an arithmetic shift gives the same quotient, and the
+   clamping is done by the saturating adds.
+*/
+
+#include "SDL_audio.h"
+#include "SDL_mixer_SSE2.h"
+
+#if SDL_SSE2_MIXERS
+
+#include <emmintrin.h>
+
+/* (s * volume) / 128 for 16 signed 8 bit samples */
+static __inline__ __m128i SDL_MixScale8(__m128i s, __m128i volume)
+{
+	__m128i sign, lo, hi;
+
+	sign = _mm_cmpgt_epi8(_mm_setzero_si128(), s);
+	lo = _mm_mullo_epi16(_mm_unpacklo_epi8(s, sign), volume);
+	hi = _mm_mullo_epi16(_mm_unpackhi_epi8(s, sign), volume);
+	lo = _mm_add_epi16(lo, _mm_srli_epi16(_mm_srai_epi16(lo, 15), 9));
+	hi = _mm_add_epi16(hi, _mm_srli_epi16(_mm_srai_epi16(hi, 15), 9));
+	return _mm_packs_epi16(_mm_srai_epi16(lo, 7), _mm_srai_epi16(hi, 7));
+}
+
+/* (s * volume) / 128 for 8 signed 16 bit samples */
+static __inline__ __m128i SDL_MixScale16(__m128i s, __m128i volume)
+{
+	__m128i lo, hi, p0, p1;
+
+	lo = _mm_mullo_epi16(s, volume);
+	hi = _mm_mulhi_epi16(s, volume);
+	p0 = _mm_unpacklo_epi16(lo, hi);
+	p1 = _mm_unpackhi_epi16(lo, hi);
+	p0 = _mm_add_epi32(p0, _mm_srli_epi32(_mm_srai_epi32(p0, 31), 25));
+	p1 = _mm_add_epi32(p1, _mm_srli_epi32(_mm_srai_epi32(p1, 31), 25));
+	return _mm_packs_epi32(_mm_srai_epi32(p0, 7), _mm_srai_epi32(p1, 7));
+}
+
+static __inline__ __m128i SDL_MixSwap16(__m128i s)
+{
+	return _mm_or_si128(_mm_slli_epi16(s, 8), _mm_srli_epi16(s, 8));
+}
+
+Uint32 SDL_MixAudio_SSE2_U8(Uint8 *dst, const Uint8 *src, Uint32 len, int volume)
+{
+	const __m128i bias = _mm_set1_epi8((char)0x80);
+	const __m128i max = _mm_set1_epi8((char)0xFE);
+	const __m128i vol = _mm_set1_epi16(volume);
+	__m128i s, d;
+	Uint32 i;
+
+	/* Unsigned samples are mixed as signed ones, and then clamped to
+	   0xFE like the mix8 table does */
+	len &= ~15;
+	for ( i = 0; i < len; i += 16 ) {
+		s = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(src+i)), bias);
+		d = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(dst+i)), bias);
+		if ( volume < SDL_MIX_MAXVOLUME ) {
+			s = SDL_MixScale8(s, vol);
+		}
+		d = _mm_xor_si128(_mm_adds_epi8(d, s), bias);
+		_mm_storeu_si128((__m128i *)(dst+i), _mm_min_epu8(d, max));
+	}
+	return len;
+}
+
+Uint32 SDL_MixAudio_SSE2_S8(Uint8 *dst, const Uint8 *src, Uint32 len, int volume)
+{
+	const __m128i vol = _mm_set1_epi16(volume);
+	__m128i s, d;
+	Uint32 i;
+
+	len &= ~15;
+	for ( i = 0; i < len; i += 16 ) {
+		s = _mm_loadu_si128((const __m128i *)(src+i));
+		d = _mm_loadu_si128((const __m128i *)(dst+i));
+		if ( volume < SDL_MIX_MAXVOLUME ) {
+			s = SDL_MixScale8(s, vol);
+		}
+		_mm_storeu_si128((__m128i *)(dst+i), _mm_adds_epi8(d, s));
+	}
+	return len;
+}
+
+Uint32 SDL_MixAudio_SSE2_S16LSB(Uint8 *dst, const Uint8 *src, Uint32 len, int volume)
+{
+	const __m128i vol = _mm_set1_epi16(volume);
+	__m128i s, d;
+	Uint32 i;
+
+	len &= ~15;
+	for ( i = 0; i < len; i += 16 ) {
+		s = _mm_loadu_si128((const __m128i *)(src+i));
+		d = _mm_loadu_si128((const __m128i *)(dst+i));
+		if ( volume < SDL_MIX_MAXVOLUME ) {
+			s = SDL_MixScale16(s, vol);
+		}
+		_mm_storeu_si128((__m128i *)(dst+i), _mm_adds_epi16(d, s));
+	}
+	return len;
+}
+
+Uint32 SDL_MixAudio_SSE2_S16MSB(Uint8 *dst, const Uint8 *src, Uint32 len, int volume)
+{
+	const __m128i vol = _mm_set1_epi16(volume);
+	__m128i s, d;
+	Uint32 i;
+
+	len &= ~15;
+	for ( i = 0; i < len; i += 16 ) {
+		s = SDL_MixSwap16(_mm_loadu_si128((const __m128i *)(src+i)));
+		d = SDL_MixSwap16(_mm_loadu_si128((const __m128i *)(dst+i)));
+		if ( volume < SDL_MIX_MAXVOLUME ) {
+			s = SDL_MixScale16(s, vol);
+		}
+		d = SDL_MixSwap16(_mm_adds_epi16(d, s));
+		_mm_storeu_si128((__m128i *)(dst+i), d);
+	}
+	return len;
+}
+
+#endif /* SDL_SSE2_MIXERS */
@@ -0,0 +1,609 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Arbitrary ratio sample rate conversion */
+
+#include "SDL_audio.h"
+#include "SDL_resample_c.h"
+
+/* Filter coefficients are signed 2.14 fixed point, and each phase of the
+   filter sums to exactly 1.0.  When the reduced output rate has more
+   steps than RESAMPLE_MAXPHASES, the phase is rounded to the nearest of
+   RESAMPLE_MAXPHASES steps.
+
+   The 32-bit formats have more precision than the fixed point filter, so
+   they are filtered in single precision floating point instead.
+*/
+#define RESAMPLE_FRACBITS	14
+#define RESAMPLE_MAXPHASES	512
+#define RESAMPLE_MAXCHANNELS	6
+
+#define RESAMPLE_PI		3.14159265358979323846
+
+struct SDL_AudioResampler {
+	Uint16 format;
+	int channels;
+	int framesize;
+
+	/* Each output frame advances src_step/dst_step input frames */
+	Uint32 src_step;
+	Uint32 dst_step;
+
+	/* Filter taps for each phase */
+	int taps;
+	int phases;
+	Sint16 *filter;
+	float *ffilter;
+
+	/* Stream state: the position of the next output frame, in units of
+	   1/dst_step frames after the newest input frame in the history,
+	   and the last 'taps' input frames of each channel, stored twice
+	   so the window starting at 'pos' is always contiguous.
+	 */
+	Uint32 frac;
+	int pos;
+	Sint32 *history;
+	float *fhistory;
+};
+
+/* The quality from SDL_AUDIO_RESAMPLE_QUALITY, or -1 if not read yet */
+static int resample_quality = -1;
+
+void SDL_ReadResampleQuality(void)
+{
+	const char *envr = SDL_getenv("SDL_AUDIO_RESAMPLE_QUALITY");
+
+	resample_quality = SDL_RESAMPLE_MEDIUM;
+	if ( envr ) {
+		if ( (SDL_strcasecmp(envr, "fast") == 0) ||
+		     (SDL_strcmp(envr, "0") == 0) ) {
+			resample_quality = SDL_RESAMPLE_FAST;
+		} else if ( (SDL_strcasecmp(envr, "best") == 0) ||
+		            (SDL_strcmp(envr, "2") == 0) ) {
+			resample_quality = SDL_RESAMPLE_BEST;
+		}
+	}
+}
+
+int SDL_GetResampleQuality(void)
+{
+	if ( resample_quality < 0 ) {
+		SDL_ReadResampleQuality();
+	}
+	return(resample_quality);
+}
+
+/* Only used while building the filter, so precision matters more than
+   speed: reduce to [-pi, pi] and sum the Taylor series.
+ */
+static double SDL_ResampleSin(double x)
+{
+	double term, sum, x2;
+	int i;
+
+	i = (int)(x / (2.0*RESAMPLE_PI));
+	x -= i * (2.0*RESAMPLE_PI);
+	if ( x > RESAMPLE_PI ) {
+		x -= 2.0*RESAMPLE_PI;
+	} else if ( x < -RESAMPLE_PI ) {
+		x += 2.0*RESAMPLE_PI;
+	}
+	x2 = x * x;
+	term = x;
+	sum = x;
+	for ( i = 1; i < 13; ++i ) {
+		term *= -x2 / ((2*i) * (2*i+1));
+		sum += term;
+	}
+	return(sum);
+}
+
+static double SDL_ResampleCos(double x)
+{
+	return(SDL_ResampleSin(x + RESAMPLE_PI/2));
+}
+
+/* Windowed sinc with cutoff 'fc' (relative to the input Nyquist rate),
+   evaluated 'd' input frames from the output position */
+static double SDL_ResampleKernel(double d, double fc, int taps)
+{
+	double x, w;
+
+	if ( taps == 2 ) {
+		/* Linear interpolation */
+		if ( d < 0.0 ) {
+			d = -d;
+		}
+		return((d < 1.0) ? (1.0 - d) : 0.0);
+	}
+	/* Blackman window over [-taps/2, taps/2] */
+	x = 2.0 * RESAMPLE_PI * d / taps;
+	w = 0.42 + 0.5 * SDL_ResampleCos(x) + 0.08 * SDL_ResampleCos(2.0*x);
+	if ( w < 0.0 ) {
+		w = 0.0;
+	}
+	x = RESAMPLE_PI * fc * d;
+	if ( (x > -1e-9) && (x < 1e-9) ) {
+		return(fc * w);
+	}
+	return(fc * w * SDL_ResampleSin(x) / x);
+}
+
+static void SDL_BuildResampleFilter(SDL_AudioResampler *r, double fc)
+{
+	double coef[64];
+	double sum, err, want;
+	int phase, i, half;
+	Sint16 *filter;
+	float *ffilter;
+
+	half = r->taps / 2;
+	filter = r->filter;
+	ffilter = r->ffilter;
+	for ( phase = 0; phase < r->phases; ++phase ) {
+		/* Tap i holds the input frame (i - half + 1 - phase) frames
+		   away from the output position */
+		sum = 0.0;
+		for ( i = 0; i < r->taps; ++i ) {
+			coef[i] = SDL_ResampleKernel(
+				(double)(i - half + 1) - (double)phase / r->phases,
+				fc, r->taps);
+			sum += coef[i];
+		}
+		if ( ffilter ) {
+			for ( i = 0; i < r->taps; ++i ) {
+				ffilter[i] = (float)(coef[i] / sum);
+			}
+			ffilter += r->taps;
+			continue;
+		}
+		/* Unity gain at DC, carrying the rounding error along */
+		err = 0.0;
+		for ( i = 0; i < r->taps; ++i ) {
+			want = coef[i] / sum * (1 << RESAMPLE_FRACBITS) + err;
+			filter[i] = (Sint16)((want < 0.0) ? (want - 0.5) : (want + 0.5));
+			err = want - filter[i];
+		}
+		filter += r->taps;
+	}
+}
+
+static Uint32 SDL_ResampleGCD(Uint32 a, Uint32 b)
+{
+	Uint32 t;
+
+	while ( b ) {
+		t = a % b;
+		a = b;
+		b = t;
+	}
+	return(a);
+}
+
+SDL_AudioResampler *SDL_CreateResampler(Uint16 format, int channels,
+                                   int src_rate, int dst_rate, int quality)
+{
+	SDL_AudioResampler *r;
+	Uint32 gcd;
+	double fc;
+
+	switch (format) {
+	    case AUDIO_U8:
+	    case AUDIO_S8:
+	    case AUDIO_U16LSB:
+	    case AUDIO_S16LSB:
+	    case AUDIO_U16MSB:
+	    case AUDIO_S16MSB:
+	    case AUDIO_S32LSB:
+	    case AUDIO_S32MSB:
+	    case AUDIO_F32LSB:
+	    case AUDIO_F32MSB:
+		break;
+	    default:
+		SDL_SetError("Unsupported audio format for resampling");
+		return(NULL);
+	}
+	if ( (channels < 1) || (channels > RESAMPLE_MAXCHANNELS) ||
+	     (src_rate <= 0) || (dst_rate <= 0) ) {
+		SDL_SetError("Invalid resampling parameters");
+		return(NULL);
+	}
+
+	r = (SDL_AudioResampler *)SDL_malloc(sizeof(*r));
+	if ( r == NULL ) {
+		SDL_OutOfMemory();
+		return(NULL);
+	}
+	SDL_memset(r, 0, sizeof(*r));
+	r->format = format;
+	r->channels = channels;
+	r->framesize = ((format & 0xFF) / 8) * channels;
+	gcd = SDL_ResampleGCD(src_rate, dst_rate);
+	r->src_step = src_rate / gcd;
+	r->dst_step = dst_rate / gcd;
+
+	switch (quality) {
+	    case SDL_RESAMPLE_FAST:
+		r->taps = 2;
+		fc = 1.0;
+		break;
+	    case SDL_RESAMPLE_BEST:
+		r->taps = 48;
+		fc = 0.95;
+		break;
+	    default:
+		r->taps = 16;
+		fc = 0.90;
+		break;
+	}
+	/* Filter out what the output rate can't represent */
+	if ( r->dst_step < r->src_step ) {
+		fc *= (double)r->dst_step / r->src_step;
+	}
+	r->phases = RESAMPLE_MAXPHASES;
+	if ( r->dst_step < RESAMPLE_MAXPHASES ) {
+		r->phases = r->dst_step;
+	}
+
+	if ( (format & 0xFF) == 32 ) {
+		r->ffilter = (float *)SDL_malloc(r->phases*r->taps*sizeof(float));
+		r->fhistory = (float *)SDL_malloc(channels*2*r->taps*sizeof(float));
+	} else {
+		r->filter = (Sint16 *)SDL_malloc(r->phases*r->taps*sizeof(Sint16));
+		r->history = (Sint32 *)SDL_malloc(channels*2*r->taps*sizeof(Sint32));
+	}
+	if ( ((r->filter == NULL) || (r->history == NULL)) &&
+	     ((r->ffilter == NULL) || (r->fhistory == NULL)) ) {
+		SDL_FreeResampler(r);
+		SDL_OutOfMemory();
+		return(NULL);
+	}
+	SDL_BuildResampleFilter(r, fc);
+	SDL_ResetResampler(r);
+	return(r);
+}
+
+void SDL_FreeResampler(SDL_AudioResampler *r)
+{
+	if ( r ) {
+		if ( r->filter ) {
+			SDL_free(r->filter);
+		}
+		if ( r->history ) {
+			SDL_free(r->history);
+		}
+		if ( r->ffilter ) {
+			SDL_free(r->ffilter);
+		}
+		if ( r->fhistory ) {
+			SDL_free(r->fhistory);
+		}
+		SDL_free(r);
+	}
+}
+
+void SDL_ResetResampler(SDL_AudioResampler *r)
+{
+	/* Start from silence, and take an input frame before the first
+	   output frame so converting in place is safe */
+	if ( r->fhistory ) {
+		SDL_memset(r->fhistory, 0, r->channels*2*r->taps*sizeof(float));
+	} else {
+		SDL_memset(r->history, 0, r->channels*2*r->taps*sizeof(Sint32));
+	}
+	r->pos = 0;
+	r->frac = r->dst_step;
+}
+
+int SDL_ResamplerOutputFrames(SDL_AudioResampler *r, int in_frames)
+{
+	double room;
+
+	/* Output frame j needs (frac + j*src_step) / dst_step input frames */
+	room = (double)in_frames * r->dst_step + (r->dst_step - 1) - r->frac;
+	if ( room < 0.0 ) {
+		return(0);
+	}
+	return((int)(room / r->src_step) + 1);
+}
+
+int SDL_ResamplerInputFrames(SDL_AudioResampler *r, int out_frames)
+{
+	if ( out_frames <= 0 ) {
+		return(0);
+	}
+	return((int)(((double)r->frac +
+	              (double)(out_frames-1) * r->src_step) / r->dst_step));
+}
+
+int SDL_ResamplerDelay(SDL_AudioResampler *r)
+{
+	return(r->taps / 2);
+}
+
+/* Read and write one 32-bit sample in either byte order */
+static Uint32 SDL_ResampleLoad32(const Uint8 *p, Uint16 format)
+{
+	if ( format & 0x1000 ) {
+		return(((Uint32)p[0] << 24) | ((Uint32)p[1] << 16) |
+		       ((Uint32)p[2] << 8) | p[3]);
+	}
+	return(((Uint32)p[3] << 24) | ((Uint32)p[2] << 16) |
+	       ((Uint32)p[1] << 8) | p[0]);
+}
+
+static void SDL_ResampleStore32(Uint8 *p, Uint16 format, Uint32 sample)
+{
+	if ( format & 0x1000 ) {
+		p[0] = (Uint8)(sample >> 24);
+		p[1] = (Uint8)(sample >> 16);
+		p[2] = (Uint8)(sample >> 8);
+		p[3] = (Uint8)sample;
+	} else {
+		p[0] = (Uint8)sample;
+		p[1] = (Uint8)(sample >> 8);
+		p[2] = (Uint8)(sample >> 16);
+		p[3] = (Uint8)(sample >> 24);
+	}
+}
+
+/* The 32-bit versions of SDL_ResamplePush() and SDL_ResampleOutput() */
+static void SDL_ResamplePushFloat(SDL_AudioResampler *r, const Uint8 *frame)
+{
+	float *history;
+	float sample;
+	union { Uint32 u; float f; } bits;
+	int c;
+
+	history = r->fhistory + r->pos;
+	for ( c = 0; c < r->channels; ++c ) {
+		bits.u = SDL_ResampleLoad32(frame + 4*c, r->format);
+		if ( r->format & 0x0100 ) {
+			sample = bits.f;
+		} else {
+			sample = (float)(Sint32)bits.u * (1.0f / 2147483648.0f);
+		}
+		history[0] = sample;
+		history[r->taps] = sample;
+		history += 2*r->taps;
+	}
+	if ( ++r->pos == r->taps ) {
+		r->pos = 0;
+	}
+}
+
+static void SDL_ResampleOutputFloat(SDL_AudioResampler *r, Uint8 *frame)
+{
+	const float *filter;
+	const float *history;
+	float sum;
+	union { Uint32 u; float f; } bits;
+	int c, i;
+
+	filter = r->ffilter + (r->frac * r->phases / r->dst_step) * r->taps;
+	history = r->fhistory + r->pos;
+	for ( c = 0; c < r->channels; ++c ) {
+		sum = 0.0f;
+		for ( i = 0; i < r->taps; ++i ) {
+			sum += history[i] * filter[i];
+		}
+		if ( r->format & 0x0100 ) {
+			bits.f = sum;
+		} else if ( sum >= 1.0f ) {
+			bits.u = 0x7FFFFFFF;
+		} else if ( sum <= -1.0f ) {
+			bits.u = 0x80000000;
+		} else {
+			bits.u = (Uint32)(Sint32)(sum * 2147483648.0f);
+		}
+		SDL_ResampleStore32(frame + 4*c, r->format, bits.u);
+		history += 2*r->taps;
+	}
+}
+
+/* Add one input frame to the history */
+static void SDL_ResamplePush(SDL_AudioResampler *r, const Uint8 *frame)
+{
+	Sint32 *history;
+	Sint32 sample;
+	int c;
+
+	history = r->history + r->pos;
+	for ( c = 0; c < r->channels; ++c ) {
+		switch (r->format) {
+		    case AUDIO_U8:
+			sample = ((Sint32)frame[c] - 0x80) * 256;
+			break;
+		    case AUDIO_S8:
+			sample = (Sint32)((Sint8)frame[c]) * 256;
+			break;
+		    case AUDIO_U16LSB:
+			sample = ((frame[2*c+1] << 8) | frame[2*c]) - 0x8000;
+			break;
+		    case AUDIO_S16LSB:
+			sample = (Sint16)((frame[2*c+1] << 8) | frame[2*c]);
+			break;
+		    case AUDIO_U16MSB:
+			sample = ((frame[2*c] << 8) | frame[2*c+1]) - 0x8000;
+			break;
+		    default:	/* AUDIO_S16MSB */
+			sample = (Sint16)((frame[2*c] << 8) | frame[2*c+1]);
+			break;
+		}
+		history[0] = sample;
+		history[r->taps] = sample;
+		history += 2*r->taps;
+	}
+	if ( ++r->pos == r->taps ) {
+		r->pos = 0;
+	}
+}
+
+/* Add one frame of silence to the history */
+static void SDL_ResamplePushSilence(SDL_AudioResampler *r)
+{
+	int c;
+
+	for ( c = 0; c < r->channels; ++c ) {
+		if ( r->fhistory ) {
+			r->fhistory[c*2*r->taps + r->pos] = 0.0f;
+			r->fhistory[c*2*r->taps + r->pos + r->taps] = 0.0f;
+		} else {
+			r->history[c*2*r->taps + r->pos] = 0;
+			r->history[c*2*r->taps + r->pos + r->taps] = 0;
+		}
+	}
+	if ( ++r->pos == r->taps ) {
+		r->pos = 0;
+	}
+}
+
+/* Compute one output frame at the current phase */
+static void SDL_ResampleOutput(SDL_AudioResampler *r, Uint8 *frame)
+{
+	const Sint16 *filter;
+	const Sint32 *history;
+	Sint32 sum;
+	int c, i;
+
+	filter = r->filter + (r->frac * r->phases / r->dst_step) * r->taps;
+	history = r->history + r->pos;
+	for ( c = 0; c < r->channels; ++c ) {
+		sum = 1 << (RESAMPLE_FRACBITS-1);
+		for ( i = 0; i < r->taps; ++i ) {
+			sum += history[i] * filter[i];
+		}
+		sum >>= RESAMPLE_FRACBITS;
+		if ( sum > 32767 ) {
+			sum = 32767;
+		} else if ( sum < -32768 ) {
+			sum = -32768;
+		}
+		switch (r->format) {
+		    case AUDIO_U8:
+			sum = (sum + 0x80) >> 8;
+			frame[c] = (Uint8)(((sum > 127) ? 127 : sum) + 0x80);
+			break;
+		    case AUDIO_S8:
+			sum = (sum + 0x80) >> 8;
+			frame[c] = (Uint8)((sum > 127) ? 127 : sum);
+			break;
+		    case AUDIO_U16LSB:
+			sum += 0x8000;
+			frame[2*c] = (Uint8)sum;
+			frame[2*c+1] = (Uint8)(sum >> 8);
+			break;
+		    case AUDIO_S16LSB:
+			frame[2*c] = (Uint8)sum;
+			frame[2*c+1] = (Uint8)(sum >> 8);
+			break;
+		    case AUDIO_U16MSB:
+			sum += 0x8000;
+			frame[2*c] = (Uint8)(sum >> 8);
+			frame[2*c+1] = (Uint8)sum;
+			break;
+		    default:	/* AUDIO_S16MSB */
+			frame[2*c] = (Uint8)(sum >> 8);
+			frame[2*c+1] = (Uint8)sum;
+			break;
+		}
+		history += 2*r->taps;
+	}
+}
+
+int SDL_Resample(SDL_AudioResampler *r, const Uint8 *in, int *in_frames,
+                 Uint8 *out, int out_frames)
+{
+	void (*push)(SDL_AudioResampler *r, const Uint8 *frame);
+	void (*output)(SDL_AudioResampler *r, Uint8 *frame);
+	int used, written;
+
+	if ( r->fhistory ) {
+		push = SDL_ResamplePushFloat;
+		output = SDL_ResampleOutputFloat;
+	} else {
+		push = SDL_ResamplePush;
+		output = SDL_ResampleOutput;
+	}
+	used = 0;
+	for ( written = 0; written < out_frames; ++written ) {
+		while ( r->frac >= r->dst_step ) {
+			if ( used == *in_frames ) {
+				goto done;
+			}
+			push(r, in);
+			in += r->framesize;
+			++used;
+			r->frac -= r->dst_step;
+		}
+		output(r, out);
+		out += r->framesize;
+		r->frac += r->src_step;
+	}
+done:
+	*in_frames = used;
+	return(written);
+}
+
+int SDL_ResamplePrime(SDL_AudioResampler *r, const Uint8 *in, int in_frames)
+{
+	int i, used;
+
+	used = 0;
+	for ( i = 0; i < r->taps / 2; ++i ) {
+		if ( used < in_frames ) {
+			if ( r->fhistory ) {
+				SDL_ResamplePushFloat(r, in);
+			} else {
+				SDL_ResamplePush(r, in);
+			}
+			in += r->framesize;
+			++used;
+		} else {
+			SDL_ResamplePushSilence(r);
+		}
+	}
+	return(used);
+}
+
+int SDL_ResampleFlush(SDL_AudioResampler *r, Uint8 *out, int out_frames)
+{
+	void (*output)(SDL_AudioResampler *r, Uint8 *frame);
+	int written;
+
+	if ( r->fhistory ) {
+		output = SDL_ResampleOutputFloat;
+	} else {
+		output = SDL_ResampleOutput;
+	}
+	for ( written = 0; written < out_frames; ++written ) {
+		while ( r->frac >= r->dst_step ) {
+			SDL_ResamplePushSilence(r);
+			r->frac -= r->dst_step;
+		}
+		output(r, out);
+		out += r->framesize;
+		r->frac += r->src_step;
+	}
+	return(written);
+}
@@ -0,0 +1,103 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#ifndef _SDL_resample_c_h
+#define _SDL_resample_c_h
+
+/* Sample rate conversion between any two rates.
+
+   The resampler is a polyphase windowed-sinc filter in fixed point.  It
+   keeps the last few input frames and the phase of the next output frame
+   between calls, so a stream can be converted in chunks of any size
+   without clicks at the chunk boundaries.  The filter is causal, which
+   delays the output by half the filter length.
+*/
+
+#include "SDL_audio.h"
+
+/* Quality levels, trading CPU time for less aliasing and ripple */
+#define SDL_RESAMPLE_FAST	0	/* linear interpolation */
+#define SDL_RESAMPLE_MEDIUM	1	/* 16 tap filter */
+#define SDL_RESAMPLE_BEST	2	/* 48 tap filter */
+
+typedef struct SDL_AudioResampler SDL_AudioResampler;
+
+/* Returns the quality requested with SDL_AUDIO_RESAMPLE_QUALITY
+   ("fast", "medium" or "best"), or SDL_RESAMPLE_MEDIUM.  The variable
+   is read by SDL_ReadResampleQuality() when the audio subsystem starts,
+   or on first use.
+*/
+extern void SDL_ReadResampleQuality(void);
+extern int SDL_GetResampleQuality(void);
+
+/* Create a resampler for interleaved samples in 'format' (any of the 8,
+   16 and 32 bit formats) with 1 to 6 channels.  Returns NULL on error.
+*/
+extern SDL_AudioResampler *SDL_CreateResampler(Uint16 format, int channels,
+                                  int src_rate, int dst_rate, int quality);
+extern void SDL_FreeResampler(SDL_AudioResampler *resampler);
+
+/* Forget the stream history, as if the resampler was just created */
+extern void SDL_ResetResampler(SDL_AudioResampler *resampler);
+
+/* Number of output frames that 'in_frames' more input frames produce,
+   and the number of input frames needed to produce 'out_frames' output
+   frames, given the current state.
+*/
+extern int SDL_ResamplerOutputFrames(SDL_AudioResampler *resampler,
+                                     int in_frames);
+extern int SDL_ResamplerInputFrames(SDL_AudioResampler *resampler,
+                                    int out_frames);
+
+/* Number of input frames the output lags behind the input */
+extern int SDL_ResamplerDelay(SDL_AudioResampler *resampler);
+
+/* Convert up to '*in_frames' frames from 'in' into at most 'out_frames'
+   frames at 'out'.  Sets '*in_frames' to the number of input frames used
+   and returns the number of output frames written.
+
+   Input is consumed before each output frame is written, so 'out' may
+   overlap 'in' as long as it starts at least as many frames before 'in'
+   as the output can grow beyond the input.
+*/
+extern int SDL_Resample(SDL_AudioResampler *resampler,
+                        const Uint8 *in, int *in_frames,
+                        Uint8 *out, int out_frames);
+
+/* For converting a whole sound at once, rather than a stream: right
+   after a reset, feed the first SDL_ResamplerDelay() frames of the sound
+   to the filter without any output, so the output starts in step with
+   the input.  If the sound is shorter, silence makes up the rest.
+   Returns the number of input frames used.
+*/
+extern int SDL_ResamplePrime(SDL_AudioResampler *resampler,
+                             const Uint8 *in, int in_frames);
+
+/* Write 'out_frames' frames at 'out' after the end of the input, feeding
+   the filter silence, to get the end of a sound out of it.  Returns the
+   number of output frames written.
+*/
+extern int SDL_ResampleFlush(SDL_AudioResampler *resampler,
+                             Uint8 *out, int out_frames);
+
+#endif /* _SDL_resample_c_h */
@@ -54,6 +54,14 @@ struct SDL_AudioDevice {
 	void (*WaitDone)(_THIS);
 	void (*CloseAudio)(_THIS);
 
+	/* * * */
+	/* Recording, for drivers that can.  OpenAudio opens an input device
+	   when 'iscapture' is set, and RecordAudio waits for the next
+	   spec.size bytes to be recorded and returns them, or NULL on error.
+	   The data may be in the driver's own buffer, and only has to stay
+	   valid until the next call.  The callback may write to it. */
+	Uint8 *(*RecordAudio)(_THIS);
+
 	/* * * */
 	/* Lock / Unlock functions added for the Mac port */
 	void (*LockAudio)(_THIS);
@@ -68,7 +76,33 @@ struct SDL_AudioDevice {
 	/* An audio conversion block for audio format emulation */
 	SDL_AudioCVT convert;
 
+	/* Rate conversion for the audio thread.  The callback fills
+	   stream_buf with stream_len bytes in the application's format,
+	   and the stream keeps what the device hasn't taken yet. */
+	SDL_AudioStream *stream;
+	Uint8 *stream_buf;
+	int stream_len;
+	int stream_silence;
+	Uint16 stream_format;
+
+	/* Set if the callback writes the whole buffer, so it needn't be
+	   cleared first (SDL_SetAudioCallbackFills()) */
+	int callback_fills;
+
+	/* Set if the audio thread converts in the device buffer, and
+	   convert.buf isn't allocated */
+	int convert_in_place;
+
+	/* The latency asked for with SDL_SetAudioLatency() in milliseconds,
+	   or 0.  The driver sets latency_frames to the sample frames it
+	   queues ahead of the speaker, and counts the times playback runs
+	   dry; a capture device leaves 'underruns' alone. */
+	int latency_ms;
+	int latency_frames;
+	Uint32 underruns;
+
 	/* Current state flags */
+	int iscapture;
 	int enabled;
 	int paused;
 	int opened;
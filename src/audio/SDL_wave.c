@@ -28,6 +28,7 @@
 
 
 static int ReadChunk(SDL_RWops *src, Chunk *chunk);
+static int ReadChunkHeader(SDL_RWops *src, Chunk *chunk);
 
 struct MS_ADPCM_decodestate {
 	Uint8 hPredictor;
@@ -35,48 +36,67 @@ struct MS_ADPCM_decodestate {
 	Sint16 iSamp1;
 	Sint16 iSamp2;
 };
-static struct MS_ADPCM_decoder {
+struct MS_ADPCM_decoder {
 	WaveFMT wavefmt;
 	Uint16 wSamplesPerBlock;
 	Uint16 wNumCoef;
 	Sint16 aCoeff[7][2];
 	/* * * */
 	struct MS_ADPCM_decodestate state[2];
-} MS_ADPCM_state;
+};
+static struct MS_ADPCM_decoder MS_ADPCM_state;
 
-static int InitMS_ADPCM(WaveFMT *format)
+static int InitMS_ADPCM(struct MS_ADPCM_decoder *decoder, WaveFMT *format,
+							int fmtlen)
 {
 	Uint8 *rogue_feel;
 	Uint16 extra_info;
-	int i;
+	int i, channels;
+
+	/* The coefficients follow the format, after three more words */
+	if ( fmtlen < (int)(sizeof(*format) + 3*sizeof(Uint16) + 7*2*sizeof(Sint16)) ) {
+		SDL_SetError("MS_ADPCM format chunk is too short");
+		return(-1);
+	}
 
 	/* Set the rogue pointer to the MS_ADPCM specific data */
-	MS_ADPCM_state.wavefmt.encoding = SDL_SwapLE16(format->encoding);
-	MS_ADPCM_state.wavefmt.channels = SDL_SwapLE16(format->channels);
-	MS_ADPCM_state.wavefmt.frequency = SDL_SwapLE32(format->frequency);
-	MS_ADPCM_state.wavefmt.byterate = SDL_SwapLE32(format->byterate);
-	MS_ADPCM_state.wavefmt.blockalign = SDL_SwapLE16(format->blockalign);
-	MS_ADPCM_state.wavefmt.bitspersample =
+	decoder->wavefmt.encoding = SDL_SwapLE16(format->encoding);
+	decoder->wavefmt.channels = SDL_SwapLE16(format->channels);
+	decoder->wavefmt.frequency = SDL_SwapLE32(format->frequency);
+	decoder->wavefmt.byterate = SDL_SwapLE32(format->byterate);
+	decoder->wavefmt.blockalign = SDL_SwapLE16(format->blockalign);
+	decoder->wavefmt.bitspersample =
 					 SDL_SwapLE16(format->bitspersample);
 	rogue_feel = (Uint8 *)format+sizeof(*format);
 	if ( sizeof(*format) == 16 ) {
 		extra_info = ((rogue_feel[1]<<8)|rogue_feel[0]);
 		rogue_feel += sizeof(Uint16);
 	}
-	MS_ADPCM_state.wSamplesPerBlock = ((rogue_feel[1]<<8)|rogue_feel[0]);
+	decoder->wSamplesPerBlock = ((rogue_feel[1]<<8)|rogue_feel[0]);
 	rogue_feel += sizeof(Uint16);
-	MS_ADPCM_state.wNumCoef = ((rogue_feel[1]<<8)|rogue_feel[0]);
+	decoder->wNumCoef = ((rogue_feel[1]<<8)|rogue_feel[0]);
 	rogue_feel += sizeof(Uint16);
-	if ( MS_ADPCM_state.wNumCoef != 7 ) {
+	if ( decoder->wNumCoef != 7 ) {
 		SDL_SetError("Unknown set of MS_ADPCM coefficients");
 		return(-1);
 	}
-	for ( i=0; i<MS_ADPCM_state.wNumCoef; ++i ) {
-		MS_ADPCM_state.aCoeff[i][0] = ((rogue_feel[1]<<8)|rogue_feel[0]);
+	for ( i=0; i<decoder->wNumCoef; ++i ) {
+		decoder->aCoeff[i][0] = ((rogue_feel[1]<<8)|rogue_feel[0]);
 		rogue_feel += sizeof(Uint16);
-		MS_ADPCM_state.aCoeff[i][1] = ((rogue_feel[1]<<8)|rogue_feel[0]);
+		decoder->aCoeff[i][1] = ((rogue_feel[1]<<8)|rogue_feel[0]);
 		rogue_feel += sizeof(Uint16);
 	}
+
+	/* Make sure a block holds the samples it says it does */
+	channels = decoder->wavefmt.channels;
+	if ( (channels < 1) || (channels > 2) ||
+	     (decoder->wSamplesPerBlock < 2) ||
+	     ((((decoder->wSamplesPerBlock-2)*channels) % 2) != 0) ||
+	     ((7*channels + (decoder->wSamplesPerBlock-2)*channels/2) >
+	      decoder->wavefmt.blockalign) ) {
+		SDL_SetError("Invalid MS_ADPCM block layout");
+		return(-1);
+	}
 	return(0);
 }
 
@@ -114,22 +134,106 @@ static Sint32 MS_ADPCM_nibble(struct MS_ADPCM_decodestate *state,
 	return(new_sample);
 }
 
-static int MS_ADPCM_decode(Uint8 **audio_buf, Uint32 *audio_len)
+/* Decode one block of wSamplesPerBlock sample frames */
+static int MS_ADPCM_decode_block(struct MS_ADPCM_decoder *decoder,
+				const Uint8 *encoded, Uint8 *decoded)
 {
 	struct MS_ADPCM_decodestate *state[2];
-	Uint8 *freeable, *encoded, *decoded;
-	Sint32 encoded_len, samplesleft;
+	Sint32 samplesleft;
 	Sint8 nybble, stereo;
 	Sint16 *coeff[2];
 	Sint32 new_sample;
 
+	stereo = (decoder->wavefmt.channels == 2);
+	state[0] = &decoder->state[0];
+	state[1] = &decoder->state[stereo];
+
+	/* Grab the initial information for this block */
+	state[0]->hPredictor = *encoded++;
+	if ( stereo ) {
+		state[1]->hPredictor = *encoded++;
+	}
+	state[0]->iDelta = ((encoded[1]<<8)|encoded[0]);
+	encoded += sizeof(Sint16);
+	if ( stereo ) {
+		state[1]->iDelta = ((encoded[1]<<8)|encoded[0]);
+		encoded += sizeof(Sint16);
+	}
+	state[0]->iSamp1 = ((encoded[1]<<8)|encoded[0]);
+	encoded += sizeof(Sint16);
+	if ( stereo ) {
+		state[1]->iSamp1 = ((encoded[1]<<8)|encoded[0]);
+		encoded += sizeof(Sint16);
+	}
+	state[0]->iSamp2 = ((encoded[1]<<8)|encoded[0]);
+	encoded += sizeof(Sint16);
+	if ( stereo ) {
+		state[1]->iSamp2 = ((encoded[1]<<8)|encoded[0]);
+		encoded += sizeof(Sint16);
+	}
+	if ( (state[0]->hPredictor >= decoder->wNumCoef) ||
+	     (state[1]->hPredictor >= decoder->wNumCoef) ) {
+		SDL_SetError("Invalid MS_ADPCM predictor");
+		return(-1);
+	}
+	coeff[0] = decoder->aCoeff[state[0]->hPredictor];
+	coeff[1] = decoder->aCoeff[state[1]->hPredictor];
+
+	/* Store the two initial samples we start with */
+	decoded[0] = state[0]->iSamp2&0xFF;
+	decoded[1] = state[0]->iSamp2>>8;
+	decoded += 2;
+	if ( stereo ) {
+		decoded[0] = state[1]->iSamp2&0xFF;
+		decoded[1] = state[1]->iSamp2>>8;
+		decoded += 2;
+	}
+	decoded[0] = state[0]->iSamp1&0xFF;
+	decoded[1] = state[0]->iSamp1>>8;
+	decoded += 2;
+	if ( stereo ) {
+		decoded[0] = state[1]->iSamp1&0xFF;
+		decoded[1] = state[1]->iSamp1>>8;
+		decoded += 2;
+	}
+
+	/* Decode and store the other samples in this block */
+	samplesleft = (decoder->wSamplesPerBlock-2)*
+				decoder->wavefmt.channels;
+	while ( samplesleft > 0 ) {
+		nybble = (*encoded)>>4;
+		new_sample = MS_ADPCM_nibble(state[0],nybble,coeff[0]);
+		decoded[0] = new_sample&0xFF;
+		new_sample >>= 8;
+		decoded[1] = new_sample&0xFF;
+		decoded += 2;
+
+		nybble = (*encoded)&0x0F;
+		new_sample = MS_ADPCM_nibble(state[1],nybble,coeff[1]);
+		decoded[0] = new_sample&0xFF;
+		new_sample >>= 8;
+		decoded[1] = new_sample&0xFF;
+		decoded += 2;
+
+		++encoded;
+		samplesleft -= 2;
+	}
+	return(0);
+}
+
+static int MS_ADPCM_decode(struct MS_ADPCM_decoder *decoder,
+				Uint8 **audio_buf, Uint32 *audio_len)
+{
+	Uint8 *freeable, *encoded, *decoded;
+	Sint32 encoded_len, decoded_block;
+
 	/* Allocate the proper sized output buffer */
 	encoded_len = *audio_len;
 	encoded = *audio_buf;
 	freeable = *audio_buf;
-	*audio_len = (encoded_len/MS_ADPCM_state.wavefmt.blockalign) * 
-				MS_ADPCM_state.wSamplesPerBlock*
-				MS_ADPCM_state.wavefmt.channels*sizeof(Sint16);
+	decoded_block = decoder->wSamplesPerBlock*
+				decoder->wavefmt.channels*sizeof(Sint16);
+	*audio_len = (encoded_len/decoder->wavefmt.blockalign) * decoded_block;
 	*audio_buf = (Uint8 *)SDL_malloc(*audio_len);
 	if ( *audio_buf == NULL ) {
 		SDL_Error(SDL_ENOMEM);
@@ -138,76 +242,16 @@ static int MS_ADPCM_decode(Uint8 **audio_buf, Uint32 *audio_len)
 	decoded = *audio_buf;
 
 	/* Get ready... Go! */
-	stereo = (MS_ADPCM_state.wavefmt.channels == 2);
-	state[0] = &MS_ADPCM_state.state[0];
-	state[1] = &MS_ADPCM_state.state[stereo];
-	while ( encoded_len >= MS_ADPCM_state.wavefmt.blockalign ) {
-		/* Grab the initial information for this block */
-		state[0]->hPredictor = *encoded++;
-		if ( stereo ) {
-			state[1]->hPredictor = *encoded++;
-		}
-		state[0]->iDelta = ((encoded[1]<<8)|encoded[0]);
-		encoded += sizeof(Sint16);
-		if ( stereo ) {
-			state[1]->iDelta = ((encoded[1]<<8)|encoded[0]);
-			encoded += sizeof(Sint16);
-		}
-		state[0]->iSamp1 = ((encoded[1]<<8)|encoded[0]);
-		encoded += sizeof(Sint16);
-		if ( stereo ) {
-			state[1]->iSamp1 = ((encoded[1]<<8)|encoded[0]);
-			encoded += sizeof(Sint16);
-		}
-		state[0]->iSamp2 = ((encoded[1]<<8)|encoded[0]);
-		encoded += sizeof(Sint16);
-		if ( stereo ) {
-			state[1]->iSamp2 = ((encoded[1]<<8)|encoded[0]);
-			encoded += sizeof(Sint16);
-		}
-		coeff[0] = MS_ADPCM_state.aCoeff[state[0]->hPredictor];
-		coeff[1] = MS_ADPCM_state.aCoeff[state[1]->hPredictor];
-
-		/* Store the two initial samples we start with */
-		decoded[0] = state[0]->iSamp2&0xFF;
-		decoded[1] = state[0]->iSamp2>>8;
-		decoded += 2;
-		if ( stereo ) {
-			decoded[0] = state[1]->iSamp2&0xFF;
-			decoded[1] = state[1]->iSamp2>>8;
-			decoded += 2;
-		}
-		decoded[0] = state[0]->iSamp1&0xFF;
-		decoded[1] = state[0]->iSamp1>>8;
-		decoded += 2;
-		if ( stereo ) {
-			decoded[0] = state[1]->iSamp1&0xFF;
-			decoded[1] = state[1]->iSamp1>>8;
-			decoded += 2;
-		}
-
-		/* Decode and store the other samples in this block */
-		samplesleft = (MS_ADPCM_state.wSamplesPerBlock-2)*
-					MS_ADPCM_state.wavefmt.channels;
-		while ( samplesleft > 0 ) {
-			nybble = (*encoded)>>4;
-			new_sample = MS_ADPCM_nibble(state[0],nybble,coeff[0]);
-			decoded[0] = new_sample&0xFF;
-			new_sample >>= 8;
-			decoded[1] = new_sample&0xFF;
-			decoded += 2;
-
-			nybble = (*encoded)&0x0F;
-			new_sample = MS_ADPCM_nibble(state[1],nybble,coeff[1]);
-			decoded[0] = new_sample&0xFF;
-			new_sample >>= 8;
-			decoded[1] = new_sample&0xFF;
-			decoded += 2;
-
-			++encoded;
-			samplesleft -= 2;
+	while ( encoded_len >= decoder->wavefmt.blockalign ) {
+		if ( MS_ADPCM_decode_block(decoder, encoded, decoded) < 0 ) {
+			SDL_free(*audio_buf);
+			*audio_buf = NULL;
+			SDL_free(freeable);
+			return(-1);
 		}
-		encoded_len -= MS_ADPCM_state.wavefmt.blockalign;
+		encoded += decoder->wavefmt.blockalign;
+		encoded_len -= decoder->wavefmt.blockalign;
+		decoded += decoded_block;
 	}
 	SDL_free(freeable);
 	return(0);
@@ -217,32 +261,57 @@ struct IMA_ADPCM_decodestate {
 	Sint32 sample;
 	Sint8 index;
 };
-static struct IMA_ADPCM_decoder {
+struct IMA_ADPCM_decoder {
 	WaveFMT wavefmt;
 	Uint16 wSamplesPerBlock;
 	/* * * */
 	struct IMA_ADPCM_decodestate state[2];
-} IMA_ADPCM_state;
+};
+static struct IMA_ADPCM_decoder IMA_ADPCM_state;
 
-static int InitIMA_ADPCM(WaveFMT *format)
+static int InitIMA_ADPCM(struct IMA_ADPCM_decoder *decoder, WaveFMT *format,
+							int fmtlen)
 {
 	Uint8 *rogue_feel;
 	Uint16 extra_info;
+	int channels;
+
+	if ( fmtlen < (int)(sizeof(*format) + 2*sizeof(Uint16)) ) {
+		SDL_SetError("IMA_ADPCM format chunk is too short");
+		return(-1);
+	}
 
 	/* Set the rogue pointer to the IMA_ADPCM specific data */
-	IMA_ADPCM_state.wavefmt.encoding = SDL_SwapLE16(format->encoding);
-	IMA_ADPCM_state.wavefmt.channels = SDL_SwapLE16(format->channels);
-	IMA_ADPCM_state.wavefmt.frequency = SDL_SwapLE32(format->frequency);
-	IMA_ADPCM_state.wavefmt.byterate = SDL_SwapLE32(format->byterate);
-	IMA_ADPCM_state.wavefmt.blockalign = SDL_SwapLE16(format->blockalign);
-	IMA_ADPCM_state.wavefmt.bitspersample =
+	decoder->wavefmt.encoding = SDL_SwapLE16(format->encoding);
+	decoder->wavefmt.channels = SDL_SwapLE16(format->channels);
+	decoder->wavefmt.frequency = SDL_SwapLE32(format->frequency);
+	decoder->wavefmt.byterate = SDL_SwapLE32(format->byterate);
+	decoder->wavefmt.blockalign = SDL_SwapLE16(format->blockalign);
+	decoder->wavefmt.bitspersample =
 					 SDL_SwapLE16(format->bitspersample);
 	rogue_feel = (Uint8 *)format+sizeof(*format);
 	if ( sizeof(*format) == 16 ) {
 		extra_info = ((rogue_feel[1]<<8)|rogue_feel[0]);
 		rogue_feel += sizeof(Uint16);
 	}
-	IMA_ADPCM_state.wSamplesPerBlock = ((rogue_feel[1]<<8)|rogue_feel[0]);
+	decoder->wSamplesPerBlock = ((rogue_feel[1]<<8)|rogue_feel[0]);
+
+	/* Check to make sure we have enough variables in the state array */
+	channels = decoder->wavefmt.channels;
+	if ( (channels < 1) || (channels > (int)SDL_arraysize(decoder->state)) ) {
+		SDL_SetError("IMA ADPCM decoder can only handle %d channels",
+					SDL_arraysize(decoder->state));
+		return(-1);
+	}
+
+	/* Samples come in groups of 8 per channel after the first one */
+	if ( (decoder->wSamplesPerBlock < 1) ||
+	     (((decoder->wSamplesPerBlock-1) % 8) != 0) ||
+	     ((4*channels + (decoder->wSamplesPerBlock-1)/2*channels) >
+	      decoder->wavefmt.blockalign) ) {
+		SDL_SetError("Invalid IMA_ADPCM block layout");
+		return(-1);
+	}
 	return(0);
 }
 
@@ -297,7 +366,7 @@ static Sint32 IMA_ADPCM_nibble(struct IMA_ADPCM_decodestate *state,Uint8 nybble)
 }
 
 /* Fill the decode buffer with a channel block of data (8 samples) */
-static void Fill_IMA_ADPCM_block(Uint8 *decoded, Uint8 *encoded,
+static void Fill_IMA_ADPCM_block(Uint8 *decoded, const Uint8 *encoded,
 	int channel, int numchannels, struct IMA_ADPCM_decodestate *state)
 {
 	int i;
@@ -324,29 +393,65 @@ static void Fill_IMA_ADPCM_block(Uint8 *decoded, Uint8 *encoded,
 	}
 }
 
-static int IMA_ADPCM_decode(Uint8 **audio_buf, Uint32 *audio_len)
+/* Decode one block of wSamplesPerBlock sample frames */
+static int IMA_ADPCM_decode_block(struct IMA_ADPCM_decoder *decoder,
+				const Uint8 *encoded, Uint8 *decoded)
 {
 	struct IMA_ADPCM_decodestate *state;
-	Uint8 *freeable, *encoded, *decoded;
-	Sint32 encoded_len, samplesleft;
+	Sint32 samplesleft;
 	unsigned int c, channels;
 
-	/* Check to make sure we have enough variables in the state array */
-	channels = IMA_ADPCM_state.wavefmt.channels;
-	if ( channels > SDL_arraysize(IMA_ADPCM_state.state) ) {
-		SDL_SetError("IMA ADPCM decoder can only handle %d channels",
-					SDL_arraysize(IMA_ADPCM_state.state));
-		return(-1);
+	channels = decoder->wavefmt.channels;
+	state = decoder->state;
+
+	/* Grab the initial information for this block */
+	for ( c=0; c<channels; ++c ) {
+		/* Fill the state information for this block */
+		state[c].sample = ((encoded[1]<<8)|encoded[0]);
+		encoded += 2;
+		if ( state[c].sample & 0x8000 ) {
+			state[c].sample -= 0x10000;
+		}
+		state[c].index = (*encoded > 88) ? 88 : *encoded;
+		++encoded;
+		/* Reserved byte in buffer header, should be 0 */
+		if ( *encoded++ != 0 ) {
+			/* Uh oh, corrupt data?  Buggy code? */;
+		}
+
+		/* Store the initial sample we start with */
+		decoded[0] = (Uint8)(state[c].sample&0xFF);
+		decoded[1] = (Uint8)(state[c].sample>>8);
+		decoded += 2;
 	}
-	state = IMA_ADPCM_state.state;
+
+	/* Decode and store the other samples in this block */
+	samplesleft = (decoder->wSamplesPerBlock-1)*channels;
+	while ( samplesleft > 0 ) {
+		for ( c=0; c<channels; ++c ) {
+			Fill_IMA_ADPCM_block(decoded, encoded,
+					c, channels, &state[c]);
+			encoded += 4;
+			samplesleft -= 8;
+		}
+		decoded += (channels * 8 * 2);
+	}
+	return(0);
+}
+
+static int IMA_ADPCM_decode(struct IMA_ADPCM_decoder *decoder,
+				Uint8 **audio_buf, Uint32 *audio_len)
+{
+	Uint8 *freeable, *encoded, *decoded;
+	Sint32 encoded_len, decoded_block;
 
 	/* Allocate the proper sized output buffer */
 	encoded_len = *audio_len;
 	encoded = *audio_buf;
 	freeable = *audio_buf;
-	*audio_len = (encoded_len/IMA_ADPCM_state.wavefmt.blockalign) * 
-				IMA_ADPCM_state.wSamplesPerBlock*
-				IMA_ADPCM_state.wavefmt.channels*sizeof(Sint16);
+	decoded_block = decoder->wSamplesPerBlock*
+				decoder->wavefmt.channels*sizeof(Sint16);
+	*audio_len = (encoded_len/decoder->wavefmt.blockalign) * decoded_block;
 	*audio_buf = (Uint8 *)SDL_malloc(*audio_len);
 	if ( *audio_buf == NULL ) {
 		SDL_Error(SDL_ENOMEM);
@@ -355,42 +460,85 @@ static int IMA_ADPCM_decode(Uint8 **audio_buf, Uint32 *audio_len)
 	decoded = *audio_buf;
 
 	/* Get ready... Go! */
-	while ( encoded_len >= IMA_ADPCM_state.wavefmt.blockalign ) {
-		/* Grab the initial information for this block */
-		for ( c=0; c<channels; ++c ) {
-			/* Fill the state information for this block */
-			state[c].sample = ((encoded[1]<<8)|encoded[0]);
-			encoded += 2;
-			if ( state[c].sample & 0x8000 ) {
-				state[c].sample -= 0x10000;
-			}
-			state[c].index = *encoded++;
-			/* Reserved byte in buffer header, should be 0 */
-			if ( *encoded++ != 0 ) {
-				/* Uh oh, corrupt data?  Buggy code? */;
-			}
+	while ( encoded_len >= decoder->wavefmt.blockalign ) {
+		IMA_ADPCM_decode_block(decoder, encoded, decoded);
+		encoded += decoder->wavefmt.blockalign;
+		encoded_len -= decoder->wavefmt.blockalign;
+		decoded += decoded_block;
+	}
+	SDL_free(freeable);
+	return(0);
+}
 
-			/* Store the initial sample we start with */
-			decoded[0] = (Uint8)(state[c].sample&0xFF);
-			decoded[1] = (Uint8)(state[c].sample>>8);
-			decoded += 2;
-		}
+/* Check the format chunk and set up its decoder.  Returns the encoding,
+   or -1 if we can't read it.
+ */
+static int InitWAVFormat(WaveFMT *format, int fmtlen,
+			struct MS_ADPCM_decoder *ms_decoder,
+			struct IMA_ADPCM_decoder *ima_decoder,
+			SDL_AudioSpec *spec)
+{
+	int encoding;
+	int was_error = 0;
 
-		/* Decode and store the other samples in this block */
-		samplesleft = (IMA_ADPCM_state.wSamplesPerBlock-1)*channels;
-		while ( samplesleft > 0 ) {
-			for ( c=0; c<channels; ++c ) {
-				Fill_IMA_ADPCM_block(decoded, encoded,
-						c, channels, &state[c]);
-				encoded += 4;
-				samplesleft -= 8;
+	if ( fmtlen < (int)sizeof(*format) ) {
+		SDL_SetError("WAVE format chunk is too short");
+		return(-1);
+	}
+	encoding = SDL_SwapLE16(format->encoding);
+	switch (encoding) {
+		case PCM_CODE:
+			/* We can understand this */
+			break;
+		case MS_ADPCM_CODE:
+			/* Try to understand this */
+			if ( InitMS_ADPCM(ms_decoder, format, fmtlen) < 0 ) {
+				return(-1);
 			}
-			decoded += (channels * 8 * 2);
-		}
-		encoded_len -= IMA_ADPCM_state.wavefmt.blockalign;
+			break;
+		case IMA_ADPCM_CODE:
+			/* Try to understand this */
+			if ( InitIMA_ADPCM(ima_decoder, format, fmtlen) < 0 ) {
+				return(-1);
+			}
+			break;
+		case MP3_CODE:
+			SDL_SetError("MPEG Layer 3 data not supported",
+					SDL_SwapLE16(format->encoding));
+			return(-1);
+		default:
+			SDL_SetError("Unknown WAVE data format: 0x%.4x",
+					SDL_SwapLE16(format->encoding));
+			return(-1);
 	}
-	SDL_free(freeable);
-	return(0);
+	SDL_memset(spec, 0, (sizeof *spec));
+	spec->freq = SDL_SwapLE32(format->frequency);
+	switch (SDL_SwapLE16(format->bitspersample)) {
+		case 4:
+			if ( encoding != PCM_CODE ) {
+				spec->format = AUDIO_S16;
+			} else {
+				was_error = 1;
+			}
+			break;
+		case 8:
+			spec->format = AUDIO_U8;
+			break;
+		case 16:
+			spec->format = AUDIO_S16;
+			break;
+		default:
+			was_error = 1;
+			break;
+	}
+	if ( was_error ) {
+		SDL_SetError("Unknown %d-bit PCM data format",
+			SDL_SwapLE16(format->bitspersample));
+		return(-1);
+	}
+	spec->channels = (Uint8)SDL_SwapLE16(format->channels);
+	spec->samples = 4096;		/* Good default buffer size */
+	return(encoding);
 }
 
 SDL_AudioSpec * SDL_LoadWAV_RW (SDL_RWops *src, int freesrc,
@@ -399,7 +547,7 @@ SDL_AudioSpec * SDL_LoadWAV_RW (SDL_RWops *src, int freesrc,
 	int was_error;
 	Chunk chunk;
 	int lenread;
-	int MS_ADPCM_encoded, IMA_ADPCM_encoded;
+	int encoding;
 	int samplesize;
 
 	/* WAV magic header */
@@ -458,65 +606,12 @@ SDL_AudioSpec * SDL_LoadWAV_RW (SDL_RWops *src, int freesrc,
 		was_error = 1;
 		goto done;
 	}
-	MS_ADPCM_encoded = IMA_ADPCM_encoded = 0;
-	switch (SDL_SwapLE16(format->encoding)) {
-		case PCM_CODE:
-			/* We can understand this */
-			break;
-		case MS_ADPCM_CODE:
-			/* Try to understand this */
-			if ( InitMS_ADPCM(format) < 0 ) {
-				was_error = 1;
-				goto done;
-			}
-			MS_ADPCM_encoded = 1;
-			break;
-		case IMA_ADPCM_CODE:
-			/* Try to understand this */
-			if ( InitIMA_ADPCM(format) < 0 ) {
-				was_error = 1;
-				goto done;
-			}
-			IMA_ADPCM_encoded = 1;
-			break;
-		case MP3_CODE:
-			SDL_SetError("MPEG Layer 3 data not supported",
-					SDL_SwapLE16(format->encoding));
-			was_error = 1;
-			goto done;
-		default:
-			SDL_SetError("Unknown WAVE data format: 0x%.4x",
-					SDL_SwapLE16(format->encoding));
-			was_error = 1;
-			goto done;
-	}
-	SDL_memset(spec, 0, (sizeof *spec));
-	spec->freq = SDL_SwapLE32(format->frequency);
-	switch (SDL_SwapLE16(format->bitspersample)) {
-		case 4:
-			if ( MS_ADPCM_encoded || IMA_ADPCM_encoded ) {
-				spec->format = AUDIO_S16;
-			} else {
-				was_error = 1;
-			}
-			break;
-		case 8:
-			spec->format = AUDIO_U8;
-			break;
-		case 16:
-			spec->format = AUDIO_S16;
-			break;
-		default:
-			was_error = 1;
-			break;
-	}
-	if ( was_error ) {
-		SDL_SetError("Unknown %d-bit PCM data format",
-			SDL_SwapLE16(format->bitspersample));
+	encoding = InitWAVFormat(format, lenread, &MS_ADPCM_state,
+					&IMA_ADPCM_state, spec);
+	if ( encoding < 0 ) {
+		was_error = 1;
 		goto done;
 	}
-	spec->channels = (Uint8)SDL_SwapLE16(format->channels);
-	spec->samples = 4096;		/* Good default buffer size */
 
 	/* Read the audio data chunk */
 	*audio_buf = NULL;
@@ -536,14 +631,14 @@ SDL_AudioSpec * SDL_LoadWAV_RW (SDL_RWops *src, int freesrc,
 	} while ( chunk.magic != DATA );
 	headerDiff += 2 * sizeof(Uint32); /* for the data chunk and len */
 
-	if ( MS_ADPCM_encoded ) {
-		if ( MS_ADPCM_decode(audio_buf, audio_len) < 0 ) {
+	if ( encoding == MS_ADPCM_CODE ) {
+		if ( MS_ADPCM_decode(&MS_ADPCM_state, audio_buf, audio_len) < 0 ) {
 			was_error = 1;
 			goto done;
 		}
 	}
-	if ( IMA_ADPCM_encoded ) {
-		if ( IMA_ADPCM_decode(audio_buf, audio_len) < 0 ) {
+	if ( encoding == IMA_ADPCM_CODE ) {
+		if ( IMA_ADPCM_decode(&IMA_ADPCM_state, audio_buf, audio_len) < 0 ) {
 			was_error = 1;
 			goto done;
 		}
@@ -581,6 +676,291 @@ void SDL_FreeWAV(Uint8 *audio_buf)
 	}
 }
 
+/* A WAVE file read a block at a time.  PCM data is read straight into
+   the caller's buffer, ADPCM data is decoded one block at a time into
+   'decoded', which holds 'blockframes' sample frames.
+ */
+struct SDL_WAVStream {
+	SDL_RWops *src;
+	int freesrc;
+	int encoding;
+	struct MS_ADPCM_decoder ms_decoder;
+	struct IMA_ADPCM_decoder ima_decoder;
+
+	/* The data chunk, in whole blocks */
+	long data_start;
+	int blockalign;
+	int blockframes;
+	int framesize;
+	Uint32 frames;
+
+	/* The next frame to read */
+	Uint32 position;
+
+	/* The current block, for ADPCM data */
+	Uint8 *block;
+	Uint8 *decoded;
+	int decoded_pos;
+	int decoded_frames;
+};
+
+SDL_WAVStream * SDL_OpenWAV_RW (SDL_RWops *src, int freesrc,
+						SDL_AudioSpec *spec)
+{
+	SDL_WAVStream *wav;
+	Chunk chunk;
+	int lenread;
+	WaveFMT *format;
+
+	/* WAV magic header */
+	Uint32 RIFFchunk;
+	Uint32 wavelen;
+	Uint32 WAVEmagic;
+
+	/* Make sure we are passed a valid data source */
+	if ( src == NULL ) {
+		return(NULL);
+	}
+	wav = (SDL_WAVStream *)SDL_malloc(sizeof(*wav));
+	if ( wav == NULL ) {
+		SDL_Error(SDL_ENOMEM);
+		if ( freesrc ) {
+			SDL_RWclose(src);
+		}
+		return(NULL);
+	}
+	SDL_memset(wav, 0, sizeof(*wav));
+	wav->src = src;
+	wav->freesrc = freesrc;
+
+	/* Check the magic header */
+	RIFFchunk	= SDL_ReadLE32(src);
+	wavelen		= SDL_ReadLE32(src);
+	if ( wavelen == WAVE ) { /* The RIFFchunk has already been read */
+		WAVEmagic = wavelen;
+		wavelen   = RIFFchunk;
+		RIFFchunk = RIFF;
+	} else {
+		WAVEmagic = SDL_ReadLE32(src);
+	}
+	if ( (RIFFchunk != RIFF) || (WAVEmagic != WAVE) ) {
+		SDL_SetError("Unrecognized file type (not WAVE)");
+		goto error;
+	}
+
+	/* Read the audio data format chunk */
+	chunk.data = NULL;
+	do {
+		if ( chunk.data != NULL ) {
+			SDL_free(chunk.data);
+			chunk.data = NULL;
+		}
+		lenread = ReadChunk(src, &chunk);
+		if ( lenread < 0 ) {
+			goto error;
+		}
+	} while ( (chunk.magic == FACT) || (chunk.magic == LIST) );
+
+	/* Decode the audio data format */
+	format = (WaveFMT *)chunk.data;
+	if ( chunk.magic != FMT ) {
+		SDL_SetError("Complex WAVE files not supported");
+		SDL_free(format);
+		goto error;
+	}
+	wav->encoding = InitWAVFormat(format, lenread, &wav->ms_decoder,
+					&wav->ima_decoder, spec);
+	SDL_free(format);
+	if ( wav->encoding < 0 ) {
+		goto error;
+	}
+
+	/* Find the audio data chunk, skipping anything else */
+	for ( ;; ) {
+		if ( ReadChunkHeader(src, &chunk) < 0 ) {
+			goto error;
+		}
+		if ( chunk.magic == DATA ) {
+			break;
+		}
+		if ( SDL_RWseek(src, chunk.length, RW_SEEK_CUR) < 0 ) {
+			goto error;
+		}
+	}
+	wav->data_start = SDL_RWtell(src);
+	if ( wav->data_start < 0 ) {
+		goto error;
+	}
+
+	wav->framesize = ((spec->format & 0xFF)/8)*spec->channels;
+	if ( wav->encoding == PCM_CODE ) {
+		wav->blockalign = wav->framesize;
+		wav->blockframes = 1;
+	} else {
+		if ( wav->encoding == MS_ADPCM_CODE ) {
+			wav->blockalign = wav->ms_decoder.wavefmt.blockalign;
+			wav->blockframes = wav->ms_decoder.wSamplesPerBlock;
+		} else {
+			wav->blockalign = wav->ima_decoder.wavefmt.blockalign;
+			wav->blockframes = wav->ima_decoder.wSamplesPerBlock;
+		}
+		wav->block = (Uint8 *)SDL_malloc(wav->blockalign);
+		wav->decoded = (Uint8 *)SDL_malloc(wav->blockframes *
+		                                   wav->framesize);
+		if ( (wav->block == NULL) || (wav->decoded == NULL) ) {
+			SDL_Error(SDL_ENOMEM);
+			goto error;
+		}
+	}
+	if ( wav->framesize == 0 ) {
+		SDL_SetError("WAVE file has no channels");
+		goto error;
+	}
+	wav->frames = (chunk.length / wav->blockalign) * wav->blockframes;
+	return(wav);
+
+error:
+	SDL_CloseWAV(wav);
+	return(NULL);
+}
+
+/* Decode the block holding the current position */
+static int SDL_DecodeWAVBlock(SDL_WAVStream *wav)
+{
+	int status;
+
+	if ( SDL_RWread(wav->src, wav->block, wav->blockalign, 1) != 1 ) {
+		SDL_Error(SDL_EFREAD);
+		return(-1);
+	}
+	if ( wav->encoding == MS_ADPCM_CODE ) {
+		status = MS_ADPCM_decode_block(&wav->ms_decoder,
+		                               wav->block, wav->decoded);
+	} else {
+		status = IMA_ADPCM_decode_block(&wav->ima_decoder,
+		                                wav->block, wav->decoded);
+	}
+	if ( status < 0 ) {
+		return(-1);
+	}
+	wav->decoded_frames = wav->blockframes;
+	return(0);
+}
+
+int SDL_ReadWAV (SDL_WAVStream *wav, void *buf, int frames)
+{
+	Uint8 *data = (Uint8 *)buf;
+	int total, len;
+
+	if ( frames < 0 ) {
+		SDL_SetError("Invalid WAVE read length");
+		return(-1);
+	}
+	if ( (Uint32)frames > (wav->frames - wav->position) ) {
+		frames = (int)(wav->frames - wav->position);
+	}
+
+	/* PCM data needs no decoding */
+	if ( wav->encoding == PCM_CODE ) {
+		if ( frames == 0 ) {
+			return(0);
+		}
+		total = SDL_RWread(wav->src, data, wav->framesize, frames);
+		if ( total < 0 ) {
+			return(-1);
+		}
+		wav->position += total;
+		return(total);
+	}
+
+	for ( total = 0; total < frames; total += len ) {
+		if ( wav->decoded_pos == wav->decoded_frames ) {
+			if ( SDL_DecodeWAVBlock(wav) < 0 ) {
+				return(total ? total : -1);
+			}
+			wav->decoded_pos = 0;
+		}
+		len = wav->decoded_frames - wav->decoded_pos;
+		if ( len > (frames - total) ) {
+			len = frames - total;
+		}
+		SDL_memcpy(data, wav->decoded + wav->decoded_pos*wav->framesize,
+		           len*wav->framesize);
+		data += len*wav->framesize;
+		wav->decoded_pos += len;
+		wav->position += len;
+	}
+	return(total);
+}
+
+int SDL_SeekWAV (SDL_WAVStream *wav, Uint32 frame)
+{
+	Uint32 block;
+
+	if ( frame > wav->frames ) {
+		frame = wav->frames;
+	}
+	block = frame / wav->blockframes;
+	if ( SDL_RWseek(wav->src, wav->data_start + block*wav->blockalign,
+	                RW_SEEK_SET) < 0 ) {
+		return(-1);
+	}
+	wav->position = frame;
+	wav->decoded_pos = 0;
+	wav->decoded_frames = 0;
+
+	/* ADPCM blocks start afresh, so only the target block is decoded */
+	if ( (wav->encoding != PCM_CODE) && (frame < wav->frames) ) {
+		if ( SDL_DecodeWAVBlock(wav) < 0 ) {
+			return(-1);
+		}
+		wav->decoded_pos = frame % wav->blockframes;
+	}
+	return(0);
+}
+
+Uint32 SDL_TellWAV (SDL_WAVStream *wav)
+{
+	return(wav->position);
+}
+
+Uint32 SDL_WAVLength (SDL_WAVStream *wav)
+{
+	return(wav->frames);
+}
+
+void SDL_CloseWAV (SDL_WAVStream *wav)
+{
+	if ( wav != NULL ) {
+		if ( wav->freesrc ) {
+			SDL_RWclose(wav->src);
+		}
+		if ( wav->block != NULL ) {
+			SDL_free(wav->block);
+		}
+		if ( wav->decoded != NULL ) {
+			SDL_free(wav->decoded);
+		}
+		SDL_free(wav);
+	}
+}
+
+static int ReadChunkHeader(SDL_RWops *src, Chunk *chunk)
+{
+	Uint8 header[8];
+
+	if ( SDL_RWread(src, header, sizeof(header), 1) != 1 ) {
+		SDL_Error(SDL_EFREAD);
+		return(-1);
+	}
+	chunk->magic = ((Uint32)header[3]<<24)|((Uint32)header[2]<<16)|
+	               ((Uint32)header[1]<<8)|header[0];
+	chunk->length = ((Uint32)header[7]<<24)|((Uint32)header[6]<<16)|
+	                ((Uint32)header[5]<<8)|header[4];
+	chunk->data = NULL;
+	return(0);
+}
+
 static int ReadChunk(SDL_RWops *src, Chunk *chunk)
 {
 	chunk->magic	= SDL_ReadLE32(src);
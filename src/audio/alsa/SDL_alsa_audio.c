@@ -48,6 +48,7 @@ static int ALSA_OpenAudio(_THIS, SDL_AudioSpec *spec);
 static void ALSA_WaitAudio(_THIS);
 static void ALSA_PlayAudio(_THIS);
 static Uint8 *ALSA_GetAudioBuf(_THIS);
+static Uint8 *ALSA_RecordAudio(_THIS);
 static void ALSA_CloseAudio(_THIS);
 
 #ifdef SDL_AUDIO_DRIVER_ALSA_DYNAMIC
@@ -59,6 +60,14 @@ static int alsa_loaded = 0;
 static int (*SDL_NAME(snd_pcm_open))(snd_pcm_t **pcm, const char *name, snd_pcm_stream_t stream, int mode);
 static int (*SDL_NAME(snd_pcm_close))(snd_pcm_t *pcm);
 static snd_pcm_sframes_t (*SDL_NAME(snd_pcm_writei))(snd_pcm_t *pcm, const void *buffer, snd_pcm_uframes_t size);
+static snd_pcm_sframes_t (*SDL_NAME(snd_pcm_mmap_writei))(snd_pcm_t *pcm, const void *buffer, snd_pcm_uframes_t size);
+static snd_pcm_sframes_t (*SDL_NAME(snd_pcm_readi))(snd_pcm_t *pcm, void *buffer, snd_pcm_uframes_t size);
+static snd_pcm_sframes_t (*SDL_NAME(snd_pcm_mmap_readi))(snd_pcm_t *pcm, void *buffer, snd_pcm_uframes_t size);
+static int (*SDL_NAME(snd_pcm_mmap_begin))(snd_pcm_t *pcm, const snd_pcm_channel_area_t **areas, snd_pcm_uframes_t *offset, snd_pcm_uframes_t *frames);
+static snd_pcm_sframes_t (*SDL_NAME(snd_pcm_mmap_commit))(snd_pcm_t *pcm, snd_pcm_uframes_t offset, snd_pcm_uframes_t frames);
+static snd_pcm_sframes_t (*SDL_NAME(snd_pcm_avail_update))(snd_pcm_t *pcm);
+static snd_pcm_state_t (*SDL_NAME(snd_pcm_state))(snd_pcm_t *pcm);
+static int (*SDL_NAME(snd_pcm_start))(snd_pcm_t *pcm);
 static int (*SDL_NAME(snd_pcm_recover))(snd_pcm_t *pcm, int err, int silent);
 static int (*SDL_NAME(snd_pcm_prepare))(snd_pcm_t *pcm);
 static int (*SDL_NAME(snd_pcm_drain))(snd_pcm_t *pcm);
@@ -97,6 +106,14 @@ static struct {
 	{ "snd_pcm_open",	(void**)(char*)&SDL_NAME(snd_pcm_open)		},
 	{ "snd_pcm_close",	(void**)(char*)&SDL_NAME(snd_pcm_close)	},
 	{ "snd_pcm_writei",	(void**)(char*)&SDL_NAME(snd_pcm_writei)	},
+	{ "snd_pcm_mmap_writei",	(void**)(char*)&SDL_NAME(snd_pcm_mmap_writei)	},
+	{ "snd_pcm_readi",	(void**)(char*)&SDL_NAME(snd_pcm_readi)	},
+	{ "snd_pcm_mmap_readi",	(void**)(char*)&SDL_NAME(snd_pcm_mmap_readi)	},
+	{ "snd_pcm_mmap_begin",	(void**)(char*)&SDL_NAME(snd_pcm_mmap_begin)	},
+	{ "snd_pcm_mmap_commit",	(void**)(char*)&SDL_NAME(snd_pcm_mmap_commit)	},
+	{ "snd_pcm_avail_update",	(void**)(char*)&SDL_NAME(snd_pcm_avail_update)	},
+	{ "snd_pcm_state",	(void**)(char*)&SDL_NAME(snd_pcm_state)	},
+	{ "snd_pcm_start",	(void**)(char*)&SDL_NAME(snd_pcm_start)	},
 	{ "snd_pcm_recover",	(void**)(char*)&SDL_NAME(snd_pcm_recover)	},
 	{ "snd_pcm_prepare",	(void**)(char*)&SDL_NAME(snd_pcm_prepare)	},
 	{ "snd_pcm_drain",	(void**)(char*)&SDL_NAME(snd_pcm_drain)	},
@@ -238,6 +255,7 @@ static SDL_AudioDevice *Audio_CreateDevice(int devindex)
 	this->WaitAudio = ALSA_WaitAudio;
 	this->PlayAudio = ALSA_PlayAudio;
 	this->GetAudioBuf = ALSA_GetAudioBuf;
+	this->RecordAudio = ALSA_RecordAudio;
 	this->CloseAudio = ALSA_CloseAudio;
 
 	this->free = Audio_DeleteDevice;
@@ -263,8 +281,8 @@ static void ALSA_WaitAudio(_THIS)
  *  and for Windows DirectX [and CoreAudio], this is FL-FR-C-LFE-RL-RR"
  */
 #define SWIZ6(T) \
-    T *ptr = (T *) mixbuf; \
-    const Uint32 count = (this->spec.samples / 6); \
+    T *ptr = (T *) buf; \
+    const Uint32 count = this->spec.samples; \
     Uint32 i; \
     for (i = 0; i < count; i++, ptr += 6) { \
         T tmp; \
@@ -272,36 +290,74 @@ static void ALSA_WaitAudio(_THIS)
         tmp = ptr[3]; ptr[3] = ptr[5]; ptr[5] = tmp; \
     }
 
-static __inline__ void swizzle_alsa_channels_6_64bit(_THIS) { SWIZ6(Uint64); }
-static __inline__ void swizzle_alsa_channels_6_32bit(_THIS) { SWIZ6(Uint32); }
-static __inline__ void swizzle_alsa_channels_6_16bit(_THIS) { SWIZ6(Uint16); }
-static __inline__ void swizzle_alsa_channels_6_8bit(_THIS) { SWIZ6(Uint8); }
+static __inline__ void swizzle_alsa_channels_6_64bit(_THIS, Uint8 *buf) { SWIZ6(Uint64); }
+static __inline__ void swizzle_alsa_channels_6_32bit(_THIS, Uint8 *buf) { SWIZ6(Uint32); }
+static __inline__ void swizzle_alsa_channels_6_16bit(_THIS, Uint8 *buf) { SWIZ6(Uint16); }
+static __inline__ void swizzle_alsa_channels_6_8bit(_THIS, Uint8 *buf) { SWIZ6(Uint8); }
 
 #undef SWIZ6
 
 
 /*
- * Called right before feeding this->mixbuf to the hardware. Swizzle channels
- *  from Windows/Mac order to the format alsalib will want.
+ * Called right before feeding a period to the hardware, or after reading
+ *  one from it. Swizzle channels from Windows/Mac order to the format
+ *  alsalib will want, or back: the swap is its own inverse.
  */
-static __inline__ void swizzle_alsa_channels(_THIS)
+static __inline__ void swizzle_alsa_channels(_THIS, Uint8 *buf)
 {
     if (this->spec.channels == 6) {
         const Uint16 fmtsize = (this->spec.format & 0xFF); /* bits/channel. */
         if (fmtsize == 16)
-            swizzle_alsa_channels_6_16bit(this);
+            swizzle_alsa_channels_6_16bit(this, buf);
         else if (fmtsize == 8)
-            swizzle_alsa_channels_6_8bit(this);
+            swizzle_alsa_channels_6_8bit(this, buf);
         else if (fmtsize == 32)
-            swizzle_alsa_channels_6_32bit(this);
+            swizzle_alsa_channels_6_32bit(this, buf);
         else if (fmtsize == 64)
-            swizzle_alsa_channels_6_64bit(this);
+            swizzle_alsa_channels_6_64bit(this, buf);
     }
 
     /* !!! FIXME: update this for 7.1 if needed, later. */
 }
 
 
+/* Recover from an error, counting playback underruns; an xrun while
+   recording is an overrun, which isn't one.  Returns -1 if it can't. */
+static int ALSA_Recover(_THIS, int status)
+{
+	if ( (status == -EPIPE) && !this->iscapture ) {
+		++this->underruns;
+	}
+	status = SDL_NAME(snd_pcm_recover)(pcm_handle, status, 0);
+	if ( status < 0 ) {
+		/* Hmm, not much we can do - abort */
+		fprintf(stderr, "ALSA %s failed (unrecoverable): %s\n",
+		        this->iscapture ? "read" : "write",
+		        SDL_NAME(snd_strerror)(status));
+		this->enabled = 0;
+		return(-1);
+	}
+	return(0);
+}
+
+/* Commit the period the callback wrote straight into the mmap buffer */
+static void ALSA_CommitAudio(_THIS)
+{
+	snd_pcm_sframes_t status;
+
+	swizzle_alsa_channels(this, mmap_buf);
+	mmap_buf = NULL;
+	status = SDL_NAME(snd_pcm_mmap_commit)(pcm_handle, mmap_offset, this->spec.samples);
+	if ( status != (snd_pcm_sframes_t)this->spec.samples ) {
+		ALSA_Recover(this, (status < 0) ? (int)status : -EPIPE);
+		return;
+	}
+	/* Unlike the write functions, a commit doesn't start the device */
+	if ( SDL_NAME(snd_pcm_state)(pcm_handle) == SND_PCM_STATE_PREPARED ) {
+		SDL_NAME(snd_pcm_start)(pcm_handle);
+	}
+}
+
 static void ALSA_PlayAudio(_THIS)
 {
 	int status;
@@ -309,7 +365,12 @@ static void ALSA_PlayAudio(_THIS)
 	const Uint8 *sample_buf = (const Uint8 *) mixbuf;
 	const int frame_size = (((int) (this->spec.format & 0xFF)) / 8) * this->spec.channels;
 
-	swizzle_alsa_channels(this);
+	if ( mmap_buf ) {
+		ALSA_CommitAudio(this);
+		return;
+	}
+
+	swizzle_alsa_channels(this, mixbuf);
 
 	frames_left = ((snd_pcm_uframes_t) this->spec.samples);
 
@@ -317,18 +378,18 @@ static void ALSA_PlayAudio(_THIS)
 		/* This works, but needs more testing before going live */
 		/*SDL_NAME(snd_pcm_wait)(pcm_handle, -1);*/
 
-		status = SDL_NAME(snd_pcm_writei)(pcm_handle, sample_buf, frames_left);
+		if ( mmap_access ) {
+			status = SDL_NAME(snd_pcm_mmap_writei)(pcm_handle, sample_buf, frames_left);
+		} else {
+			status = SDL_NAME(snd_pcm_writei)(pcm_handle, sample_buf, frames_left);
+		}
 		if ( status < 0 ) {
 			if ( status == -EAGAIN ) {
 				/* Apparently snd_pcm_recover() doesn't handle this case - does it assume snd_pcm_wait() above? */
 				SDL_Delay(1);
 				continue;
 			}
-			status = SDL_NAME(snd_pcm_recover)(pcm_handle, status, 0);
-			if ( status < 0 ) {
-				/* Hmm, not much we can do - abort */
-				fprintf(stderr, "ALSA write failed (unrecoverable): %s\n", SDL_NAME(snd_strerror)(status));
-				this->enabled = 0;
+			if ( ALSA_Recover(this, status) < 0 ) {
 				return;
 			}
 			continue;
@@ -338,8 +399,147 @@ static void ALSA_PlayAudio(_THIS)
 	}
 }
 
+/* With mmap access, hand out the next period of the device buffer itself
+   when it's contiguous, so the callback writes where the hardware reads */
 static Uint8 *ALSA_GetAudioBuf(_THIS)
 {
+	const snd_pcm_channel_area_t *areas;
+	snd_pcm_uframes_t offset, frames;
+	snd_pcm_sframes_t avail;
+	int status;
+
+	if ( !mmap_access ) {
+		return(mixbuf);
+	}
+	mmap_buf = NULL;
+	for ( ;; ) {
+		avail = SDL_NAME(snd_pcm_avail_update)(pcm_handle);
+		if ( avail < 0 ) {
+			if ( ALSA_Recover(this, (int)avail) < 0 ) {
+				return(mixbuf);
+			}
+			continue;
+		}
+		if ( avail >= (snd_pcm_sframes_t)this->spec.samples ) {
+			break;
+		}
+		status = SDL_NAME(snd_pcm_wait)(pcm_handle, 1000);
+		if ( status < 0 ) {
+			if ( ALSA_Recover(this, status) < 0 ) {
+				return(mixbuf);
+			}
+		} else if ( status == 0 ) {
+			/* The device is stuck, let the write path sort it out */
+			return(mixbuf);
+		}
+	}
+
+	frames = this->spec.samples;
+	status = SDL_NAME(snd_pcm_mmap_begin)(pcm_handle, &areas, &offset, &frames);
+	if ( status < 0 ) {
+		return(mixbuf);
+	}
+	if ( frames < this->spec.samples ) {
+		/* The period wraps around the end of the buffer */
+		SDL_NAME(snd_pcm_mmap_commit)(pcm_handle, offset, 0);
+		return(mixbuf);
+	}
+	mmap_offset = offset;
+	mmap_buf = (Uint8 *)areas[0].addr +
+	           (areas[0].first + offset * areas[0].step) / 8;
+	return(mmap_buf);
+}
+
+/* With mmap access, the recorded period is handed out where the hardware
+   put it when it's contiguous, and released on the next call */
+static Uint8 *ALSA_RecordAudio(_THIS)
+{
+	const snd_pcm_channel_area_t *areas;
+	snd_pcm_uframes_t offset, frames;
+	snd_pcm_uframes_t frames_left;
+	Uint8 *sample_buf;
+	const int frame_size = (((int) (this->spec.format & 0xFF)) / 8) * this->spec.channels;
+	int status;
+
+	if ( mmap_buf ) {
+		mmap_buf = NULL;
+		status = SDL_NAME(snd_pcm_mmap_commit)(pcm_handle, mmap_offset, this->spec.samples);
+		if ( status != (int)this->spec.samples ) {
+			if ( ALSA_Recover(this, (status < 0) ? status : -EPIPE) < 0 ) {
+				return(NULL);
+			}
+		}
+	}
+
+	/* The channels are reordered in our own buffer, not the device's */
+	if ( mmap_access && (this->spec.channels != 6) ) {
+		if ( SDL_NAME(snd_pcm_state)(pcm_handle) == SND_PCM_STATE_PREPARED ) {
+			SDL_NAME(snd_pcm_start)(pcm_handle);
+		}
+		for ( ;; ) {
+			status = (int)SDL_NAME(snd_pcm_avail_update)(pcm_handle);
+			if ( status < 0 ) {
+				if ( ALSA_Recover(this, status) < 0 ) {
+					return(NULL);
+				}
+				SDL_NAME(snd_pcm_start)(pcm_handle);
+				continue;
+			}
+			if ( status >= (int)this->spec.samples ) {
+				break;
+			}
+			status = SDL_NAME(snd_pcm_wait)(pcm_handle, 1000);
+			if ( status < 0 ) {
+				if ( ALSA_Recover(this, status) < 0 ) {
+					return(NULL);
+				}
+				SDL_NAME(snd_pcm_start)(pcm_handle);
+			} else if ( status == 0 ) {
+				return(NULL);
+			}
+		}
+
+		frames = this->spec.samples;
+		status = SDL_NAME(snd_pcm_mmap_begin)(pcm_handle, &areas, &offset, &frames);
+		if ( status < 0 ) {
+			return(NULL);
+		}
+		if ( frames >= this->spec.samples ) {
+			mmap_offset = offset;
+			mmap_buf = (Uint8 *)areas[0].addr +
+			           (areas[0].first + offset * areas[0].step) / 8;
+			return(mmap_buf);
+		}
+		/* The period wraps around the end of the buffer */
+		SDL_NAME(snd_pcm_mmap_commit)(pcm_handle, offset, 0);
+	}
+
+	sample_buf = mixbuf;
+	frames_left = ((snd_pcm_uframes_t) this->spec.samples);
+	while ( frames_left > 0 && this->enabled ) {
+		if ( mmap_access ) {
+			status = SDL_NAME(snd_pcm_mmap_readi)(pcm_handle, sample_buf, frames_left);
+		} else {
+			status = SDL_NAME(snd_pcm_readi)(pcm_handle, sample_buf, frames_left);
+		}
+		if ( status < 0 ) {
+			if ( status == -EAGAIN ) {
+				SDL_Delay(1);
+				continue;
+			}
+			if ( ALSA_Recover(this, status) < 0 ) {
+				return(NULL);
+			}
+			continue;
+		}
+		sample_buf += status * frame_size;
+		frames_left -= status;
+	}
+	if ( frames_left > 0 ) {
+		/* The device was closed before the buffer was full */
+		return(NULL);
+	}
+	swizzle_alsa_channels(this, mixbuf);
 	return(mixbuf);
 }
 
@@ -378,6 +578,7 @@ static int ALSA_finalize_hardware(_THIS, SDL_AudioSpec *spec, snd_pcm_hw_params_
 
 	/* FIXME: Is this safe to do? */
 	spec->samples = bufsize / 2;
+	this->latency_frames = bufsize;
 
 	/* This is useful for debugging */
 	if ( getenv("SDL_AUDIO_ALSA_DEBUG") ) {
@@ -471,7 +672,9 @@ static int ALSA_OpenAudio(_THIS, SDL_AudioSpec *spec)
 
 	/* Open the audio device */
 	/* Name of device should depend on # channels in spec */
-	status = SDL_NAME(snd_pcm_open)(&pcm_handle, get_audio_device(spec->channels), SND_PCM_STREAM_PLAYBACK, SND_PCM_NONBLOCK);
+	status = SDL_NAME(snd_pcm_open)(&pcm_handle, get_audio_device(spec->channels),
+		this->iscapture ? SND_PCM_STREAM_CAPTURE : SND_PCM_STREAM_PLAYBACK,
+		SND_PCM_NONBLOCK);
 
 	if ( status < 0 ) {
 		SDL_SetError("Couldn't open audio device: %s", SDL_NAME(snd_strerror)(status));
@@ -487,8 +690,13 @@ static int ALSA_OpenAudio(_THIS, SDL_AudioSpec *spec)
 		return(-1);
 	}
 
-	/* SDL only uses interleaved sample output */
-	status = SDL_NAME(snd_pcm_hw_params_set_access)(pcm_handle, hwparams, SND_PCM_ACCESS_RW_INTERLEAVED);
+	/* SDL only uses interleaved sample output, through mmap if it can */
+	mmap_access = 1;
+	status = SDL_NAME(snd_pcm_hw_params_set_access)(pcm_handle, hwparams, SND_PCM_ACCESS_MMAP_INTERLEAVED);
+	if ( status < 0 ) {
+		mmap_access = 0;
+		status = SDL_NAME(snd_pcm_hw_params_set_access)(pcm_handle, hwparams, SND_PCM_ACCESS_RW_INTERLEAVED);
+	}
 	if ( status < 0 ) {
 		SDL_SetError("Couldn't set interleaved access: %s", SDL_NAME(snd_strerror)(status));
 		ALSA_CloseAudio(this);
@@ -518,6 +726,18 @@ static int ALSA_OpenAudio(_THIS, SDL_AudioSpec *spec)
 			case AUDIO_U16MSB:
 				format = SND_PCM_FORMAT_U16_BE;
 				break;
+			case AUDIO_S32LSB:
+				format = SND_PCM_FORMAT_S32_LE;
+				break;
+			case AUDIO_S32MSB:
+				format = SND_PCM_FORMAT_S32_BE;
+				break;
+			case AUDIO_F32LSB:
+				format = SND_PCM_FORMAT_FLOAT_LE;
+				break;
+			case AUDIO_F32MSB:
+				format = SND_PCM_FORMAT_FLOAT_BE;
+				break;
 			default:
 				format = 0;
 				break;
@@ -604,7 +824,7 @@ static int ALSA_OpenAudio(_THIS, SDL_AudioSpec *spec)
 	}
 	SDL_memset(mixbuf, spec->silence, spec->size);
 
-	/* Switch to blocking mode for playback */
+	/* Switch to blocking mode for playback and recording */
 	SDL_NAME(snd_pcm_nonblock)(pcm_handle, 0);
 
 	/* We're ready to rock and roll. :-) */
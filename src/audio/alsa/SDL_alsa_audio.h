@@ -38,11 +38,21 @@ struct SDL_PrivateAudioData {
 	/* Raw mixing buffer */
 	Uint8 *mixbuf;
 	int    mixlen;
+
+	/* Set if the device buffer is written through mmap.  When the next
+	   period is contiguous, the callback fills it directly, at
+	   mmap_offset in the ring buffer, and mmap_buf points to it. */
+	int mmap_access;
+	Uint8 *mmap_buf;
+	snd_pcm_uframes_t mmap_offset;
 };
 
 /* Old variable names */
 #define pcm_handle		(this->hidden->pcm_handle)
 #define mixbuf			(this->hidden->mixbuf)
 #define mixlen			(this->hidden->mixlen)
+#define mmap_access		(this->hidden->mmap_access)
+#define mmap_buf		(this->hidden->mmap_buf)
+#define mmap_offset		(this->hidden->mmap_offset)
 
 #endif /* _ALSA_PCM_audio_h */
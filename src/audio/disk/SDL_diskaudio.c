@@ -23,7 +23,7 @@
 */
 #include "SDL_config.h"
 
-/* Output raw audio data to a file. */
+/* Output raw audio data to a file, or record it from one. */
 
 #if HAVE_STDIO_H
 #include <stdio.h>
@@ -43,6 +43,8 @@
 /* environment variables and defaults. */
 #define DISKENVR_OUTFILE         "SDL_DISKAUDIOFILE"
 #define DISKDEFAULT_OUTFILE      "sdlaudio.raw"
+#define DISKENVR_INFILE          "SDL_DISKAUDIOFILE_IN"
+#define DISKDEFAULT_INFILE       "sdlaudio-in.raw"
 #define DISKENVR_WRITEDELAY      "SDL_DISKAUDIODELAY"
 #define DISKDEFAULT_WRITEDELAY   150
 
@@ -51,6 +53,7 @@ static int DISKAUD_OpenAudio(_THIS, SDL_AudioSpec *spec);
 static void DISKAUD_WaitAudio(_THIS);
 static void DISKAUD_PlayAudio(_THIS);
 static Uint8 *DISKAUD_GetAudioBuf(_THIS);
+static Uint8 *DISKAUD_RecordAudio(_THIS);
 static void DISKAUD_CloseAudio(_THIS);
 
 static const char *DISKAUD_GetOutputFilename(void)
@@ -59,6 +62,12 @@ static const char *DISKAUD_GetOutputFilename(void)
 	return((envr != NULL) ? envr : DISKDEFAULT_OUTFILE);
 }
 
+static const char *DISKAUD_GetInputFilename(void)
+{
+	const char *envr = SDL_getenv(DISKENVR_INFILE);
+	return((envr != NULL) ? envr : DISKDEFAULT_INFILE);
+}
+
 /* Audio driver bootstrap functions */
 static int DISKAUD_Available(void)
 {
@@ -104,6 +113,7 @@ static SDL_AudioDevice *DISKAUD_CreateDevice(int devindex)
 	this->WaitAudio = DISKAUD_WaitAudio;
 	this->PlayAudio = DISKAUD_PlayAudio;
 	this->GetAudioBuf = DISKAUD_GetAudioBuf;
+	this->RecordAudio = DISKAUD_RecordAudio;
 	this->CloseAudio = DISKAUD_CloseAudio;
 
 	this->free = DISKAUD_DeleteDevice;
@@ -145,6 +155,26 @@ static Uint8 *DISKAUD_GetAudioBuf(_THIS)
 	return(this->hidden->mixbuf);
 }
 
+/* Read the next buffer from the file, paced like the writer.  Once the
+   file runs out, the rest is silence. */
+static Uint8 *DISKAUD_RecordAudio(_THIS)
+{
+	int got;
+
+	SDL_Delay(this->hidden->write_delay);
+	got = SDL_RWread(this->hidden->output,
+	                 this->hidden->mixbuf, 1,
+	                 this->hidden->mixlen);
+	if ( got < 0 ) {
+		got = 0;
+	}
+	if ( (Uint32)got < this->hidden->mixlen ) {
+		SDL_memset(this->hidden->mixbuf + got, this->spec.silence,
+		           this->hidden->mixlen - got);
+	}
+	return(this->hidden->mixbuf);
+}
+
 static void DISKAUD_CloseAudio(_THIS)
 {
 	if ( this->hidden->mixbuf != NULL ) {
@@ -159,17 +189,24 @@ static void DISKAUD_CloseAudio(_THIS)
 
 static int DISKAUD_OpenAudio(_THIS, SDL_AudioSpec *spec)
 {
-	const char *fname = DISKAUD_GetOutputFilename();
+	const char *fname;
 
 	/* Open the audio device */
-	this->hidden->output = SDL_RWFromFile(fname, "wb");
+	if ( this->iscapture ) {
+		fname = DISKAUD_GetInputFilename();
+		this->hidden->output = SDL_RWFromFile(fname, "rb");
+	} else {
+		fname = DISKAUD_GetOutputFilename();
+		this->hidden->output = SDL_RWFromFile(fname, "wb");
+	}
 	if ( this->hidden->output == NULL ) {
 		return(-1);
 	}
 
 #if HAVE_STDIO_H
 	fprintf(stderr, "WARNING: You are using the SDL disk writer"
-                    " audio driver!\n Writing to file [%s].\n", fname);
+                    " audio driver!\n %s file [%s].\n",
+	        this->iscapture ? "Reading from" : "Writing to", fname);
 #endif
 
 	/* Allocate mixing buffer */
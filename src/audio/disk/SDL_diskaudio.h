@@ -31,7 +31,7 @@
 #define _THIS	SDL_AudioDevice *this
 
 struct SDL_PrivateAudioData {
-	/* The file descriptor for the audio device */
+	/* The file descriptor for the audio device, read when recording */
 	SDL_RWops *output;
 	Uint8 *mixbuf;
 	Uint32 mixlen;
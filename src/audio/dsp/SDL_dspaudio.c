@@ -56,12 +56,14 @@
 
 /* Open the audio device for playback, and don't block if busy */
 #define OPEN_FLAGS	(O_WRONLY|O_NONBLOCK)
+#define OPEN_FLAGS_INPUT	(O_RDONLY|O_NONBLOCK)
 
 /* Audio driver functions */
 static int DSP_OpenAudio(_THIS, SDL_AudioSpec *spec);
 static void DSP_WaitAudio(_THIS);
 static void DSP_PlayAudio(_THIS);
 static Uint8 *DSP_GetAudioBuf(_THIS);
+static Uint8 *DSP_RecordAudio(_THIS);
 static void DSP_CloseAudio(_THIS);
 
 /* Audio driver bootstrap functions */
@@ -112,6 +114,7 @@ static SDL_AudioDevice *Audio_CreateDevice(int devindex)
 	this->WaitAudio = DSP_WaitAudio;
 	this->PlayAudio = DSP_PlayAudio;
 	this->GetAudioBuf = DSP_GetAudioBuf;
+	this->RecordAudio = DSP_RecordAudio;
 	this->CloseAudio = DSP_CloseAudio;
 
 	this->free = Audio_DeleteDevice;
@@ -137,6 +140,14 @@ static void DSP_PlayAudio(_THIS)
 		perror("Audio write");
 		this->enabled = 0;
 	}
+#ifdef SNDCTL_DSP_GETERROR
+	/* OSS 4 counts underruns, and clears the count when it's read */
+	{ audio_errinfo info;
+	  if ( ioctl(audio_fd, SNDCTL_DSP_GETERROR, &info) == 0 ) {
+		this->underruns += info.play_underruns;
+	  }
+	}
+#endif
 
 #ifdef DEBUG_AUDIO
 	fprintf(stderr, "Wrote %d bytes of audio data\n", mixlen);
@@ -148,6 +159,26 @@ static Uint8 *DSP_GetAudioBuf(_THIS)
 	return(mixbuf);
 }
 
+/* Blocking reads, like the writes */
+static Uint8 *DSP_RecordAudio(_THIS)
+{
+	int got, len;
+
+	for ( got = 0; got < mixlen; got += len ) {
+		len = read(audio_fd, mixbuf + got, mixlen - got);
+		if ( len <= 0 ) {
+			if ( (len < 0) && (errno == EINTR) ) {
+				len = 0;
+				continue;
+			}
+			perror("Audio read");
+			this->enabled = 0;
+			return(NULL);
+		}
+	}
+	return(mixbuf);
+}
+
 static void DSP_CloseAudio(_THIS)
 {
 	if ( mixbuf != NULL ) {
@@ -178,14 +209,15 @@ static int DSP_OpenAudio(_THIS, SDL_AudioSpec *spec)
         spec->channels = 2;
 
 	/* Open the audio device */
-	audio_fd = SDL_OpenAudioPath(audiodev, sizeof(audiodev), OPEN_FLAGS, 0);
+	audio_fd = SDL_OpenAudioPath(audiodev, sizeof(audiodev),
+	        this->iscapture ? OPEN_FLAGS_INPUT : OPEN_FLAGS, 0);
 	if ( audio_fd < 0 ) {
 		SDL_SetError("Couldn't open %s: %s", audiodev, strerror(errno));
 		return(-1);
 	}
 	mixbuf = NULL;
 
-	/* Make the file descriptor use blocking writes with fcntl() */
+	/* Make the file descriptor use blocking I/O with fcntl() */
 	{ long flags;
 		flags = fcntl(audio_fd, F_GETFL);
 		flags &= ~O_NONBLOCK;
@@ -227,6 +259,18 @@ static int DSP_OpenAudio(_THIS, SDL_AudioSpec *spec)
 					format = AFMT_S16_BE;
 				}
 				break;
+#ifdef AFMT_S32_LE
+			case AUDIO_S32LSB:
+				if ( value & AFMT_S32_LE ) {
+					format = AFMT_S32_LE;
+				}
+				break;
+			case AUDIO_S32MSB:
+				if ( value & AFMT_S32_BE ) {
+					format = AFMT_S32_BE;
+				}
+				break;
+#endif
 #if 0
 /*
  * These formats are not used by any real life systems so they are not 
@@ -313,6 +357,13 @@ static int DSP_OpenAudio(_THIS, SDL_AudioSpec *spec)
 	if ( ioctl(audio_fd, SNDCTL_DSP_SETFRAGMENT, &frag_spec) < 0 ) {
 		perror("SNDCTL_DSP_SETFRAGMENT");
 	}
+	/* The whole device buffer is queued ahead of the speaker */
+	if ( ! this->iscapture ) { audio_buf_info info;
+	  if ( ioctl(audio_fd, SNDCTL_DSP_GETOSPACE, &info) == 0 ) {
+		this->latency_frames = (info.fragstotal * info.fragsize) /
+			(((spec->format & 0xFF) / 8) * spec->channels);
+	  }
+	}
 #ifdef DEBUG_AUDIO
 	{ audio_buf_info info;
 	  ioctl(audio_fd, SNDCTL_DSP_GETOSPACE, &info);
@@ -54,6 +54,7 @@ static int PULSE_OpenAudio(_THIS, SDL_AudioSpec *spec);
 static void PULSE_WaitAudio(_THIS);
 static void PULSE_PlayAudio(_THIS);
 static Uint8 *PULSE_GetAudioBuf(_THIS);
+static Uint8 *PULSE_RecordAudio(_THIS);
 static void PULSE_CloseAudio(_THIS);
 static void PULSE_WaitDone(_THIS);
 
@@ -113,6 +114,15 @@ pa_operation * (*SDL_NAME(pa_stream_drain))(pa_stream *s,
 	pa_stream_success_cb_t cb, void *userdata);
 int (*SDL_NAME(pa_stream_disconnect))(pa_stream *s);
 void (*SDL_NAME(pa_stream_unref))(pa_stream *s);
+void (*SDL_NAME(pa_stream_set_underflow_callback))(pa_stream *s,
+	pa_stream_notify_cb_t cb, void *userdata);
+const pa_buffer_attr * (*SDL_NAME(pa_stream_get_buffer_attr))(pa_stream *s);
+int (*SDL_NAME(pa_stream_connect_record))(pa_stream *s, const char *dev,
+	const pa_buffer_attr *attr, pa_stream_flags_t flags);
+size_t (*SDL_NAME(pa_stream_readable_size))(pa_stream *s);
+int (*SDL_NAME(pa_stream_peek))(pa_stream *s, const void **data,
+	size_t *nbytes);
+int (*SDL_NAME(pa_stream_drop))(pa_stream *s);
 
 static struct {
 	const char *name;
@@ -164,6 +174,18 @@ static struct {
 		(void **)&SDL_NAME(pa_stream_disconnect)	},
 	{ "pa_stream_unref",
 		(void **)&SDL_NAME(pa_stream_unref)		},
+	{ "pa_stream_set_underflow_callback",
+		(void **)&SDL_NAME(pa_stream_set_underflow_callback)	},
+	{ "pa_stream_get_buffer_attr",
+		(void **)&SDL_NAME(pa_stream_get_buffer_attr)	},
+	{ "pa_stream_connect_record",
+		(void **)&SDL_NAME(pa_stream_connect_record)	},
+	{ "pa_stream_readable_size",
+		(void **)&SDL_NAME(pa_stream_readable_size)	},
+	{ "pa_stream_peek",
+		(void **)&SDL_NAME(pa_stream_peek)		},
+	{ "pa_stream_drop",
+		(void **)&SDL_NAME(pa_stream_drop)		},
 };
 
 static void UnloadPulseLibrary()
@@ -279,6 +301,7 @@ static SDL_AudioDevice *Audio_CreateDevice(int devindex)
 	this->WaitAudio = PULSE_WaitAudio;
 	this->PlayAudio = PULSE_PlayAudio;
 	this->GetAudioBuf = PULSE_GetAudioBuf;
+	this->RecordAudio = PULSE_RecordAudio;
 	this->CloseAudio = PULSE_CloseAudio;
 	this->WaitDone = PULSE_WaitDone;
 
@@ -321,6 +344,63 @@ static Uint8 *PULSE_GetAudioBuf(_THIS)
 	return(mixbuf);
 }
 
+/* Recorded data is copied out of the server's fragments into mixbuf.
+   The fragments may be in the server's read-only shared memory, and the
+   callback is free to work on its buffer in place. */
+static Uint8 *PULSE_RecordAudio(_THIS)
+{
+	const void *data;
+	size_t nbytes;
+	int got = 0;
+	int len;
+
+	while ( this->enabled ) {
+		if ( capture_len == 0 ) {
+			/* Done with the last fragment, wait for the next */
+			if ( capture_held ) {
+				SDL_NAME(pa_stream_drop)(stream);
+				capture_held = 0;
+			}
+			while ( SDL_NAME(pa_stream_readable_size)(stream) == 0 ) {
+				if (SDL_NAME(pa_context_get_state)(context) != PA_CONTEXT_READY ||
+				    SDL_NAME(pa_stream_get_state)(stream) != PA_STREAM_READY ||
+				    SDL_NAME(pa_mainloop_iterate)(mainloop, 1, NULL) < 0) {
+					this->enabled = 0;
+					return(NULL);
+				}
+			}
+			if ( SDL_NAME(pa_stream_peek)(stream, &data, &nbytes) < 0 ) {
+				this->enabled = 0;
+				return(NULL);
+			}
+			if ( nbytes == 0 ) {
+				continue;
+			}
+			capture_held = 1;
+			if ( data == NULL ) {
+				/* A hole in the stream, nothing was recorded */
+				SDL_NAME(pa_stream_drop)(stream);
+				capture_held = 0;
+				continue;
+			}
+			capture_buf = (const Uint8 *)data;
+			capture_len = nbytes;
+		}
+		len = mixlen - got;
+		if ( (size_t)len > capture_len ) {
+			len = (int)capture_len;
+		}
+		SDL_memcpy(mixbuf + got, capture_buf, len);
+		capture_buf += len;
+		capture_len -= len;
+		got += len;
+		if ( got == mixlen ) {
+			return(mixbuf);
+		}
+	}
+	return(NULL);
+}
+
 static void PULSE_CloseAudio(_THIS)
 {
 	if ( mixbuf != NULL ) {
@@ -394,6 +474,13 @@ static void PULSE_WaitDone(_THIS)
 	SDL_NAME(pa_operation_unref)(o);
 }
 
+static void stream_underflow(pa_stream *s, void *userdata)
+{
+	SDL_AudioDevice *this = (SDL_AudioDevice *)userdata;
+
+	++this->underruns;
+}
+
 static int PULSE_OpenAudio(_THIS, SDL_AudioSpec *spec)
 {
 	int             state;
@@ -415,9 +502,24 @@ static int PULSE_OpenAudio(_THIS, SDL_AudioSpec *spec)
 			case AUDIO_S16MSB:
 				paspec.format = PA_SAMPLE_S16BE;
 				break;
+#ifdef PA_SAMPLE_S32LE
+			case AUDIO_S32LSB:
+				paspec.format = PA_SAMPLE_S32LE;
+				break;
+			case AUDIO_S32MSB:
+				paspec.format = PA_SAMPLE_S32BE;
+				break;
+#endif
+			case AUDIO_F32LSB:
+				paspec.format = PA_SAMPLE_FLOAT32LE;
+				break;
+			case AUDIO_F32MSB:
+				paspec.format = PA_SAMPLE_FLOAT32BE;
+				break;
 		}
 		if ( paspec.format != PA_SAMPLE_INVALID )
 			break;
+		test_format = SDL_NextAudioFormat();
 	}
 	if (paspec.format == PA_SAMPLE_INVALID ) {
 		SDL_SetError("Couldn't find any suitable audio formats");
@@ -430,7 +532,9 @@ static int PULSE_OpenAudio(_THIS, SDL_AudioSpec *spec)
 
 	/* Calculate the final parameters for this audio specification */
 #ifdef PA_STREAM_ADJUST_LATENCY
-	spec->samples /= 2; /* Mix in smaller chunck to avoid underruns */
+	if ( ! this->iscapture ) {
+		spec->samples /= 2; /* Mix in smaller chunck to avoid underruns */
+	}
 #endif
 	SDL_CalculateAudioSpec(spec);
 
@@ -450,12 +554,22 @@ static int PULSE_OpenAudio(_THIS, SDL_AudioSpec *spec)
 	paattr.minreq = mixlen; /* -1 can lead to pa_stream_writable_size()
 				   >= mixlen never becoming true */
 	flags = PA_STREAM_ADJUST_LATENCY;
+	if ( this->latency_ms > 0 ) {
+		/* Ask the server for the requested latency, not the default */
+		Uint32 tlength = (Uint32)(spec->freq / 1000) * this->latency_ms *
+		                 (mixlen / spec->samples);
+		if ( tlength < (Uint32)mixlen*2 ) {
+			tlength = mixlen*2;
+		}
+		paattr.tlength = tlength;
+	}
 #else
 	paattr.tlength = mixlen*2;
 	paattr.prebuf = mixlen*2;
 	paattr.maxlength = mixlen*2;
 	paattr.minreq = mixlen;
 #endif
+	paattr.fragsize = mixlen; /* recorded data comes a buffer at a time */
 
 	/* The SDL ALSA output hints us that we use Windows' channel mapping */
 	/* http://bugzilla.libsdl.org/show_bug.cgi?id=110 */
@@ -509,8 +623,14 @@ static int PULSE_OpenAudio(_THIS, SDL_AudioSpec *spec)
 		return(-1);
 	}
 
-	if (SDL_NAME(pa_stream_connect_playback)(stream, NULL, &paattr, flags,
-			NULL, NULL) < 0) {
+	if ( this->iscapture ) {
+		state = SDL_NAME(pa_stream_connect_record)(stream, NULL,
+			&paattr, flags);
+	} else {
+		state = SDL_NAME(pa_stream_connect_playback)(stream, NULL,
+			&paattr, flags, NULL, NULL);
+	}
+	if ( state < 0 ) {
 		PULSE_CloseAudio(this);
 		SDL_SetError("Could not connect PulseAudio stream");
 		return(-1);
@@ -530,5 +650,19 @@ static int PULSE_OpenAudio(_THIS, SDL_AudioSpec *spec)
 		}
 	} while (state != PA_STREAM_READY);
 
+	/* The server may not have given us the buffer we asked for */
+	{
+		const pa_buffer_attr *attr;
+
+		attr = SDL_NAME(pa_stream_get_buffer_attr)(stream);
+		if ( attr ) {
+			this->latency_frames = attr->tlength / (mixlen / spec->samples);
+		}
+	}
+	if ( ! this->iscapture ) {
+		SDL_NAME(pa_stream_set_underflow_callback)(stream,
+			stream_underflow, this);
+	}
+
 	return(0);
 }
@@ -40,6 +40,12 @@ struct SDL_PrivateAudioData {
 	/* Raw mixing buffer */
 	Uint8 *mixbuf;
 	int    mixlen;
+
+	/* The recorded fragment being read, which is dropped from the
+	   stream once it has all been handed out */
+	const Uint8 *capture_buf;
+	size_t capture_len;
+	int capture_held;
 };
 
 #if (PA_API_VERSION < 12)
@@ -66,6 +72,9 @@ static inline int PA_STREAM_IS_GOOD(pa_stream_state_t x) {
 #define stream			(this->hidden->stream)
 #define mixbuf			(this->hidden->mixbuf)
 #define mixlen			(this->hidden->mixlen)
+#define capture_buf		(this->hidden->capture_buf)
+#define capture_len		(this->hidden->capture_len)
+#define capture_held		(this->hidden->capture_held)
 
 #endif /* _SDL_pulseaudio_h */
 
@@ -32,6 +32,10 @@
 #include <signal.h>
 #include <setjmp.h>
 #endif
+#if defined(__linux__) && defined(__arm__) && !defined(__ARM_NEON__)
+#include <fcntl.h>	/* For NEON check */
+#include <unistd.h>
+#endif
 
 #define CPU_HAS_RDTSC	0x00000001
 #define CPU_HAS_MMX	0x00000002
@@ -41,6 +45,7 @@
 #define CPU_HAS_SSE	0x00000040
 #define CPU_HAS_SSE2	0x00000080
 #define CPU_HAS_ALTIVEC	0x00000100
+#define CPU_HAS_NEON	0x00000200
 
 #if SDL_ALTIVEC_BLITTERS && HAVE_SETJMP && !__MACOSX__
 /* This is the brute force way of detecting instruction sets...
@@ -361,6 +366,28 @@ static __inline__ int CPU_haveAltiVec(void)
 	return altivec; 
 }
 
+static __inline__ int CPU_haveNEON(void)
+{
+	int neon = 0;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)
+	neon = 1;
+#elif defined(__linux__) && defined(__arm__)
+	/* Look for HWCAP_NEON in the auxiliary vector */
+	Uint32 auxv[2];
+	int fd = open("/proc/self/auxv", O_RDONLY);
+	if ( fd >= 0 ) {
+		while ( read(fd, auxv, sizeof(auxv)) == sizeof(auxv) ) {
+			if ( auxv[0] == 16 /* AT_HWCAP */ ) {
+				neon = ((auxv[1] & (1 << 12)) != 0);
+				break;
+			}
+		}
+		close(fd);
+	}
+#endif
+	return neon;
+}
+
 static Uint32 SDL_CPUFeatures = 0xFFFFFFFF;
 
 static Uint32 SDL_GetCPUFeatures(void)
@@ -391,6 +418,9 @@ static Uint32 SDL_GetCPUFeatures(void)
 		if ( CPU_haveAltiVec() ) {
 			SDL_CPUFeatures |= CPU_HAS_ALTIVEC;
 		}
+		if ( CPU_haveNEON() ) {
+			SDL_CPUFeatures |= CPU_HAS_NEON;
+		}
 	}
 	return SDL_CPUFeatures;
 }
@@ -459,6 +489,14 @@ SDL_bool SDL_HasAltiVec(void)
 	return SDL_FALSE;
 }
 
+SDL_bool SDL_HasNEON(void)
+{
+	if ( SDL_GetCPUFeatures() & CPU_HAS_NEON ) {
+		return SDL_TRUE;
+	}
+	return SDL_FALSE;
+}
+
 #ifdef TEST_MAIN
 
 #include <stdio.h>
@@ -473,6 +511,7 @@ int main()
 	printf("SSE: %d\n", SDL_HasSSE());
 	printf("SSE2: %d\n", SDL_HasSSE2());
 	printf("AltiVec: %d\n", SDL_HasAltiVec());
+	printf("NEON: %d\n", SDL_HasNEON());
 	return 0;
 }
 
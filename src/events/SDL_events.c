@@ -32,21 +32,56 @@
 #include "../joystick/SDL_joystick_c.h"
 #endif
 
+#ifdef HAVE_SELECT
+#include <sys/types.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#endif
+
 /* Public data -- the event filter */
 SDL_EventFilter SDL_EventOK = NULL;
 Uint8 SDL_ProcessEvents[SDL_NUMEVENTS];
 static Uint32 SDL_eventstate = 0;
 
-/* Private data -- event queue */
+/* Private data -- event queue
+
+   Queued events live in a pool of nodes and are chained into one list
+   per event type, so taking the first event matching a mask only looks
+   at the head of each matching list.  A sequence number stamped on each
+   event keeps the overall order.  The capacity can be changed with the
+   SDL_EVENT_QUEUE_SIZE environment variable.
+
+   Threads blocked in SDL_WaitEvent() sleep on the 'wait' condition, or,
+   when they also have to watch the video driver's input, in select() on
+   the driver's descriptors and the read end of 'wakefd'.  Adding an event
+   signals the condition and writes a byte to 'wakefd' if anyone sleeps.
+*/
 #define MAXEVENTS	128
+#define MAXWAITFDS	8
+typedef struct SDL_EventNode {
+	SDL_Event event;
+	Uint32 seq;
+	int next;
+} SDL_EventNode;
+
 static struct {
 	SDL_mutex *lock;
 	int active;
-	int head;
-	int tail;
-	SDL_Event event[MAXEVENTS];
-	int wmmsg_next;
-	struct SDL_SysWMmsg wmmsg[MAXEVENTS];
+	volatile int count;		/* may be read without the lock */
+	int size;
+	SDL_EventNode *node;
+	struct SDL_SysWMmsg *wmmsg;	/* one per node */
+	int free;			/* list of unused nodes */
+	Uint32 seq;			/* stamp of the next event */
+	Uint32 used;			/* mask of types with queued events */
+	int head[SDL_NUMEVENTS];
+	int tail[SDL_NUMEVENTS];
+	SDL_cond *wait;			/* signalled when events are added */
+	int sleepers;			/* threads waiting for events */
+	int wakefd[2];			/* pipe waking select() sleepers */
+	int woken;			/* a byte is pending in the pipe */
 } SDL_EventQ;
 
 /* Private data -- event locking structure */
@@ -73,6 +108,10 @@ void SDL_Unlock_EventThread(void)
 {
 	if ( SDL_EventThread && (SDL_ThreadID() != event_thread) ) {
 		SDL_mutexV(SDL_EventLock.lock);
+		/* Calls made under the lock may have read input into the video
+		   driver's own queue, where the event thread's select() won't
+		   see it, so have the thread look again */
+		SDL_WakeEventThread();
 	}
 }
 
@@ -87,6 +126,8 @@ void SDL_Unlock_EventThread(void)
 #include <time.h>
 #endif
 
+static void SDL_IdleEventThread(void);
+
 static int SDLCALL SDL_GobbleEvents(void *unused)
 {
 	event_thread = SDL_ThreadID();
@@ -117,12 +158,12 @@ static int SDLCALL SDL_GobbleEvents(void *unused)
 		}
 #endif
 
-		/* Give up the CPU for the rest of our timeslice */
+		/* Give up the CPU until there is something to do */
 		SDL_EventLock.safe = 1;
 		if ( SDL_timer_running ) {
 			SDL_ThreadedTimerCheck();
 		}
-		SDL_Delay(1);
+		SDL_IdleEventThread();
 
 		/* Check for event locking.
 		   On the P of the lock mutex, if the lock is held, this thread
@@ -157,9 +198,21 @@ static int SDL_StartEventThread(Uint32 flags)
 		return(-1);
 #endif
 	}
+	SDL_EventQ.wait = SDL_CreateCond();
 #endif /* !SDL_THREADS_DISABLED */
 	SDL_EventQ.active = 1;
 
+#ifdef HAVE_SELECT
+	/* Whoever pumps the video driver sleeps on this and its descriptors */
+	if ( pipe(SDL_EventQ.wakefd) == 0 ) {
+		fcntl(SDL_EventQ.wakefd[0], F_SETFL, O_NONBLOCK);
+		fcntl(SDL_EventQ.wakefd[1], F_SETFL, O_NONBLOCK);
+	} else {
+		SDL_EventQ.wakefd[0] = -1;
+		SDL_EventQ.wakefd[1] = -1;
+	}
+#endif
+
 	if ( (flags&SDL_INIT_EVENTTHREAD) == SDL_INIT_EVENTTHREAD ) {
 		SDL_EventLock.lock = SDL_CreateMutex();
 		if ( SDL_EventLock.lock == NULL ) {
@@ -188,11 +241,24 @@ static void SDL_StopEventThread(void)
 {
 	SDL_EventQ.active = 0;
 	if ( SDL_EventThread ) {
+		SDL_WakeEventThread();
 		SDL_WaitThread(SDL_EventThread, NULL);
 		SDL_EventThread = NULL;
 		SDL_DestroyMutex(SDL_EventLock.lock);
 		SDL_EventLock.lock = NULL;
 	}
+#ifdef HAVE_SELECT
+	if ( SDL_EventQ.wakefd[0] >= 0 ) {
+		close(SDL_EventQ.wakefd[0]);
+		close(SDL_EventQ.wakefd[1]);
+		SDL_EventQ.wakefd[0] = -1;
+		SDL_EventQ.wakefd[1] = -1;
+	}
+#endif
+	if ( SDL_EventQ.wait ) {
+		SDL_DestroyCond(SDL_EventQ.wait);
+		SDL_EventQ.wait = NULL;
+	}
 #ifndef IPOD
 	SDL_DestroyMutex(SDL_EventQ.lock);
 	SDL_EventQ.lock = NULL;
@@ -204,6 +270,79 @@ Uint32 SDL_EventThreadID(void)
 	return(event_thread);
 }
 
+void SDL_WakeEventThread(void)
+{
+#ifdef HAVE_SELECT
+	if ( SDL_EventThread && (SDL_ThreadID() != event_thread) &&
+	     (SDL_EventQ.wakefd[1] >= 0) ) {
+		char c = 0;
+		/* If the pipe is full, the thread has a wakeup pending anyway */
+		if ( write(SDL_EventQ.wakefd[1], &c, 1) < 0 ) {
+			return;
+		}
+	}
+#endif
+}
+
+/* Put every node back on the free list */
+static void SDL_ClearEventQ(void)
+{
+	int i;
+
+	SDL_EventQ.count = 0;
+	SDL_EventQ.used = 0;
+	for ( i=0; i<SDL_NUMEVENTS; ++i ) {
+		SDL_EventQ.head[i] = -1;
+		SDL_EventQ.tail[i] = -1;
+	}
+	for ( i=0; i<SDL_EventQ.size; ++i ) {
+		SDL_EventQ.node[i].next = i+1;
+	}
+	if ( SDL_EventQ.size > 0 ) {
+		SDL_EventQ.node[SDL_EventQ.size-1].next = -1;
+		SDL_EventQ.free = 0;
+	} else {
+		SDL_EventQ.free = -1;
+	}
+}
+
+static int SDL_AllocEventQ(void)
+{
+	const char *envr;
+	int size;
+
+	size = MAXEVENTS;
+	envr = SDL_getenv("SDL_EVENT_QUEUE_SIZE");
+	if ( envr && (SDL_atoi(envr) > 0) ) {
+		size = SDL_atoi(envr);
+	}
+	SDL_EventQ.node = (SDL_EventNode *)
+			SDL_malloc(size*sizeof(*SDL_EventQ.node));
+	SDL_EventQ.wmmsg = (struct SDL_SysWMmsg *)
+			SDL_malloc(size*sizeof(*SDL_EventQ.wmmsg));
+	if ( !SDL_EventQ.node || !SDL_EventQ.wmmsg ) {
+		SDL_OutOfMemory();
+		return(-1);
+	}
+	SDL_EventQ.size = size;
+	SDL_ClearEventQ();
+	return(0);
+}
+
+static void SDL_FreeEventQ(void)
+{
+	if ( SDL_EventQ.node ) {
+		SDL_free(SDL_EventQ.node);
+		SDL_EventQ.node = NULL;
+	}
+	if ( SDL_EventQ.wmmsg ) {
+		SDL_free(SDL_EventQ.wmmsg);
+		SDL_EventQ.wmmsg = NULL;
+	}
+	SDL_EventQ.size = 0;
+	SDL_ClearEventQ();
+}
+
 /* Public functions */
 
 void SDL_StopEventLoop(void)
@@ -218,9 +357,7 @@ void SDL_StopEventLoop(void)
 	SDL_QuitQuit();
 
 	/* Clean out EventQ */
-	SDL_EventQ.head = 0;
-	SDL_EventQ.tail = 0;
-	SDL_EventQ.wmmsg_next = 0;
+	SDL_FreeEventQ();
 }
 
 /* This function (and associated calls) may be called more than once */
@@ -231,6 +368,9 @@ int SDL_StartEventLoop(Uint32 flags)
 	/* Clean out the event queue */
 	SDL_EventThread = NULL;
 	SDL_EventQ.lock = NULL;
+	SDL_EventQ.wait = NULL;
+	SDL_EventQ.wakefd[0] = -1;
+	SDL_EventQ.wakefd[1] = -1;
 	SDL_StopEventLoop();
 
 	/* No filter to start with, process most event types */
@@ -252,7 +392,11 @@ int SDL_StartEventLoop(Uint32 flags)
 		return(-1);
 	}
 
-	/* Create the lock and event thread */
+	/* Create the queue, the lock and event thread */
+	if ( SDL_AllocEventQ() < 0 ) {
+		SDL_StopEventLoop();
+		return(-1);
+	}
 	if ( SDL_StartEventThread(flags) < 0 ) {
 		SDL_StopEventLoop();
 		return(-1);
@@ -261,58 +405,98 @@ int SDL_StartEventLoop(Uint32 flags)
 }
 
 
+#define SDL_EventBucket(type)	((type) % SDL_NUMEVENTS)
+
 /* Add an event to the event queue -- called with the queue locked */
 static int SDL_AddEvent(SDL_Event *event)
 {
-	int tail, added;
+	SDL_EventNode *node;
+	int spot, type;
 
-	tail = (SDL_EventQ.tail+1)%MAXEVENTS;
-	if ( tail == SDL_EventQ.head ) {
+	spot = SDL_EventQ.free;
+	if ( spot < 0 ) {
 		/* Overflow, drop event */
-		added = 0;
+		return(0);
+	}
+	node = &SDL_EventQ.node[spot];
+	SDL_EventQ.free = node->next;
+
+	node->event = *event;
+	if ( event->type == SDL_SYSWMEVENT ) {
+		SDL_EventQ.wmmsg[spot] = *event->syswm.msg;
+		node->event.syswm.msg = &SDL_EventQ.wmmsg[spot];
+	}
+	node->seq = SDL_EventQ.seq++;
+	node->next = -1;
+
+	type = SDL_EventBucket(event->type);
+	if ( SDL_EventQ.tail[type] < 0 ) {
+		SDL_EventQ.head[type] = spot;
+		SDL_EventQ.used |= SDL_EVENTMASK(type);
 	} else {
-		SDL_EventQ.event[SDL_EventQ.tail] = *event;
-		if (event->type == SDL_SYSWMEVENT) {
-			/* Note that it's possible to lose an event */
-			int next = SDL_EventQ.wmmsg_next;
-			SDL_EventQ.wmmsg[next] = *event->syswm.msg;
-		        SDL_EventQ.event[SDL_EventQ.tail].syswm.msg =
-						&SDL_EventQ.wmmsg[next];
-			SDL_EventQ.wmmsg_next = (next+1)%MAXEVENTS;
+		SDL_EventQ.node[SDL_EventQ.tail[type]].next = spot;
+	}
+	SDL_EventQ.tail[type] = spot;
+	++SDL_EventQ.count;
+
+	/* Wake up anybody waiting for it */
+	if ( SDL_EventQ.sleepers ) {
+		if ( SDL_EventQ.wait ) {
+			SDL_CondBroadcast(SDL_EventQ.wait);
 		}
-		SDL_EventQ.tail = tail;
-		added = 1;
+#ifdef HAVE_SELECT
+		if ( !SDL_EventThread && !SDL_EventQ.woken &&
+		     (SDL_EventQ.wakefd[1] >= 0) ) {
+			char c = 0;
+			if ( write(SDL_EventQ.wakefd[1], &c, 1) == 1 ) {
+				SDL_EventQ.woken = 1;
+			}
+		}
+#endif
 	}
-	return(added);
+	return(1);
 }
 
-/* Cut an event, and return the next valid spot, or the tail */
-/*                           -- called with the queue locked */
-static int SDL_CutEvent(int spot)
+/* Find the oldest event of the types in 'mask', starting each type's
+   search at cursor[type], or return -1 -- called with the queue locked */
+static int SDL_FindEvent(Uint32 mask, const int *cursor, int *found_type)
 {
-	if ( spot == SDL_EventQ.head ) {
-		SDL_EventQ.head = (SDL_EventQ.head+1)%MAXEVENTS;
-		return(SDL_EventQ.head);
-	} else
-	if ( (spot+1)%MAXEVENTS == SDL_EventQ.tail ) {
-		SDL_EventQ.tail = spot;
-		return(SDL_EventQ.tail);
-	} else
-	/* We cut the middle -- shift everything over */
-	{
-		int here, next;
-
-		/* This can probably be optimized with SDL_memcpy() -- careful! */
-		if ( --SDL_EventQ.tail < 0 ) {
-			SDL_EventQ.tail = MAXEVENTS-1;
+	Uint32 types;
+	int type, spot, best;
+
+	best = -1;
+	types = mask & SDL_EventQ.used;
+	for ( type=0; types; ++type, types >>= 1 ) {
+		if ( !(types & 1) ) {
+			continue;
 		}
-		for ( here=spot; here != SDL_EventQ.tail; here = next ) {
-			next = (here+1)%MAXEVENTS;
-			SDL_EventQ.event[here] = SDL_EventQ.event[next];
+		spot = cursor[type];
+		if ( spot < 0 ) {
+			continue;
 		}
-		return(spot);
+		if ( (best < 0) || ((Sint32)(SDL_EventQ.node[spot].seq -
+		                    SDL_EventQ.node[best].seq) < 0) ) {
+			best = spot;
+			*found_type = type;
+		}
+	}
+	return(best);
+}
+
+/* Remove the first event of a type's list -- called with the queue locked */
+static void SDL_CutEvent(int type)
+{
+	int spot = SDL_EventQ.head[type];
+	SDL_EventNode *node = &SDL_EventQ.node[spot];
+
+	SDL_EventQ.head[type] = node->next;
+	if ( node->next < 0 ) {
+		SDL_EventQ.tail[type] = -1;
+		SDL_EventQ.used &= ~SDL_EVENTMASK(type);
 	}
-	/* NOTREACHED */
+	node->next = SDL_EventQ.free;
+	SDL_EventQ.free = spot;
+	--SDL_EventQ.count;
 }
 
 /* Lock the event queue, take a peep at it, and unlock it */
@@ -325,6 +509,10 @@ int SDL_PeepEvents(SDL_Event *events, int numevents, SDL_eventaction action,
 	if ( ! SDL_EventQ.active ) {
 		return(-1);
 	}
+	/* Nothing to look at -- no need to take the lock */
+	if ( (action != SDL_ADDEVENT) && (SDL_EventQ.count == 0) ) {
+		return(0);
+	}
 	/* Lock the event queue */
 	used = 0;
 	if ( SDL_mutexP(SDL_EventQ.lock) == 0 ) {
@@ -334,7 +522,8 @@ int SDL_PeepEvents(SDL_Event *events, int numevents, SDL_eventaction action,
 			}
 		} else {
 			SDL_Event tmpevent;
-			int spot;
+			int cursor[SDL_NUMEVENTS];
+			int spot, type;
 
 			/* If 'events' is NULL, just see if they exist */
 			if ( events == NULL ) {
@@ -342,17 +531,19 @@ int SDL_PeepEvents(SDL_Event *events, int numevents, SDL_eventaction action,
 				numevents = 1;
 				events = &tmpevent;
 			}
-			spot = SDL_EventQ.head;
-			while ((used < numevents)&&(spot != SDL_EventQ.tail)) {
-				if ( mask & SDL_EVENTMASK(SDL_EventQ.event[spot].type) ) {
-					events[used++] = SDL_EventQ.event[spot];
-					if ( action == SDL_GETEVENT ) {
-						spot = SDL_CutEvent(spot);
-					} else {
-						spot = (spot+1)%MAXEVENTS;
-					}
+			/* Peeking walks the lists, getting always takes the heads */
+			SDL_memcpy(cursor, SDL_EventQ.head, sizeof(cursor));
+			while ( used < numevents ) {
+				spot = SDL_FindEvent(mask, cursor, &type);
+				if ( spot < 0 ) {
+					break;
+				}
+				events[used++] = SDL_EventQ.node[spot].event;
+				if ( action == SDL_GETEVENT ) {
+					SDL_CutEvent(type);
+					cursor[type] = SDL_EventQ.head[type];
 				} else {
-					spot = (spot+1)%MAXEVENTS;
+					cursor[type] = SDL_EventQ.node[spot].next;
 				}
 			}
 		}
@@ -400,18 +591,205 @@ int SDL_PollEvent (SDL_Event *event)
 	return 1;
 }
 
-int SDL_WaitEvent (SDL_Event *event)
+/* How long the thread pumping the event sources may sleep before it has
+   to poll them again (every 'interval' ms if the video driver can't wake
+   it), or -1 if it can sleep until the driver's descriptors wake it.
+ */
+static int SDL_PollTimeout(int have_fds, int interval)
 {
+	int timeout, repeat;
+
+	timeout = -1;
+	if ( !have_fds ) {
+		timeout = interval;
+	}
+#if !SDL_JOYSTICK_DISABLED
+	if ( SDL_numjoysticks && (SDL_eventstate & SDL_JOYEVENTMASK) ) {
+		timeout = interval;
+	}
+#endif
+	repeat = SDL_KeyRepeatTimeout();
+	if ( (repeat >= 0) && ((timeout < 0) || (repeat < timeout)) ) {
+		timeout = repeat;
+	}
+	return(timeout);
+}
+
+#ifdef HAVE_SELECT
+/* Get the video driver's input descriptors, if we can sleep on them,
+   and in 'due' when it has to be pumped anyway (-1 if never) */
+static int SDL_GetEventFDs(int *fds, int *due)
+{
+	*due = -1;
+	if ( (SDL_EventQ.wakefd[0] >= 0) &&
+	     current_video && current_video->GetEventFDs ) {
+		return current_video->GetEventFDs(current_video,
+		                                  fds, MAXWAITFDS, due);
+	}
+	return(0);
+}
+
+/* Sleep until one of 'fds' or the wakeup pipe is readable, or until
+   'timeout' ms have passed (forever if it is negative) */
+static void SDL_SelectEventFDs(const int *fds, int numfds, int timeout)
+{
+	fd_set fdset;
+	struct timeval tv;
+	int i, max_fd;
+
+	FD_ZERO(&fdset);
+	FD_SET(SDL_EventQ.wakefd[0], &fdset);
+	max_fd = SDL_EventQ.wakefd[0];
+	for ( i=0; i<numfds; ++i ) {
+		FD_SET(fds[i], &fdset);
+		if ( max_fd < fds[i] ) {
+			max_fd = fds[i];
+		}
+	}
+	if ( timeout >= 0 ) {
+		tv.tv_sec = timeout / 1000;
+		tv.tv_usec = (timeout % 1000) * 1000;
+	}
+	select(max_fd+1, &fdset, NULL, NULL, (timeout >= 0) ? &tv : NULL);
+}
+
+static void SDL_DrainWakeup(void)
+{
+	char buf[16];
+
+	while ( read(SDL_EventQ.wakefd[0], buf, sizeof(buf)) > 0 )
+		;
+}
+#endif /* HAVE_SELECT */
+
+/* Sleep in the event thread until the video driver has input, a timer
+   or key repeat is due, or somebody wakes us with SDL_WakeEventThread()
+ */
+static void SDL_IdleEventThread(void)
+{
+	int fds[MAXWAITFDS];
+	int numfds, timeout, due, timer;
+
+	numfds = 0;
+	due = -1;
+#ifdef HAVE_SELECT
+	numfds = SDL_GetEventFDs(fds, &due);
+#endif
+	timeout = SDL_PollTimeout(numfds > 0, 1);
+	if ( (due >= 0) && ((timeout < 0) || (due < timeout)) ) {
+		timeout = due;
+	}
+	if ( SDL_timer_running ) {
+		timer = SDL_ThreadedTimerTimeout();
+		if ( (timer >= 0) && ((timeout < 0) || (timer < timeout)) ) {
+			timeout = timer;
+		}
+	}
+	if ( (timeout == 0) || !SDL_EventQ.active ) {
+		return;
+	}
+#ifdef HAVE_SELECT
+	if ( SDL_EventQ.wakefd[0] >= 0 ) {
+		SDL_SelectEventFDs(fds, numfds, timeout);
+		SDL_DrainWakeup();
+		return;
+	}
+#endif
+	SDL_Delay(1);
+}
+
+/* Sleep until an event may be available or 'timeout' ms have passed */
+static void SDL_SleepEvents(int timeout)
+{
+	int fds[MAXWAITFDS];
+	int numfds, poll, due;
+
+	numfds = 0;
+	if ( !SDL_EventThread ) {
+		/* We are pumping the event sources ourselves */
+		due = -1;
+#ifdef HAVE_SELECT
+		numfds = SDL_GetEventFDs(fds, &due);
+#endif
+		poll = SDL_PollTimeout(numfds > 0, 10);
+		if ( (due >= 0) && ((poll < 0) || (due < poll)) ) {
+			poll = due;
+		}
+		if ( (poll >= 0) && ((timeout < 0) || (poll < timeout)) ) {
+			timeout = poll;
+		}
+	}
+	if ( timeout == 0 ) {
+		return;
+	}
+
+	if ( SDL_mutexP(SDL_EventQ.lock) < 0 ) {
+		SDL_Delay(10);
+		return;
+	}
+	if ( SDL_EventQ.count > 0 || !SDL_EventQ.active ) {
+		SDL_mutexV(SDL_EventQ.lock);
+		return;
+	}
+	++SDL_EventQ.sleepers;
+#ifdef HAVE_SELECT
+	if ( numfds > 0 ) {
+		/* Events added from now on write to the pipe */
+		SDL_mutexV(SDL_EventQ.lock);
+		SDL_SelectEventFDs(fds, numfds, timeout);
+		SDL_mutexP(SDL_EventQ.lock);
+		if ( SDL_EventQ.woken ) {
+			SDL_DrainWakeup();
+			SDL_EventQ.woken = 0;
+		}
+	} else
+#endif
+	if ( SDL_EventQ.wait ) {
+		if ( timeout > 0 ) {
+			SDL_CondWaitTimeout(SDL_EventQ.wait, SDL_EventQ.lock,
+			                    (Uint32)timeout);
+		} else {
+			SDL_CondWait(SDL_EventQ.wait, SDL_EventQ.lock);
+		}
+	} else {
+		/* No way to be woken up, fall back to polling */
+		SDL_mutexV(SDL_EventQ.lock);
+		SDL_Delay((timeout > 0 && timeout < 10) ? timeout : 10);
+		SDL_mutexP(SDL_EventQ.lock);
+	}
+	--SDL_EventQ.sleepers;
+	SDL_mutexV(SDL_EventQ.lock);
+}
+
+int SDL_WaitEventTimeout (SDL_Event *event, int timeout)
+{
+	Uint32 start, elapsed;
+
+	start = SDL_GetTicks();
 	while ( 1 ) {
 		SDL_PumpEvents();
 		switch(SDL_PeepEvents(event, 1, SDL_GETEVENT, SDL_ALLEVENTS)) {
 		    case -1: return 0;
 		    case 1: return 1;
-		    case 0: SDL_Delay(10);
+		    case 0: break;
+		}
+		if ( timeout < 0 ) {
+			SDL_SleepEvents(-1);
+			continue;
+		}
+		elapsed = SDL_GetTicks() - start;
+		if ( elapsed >= (Uint32)timeout ) {
+			return 0;
 		}
+		SDL_SleepEvents(timeout - elapsed);
 	}
 }
 
+int SDL_WaitEvent (SDL_Event *event)
+{
+	return SDL_WaitEventTimeout(event, -1);
+}
+
 int SDL_PushEvent(SDL_Event *event)
 {
 	if ( SDL_PeepEvents(event, 1, SDL_ADDEVENT, 0) <= 0 )
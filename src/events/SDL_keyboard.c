@@ -593,6 +593,27 @@ void SDL_CheckKeyRepeat(void)
 	}
 }
 
+int SDL_KeyRepeatTimeout(void)
+{
+	Uint32 elapsed, wait;
+
+	if ( ! SDL_KeyRepeat.timestamp ) {
+		return(-1);
+	}
+	elapsed = SDL_GetTicks() - SDL_KeyRepeat.timestamp;
+	if ( SDL_KeyRepeat.firsttime ) {
+		wait = SDL_KeyRepeat.delay;
+	} else {
+		wait = SDL_KeyRepeat.interval;
+	}
+	/* SDL_CheckKeyRepeat() fires once the interval has been exceeded */
+	++wait;
+	if ( elapsed >= wait ) {
+		return(0);
+	}
+	return(wait - elapsed);
+}
+
 int SDL_EnableKeyRepeat(int delay, int interval)
 {
 	if ( (delay < 0) || (interval < 0) ) {
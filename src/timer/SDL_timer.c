@@ -25,17 +25,27 @@
 #include "SDL_timer_c.h"
 #include "SDL_mutex.h"
 #include "SDL_systimer.h"
+#include "../events/SDL_events_c.h"
 
 /* #define DEBUG_TIMERS */
 
 int SDL_timer_started = 0;
 int SDL_timer_running = 0;
+Uint32 SDL_timer_resolution = TIMER_RESOLUTION;
 
 /* Data to handle a single periodic alarm */
 Uint32 SDL_alarm_interval = 0;
 SDL_TimerCallback SDL_alarm_callback;
 
-/* Data used for a thread-based timer */
+/* Data used for a thread-based timer
+
+   Timers are kept in a binary min-heap ordered by the time they are next
+   due, so the timer thread only ever looks at the top of the heap and
+   can sleep until that deadline.  Each timer remembers its position in
+   the heap, so removing one doesn't need a search.  Removed timers are
+   kept on a free list until SDL_TimerQuit(), so a stale SDL_TimerID can
+   still be safely passed to SDL_RemoveTimer().
+*/
 static int SDL_timer_threaded = 0;
 
 struct _SDL_TimerID {
@@ -43,12 +53,126 @@ struct _SDL_TimerID {
 	SDL_NewTimerCallback cb;
 	void *param;
 	Uint32 last_alarm;
-	struct _SDL_TimerID *next;
+	Uint32 due;		/* last_alarm + interval */
+	Uint32 pass;		/* SDL_timer_pass when it last ran */
+	int index;		/* position in SDL_timers, -1 if free */
+	struct _SDL_TimerID *next;	/* free list */
 };
 
-static SDL_TimerID SDL_timers = NULL;
+static SDL_TimerID *SDL_timers = NULL;
+static int SDL_numtimers = 0;
+static int SDL_maxtimers = 0;
 static SDL_mutex *SDL_timer_mutex;
-static volatile SDL_bool list_changed = SDL_FALSE;
+static SDL_cond *SDL_timer_cond;
+static int SDL_timer_woken = 0;
+static Uint32 SDL_timer_pass = 0;
+static SDL_TimerID SDL_timer_current = NULL;	/* callback in progress */
+static SDL_TimerID SDL_timer_free = NULL;
+
+/* Is timer 'a' due before timer 'b'? */
+#define SDL_TimerBefore(a, b)	((Sint32)((a)->due - (b)->due) < 0)
+
+static void SDL_TimerPlace(SDL_TimerID t, int index)
+{
+	SDL_timers[index] = t;
+	t->index = index;
+}
+
+/* Restore the heap order around a timer whose due time changed */
+static void SDL_TimerSift(SDL_TimerID t)
+{
+	int index, child;
+
+	index = t->index;
+	while ( index > 0 && SDL_TimerBefore(t, SDL_timers[(index-1)/2]) ) {
+		SDL_TimerPlace(SDL_timers[(index-1)/2], index);
+		index = (index-1)/2;
+	}
+	for ( ; ; ) {
+		child = 2*index+1;
+		if ( child >= SDL_numtimers ) {
+			break;
+		}
+		if ( (child+1 < SDL_numtimers) &&
+		     SDL_TimerBefore(SDL_timers[child+1], SDL_timers[child]) ) {
+			++child;
+		}
+		if ( ! SDL_TimerBefore(SDL_timers[child], t) ) {
+			break;
+		}
+		SDL_TimerPlace(SDL_timers[child], index);
+		index = child;
+	}
+	SDL_TimerPlace(t, index);
+}
+
+static int SDL_TimerInsert(SDL_TimerID t)
+{
+	if ( SDL_numtimers == SDL_maxtimers ) {
+		int maxtimers = SDL_maxtimers ? 2*SDL_maxtimers : 16;
+		SDL_TimerID *timers = (SDL_TimerID *)SDL_realloc(SDL_timers,
+		                                maxtimers*sizeof(*timers));
+		if ( ! timers ) {
+			SDL_OutOfMemory();
+			return(-1);
+		}
+		SDL_timers = timers;
+		SDL_maxtimers = maxtimers;
+	}
+	t->index = SDL_numtimers++;
+	SDL_timers[t->index] = t;
+	SDL_TimerSift(t);
+	return(0);
+}
+
+static void SDL_TimerDelete(SDL_TimerID t)
+{
+	SDL_TimerID last;
+
+	last = SDL_timers[--SDL_numtimers];
+	if ( last != t ) {
+		last->index = t->index;
+		SDL_timers[last->index] = last;
+		SDL_TimerSift(last);
+	}
+	if ( t == SDL_timer_current ) {
+		SDL_timer_current = NULL;
+	}
+	t->index = -1;
+	t->next = SDL_timer_free;
+	SDL_timer_free = t;
+	--SDL_timer_running;
+}
+
+static void SDL_TimerDeleteAll(void)
+{
+	SDL_TimerID t;
+
+	while ( SDL_numtimers > 0 ) {
+		SDL_TimerDelete(SDL_timers[SDL_numtimers-1]);
+	}
+	SDL_free(SDL_timers);
+	SDL_timers = NULL;
+	SDL_maxtimers = 0;
+	while ( SDL_timer_free ) {
+		t = SDL_timer_free;
+		SDL_timer_free = t->next;
+		SDL_free(t);
+	}
+}
+
+/* Let whoever runs the timers know that the earliest deadline changed
+   -- called with the timer mutex held */
+static void SDL_TimerWake(void)
+{
+	if ( SDL_timer_threaded == 2 ) {
+		/* The event thread may be asleep until a later deadline */
+		SDL_WakeEventThread();
+	} else {
+		SDL_timer_woken = 1;
+		SDL_CondSignal(SDL_timer_cond);
+	}
+}
 
 /* Set whether or not the timer should use a thread.
    This should not be called while the timer subsystem is running.
@@ -69,17 +193,25 @@ int SDL_SetTimerThreaded(int value)
 
 int SDL_TimerInit(void)
 {
+	const char *envr;
 	int retval;
 
 	retval = 0;
 	if ( SDL_timer_started ) {
 		SDL_TimerQuit();
 	}
+	/* Allow timers finer than the default resolution */
+	SDL_timer_resolution = TIMER_RESOLUTION;
+	envr = SDL_getenv("SDL_TIMER_RESOLUTION");
+	if ( envr && (SDL_atoi(envr) > 0) ) {
+		SDL_timer_resolution = SDL_atoi(envr);
+	}
 	if ( ! SDL_timer_threaded ) {
 		retval = SDL_SYS_TimerInit();
 	}
 	if ( SDL_timer_threaded ) {
 		SDL_timer_mutex = SDL_CreateMutex();
+		SDL_timer_cond = SDL_CreateCond();
 	}
 	if ( retval == 0 ) {
 		SDL_timer_started = 1;
@@ -94,6 +226,11 @@ void SDL_TimerQuit(void)
 		SDL_SYS_TimerQuit();
 	}
 	if ( SDL_timer_threaded ) {
+		SDL_mutexP(SDL_timer_mutex);
+		SDL_TimerDeleteAll();
+		SDL_mutexV(SDL_timer_mutex);
+		SDL_DestroyCond(SDL_timer_cond);
+		SDL_timer_cond = NULL;
 		SDL_DestroyMutex(SDL_timer_mutex);
 		SDL_timer_mutex = NULL;
 	}
@@ -101,80 +238,142 @@ void SDL_TimerQuit(void)
 	SDL_timer_threaded = 0;
 }
 
+/* A zero interval would leave the timer due on every pass, with the
+   timer thread spinning, so it waits one tick of the resolution */
+static Uint32 SDL_TimerDelay(Uint32 interval)
+{
+	if ( interval == 0 ) {
+		return(SDL_timer_resolution);
+	}
+	return(interval);
+}
+
 void SDL_ThreadedTimerCheck(void)
 {
 	Uint32 now, ms;
-	SDL_TimerID t, prev, next;
-	SDL_bool removed;
+	SDL_TimerID t;
+	struct _SDL_TimerID timer;
 
 	SDL_mutexP(SDL_timer_mutex);
-	list_changed = SDL_FALSE;
 	now = SDL_GetTicks();
-	for ( prev = NULL, t = SDL_timers; t; t = next ) {
-		removed = SDL_FALSE;
-		ms = t->interval - SDL_TIMESLICE;
-		next = t->next;
-		if ( (int)(now - t->last_alarm) > (int)ms ) {
-			struct _SDL_TimerID timer;
-
-			if ( (now - t->last_alarm) < t->interval ) {
-				t->last_alarm += t->interval;
-			} else {
-				t->last_alarm = now;
-			}
+	++SDL_timer_pass;
+	while ( SDL_numtimers > 0 ) {
+		t = SDL_timers[0];
+		/* Timers rescheduled in this pass wait for the next one */
+		if ( (Sint32)(now - t->due) < 0 || (t->pass == SDL_timer_pass) ) {
+			break;
+		}
+		t->pass = SDL_timer_pass;
+		if ( (now - t->last_alarm) < 2*t->interval ) {
+			t->last_alarm += t->interval;
+		} else {
+			t->last_alarm = now;
+		}
 #ifdef DEBUG_TIMERS
-			printf("Executing timer %p (thread = %d)\n",
-				t, SDL_ThreadID());
+		printf("Executing timer %p (thread = %d)\n",
+			t, SDL_ThreadID());
 #endif
-			timer = *t;
-			SDL_mutexV(SDL_timer_mutex);
-			ms = timer.cb(timer.interval, timer.param);
-			SDL_mutexP(SDL_timer_mutex);
-			if ( list_changed ) {
-				/* Abort, list of timers modified */
-				/* FIXME: what if ms was changed? */
-				break;
-			}
-			if ( ms != t->interval ) {
-				if ( ms ) {
-					t->interval = ROUND_RESOLUTION(ms);
-				} else {
-					/* Remove timer from the list */
+		/* The callback may add or remove timers, including this one */
+		timer = *t;
+		SDL_timer_current = t;
+		SDL_mutexV(SDL_timer_mutex);
+		ms = timer.cb(timer.interval, timer.param);
+		SDL_mutexP(SDL_timer_mutex);
+		if ( SDL_timer_current != t ) {
+			/* It was removed while the callback ran */
+			continue;
+		}
+		SDL_timer_current = NULL;
+		if ( ms ) {
+			t->interval = ROUND_RESOLUTION(ms);
+			t->due = t->last_alarm + SDL_TimerDelay(t->interval);
+			SDL_TimerSift(t);
+		} else {
+			/* Remove timer from the list */
 #ifdef DEBUG_TIMERS
-					printf("SDL: Removing timer %p\n", t);
+			printf("SDL: Removing timer %p\n", t);
 #endif
-					if ( prev ) {
-						prev->next = next;
-					} else {
-						SDL_timers = next;
-					}
-					SDL_free(t);
-					--SDL_timer_running;
-					removed = SDL_TRUE;
-				}
-			}
+			SDL_TimerDelete(t);
 		}
-		/* Don't update prev if the timer has disappeared */
-		if ( ! removed ) {
-			prev = t;
+	}
+	SDL_mutexV(SDL_timer_mutex);
+}
+
+int SDL_ThreadedTimerTimeout(void)
+{
+	int timeout;
+
+	timeout = -1;
+	SDL_mutexP(SDL_timer_mutex);
+	if ( SDL_numtimers > 0 ) {
+		timeout = (int)(SDL_timers[0]->due - SDL_GetTicks());
+		if ( timeout < 0 ) {
+			timeout = 0;
+		}
+	}
+	SDL_mutexV(SDL_timer_mutex);
+	return(timeout);
+}
+
+void SDL_ThreadedTimerWait(void)
+{
+	int timeout;
+
+	if ( ! SDL_timer_mutex || ! SDL_timer_cond ) {
+		/* Still starting up */
+		SDL_Delay(1);
+		return;
+	}
+	timeout = SDL_ThreadedTimerTimeout();
+	SDL_mutexP(SDL_timer_mutex);
+	if ( ! SDL_timer_woken && (timeout != 0) ) {
+		if ( timeout > 0 ) {
+			SDL_CondWaitTimeout(SDL_timer_cond, SDL_timer_mutex,
+			                    (Uint32)timeout);
+		} else {
+			SDL_CondWait(SDL_timer_cond, SDL_timer_mutex);
 		}
 	}
+	SDL_timer_woken = 0;
 	SDL_mutexV(SDL_timer_mutex);
 }
 
+void SDL_ThreadedTimerWake(void)
+{
+	if ( SDL_timer_mutex && SDL_timer_cond ) {
+		SDL_mutexP(SDL_timer_mutex);
+		SDL_timer_woken = 1;
+		SDL_CondSignal(SDL_timer_cond);
+		SDL_mutexV(SDL_timer_mutex);
+	}
+}
+
 static SDL_TimerID SDL_AddTimerInternal(Uint32 interval, SDL_NewTimerCallback callback, void *param)
 {
 	SDL_TimerID t;
-	t = (SDL_TimerID) SDL_malloc(sizeof(struct _SDL_TimerID));
+	if ( SDL_timer_free ) {
+		t = SDL_timer_free;
+		SDL_timer_free = t->next;
+	} else {
+		t = (SDL_TimerID) SDL_malloc(sizeof(struct _SDL_TimerID));
+	}
 	if ( t ) {
 		t->interval = ROUND_RESOLUTION(interval);
 		t->cb = callback;
 		t->param = param;
 		t->last_alarm = SDL_GetTicks();
-		t->next = SDL_timers;
-		SDL_timers = t;
+		t->due = t->last_alarm + SDL_TimerDelay(t->interval);
+		t->pass = SDL_timer_pass;
+		if ( SDL_TimerInsert(t) < 0 ) {
+			t->index = -1;
+			t->next = SDL_timer_free;
+			SDL_timer_free = t;
+			return NULL;
+		}
 		++SDL_timer_running;
-		list_changed = SDL_TRUE;
+		if ( t->index == 0 ) {
+			SDL_TimerWake();
+		}
 	}
 #ifdef DEBUG_TIMERS
 	printf("SDL_AddTimer(%d) = %08x num_timers = %d\n", interval, (Uint32)t, SDL_timer_running);
@@ -205,24 +404,16 @@ SDL_TimerID SDL_AddTimer(Uint32 interval, SDL_NewTimerCallback callback, void *p
 
 SDL_bool SDL_RemoveTimer(SDL_TimerID id)
 {
-	SDL_TimerID t, prev = NULL;
+	int i;
 	SDL_bool removed;
 
 	removed = SDL_FALSE;
 	SDL_mutexP(SDL_timer_mutex);
-	/* Look for id in the linked list of timers */
-	for (t = SDL_timers; t; prev=t, t = t->next ) {
-		if ( t == id ) {
-			if(prev) {
-				prev->next = t->next;
-			} else {
-				SDL_timers = t->next;
-			}
-			SDL_free(t);
-			--SDL_timer_running;
+	if ( id ) {
+		i = id->index;
+		if ( (i >= 0) && (i < SDL_numtimers) && (SDL_timers[i] == id) ) {
+			SDL_TimerDelete(id);
 			removed = SDL_TRUE;
-			list_changed = SDL_TRUE;
-			break;
 		}
 	}
 #ifdef DEBUG_TIMERS
@@ -253,13 +444,9 @@ int SDL_SetTimer(Uint32 ms, SDL_TimerCallback callback)
 	}
 	if ( SDL_timer_running ) {	/* Stop any currently running timer */
 		if ( SDL_timer_threaded ) {
-			while ( SDL_timers ) {
-				SDL_TimerID freeme = SDL_timers;
-				SDL_timers = SDL_timers->next;
-				SDL_free(freeme);
+			while ( SDL_numtimers > 0 ) {
+				SDL_TimerDelete(SDL_timers[SDL_numtimers-1]);
 			}
-			SDL_timer_running = 0;
-			list_changed = SDL_TRUE;
 		} else {
 			SDL_SYS_StopTimer();
 			SDL_timer_running = 0;
@@ -283,3 +470,25 @@ int SDL_SetTimer(Uint32 ms, SDL_TimerCallback callback)
 
 	return retval;
 }
+
+#if defined(SDL_HAS_64BIT_TYPE) && !SDL_TIMER_UNIX
+/* Timer backends without a clock finer than SDL_GetTicks() */
+Uint64 SDL_GetTicksNS(void)
+{
+	return((Uint64)SDL_GetTicks() * 1000000);
+}
+
+void SDL_DelayUntilNS(Uint64 deadline)
+{
+	Uint64 now = SDL_GetTicksNS();
+
+	if ( deadline > now ) {
+		SDL_Delay((Uint32)((deadline - now + 999999) / 1000000));
+	}
+}
+
+void SDL_DelayNS(Uint64 ns)
+{
+	SDL_Delay((Uint32)((ns + 999999) / 1000000));
+}
+#endif /* SDL_HAS_64BIT_TYPE && !SDL_TIMER_UNIX */
@@ -25,9 +25,10 @@
 #include "SDL_timer.h"
 
 #define ROUND_RESOLUTION(X)	\
-	(((X+TIMER_RESOLUTION-1)/TIMER_RESOLUTION)*TIMER_RESOLUTION)
+	(((X+SDL_timer_resolution-1)/SDL_timer_resolution)*SDL_timer_resolution)
 
 extern int SDL_timer_started;
+extern Uint32 SDL_timer_resolution;
 extern int SDL_timer_running;
 
 /* Data to handle a single periodic alarm */
@@ -44,3 +45,12 @@ extern void SDL_TimerQuit(void);
 
 /* This function is called from the SDL event thread if it is available */
 extern void SDL_ThreadedTimerCheck(void);
+
+/* Milliseconds until SDL_ThreadedTimerCheck() has a timer to run,
+   or -1 if there are no timers */
+extern int SDL_ThreadedTimerTimeout(void);
+
+/* Used by a dedicated timer thread to sleep until the next timer is due,
+   or until SDL_ThreadedTimerWake() is called */
+extern void SDL_ThreadedTimerWait(void);
+extern void SDL_ThreadedTimerWake(void);
@@ -53,7 +53,7 @@ static int RunTimer(void *unused)
 		if ( SDL_timer_running ) {
 			SDL_ThreadedTimerCheck();
 		}
-		SDL_Delay(1);
+		SDL_ThreadedTimerWait();
 	}
 	return(0);
 }
@@ -72,6 +72,7 @@ void SDL_SYS_TimerQuit(void)
 {
 	timer_alive = 0;
 	if ( timer ) {
+		SDL_ThreadedTimerWake();
 		SDL_WaitThread(timer, NULL);
 		timer = NULL;
 	}
@@ -134,6 +134,59 @@ void SDL_Delay (Uint32 ms)
 #endif /* SDL_THREAD_PTH */
 }
 
+#ifdef SDL_HAS_64BIT_TYPE
+Uint64 SDL_GetTicksNS (void)
+{
+#if HAVE_CLOCK_GETTIME
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return((Uint64)(now.tv_sec-start.tv_sec)*1000000000 +
+	       now.tv_nsec - start.tv_nsec);
+#else
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	return((Uint64)(now.tv_sec-start.tv_sec)*1000000000 +
+	       (Sint64)(now.tv_usec-start.tv_usec)*1000);
+#endif
+}
+
+void SDL_DelayUntilNS (Uint64 deadline)
+{
+#if HAVE_CLOCK_NANOSLEEP && !SDL_THREAD_PTH
+	struct timespec tv;
+
+	/* Sleep on the same clock SDL_GetTicksNS() reads, so an interrupted
+	   or late wakeup never adds up across calls */
+	tv.tv_sec = start.tv_sec + (time_t)(deadline / 1000000000);
+	tv.tv_nsec = start.tv_nsec + (long)(deadline % 1000000000);
+	if ( tv.tv_nsec >= 1000000000 ) {
+		tv.tv_nsec -= 1000000000;
+		++tv.tv_sec;
+	}
+	while ( clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &tv, NULL) == EINTR )
+		;
+#else
+	Uint64 now;
+
+	while ( (now = SDL_GetTicksNS()) < deadline ) {
+#if HAVE_NANOSLEEP && !SDL_THREAD_PTH
+		struct timespec tv;
+		tv.tv_sec = (time_t)((deadline - now) / 1000000000);
+		tv.tv_nsec = (long)((deadline - now) % 1000000000);
+		nanosleep(&tv, NULL);
+#else
+		SDL_Delay((Uint32)((deadline - now + 999999) / 1000000));
+#endif
+	}
+#endif /* HAVE_CLOCK_NANOSLEEP */
+}
+
+void SDL_DelayNS (Uint64 ns)
+{
+	SDL_DelayUntilNS(SDL_GetTicksNS() + ns);
+}
+#endif /* SDL_HAS_64BIT_TYPE */
+
 #ifdef USE_ITIMER
 
 static void HandleAlarm(int sig)
@@ -200,7 +253,7 @@ static int RunTimer(void *unused)
 		if ( SDL_timer_running ) {
 			SDL_ThreadedTimerCheck();
 		}
-		SDL_Delay(1);
+		SDL_ThreadedTimerWait();
 	}
 	return(0);
 }
@@ -219,6 +272,7 @@ void SDL_SYS_TimerQuit(void)
 {
 	timer_alive = 0;
 	if ( timer ) {
+		SDL_ThreadedTimerWake();
 		SDL_WaitThread(timer, NULL);
 		timer = NULL;
 	}
@@ -40,7 +40,7 @@
 #endif
 
 /* The general purpose software blit routine */
-static int SDL_SoftBlit(SDL_Surface *src, SDL_Rect *srcrect,
+int SDL_SoftBlit(SDL_Surface *src, SDL_Rect *srcrect,
 			SDL_Surface *dst, SDL_Rect *dstrect)
 {
 	int okay;
@@ -108,6 +108,74 @@ static int SDL_SoftBlit(SDL_Surface *src, SDL_Rect *srcrect,
 	return(okay ? 0 : -1);
 }
 
+/* The same for a run of clipped blits from one source, for SDL_BlitSurfaces() */
+int SDL_SoftBlitBatch(SDL_Surface *src, SDL_Surface *dst,
+			SDL_BlitEntry *blits, int numblits)
+{
+	int okay;
+	int src_locked;
+	int dst_locked;
+
+	okay = 1;
+	dst_locked = 0;
+	if ( SDL_MUSTLOCK(dst) ) {
+		if ( SDL_LockSurface(dst) < 0 ) {
+			okay = 0;
+		} else {
+			dst_locked = 1;
+		}
+	}
+	src_locked = 0;
+	if ( SDL_MUSTLOCK(src) ) {
+		if ( SDL_LockSurface(src) < 0 ) {
+			okay = 0;
+		} else {
+			src_locked = 1;
+		}
+	}
+
+	/* Only the rectangles change from one blit to the next */
+	if ( okay ) {
+		SDL_BlitInfo info;
+		SDL_loblit RunBlit;
+		int s_bpp, d_bpp;
+
+		s_bpp = src->format->BytesPerPixel;
+		d_bpp = dst->format->BytesPerPixel;
+		info.aux_data = src->map->sw_data->aux_data;
+		info.src = src->format;
+		info.table = src->map->table;
+		info.dst = dst->format;
+		RunBlit = src->map->sw_data->blit;
+		for ( ; numblits; --numblits, ++blits ) {
+			if ( ! blits->dstrect.w ) {
+				continue;
+			}
+			info.s_pixels = (Uint8 *)src->pixels +
+					(Uint16)blits->srcrect.y*src->pitch +
+					(Uint16)blits->srcrect.x*s_bpp;
+			info.s_width = blits->srcrect.w;
+			info.s_height = blits->srcrect.h;
+			info.s_skip = src->pitch-info.s_width*s_bpp;
+			info.d_pixels = (Uint8 *)dst->pixels +
+					(Uint16)blits->dstrect.y*dst->pitch +
+					(Uint16)blits->dstrect.x*d_bpp;
+			info.d_width = blits->dstrect.w;
+			info.d_height = blits->dstrect.h;
+			info.d_skip = dst->pitch-info.d_width*d_bpp;
+			RunBlit(&info);
+		}
+	}
+
+	if ( dst_locked ) {
+		SDL_UnlockSurface(dst);
+	}
+	if ( src_locked ) {
+		SDL_UnlockSurface(src);
+	}
+	return(okay ? 0 : -1);
+}
+
 #ifdef MMX_ASMBLIT
 static __inline__ void SDL_memcpyMMX(Uint8 *to, const Uint8 *from, int len)
 {
@@ -152,6 +220,9 @@ static __inline__ void SDL_memcpySSE(Uint8 *to, const Uint8 *from, int len)
 #endif
 #endif
 
+/* The smallest blit, in bytes, that SDL_BlitCopy() uses MMX or SSE for */
+#define BLITCOPY_ASM_MIN	(64*1024)
+
 static void SDL_BlitCopy(SDL_BlitInfo *info)
 {
 	Uint8 *src, *dst;
@@ -165,8 +236,12 @@ static void SDL_BlitCopy(SDL_BlitInfo *info)
 	srcskip = w+info->s_skip;
 	dstskip = w+info->d_skip;
 
+	/* The prefetching, streaming stores and emms cost more than they
+	   save on small blits like tiles and sprites, which the destination
+	   cache holds anyway, so leave those to SDL_memcpy()
+	 */
 #ifdef SSE_ASMBLIT
-	if(SDL_HasSSE())
+	if(w*h >= BLITCOPY_ASM_MIN && SDL_HasSSE())
 	{
 		while ( h-- ) {
 			SDL_memcpySSE(dst, src, w);
@@ -180,7 +255,7 @@ static void SDL_BlitCopy(SDL_BlitInfo *info)
 	else
 #endif
 #ifdef MMX_ASMBLIT
-	if(SDL_HasMMX())
+	if(w*h >= BLITCOPY_ASM_MIN && SDL_HasMMX())
 	{
 		while ( h-- ) {
 			SDL_memcpyMMX(dst, src, w);
@@ -358,3 +433,37 @@ int SDL_CalculateBlit(SDL_Surface *surface)
 	return(0);
 }
 
+
+/* Look up the name of the blit routine SDL_CalculateBlit() set up */
+const char *SDL_CalculatedBlitName(SDL_Surface *surface)
+{
+	static const SDL_BlitName copy_names[] = {
+		SDL_BLIT_NAME(SDL_BlitCopy),
+		SDL_BLIT_NAME(SDL_BlitCopyOverlap),
+		{ NULL, NULL }
+	};
+	static const SDL_BlitName *tables[] = {
+		copy_names, SDL_BlitNames0, SDL_BlitNames1,
+		SDL_BlitNamesN, SDL_AlphaBlitNames
+	};
+	const SDL_BlitName *names;
+	int i;
+
+	if ( (surface->flags & SDL_HWACCEL) == SDL_HWACCEL ) {
+		return("hardware");
+	}
+	if ( surface->map->sw_blit == SDL_RLEBlit ) {
+		return("SDL_RLEBlit");
+	}
+	if ( surface->map->sw_blit == SDL_RLEAlphaBlit ) {
+		return("SDL_RLEAlphaBlit");
+	}
+	for ( i = 0; i < (int)SDL_arraysize(tables); ++i ) {
+		for ( names = tables[i]; names->blit; ++names ) {
+			if ( names->blit == surface->map->sw_data->blit ) {
+				return(names->name);
+			}
+		}
+	}
+	return("unknown");
+}
@@ -67,8 +67,21 @@ typedef struct SDL_BlitMap {
 } SDL_BlitMap;
 
 
+/* Names of the low level blit functions, for SDL_GetBlitName() */
+typedef struct {
+	SDL_loblit blit;
+	const char *name;
+} SDL_BlitName;
+
+#define SDL_BLIT_NAME(blit)	{ blit, #blit }
+
 /* Functions found in SDL_blit.c */
 extern int SDL_CalculateBlit(SDL_Surface *surface);
+extern int SDL_SoftBlit(SDL_Surface *src, SDL_Rect *srcrect,
+			SDL_Surface *dst, SDL_Rect *dstrect);
+extern int SDL_SoftBlitBatch(SDL_Surface *src, SDL_Surface *dst,
+			SDL_BlitEntry *blits, int numblits);
+extern const char *SDL_CalculatedBlitName(SDL_Surface *surface);
 
 /* Functions found in SDL_blit_{0,1,N,A}.c */
 extern SDL_loblit SDL_CalculateBlit0(SDL_Surface *surface, int complex);
@@ -76,6 +89,12 @@ extern SDL_loblit SDL_CalculateBlit1(SDL_Surface *surface, int complex);
 extern SDL_loblit SDL_CalculateBlitN(SDL_Surface *surface, int complex);
 extern SDL_loblit SDL_CalculateAlphaBlit(SDL_Surface *surface, int complex);
 
+/* The blitters those functions can return, ending with a NULL blit */
+extern const SDL_BlitName SDL_BlitNames0[];
+extern const SDL_BlitName SDL_BlitNames1[];
+extern const SDL_BlitName SDL_BlitNamesN[];
+extern const SDL_BlitName SDL_AlphaBlitNames[];
+
 /*
  * Useful macros for blitting routines
  */
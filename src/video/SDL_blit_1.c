@@ -491,6 +491,15 @@ static SDL_loblit one_blitkey[] = {
         NULL, Blit1to1Key, Blit1to2Key, Blit1to3Key, Blit1to4Key
 };
 
+const SDL_BlitName SDL_BlitNames1[] = {
+	SDL_BLIT_NAME(Blit1to1), SDL_BLIT_NAME(Blit1to2),
+	SDL_BLIT_NAME(Blit1to3), SDL_BLIT_NAME(Blit1to4),
+	SDL_BLIT_NAME(Blit1to1Key), SDL_BLIT_NAME(Blit1to2Key),
+	SDL_BLIT_NAME(Blit1to3Key), SDL_BLIT_NAME(Blit1to4Key),
+	SDL_BLIT_NAME(Blit1toNAlpha), SDL_BLIT_NAME(Blit1toNAlphaKey),
+	{ NULL, NULL }
+};
+
 SDL_loblit SDL_CalculateBlit1(SDL_Surface *surface, int blit_index)
 {
 	int which;
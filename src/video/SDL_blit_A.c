@@ -23,6 +23,8 @@
 
 #include "SDL_video.h"
 #include "SDL_blit.h"
+#include "SDL_blit_A_SSE2.h"
+#include "SDL_blit_A_NEON.h"
 
 /*
   In Visual C, VC6 has mmintrin.h in the "Processor Pack" add-on.
@@ -2719,6 +2721,138 @@ static void BlitNtoNPixelAlpha(SDL_BlitInfo *info)
 }
 
 
+#if SDL_SSE2_BLITTERS || SDL_NEON_BLITTERS
+/* The vector kernels blend as much of each row as they can, the same
+   number of pixels on every row, and return how many they did.  The
+   blitter they stand in for does the columns that are left.
+ */
+typedef int (*SDL_BlitRow)(const Uint8 *src, Uint8 *dst, int width,
+                           const SDL_PixelFormat *srcfmt,
+                           const SDL_PixelFormat *dstfmt);
+
+static void BlitPixelAlphaColumns(SDL_BlitInfo *info, SDL_BlitRow kernel,
+                                  SDL_loblit blit)
+{
+	int width = info->d_width;
+	int height = info->d_height;
+	Uint8 *src = info->s_pixels;
+	Uint8 *dst = info->d_pixels;
+	int srcbpp = info->src->BytesPerPixel;
+	int dstbpp = info->dst->BytesPerPixel;
+	int n = 0;
+
+	while ( height-- ) {
+		n = kernel(src, dst, width, info->src, info->dst);
+		src += width*srcbpp + info->s_skip;
+		dst += width*dstbpp + info->d_skip;
+	}
+	if ( n < width ) {
+		SDL_BlitInfo rest = *info;
+
+		rest.s_pixels += n*srcbpp;
+		rest.s_width -= n;
+		rest.s_skip += n*srcbpp;
+		rest.d_pixels += n*dstbpp;
+		rest.d_width -= n;
+		rest.d_skip += n*dstbpp;
+		blit(&rest);
+	}
+}
+#endif /* SDL_SSE2_BLITTERS || SDL_NEON_BLITTERS */
+
+#if SDL_SSE2_BLITTERS
+#if MMX_ASMBLIT
+static void BlitRGBtoRGBPixelAlphaSSE2(SDL_BlitInfo *info)
+{
+	BlitPixelAlphaColumns(info, SDL_BlitRGBtoRGBPixelAlpha_SSE2,
+	                      BlitRGBtoRGBPixelAlphaMMX);
+}
+#endif
+static void BlitARGBto565PixelAlphaSSE2(SDL_BlitInfo *info)
+{
+	BlitPixelAlphaColumns(info, SDL_BlitARGBto565PixelAlpha_SSE2,
+	                      BlitARGBto565PixelAlpha);
+}
+static void BlitARGBto555PixelAlphaSSE2(SDL_BlitInfo *info)
+{
+	BlitPixelAlphaColumns(info, SDL_BlitARGBto555PixelAlpha_SSE2,
+	                      BlitARGBto555PixelAlpha);
+}
+static void BlitNtoNPixelAlphaSSE2(SDL_BlitInfo *info)
+{
+	BlitPixelAlphaColumns(info, SDL_BlitNtoNPixelAlpha_SSE2,
+	                      BlitNtoNPixelAlpha);
+}
+#endif /* SDL_SSE2_BLITTERS */
+
+#if SDL_NEON_BLITTERS
+static void BlitRGBtoRGBPixelAlphaNEON(SDL_BlitInfo *info)
+{
+	BlitPixelAlphaColumns(info, SDL_BlitRGBtoRGBPixelAlpha_NEON,
+	                      BlitRGBtoRGBPixelAlpha);
+}
+static void BlitARGBto565PixelAlphaNEON(SDL_BlitInfo *info)
+{
+	BlitPixelAlphaColumns(info, SDL_BlitARGBto565PixelAlpha_NEON,
+	                      BlitARGBto565PixelAlpha);
+}
+static void BlitARGBto555PixelAlphaNEON(SDL_BlitInfo *info)
+{
+	BlitPixelAlphaColumns(info, SDL_BlitARGBto555PixelAlpha_NEON,
+	                      BlitARGBto555PixelAlpha);
+}
+static void BlitNtoNPixelAlphaNEON(SDL_BlitInfo *info)
+{
+	BlitPixelAlphaColumns(info, SDL_BlitNtoNPixelAlpha_NEON,
+	                      BlitNtoNPixelAlpha);
+}
+#endif /* SDL_NEON_BLITTERS */
+
+const SDL_BlitName SDL_AlphaBlitNames[] = {
+#if SDL_ALTIVEC_BLITTERS
+	SDL_BLIT_NAME(Blit32to32SurfaceAlphaKeyAltivec),
+	SDL_BLIT_NAME(BlitRGBtoRGBSurfaceAlphaAltivec),
+	SDL_BLIT_NAME(Blit32to32SurfaceAlphaAltivec),
+	SDL_BLIT_NAME(Blit32to565PixelAlphaAltivec),
+	SDL_BLIT_NAME(BlitRGBtoRGBPixelAlphaAltivec),
+	SDL_BLIT_NAME(Blit32to32PixelAlphaAltivec),
+#endif
+#if MMX_ASMBLIT
+	SDL_BLIT_NAME(Blit565to565SurfaceAlphaMMX),
+	SDL_BLIT_NAME(Blit555to555SurfaceAlphaMMX),
+	SDL_BLIT_NAME(BlitRGBtoRGBSurfaceAlphaMMX),
+	SDL_BLIT_NAME(BlitRGBtoRGBPixelAlphaMMX),
+	SDL_BLIT_NAME(BlitRGBtoRGBPixelAlphaMMX3DNOW),
+#if SDL_SSE2_BLITTERS
+	SDL_BLIT_NAME(BlitRGBtoRGBPixelAlphaSSE2),
+#endif
+#endif
+#if SDL_SSE2_BLITTERS
+	SDL_BLIT_NAME(BlitARGBto565PixelAlphaSSE2),
+	SDL_BLIT_NAME(BlitARGBto555PixelAlphaSSE2),
+	SDL_BLIT_NAME(BlitNtoNPixelAlphaSSE2),
+#endif
+#if SDL_NEON_BLITTERS
+	SDL_BLIT_NAME(BlitRGBtoRGBPixelAlphaNEON),
+	SDL_BLIT_NAME(BlitARGBto565PixelAlphaNEON),
+	SDL_BLIT_NAME(BlitARGBto555PixelAlphaNEON),
+	SDL_BLIT_NAME(BlitNtoNPixelAlphaNEON),
+#endif
+	SDL_BLIT_NAME(Blit565to565SurfaceAlpha),
+	SDL_BLIT_NAME(Blit555to555SurfaceAlpha),
+	SDL_BLIT_NAME(BlitRGBtoRGBSurfaceAlpha),
+	SDL_BLIT_NAME(BlitRGBtoRGBPixelAlpha),
+	SDL_BLIT_NAME(BlitARGBto565PixelAlpha),
+	SDL_BLIT_NAME(BlitARGBto555PixelAlpha),
+	SDL_BLIT_NAME(BlitNto1SurfaceAlpha),
+	SDL_BLIT_NAME(BlitNto1SurfaceAlphaKey),
+	SDL_BLIT_NAME(BlitNto1PixelAlpha),
+	SDL_BLIT_NAME(BlitNtoNSurfaceAlpha),
+	SDL_BLIT_NAME(BlitNtoNSurfaceAlphaKey),
+	SDL_BLIT_NAME(BlitNtoNPixelAlpha),
+	{ NULL, NULL }
+};
+
 SDL_loblit SDL_CalculateAlphaBlit(SDL_Surface *surface, int blit_index)
 {
     SDL_PixelFormat *sf = surface->format;
@@ -2819,11 +2953,36 @@ SDL_loblit SDL_CalculateAlphaBlit(SDL_Surface *surface, int blit_index)
 	       && sf->Gmask == 0xff00
 	       && ((sf->Rmask == 0xff && df->Rmask == 0x1f)
 		   || (sf->Bmask == 0xff && df->Bmask == 0x1f))) {
-		if(df->Gmask == 0x7e0)
+		if(df->Gmask == 0x7e0) {
+#if SDL_SSE2_BLITTERS
+		    if(SDL_HasSSE2())
+			return BlitARGBto565PixelAlphaSSE2;
+#endif
+#if SDL_NEON_BLITTERS
+		    if(SDL_HasNEON())
+			return BlitARGBto565PixelAlphaNEON;
+#endif
 		    return BlitARGBto565PixelAlpha;
-		else if(df->Gmask == 0x3e0)
+		} else if(df->Gmask == 0x3e0) {
+#if SDL_SSE2_BLITTERS
+		    if(SDL_HasSSE2())
+			return BlitARGBto555PixelAlphaSSE2;
+#endif
+#if SDL_NEON_BLITTERS
+		    if(SDL_HasNEON())
+			return BlitARGBto555PixelAlphaNEON;
+#endif
 		    return BlitARGBto555PixelAlpha;
+		}
 	    }
+#if SDL_SSE2_BLITTERS
+	    if(sf->BytesPerPixel == 4 && SDL_HasSSE2())
+		return BlitNtoNPixelAlphaSSE2;
+#endif
+#if SDL_NEON_BLITTERS
+	    if(sf->BytesPerPixel == 4 && SDL_HasNEON())
+		return BlitNtoNPixelAlphaNEON;
+#endif
 	    return BlitNtoNPixelAlpha;
 
 	case 4:
@@ -2839,6 +2998,10 @@ SDL_loblit SDL_CalculateAlphaBlit(SDL_Surface *surface, int blit_index)
 		   && sf->Ashift % 8 == 0
 		   && sf->Aloss == 0)
 		{
+#if SDL_SSE2_BLITTERS
+			if(SDL_HasSSE2())
+				return BlitRGBtoRGBPixelAlphaSSE2;
+#endif
 			if(SDL_Has3DNow())
 				return BlitRGBtoRGBPixelAlphaMMX3DNOW;
 			if(SDL_HasMMX())
@@ -2851,6 +3014,10 @@ SDL_loblit SDL_CalculateAlphaBlit(SDL_Surface *surface, int blit_index)
 			if(!(surface->map->dst->flags & SDL_HWSURFACE)
 				&& SDL_HasAltiVec())
 				return BlitRGBtoRGBPixelAlphaAltivec;
+#endif
+#if SDL_NEON_BLITTERS
+			if(SDL_HasNEON())
+				return BlitRGBtoRGBPixelAlphaNEON;
 #endif
 			return BlitRGBtoRGBPixelAlpha;
 		}
@@ -2860,6 +3027,16 @@ SDL_loblit SDL_CalculateAlphaBlit(SDL_Surface *surface, int blit_index)
 	        !(surface->map->dst->flags & SDL_HWSURFACE) && SDL_HasAltiVec())
 		return Blit32to32PixelAlphaAltivec;
 	    else
+#endif
+#if SDL_SSE2_BLITTERS
+	    if (sf->BytesPerPixel == 4 && SDL_HasSSE2())
+		return BlitNtoNPixelAlphaSSE2;
+	    else
+#endif
+#if SDL_NEON_BLITTERS
+	    if (sf->BytesPerPixel == 4 && SDL_HasNEON())
+		return BlitNtoNPixelAlphaNEON;
+	    else
 #endif
 		return BlitNtoNPixelAlpha;
 
@@ -0,0 +1,254 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* NEON row kernels for the per-pixel alpha blitters
+
+   These follow the arithmetic of the C code step by step, wraparound
+   included, so the pixels come out the same.  Blocks where every source
+   pixel is transparent are skipped, and blocks where every one is opaque
+   are copied, where the C code does the same.
+*/
+
+#include "SDL_video.h"
+#include "SDL_blit_A_NEON.h"
+
+#if SDL_NEON_BLITTERS
+
+#include <arm_neon.h>
+
+static __inline__ int SDL_AllZero(uint32x4_t v)
+{
+	uint32x2_t t = vorr_u32(vget_low_u32(v), vget_high_u32(v));
+	return (vget_lane_u32(t, 0) | vget_lane_u32(t, 1)) == 0;
+}
+
+static __inline__ int SDL_AllSet(uint32x4_t mask)
+{
+	return SDL_AllZero(vmvnq_u32(mask));
+}
+
+/* The C code blends red and blue together, and green on its own, with
+   32-bit arithmetic */
+int SDL_BlitRGBtoRGBPixelAlpha_NEON(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt)
+{
+	const uint32x4_t rbmask = vdupq_n_u32(0xff00ff);
+	const uint32x4_t gmask = vdupq_n_u32(0xff00);
+	const uint32x4_t amask = vdupq_n_u32(0xff000000);
+	uint32x4_t s, d, alpha, opaque, copy, s1, d1, dg;
+	int i;
+
+	for ( i = 0; i + 4 <= width; i += 4 ) {
+		s = vld1q_u32((const uint32_t *)src);
+		alpha = vshrq_n_u32(s, 24);
+		if ( !SDL_AllZero(alpha) ) {
+			d = vld1q_u32((const uint32_t *)dst);
+			opaque = vceqq_u32(alpha, vdupq_n_u32(SDL_ALPHA_OPAQUE));
+			/* Opaque pixels copy RGB and keep the destination alpha */
+			copy = vorrq_u32(vbicq_u32(s, amask), vandq_u32(d, amask));
+			if ( SDL_AllSet(opaque) ) {
+				d = copy;
+			} else {
+				s1 = vandq_u32(s, rbmask);
+				d1 = vandq_u32(d, rbmask);
+				d1 = vaddq_u32(d1, vshrq_n_u32(
+					vmulq_u32(vsubq_u32(s1, d1), alpha), 8));
+				d1 = vandq_u32(d1, rbmask);
+				s1 = vandq_u32(s, gmask);
+				dg = vandq_u32(d, gmask);
+				dg = vaddq_u32(dg, vshrq_n_u32(
+					vmulq_u32(vsubq_u32(s1, dg), alpha), 8));
+				dg = vandq_u32(dg, gmask);
+				d1 = vorrq_u32(vorrq_u32(d1, dg), vandq_u32(d, amask));
+				d = vbslq_u32(opaque, copy, d1);
+			}
+			vst1q_u32((uint32_t *)dst, d);
+		}
+		src += 16;
+		dst += 16;
+	}
+	return i;
+}
+
+/* The C code converts both pixels to G0R0B with a 5-bit alpha and blends
+   all three channels in one 32-bit multiply.  The arguments describe the
+   two layouts: green is (s & gmask) << gup in the blend and
+   (s >> gdown) & gmask16 when opaque, red is (s >> rdown) & rmask */
+static int SDL_BlitARGBto16PixelAlpha(const Uint8 *src, Uint8 *dst, int width,
+                                      Uint32 gmask, int gup,
+                                      Uint32 gmask16, int gdown,
+                                      Uint32 rmask, int rdown,
+                                      Uint32 fields)
+{
+	const uint32x4_t bmask = vdupq_n_u32(0x1f);
+	const uint32x4_t gm = vdupq_n_u32(gmask);
+	const uint32x4_t gm16 = vdupq_n_u32(gmask16);
+	const uint32x4_t rm = vdupq_n_u32(rmask);
+	const uint32x4_t fm = vdupq_n_u32(fields);
+	const int32x4_t gu = vdupq_n_s32(gup);
+	const int32x4_t gd = vdupq_n_s32(-gdown);
+	const int32x4_t rd = vdupq_n_s32(-rdown);
+	uint32x4_t s[2], a[2], o[2], rb[2], r[2], d0, dd, x;
+	uint16x8_t d;
+	int i, j;
+
+	for ( i = 0; i + 8 <= width; i += 8 ) {
+		s[0] = vld1q_u32((const uint32_t *)src);
+		s[1] = vld1q_u32((const uint32_t *)(src + 16));
+		/* downscale alpha to 5 bits */
+		a[0] = vshrq_n_u32(s[0], 27);
+		a[1] = vshrq_n_u32(s[1], 27);
+		if ( SDL_AllZero(vorrq_u32(a[0], a[1])) ) {
+			src += 32;
+			dst += 16;
+			continue;
+		}
+		o[0] = vceqq_u32(a[0], vdupq_n_u32(SDL_ALPHA_OPAQUE >> 3));
+		o[1] = vceqq_u32(a[1], vdupq_n_u32(SDL_ALPHA_OPAQUE >> 3));
+		for ( j = 0; j < 2; ++j ) {
+			rb[j] = vaddq_u32(vandq_u32(vshlq_u32(s[j], rd), rm),
+			                  vandq_u32(vshrq_n_u32(s[j], 3), bmask));
+			r[j] = vaddq_u32(rb[j], vandq_u32(vshlq_u32(s[j], gd), gm16));
+		}
+		if ( !SDL_AllSet(vandq_u32(o[0], o[1])) ) {
+			d = vld1q_u16((const uint16_t *)dst);
+			for ( j = 0; j < 2; ++j ) {
+				x = vaddq_u32(rb[j], vshlq_u32(vandq_u32(s[j], gm), gu));
+				d0 = vmovl_u16(j ? vget_high_u16(d) : vget_low_u16(d));
+				dd = vandq_u32(vorrq_u32(d0, vshlq_n_u32(d0, 16)), fm);
+				x = vmulq_u32(vsubq_u32(x, dd), a[j]);
+				dd = vaddq_u32(dd, vshrq_n_u32(x, 5));
+				dd = vandq_u32(dd, fm);
+				dd = vorrq_u32(dd, vshrq_n_u32(dd, 16));
+				r[j] = vbslq_u32(o[j], r[j], dd);
+				/* Transparent pixels are left alone, unused bits and all */
+				r[j] = vbslq_u32(vceqq_u32(a[j], vdupq_n_u32(0)), d0, r[j]);
+			}
+		}
+		vst1q_u16((uint16_t *)dst, vcombine_u16(vmovn_u32(r[0]), vmovn_u32(r[1])));
+		src += 32;
+		dst += 16;
+	}
+	return i;
+}
+
+int SDL_BlitARGBto565PixelAlpha_NEON(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt)
+{
+	return SDL_BlitARGBto16PixelAlpha(src, dst, width,
+	                                  0xfc00, 11, 0x7e0, 5,
+	                                  0xf800, 8, 0x07e0f81f);
+}
+
+int SDL_BlitARGBto555PixelAlpha_NEON(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt)
+{
+	return SDL_BlitARGBto16PixelAlpha(src, dst, width,
+	                                  0xf800, 10, 0x3e0, 6,
+	                                  0x7c00, 9, 0x03e07c1f);
+}
+
+/* One channel of a format, unpacked as ((pixel & mask) >> shift) << loss
+   and packed as (value >> loss) << shift, like the C macros */
+typedef struct {
+	uint32x4_t mask;
+	int32x4_t shift;
+	int32x4_t loss;
+} SDL_AlphaChannel;
+
+static void SDL_InitAlphaChannel(SDL_AlphaChannel *channel,
+                                 Uint32 mask, int shift, int loss)
+{
+	channel->mask = vdupq_n_u32(mask);
+	channel->shift = vdupq_n_s32(shift);
+	channel->loss = vdupq_n_s32(loss);
+}
+
+static __inline__ uint32x4_t SDL_UnpackAlphaChannel(uint32x4_t p,
+                                                    const SDL_AlphaChannel *c)
+{
+	p = vandq_u32(p, c->mask);
+	return vshlq_u32(vshlq_u32(p, vnegq_s32(c->shift)), c->loss);
+}
+
+static __inline__ uint32x4_t SDL_PackAlphaChannel(uint32x4_t v,
+                                                  const SDL_AlphaChannel *c)
+{
+	return vshlq_u32(vshlq_u32(v, vnegq_s32(c->loss)), c->shift);
+}
+
+/* ALPHA_BLEND() works on unsigned ints, so a channel getting darker wraps
+   around and leaves bit 24 set, which ASSEMBLE_RGBA() packs along with
+   it.  That happens here too. */
+int SDL_BlitNtoNPixelAlpha_NEON(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt)
+{
+	const int dstbpp = dstfmt->BytesPerPixel;
+	const uint32x4_t round = vdupq_n_u32(255);
+	const uint32x4_t damask = vdupq_n_u32(dstfmt->Amask);
+	SDL_AlphaChannel schan[3], dchan[3], salpha;
+	uint32x4_t s, d, sa, x, dc, p;
+	int i, c;
+
+	/* Channels wider than 8 bits don't fit the C code */
+	if ( (srcfmt->Rloss > 8) || (srcfmt->Gloss > 8) ||
+	     (srcfmt->Bloss > 8) || (srcfmt->Aloss > 8) ||
+	     (dstfmt->Rloss > 8) || (dstfmt->Gloss > 8) ||
+	     (dstfmt->Bloss > 8) || (dstfmt->Aloss > 8) ) {
+		return 0;
+	}
+	SDL_InitAlphaChannel(&schan[0], srcfmt->Rmask, srcfmt->Rshift, srcfmt->Rloss);
+	SDL_InitAlphaChannel(&schan[1], srcfmt->Gmask, srcfmt->Gshift, srcfmt->Gloss);
+	SDL_InitAlphaChannel(&schan[2], srcfmt->Bmask, srcfmt->Bshift, srcfmt->Bloss);
+	SDL_InitAlphaChannel(&salpha, srcfmt->Amask, srcfmt->Ashift, srcfmt->Aloss);
+	SDL_InitAlphaChannel(&dchan[0], dstfmt->Rmask, dstfmt->Rshift, dstfmt->Rloss);
+	SDL_InitAlphaChannel(&dchan[1], dstfmt->Gmask, dstfmt->Gshift, dstfmt->Gloss);
+	SDL_InitAlphaChannel(&dchan[2], dstfmt->Bmask, dstfmt->Bshift, dstfmt->Bloss);
+
+	for ( i = 0; i + 4 <= width; i += 4 ) {
+		s = vld1q_u32((const uint32_t *)src);
+		sa = SDL_UnpackAlphaChannel(s, &salpha);
+		if ( !SDL_AllZero(sa) ) {
+			if ( dstbpp == 2 ) {
+				d = vmovl_u16(vld1_u16((const uint16_t *)dst));
+			} else {
+				d = vld1q_u32((const uint32_t *)dst);
+			}
+			p = vandq_u32(d, damask);
+			for ( c = 0; c < 3; ++c ) {
+				dc = SDL_UnpackAlphaChannel(d, &dchan[c]);
+				x = vsubq_u32(SDL_UnpackAlphaChannel(s, &schan[c]), dc);
+				x = vaddq_u32(vmulq_u32(x, sa), round);
+				x = vaddq_u32(vshrq_n_u32(x, 8), dc);
+				p = vorrq_u32(p, SDL_PackAlphaChannel(x, &dchan[c]));
+			}
+			d = vbslq_u32(vceqq_u32(sa, vdupq_n_u32(0)), d, p);
+			if ( dstbpp == 2 ) {
+				vst1_u16((uint16_t *)dst, vmovn_u32(d));
+			} else {
+				vst1q_u32((uint32_t *)dst, d);
+			}
+		}
+		src += 16;
+		dst += 4 * dstbpp;
+	}
+	return i;
+}
+
+#endif /* SDL_NEON_BLITTERS */
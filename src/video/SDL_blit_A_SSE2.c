@@ -0,0 +1,280 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* SSE2 row kernels for the per-pixel alpha blitters
+
+   These follow the arithmetic of the code they stand in for step by step,
+   wraparound included, so the pixels come out the same.  Blocks where
+   every source pixel is transparent are skipped, and blocks where every
+   one is opaque are copied, where the code they follow does the same.
+   SSE2 has no 32-bit multiply, so one is made from the 16-bit ones; the
+   alpha always fits in 16 bits.
+*/
+
+#include "SDL_video.h"
+#include "SDL_blit_A_SSE2.h"
+
+#if SDL_SSE2_BLITTERS
+
+#include <emmintrin.h>
+
+/* x * a in each 32-bit lane, with a < 65536 in both halves of the lane */
+static __inline__ __m128i SDL_MulAlpha32(__m128i x, __m128i a)
+{
+	return _mm_add_epi32(_mm_mullo_epi16(x, a),
+	                     _mm_slli_epi32(_mm_mulhi_epu16(x, a), 16));
+}
+
+/* Picks b where mask is set, and a elsewhere */
+static __inline__ __m128i SDL_SelectAlpha(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_andnot_si128(mask, a), _mm_and_si128(mask, b));
+}
+
+/* Packs the low 16 bits of each 32-bit lane, without saturating */
+static __inline__ __m128i SDL_PackAlpha16(__m128i lo, __m128i hi)
+{
+	lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+	hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+	return _mm_packs_epi32(lo, hi);
+}
+
+/* The MMX code blends each channel as d + (((s - d) * alpha) >> 8), with
+   16-bit products and 8-bit sums that wrap */
+int SDL_BlitRGBtoRGBPixelAlpha_SSE2(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i amask = _mm_set1_epi32(srcfmt->Amask);
+	const __m128i chanmask = _mm_set1_epi32(~srcfmt->Amask);
+	const __m128i multmask = _mm_unpacklo_epi8(chanmask, chanmask);
+	const __m128i ashift = _mm_cvtsi32_si128(srcfmt->Ashift);
+	__m128i s, d, alpha, transparent, opaque, copy;
+	__m128i a, alo, ahi, lo, hi, dlo, dhi;
+	int i;
+
+	for ( i = 0; i + 4 <= width; i += 4 ) {
+		s = _mm_loadu_si128((const __m128i *)src);
+		alpha = _mm_and_si128(s, amask);
+		transparent = _mm_cmpeq_epi32(alpha, zero);
+		if ( _mm_movemask_epi8(transparent) != 0xFFFF ) {
+			d = _mm_loadu_si128((const __m128i *)dst);
+			opaque = _mm_cmpeq_epi32(alpha, amask);
+			/* Opaque pixels copy RGB and keep the destination alpha */
+			copy = _mm_or_si128(_mm_and_si128(s, chanmask),
+			                    _mm_andnot_si128(chanmask, d));
+			if ( _mm_movemask_epi8(opaque) == 0xFFFF ) {
+				d = copy;
+			} else {
+				a = _mm_srl_epi32(alpha, ashift);
+				a = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+				alo = _mm_and_si128(_mm_unpacklo_epi32(a, a), multmask);
+				ahi = _mm_and_si128(_mm_unpackhi_epi32(a, a), multmask);
+				dlo = _mm_unpacklo_epi8(d, zero);
+				dhi = _mm_unpackhi_epi8(d, zero);
+				lo = _mm_sub_epi16(_mm_unpacklo_epi8(s, zero), dlo);
+				hi = _mm_sub_epi16(_mm_unpackhi_epi8(s, zero), dhi);
+				lo = _mm_srli_epi16(_mm_mullo_epi16(lo, alo), 8);
+				hi = _mm_srli_epi16(_mm_mullo_epi16(hi, ahi), 8);
+				lo = _mm_add_epi8(lo, dlo);
+				hi = _mm_add_epi8(hi, dhi);
+				d = SDL_SelectAlpha(opaque, _mm_packus_epi16(lo, hi), copy);
+			}
+			_mm_storeu_si128((__m128i *)dst, d);
+		}
+		src += 16;
+		dst += 16;
+	}
+	return i;
+}
+
+/* The C code converts both pixels to G0R0B with a 5-bit alpha and blends
+   all three channels in one 32-bit multiply.  The arguments describe the
+   two layouts: green is (s & gmask) << gup in the blend and
+   (s >> gdown) & gmask16 when opaque, red is (s >> rdown) & rmask */
+static int SDL_BlitARGBto16PixelAlpha(const Uint8 *src, Uint8 *dst, int width,
+                                      Uint32 gmask, int gup,
+                                      Uint32 gmask16, int gdown,
+                                      Uint32 rmask, int rdown,
+                                      Uint32 fields)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i opaque = _mm_set1_epi32(SDL_ALPHA_OPAQUE >> 3);
+	const __m128i bmask = _mm_set1_epi32(0x1f);
+	const __m128i gm = _mm_set1_epi32(gmask);
+	const __m128i gm16 = _mm_set1_epi32(gmask16);
+	const __m128i rm = _mm_set1_epi32(rmask);
+	const __m128i fm = _mm_set1_epi32(fields);
+	const __m128i gu = _mm_cvtsi32_si128(gup);
+	const __m128i gd = _mm_cvtsi32_si128(gdown);
+	const __m128i rd = _mm_cvtsi32_si128(rdown);
+	__m128i s[2], a[2], o[2], rb[2], r[2], d, d0, dd, x;
+	int i, j;
+
+	for ( i = 0; i + 8 <= width; i += 8 ) {
+		s[0] = _mm_loadu_si128((const __m128i *)src);
+		s[1] = _mm_loadu_si128((const __m128i *)(src + 16));
+		/* downscale alpha to 5 bits */
+		a[0] = _mm_srli_epi32(s[0], 27);
+		a[1] = _mm_srli_epi32(s[1], 27);
+		if ( _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_or_si128(a[0], a[1]), zero)) == 0xFFFF ) {
+			src += 32;
+			dst += 16;
+			continue;
+		}
+		o[0] = _mm_cmpeq_epi32(a[0], opaque);
+		o[1] = _mm_cmpeq_epi32(a[1], opaque);
+		for ( j = 0; j < 2; ++j ) {
+			rb[j] = _mm_add_epi32(_mm_and_si128(_mm_srl_epi32(s[j], rd), rm),
+			                      _mm_and_si128(_mm_srli_epi32(s[j], 3), bmask));
+			r[j] = _mm_add_epi32(rb[j],
+				_mm_and_si128(_mm_srl_epi32(s[j], gd), gm16));
+		}
+		if ( _mm_movemask_epi8(_mm_and_si128(o[0], o[1])) != 0xFFFF ) {
+			d = _mm_loadu_si128((const __m128i *)dst);
+			for ( j = 0; j < 2; ++j ) {
+				x = _mm_add_epi32(rb[j],
+					_mm_sll_epi32(_mm_and_si128(s[j], gm), gu));
+				d0 = j ? _mm_unpackhi_epi16(d, zero) : _mm_unpacklo_epi16(d, zero);
+				dd = _mm_and_si128(_mm_or_si128(d0, _mm_slli_epi32(d0, 16)), fm);
+				x = SDL_MulAlpha32(_mm_sub_epi32(x, dd),
+					_mm_or_si128(a[j], _mm_slli_epi32(a[j], 16)));
+				dd = _mm_add_epi32(dd, _mm_srli_epi32(x, 5));
+				dd = _mm_and_si128(dd, fm);
+				dd = _mm_or_si128(dd, _mm_srli_epi32(dd, 16));
+				r[j] = SDL_SelectAlpha(o[j], dd, r[j]);
+				/* Transparent pixels are left alone, unused bits and all */
+				r[j] = SDL_SelectAlpha(_mm_cmpeq_epi32(a[j], zero), r[j], d0);
+			}
+		}
+		_mm_storeu_si128((__m128i *)dst, SDL_PackAlpha16(r[0], r[1]));
+		src += 32;
+		dst += 16;
+	}
+	return i;
+}
+
+int SDL_BlitARGBto565PixelAlpha_SSE2(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt)
+{
+	return SDL_BlitARGBto16PixelAlpha(src, dst, width,
+	                                  0xfc00, 11, 0x7e0, 5,
+	                                  0xf800, 8, 0x07e0f81f);
+}
+
+int SDL_BlitARGBto555PixelAlpha_SSE2(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt)
+{
+	return SDL_BlitARGBto16PixelAlpha(src, dst, width,
+	                                  0xf800, 10, 0x3e0, 6,
+	                                  0x7c00, 9, 0x03e07c1f);
+}
+
+/* One channel of a format, unpacked as ((pixel & mask) >> shift) << loss
+   and packed as (value >> loss) << shift, like the C macros */
+typedef struct {
+	__m128i mask;
+	__m128i shift;
+	__m128i loss;
+} SDL_AlphaChannel;
+
+static void SDL_InitAlphaChannel(SDL_AlphaChannel *channel,
+                                 Uint32 mask, int shift, int loss)
+{
+	channel->mask = _mm_set1_epi32(mask);
+	channel->shift = _mm_cvtsi32_si128(shift);
+	channel->loss = _mm_cvtsi32_si128(loss);
+}
+
+static __inline__ __m128i SDL_UnpackAlphaChannel(__m128i p,
+                                                 const SDL_AlphaChannel *c)
+{
+	p = _mm_and_si128(p, c->mask);
+	return _mm_sll_epi32(_mm_srl_epi32(p, c->shift), c->loss);
+}
+
+static __inline__ __m128i SDL_PackAlphaChannel(__m128i v,
+                                               const SDL_AlphaChannel *c)
+{
+	return _mm_sll_epi32(_mm_srl_epi32(v, c->loss), c->shift);
+}
+
+/* ALPHA_BLEND() works on unsigned ints, so a channel getting darker wraps
+   around and leaves bit 24 set, which ASSEMBLE_RGBA() packs along with
+   it.  That happens here too. */
+int SDL_BlitNtoNPixelAlpha_SSE2(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt)
+{
+	const int dstbpp = dstfmt->BytesPerPixel;
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i round = _mm_set1_epi32(255);
+	const __m128i damask = _mm_set1_epi32(dstfmt->Amask);
+	SDL_AlphaChannel schan[3], dchan[3], salpha;
+	__m128i s, d, sa, a, transparent, x, dc, p;
+	int i, c;
+
+	/* Channels wider than 8 bits don't fit the C code */
+	if ( (srcfmt->Rloss > 8) || (srcfmt->Gloss > 8) ||
+	     (srcfmt->Bloss > 8) || (srcfmt->Aloss > 8) ||
+	     (dstfmt->Rloss > 8) || (dstfmt->Gloss > 8) ||
+	     (dstfmt->Bloss > 8) || (dstfmt->Aloss > 8) ) {
+		return 0;
+	}
+	SDL_InitAlphaChannel(&schan[0], srcfmt->Rmask, srcfmt->Rshift, srcfmt->Rloss);
+	SDL_InitAlphaChannel(&schan[1], srcfmt->Gmask, srcfmt->Gshift, srcfmt->Gloss);
+	SDL_InitAlphaChannel(&schan[2], srcfmt->Bmask, srcfmt->Bshift, srcfmt->Bloss);
+	SDL_InitAlphaChannel(&salpha, srcfmt->Amask, srcfmt->Ashift, srcfmt->Aloss);
+	SDL_InitAlphaChannel(&dchan[0], dstfmt->Rmask, dstfmt->Rshift, dstfmt->Rloss);
+	SDL_InitAlphaChannel(&dchan[1], dstfmt->Gmask, dstfmt->Gshift, dstfmt->Gloss);
+	SDL_InitAlphaChannel(&dchan[2], dstfmt->Bmask, dstfmt->Bshift, dstfmt->Bloss);
+
+	for ( i = 0; i + 4 <= width; i += 4 ) {
+		s = _mm_loadu_si128((const __m128i *)src);
+		sa = SDL_UnpackAlphaChannel(s, &salpha);
+		transparent = _mm_cmpeq_epi32(sa, zero);
+		if ( _mm_movemask_epi8(transparent) != 0xFFFF ) {
+			if ( dstbpp == 2 ) {
+				d = _mm_loadl_epi64((const __m128i *)dst);
+				d = _mm_unpacklo_epi16(d, zero);
+			} else {
+				d = _mm_loadu_si128((const __m128i *)dst);
+			}
+			a = _mm_or_si128(sa, _mm_slli_epi32(sa, 16));
+			p = _mm_and_si128(d, damask);
+			for ( c = 0; c < 3; ++c ) {
+				dc = SDL_UnpackAlphaChannel(d, &dchan[c]);
+				x = _mm_sub_epi32(SDL_UnpackAlphaChannel(s, &schan[c]), dc);
+				x = _mm_add_epi32(SDL_MulAlpha32(x, a), round);
+				x = _mm_add_epi32(_mm_srli_epi32(x, 8), dc);
+				p = _mm_or_si128(p, SDL_PackAlphaChannel(x, &dchan[c]));
+			}
+			d = SDL_SelectAlpha(transparent, p, d);
+			if ( dstbpp == 2 ) {
+				_mm_storel_epi64((__m128i *)dst, SDL_PackAlpha16(d, d));
+			} else {
+				_mm_storeu_si128((__m128i *)dst, d);
+			}
+		}
+		src += 16;
+		dst += 4 * dstbpp;
+	}
+	return i;
+}
+
+#endif /* SDL_SSE2_BLITTERS */
@@ -25,6 +25,8 @@
 #include "SDL_endian.h"
 #include "SDL_cpuinfo.h"
 #include "SDL_blit.h"
+#include "SDL_blit_N_SSE2.h"
+#include "SDL_blit_N_NEON.h"
 
 /* Functions to blit from N-bit surfaces to other surfaces */
 
@@ -837,8 +839,28 @@ static Uint32 GetBlitFeatures( void )
 #pragma altivec_model off
 #endif
 #else
-/* Feature 1 is has-MMX */
-#define GetBlitFeatures() ((Uint32)(SDL_HasMMX() ? 1 : 0))
+static Uint32 GetBlitFeatures( void )
+{
+    static Uint32 features = 0xffffffff;
+    if (features == 0xffffffff) {
+        /* Provide an override for testing .. */
+        char *override = SDL_getenv("SDL_BLIT_FEATURES");
+        if (override) {
+            features = 0;
+            SDL_sscanf(override, "%u", &features);
+        } else {
+            features = ( 0
+                /* Feature 1 is has-MMX */
+                | ((SDL_HasMMX()) ? 1 : 0)
+                /* Feature 8 is has-SSE2 */
+                | ((SDL_HasSSE2()) ? 8 : 0)
+                /* Feature 16 is has-NEON */
+                | ((SDL_HasNEON()) ? 16 : 0)
+            );
+        }
+    }
+    return features;
+}
 #endif
 
 /* This is now endian dependent */
@@ -2269,6 +2291,219 @@ static void BlitNtoNKeyCopyAlpha(SDL_BlitInfo *info)
 	}
 }
 
+#if SDL_SSE2_BLITTERS || SDL_NEON_BLITTERS
+/* The vector kernels convert as much of each row as they can, and return
+   the number of pixels they did.  These run them and finish each row with
+   the C code of the blitter they stand in for.
+ */
+typedef int (*SDL_BlitRow)(const Uint8 *src, Uint8 *dst, int width,
+                           const SDL_PixelFormat *srcfmt,
+                           const SDL_PixelFormat *dstfmt);
+
+/* aux_data is the lookup table the C code would use */
+static void Blit_RGB565_32Rows(SDL_BlitInfo *info, SDL_BlitRow kernel)
+{
+	int width = info->d_width;
+	int height = info->d_height;
+	Uint8 *src = info->s_pixels;
+	int srcskip = info->s_skip;
+	Uint32 *dst = (Uint32 *)info->d_pixels;
+	int dstskip = info->d_skip/4;
+	const Uint32 *map = (const Uint32 *)info->aux_data;
+	int n;
+
+	while ( height-- ) {
+		n = kernel(src, (Uint8 *)dst, width, info->src, info->dst);
+		src += n*2;
+		dst += n;
+		for ( n = width - n; n; --n ) {
+			*dst++ = RGB565_32(dst, src, map);
+			src += 2;
+		}
+		src += srcskip;
+		dst += dstskip;
+	}
+}
+
+static void BlitNtoNRows(SDL_BlitInfo *info, SDL_BlitRow kernel)
+{
+	int width = info->d_width;
+	int height = info->d_height;
+	Uint8 *src = info->s_pixels;
+	int srcskip = info->s_skip;
+	Uint8 *dst = info->d_pixels;
+	int dstskip = info->d_skip;
+	SDL_PixelFormat *srcfmt = info->src;
+	int srcbpp = srcfmt->BytesPerPixel;
+	SDL_PixelFormat *dstfmt = info->dst;
+	int dstbpp = dstfmt->BytesPerPixel;
+	unsigned alpha = dstfmt->Amask ? srcfmt->alpha : 0;
+	int copy_alpha = (srcfmt->Amask && dstfmt->Amask);
+	int n;
+
+	while ( height-- ) {
+		n = kernel(src, dst, width, srcfmt, dstfmt);
+		src += n*srcbpp;
+		dst += n*dstbpp;
+		for ( n = width - n; n; --n ) {
+		        Uint32 Pixel;
+			unsigned sR, sG, sB, sA;
+			if ( copy_alpha ) {
+				DISEMBLE_RGBA(src, srcbpp, srcfmt, Pixel,
+					      sR, sG, sB, sA);
+				ASSEMBLE_RGBA(dst, dstbpp, dstfmt,
+					      sR, sG, sB, sA);
+			} else {
+				DISEMBLE_RGB(src, srcbpp, srcfmt, Pixel,
+					     sR, sG, sB);
+				ASSEMBLE_RGBA(dst, dstbpp, dstfmt,
+					      sR, sG, sB, alpha);
+			}
+			dst += dstbpp;
+			src += srcbpp;
+		}
+		src += srcskip;
+		dst += dstskip;
+	}
+}
+
+static void Blit4to4MaskAlphaRows(SDL_BlitInfo *info, SDL_BlitRow kernel)
+{
+	int width = info->d_width;
+	int height = info->d_height;
+	Uint32 *src = (Uint32 *)info->s_pixels;
+	int srcskip = info->s_skip;
+	Uint32 *dst = (Uint32 *)info->d_pixels;
+	int dstskip = info->d_skip;
+	SDL_PixelFormat *srcfmt = info->src;
+	SDL_PixelFormat *dstfmt = info->dst;
+	Uint32 keep, set;
+	int n;
+
+	if (dstfmt->Amask) {
+		keep = 0xFFFFFFFF;
+		set = (srcfmt->alpha >> dstfmt->Aloss) << dstfmt->Ashift;
+	} else {
+		keep = srcfmt->Rmask | srcfmt->Gmask | srcfmt->Bmask;
+		set = 0;
+	}
+	while ( height-- ) {
+		n = kernel((Uint8 *)src, (Uint8 *)dst, width, srcfmt, dstfmt);
+		src += n;
+		dst += n;
+		for ( n = width - n; n; --n ) {
+			*dst = (*src & keep) | set;
+			++dst;
+			++src;
+		}
+		src = (Uint32*)((Uint8*)src + srcskip);
+		dst = (Uint32*)((Uint8*)dst + dstskip);
+	}
+}
+
+static void BlitNtoNKeyRows(SDL_BlitInfo *info, SDL_BlitRow kernel)
+{
+	int width = info->d_width;
+	int height = info->d_height;
+	Uint8 *src = info->s_pixels;
+	int srcskip = info->s_skip;
+	Uint8 *dst = info->d_pixels;
+	int dstskip = info->d_skip;
+	SDL_PixelFormat *srcfmt = info->src;
+	int srcbpp = srcfmt->BytesPerPixel;
+	SDL_PixelFormat *dstfmt = info->dst;
+	int dstbpp = dstfmt->BytesPerPixel;
+	unsigned alpha = dstfmt->Amask ? srcfmt->alpha : 0;
+	int copy_alpha = (srcfmt->Amask && dstfmt->Amask);
+	Uint32 rgbmask = ~srcfmt->Amask;
+	Uint32 ckey = srcfmt->colorkey & rgbmask;
+	int n;
+
+	while ( height-- ) {
+		n = kernel(src, dst, width, srcfmt, dstfmt);
+		src += n*srcbpp;
+		dst += n*dstbpp;
+		for ( n = width - n; n; --n ) {
+		        Uint32 Pixel;
+			unsigned sR, sG, sB, sA;
+			DISEMBLE_RGBA(src, srcbpp, srcfmt, Pixel,
+				      sR, sG, sB, sA);
+			if ( (Pixel & rgbmask) != ckey ) {
+				if ( !copy_alpha ) {
+					sA = alpha;
+				}
+				ASSEMBLE_RGBA(dst, dstbpp, dstfmt,
+					      sR, sG, sB, sA);
+			}
+			dst += dstbpp;
+			src += srcbpp;
+		}
+		src += srcskip;
+		dst += dstskip;
+	}
+}
+#endif /* SDL_SSE2_BLITTERS || SDL_NEON_BLITTERS */
+
+#if SDL_SSE2_BLITTERS
+static void Blit_RGB565_32SSE2(SDL_BlitInfo *info)
+{
+	Blit_RGB565_32Rows(info, SDL_Blit_RGB565_32_SSE2);
+}
+static void Blit_RGB565_32XSSE2(SDL_BlitInfo *info)
+{
+	BlitNtoNRows(info, SDL_Blit_RGB565_32X_SSE2);
+}
+static void Blit32to16SSE2(SDL_BlitInfo *info)
+{
+	BlitNtoNRows(info, SDL_Blit32to16_SSE2);
+}
+static void Blit32to32SSE2(SDL_BlitInfo *info)
+{
+	/* Matching RGB masks take the Blit4to4MaskAlpha() shortcut */
+	if ( info->src->Rmask == info->dst->Rmask &&
+	     info->src->Gmask == info->dst->Gmask &&
+	     info->src->Bmask == info->dst->Bmask ) {
+		Blit4to4MaskAlphaRows(info, SDL_Blit4to4MaskAlpha_SSE2);
+	} else {
+		BlitNtoNRows(info, SDL_Blit32to32_SSE2);
+	}
+}
+static void Blit32to32KeySSE2(SDL_BlitInfo *info)
+{
+	BlitNtoNKeyRows(info, SDL_Blit32to32Key_SSE2);
+}
+#endif /* SDL_SSE2_BLITTERS */
+
+#if SDL_NEON_BLITTERS
+static void Blit_RGB565_32NEON(SDL_BlitInfo *info)
+{
+	Blit_RGB565_32Rows(info, SDL_Blit_RGB565_32_NEON);
+}
+static void Blit_RGB565_32XNEON(SDL_BlitInfo *info)
+{
+	BlitNtoNRows(info, SDL_Blit_RGB565_32X_NEON);
+}
+static void Blit32to16NEON(SDL_BlitInfo *info)
+{
+	BlitNtoNRows(info, SDL_Blit32to16_NEON);
+}
+static void Blit32to32NEON(SDL_BlitInfo *info)
+{
+	/* Matching RGB masks take the Blit4to4MaskAlpha() shortcut */
+	if ( info->src->Rmask == info->dst->Rmask &&
+	     info->src->Gmask == info->dst->Gmask &&
+	     info->src->Bmask == info->dst->Bmask ) {
+		Blit4to4MaskAlphaRows(info, SDL_Blit4to4MaskAlpha_NEON);
+	} else {
+		BlitNtoNRows(info, SDL_Blit32to32_NEON);
+	}
+}
+static void Blit32to32KeyNEON(SDL_BlitInfo *info)
+{
+	BlitNtoNKeyRows(info, SDL_Blit32to32Key_NEON);
+}
+#endif /* SDL_NEON_BLITTERS */
+
 /* Normal N to N optimized blitters */
 struct blit_table {
 	Uint32 srcR, srcG, srcB;
@@ -2297,6 +2532,44 @@ static const struct blit_table normal_blit_2[] = {
       2, NULL, Blit_RGB565_32Altivec, NO_ALPHA | COPY_ALPHA | SET_ALPHA },
     { 0x00007C00,0x000003E0,0x0000001F, 4, 0x00000000,0x00000000,0x00000000,
       2, NULL, Blit_RGB555_32Altivec, NO_ALPHA | COPY_ALPHA | SET_ALPHA },
+#endif
+#if SDL_SSE2_BLITTERS
+    /* has-SSE2 */
+    { 0x0000F800,0x000007E0,0x0000001F, 4, 0x00FF0000,0x0000FF00,0x000000FF,
+      8, (void *)RGB565_ARGB8888_LUT, Blit_RGB565_32SSE2, SET_ALPHA },
+    { 0x0000F800,0x000007E0,0x0000001F, 4, 0x000000FF,0x0000FF00,0x00FF0000,
+      8, (void *)RGB565_ABGR8888_LUT, Blit_RGB565_32SSE2, SET_ALPHA },
+    { 0x0000F800,0x000007E0,0x0000001F, 4, 0xFF000000,0x00FF0000,0x0000FF00,
+      8, (void *)RGB565_RGBA8888_LUT, Blit_RGB565_32SSE2, SET_ALPHA },
+    { 0x0000F800,0x000007E0,0x0000001F, 4, 0x0000FF00,0x00FF0000,0xFF000000,
+      8, (void *)RGB565_BGRA8888_LUT, Blit_RGB565_32SSE2, SET_ALPHA },
+    { 0x0000F800,0x000007E0,0x0000001F, 4, 0x00FF0000,0x0000FF00,0x000000FF,
+      8, NULL, Blit_RGB565_32XSSE2, NO_ALPHA },
+    { 0x0000F800,0x000007E0,0x0000001F, 4, 0x000000FF,0x0000FF00,0x00FF0000,
+      8, NULL, Blit_RGB565_32XSSE2, NO_ALPHA },
+    { 0x0000F800,0x000007E0,0x0000001F, 4, 0xFF000000,0x00FF0000,0x0000FF00,
+      8, NULL, Blit_RGB565_32XSSE2, NO_ALPHA },
+    { 0x0000F800,0x000007E0,0x0000001F, 4, 0x0000FF00,0x00FF0000,0xFF000000,
+      8, NULL, Blit_RGB565_32XSSE2, NO_ALPHA },
+#endif
+#if SDL_NEON_BLITTERS
+    /* has-NEON */
+    { 0x0000F800,0x000007E0,0x0000001F, 4, 0x00FF0000,0x0000FF00,0x000000FF,
+      16, (void *)RGB565_ARGB8888_LUT, Blit_RGB565_32NEON, SET_ALPHA },
+    { 0x0000F800,0x000007E0,0x0000001F, 4, 0x000000FF,0x0000FF00,0x00FF0000,
+      16, (void *)RGB565_ABGR8888_LUT, Blit_RGB565_32NEON, SET_ALPHA },
+    { 0x0000F800,0x000007E0,0x0000001F, 4, 0xFF000000,0x00FF0000,0x0000FF00,
+      16, (void *)RGB565_RGBA8888_LUT, Blit_RGB565_32NEON, SET_ALPHA },
+    { 0x0000F800,0x000007E0,0x0000001F, 4, 0x0000FF00,0x00FF0000,0xFF000000,
+      16, (void *)RGB565_BGRA8888_LUT, Blit_RGB565_32NEON, SET_ALPHA },
+    { 0x0000F800,0x000007E0,0x0000001F, 4, 0x00FF0000,0x0000FF00,0x000000FF,
+      16, NULL, Blit_RGB565_32XNEON, NO_ALPHA },
+    { 0x0000F800,0x000007E0,0x0000001F, 4, 0x000000FF,0x0000FF00,0x00FF0000,
+      16, NULL, Blit_RGB565_32XNEON, NO_ALPHA },
+    { 0x0000F800,0x000007E0,0x0000001F, 4, 0xFF000000,0x00FF0000,0x0000FF00,
+      16, NULL, Blit_RGB565_32XNEON, NO_ALPHA },
+    { 0x0000F800,0x000007E0,0x0000001F, 4, 0x0000FF00,0x00FF0000,0xFF000000,
+      16, NULL, Blit_RGB565_32XNEON, NO_ALPHA },
 #endif
     { 0x0000F800,0x000007E0,0x0000001F, 4, 0x00FF0000,0x0000FF00,0x000000FF,
       0, NULL, Blit_RGB565_ARGB8888, SET_ALPHA },
@@ -2315,6 +2588,20 @@ static const struct blit_table normal_blit_3[] = {
     { 0,0,0, 0, 0,0,0, 0, NULL, BlitNtoN, 0 }
 };
 static const struct blit_table normal_blit_4[] = {
+#if SDL_SSE2_BLITTERS
+    /* has-SSE2 */
+    { 0x00000000,0x00000000,0x00000000, 2, 0x00000000,0x00000000,0x00000000,
+      8, NULL, Blit32to16SSE2, NO_ALPHA },
+    { 0x00000000,0x00000000,0x00000000, 4, 0x00000000,0x00000000,0x00000000,
+      8, NULL, Blit32to32SSE2, NO_ALPHA | COPY_ALPHA | SET_ALPHA },
+#endif
+#if SDL_NEON_BLITTERS
+    /* has-NEON */
+    { 0x00000000,0x00000000,0x00000000, 2, 0x00000000,0x00000000,0x00000000,
+      16, NULL, Blit32to16NEON, NO_ALPHA },
+    { 0x00000000,0x00000000,0x00000000, 4, 0x00000000,0x00000000,0x00000000,
+      16, NULL, Blit32to32NEON, NO_ALPHA | COPY_ALPHA | SET_ALPHA },
+#endif
 #if SDL_HERMES_BLITTERS
     { 0x00FF0000,0x0000FF00,0x000000FF, 2, 0x0000F800,0x000007E0,0x0000001F,
       1, ConvertMMXpII32_16RGB565, ConvertMMX, NO_ALPHA },
@@ -2368,6 +2655,53 @@ static const struct blit_table *normal_blit[] = {
 	normal_blit_1, normal_blit_2, normal_blit_3, normal_blit_4
 };
 
+const SDL_BlitName SDL_BlitNamesN[] = {
+#if SDL_HERMES_BLITTERS
+	SDL_BLIT_NAME(ConvertMMX),
+	SDL_BLIT_NAME(ConvertX86),
+#else
+	SDL_BLIT_NAME(Blit_RGB888_index8),
+	SDL_BLIT_NAME(Blit_RGB888_RGB565),
+	SDL_BLIT_NAME(Blit_RGB888_RGB555),
+#endif
+#if SDL_ALTIVEC_BLITTERS
+	SDL_BLIT_NAME(Blit_RGB565_32Altivec),
+	SDL_BLIT_NAME(Blit_RGB555_32Altivec),
+	SDL_BLIT_NAME(Blit_RGB888_RGB565Altivec),
+	SDL_BLIT_NAME(ConvertAltivec32to32_noprefetch),
+	SDL_BLIT_NAME(ConvertAltivec32to32_prefetch),
+	SDL_BLIT_NAME(Blit32to32KeyAltivec),
+#endif
+#if SDL_SSE2_BLITTERS
+	SDL_BLIT_NAME(Blit_RGB565_32SSE2),
+	SDL_BLIT_NAME(Blit_RGB565_32XSSE2),
+	SDL_BLIT_NAME(Blit32to16SSE2),
+	SDL_BLIT_NAME(Blit32to32SSE2),
+	SDL_BLIT_NAME(Blit32to32KeySSE2),
+#endif
+#if SDL_NEON_BLITTERS
+	SDL_BLIT_NAME(Blit_RGB565_32NEON),
+	SDL_BLIT_NAME(Blit_RGB565_32XNEON),
+	SDL_BLIT_NAME(Blit32to16NEON),
+	SDL_BLIT_NAME(Blit32to32NEON),
+	SDL_BLIT_NAME(Blit32to32KeyNEON),
+#endif
+	SDL_BLIT_NAME(Blit_RGB565_ARGB8888),
+	SDL_BLIT_NAME(Blit_RGB565_ABGR8888),
+	SDL_BLIT_NAME(Blit_RGB565_RGBA8888),
+	SDL_BLIT_NAME(Blit_RGB565_BGRA8888),
+	SDL_BLIT_NAME(Blit_RGB888_index8_map),
+	SDL_BLIT_NAME(Blit4to4MaskAlpha),
+	SDL_BLIT_NAME(Blit2to2Key),
+	SDL_BLIT_NAME(BlitNto1),
+	SDL_BLIT_NAME(BlitNto1Key),
+	SDL_BLIT_NAME(BlitNtoN),
+	SDL_BLIT_NAME(BlitNtoNCopyAlpha),
+	SDL_BLIT_NAME(BlitNtoNKey),
+	SDL_BLIT_NAME(BlitNtoNKeyCopyAlpha),
+	{ NULL, NULL }
+};
+
 /* Mask matches table, or table entry is zero */
 #define MASKOK(x, y) (((x) == (y)) || ((y) == 0x00000000))
 
@@ -2411,6 +2745,16 @@ SDL_loblit SDL_CalculateBlitN(SDL_Surface *surface, int blit_index)
             return Blit32to32KeyAltivec;
         } else
 #endif
+#if SDL_SSE2_BLITTERS
+        if((srcfmt->BytesPerPixel == 4) && (dstfmt->BytesPerPixel == 4) && (GetBlitFeatures() & 8)) {
+            return Blit32to32KeySSE2;
+        } else
+#endif
+#if SDL_NEON_BLITTERS
+        if((srcfmt->BytesPerPixel == 4) && (dstfmt->BytesPerPixel == 4) && (GetBlitFeatures() & 16)) {
+            return Blit32to32KeyNEON;
+        } else
+#endif
 
 		if(srcfmt->Amask && dstfmt->Amask)
 		    return BlitNtoNKeyCopyAlpha;
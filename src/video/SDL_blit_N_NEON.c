@@ -0,0 +1,296 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* NEON row kernels for the N to N blitters
+
+   The C code unpacks each channel to 8 bits and packs it again, which
+   for a channel of a 32-bit pixel comes to ((pixel & mask) >> down) << up.
+   The kernels do that four pixels at a time, with the shift counts worked
+   out from the two formats at the start of each row.  NEON shifts right
+   by a negative left shift.
+*/
+
+#include "SDL_video.h"
+#include "SDL_blit_N_NEON.h"
+
+#if SDL_NEON_BLITTERS
+
+#include <arm_neon.h>
+
+typedef struct {
+	uint32x4_t mask;
+	int32x4_t down;
+	int32x4_t up;
+} SDL_BlitChannel;
+
+static void SDL_InitBlitChannel(SDL_BlitChannel *channel, Uint32 mask,
+                                int srcshift, int srcloss,
+                                int dstshift, int dstloss)
+{
+	int down = srcshift;
+	int up = dstshift;
+
+	if ( dstloss > srcloss ) {
+		down += dstloss - srcloss;
+	} else {
+		up += srcloss - dstloss;
+	}
+	channel->mask = vdupq_n_u32(mask);
+	channel->down = vdupq_n_s32(-down);
+	channel->up = vdupq_n_s32(up);
+}
+
+/* Channels wider than 8 bits don't fit the C code, which shifts them by
+   a negative loss, so those formats are all left to it */
+static int SDL_InitBlitChannels(SDL_BlitChannel *channels,
+                                const SDL_PixelFormat *srcfmt,
+                                const SDL_PixelFormat *dstfmt)
+{
+	if ( (srcfmt->Rloss > 8) || (srcfmt->Gloss > 8) ||
+	     (srcfmt->Bloss > 8) || (srcfmt->Aloss > 8) ||
+	     (dstfmt->Rloss > 8) || (dstfmt->Gloss > 8) ||
+	     (dstfmt->Bloss > 8) || (dstfmt->Aloss > 8) ) {
+		return 0;
+	}
+	SDL_InitBlitChannel(&channels[0], srcfmt->Rmask, srcfmt->Rshift,
+	                    srcfmt->Rloss, dstfmt->Rshift, dstfmt->Rloss);
+	SDL_InitBlitChannel(&channels[1], srcfmt->Gmask, srcfmt->Gshift,
+	                    srcfmt->Gloss, dstfmt->Gshift, dstfmt->Gloss);
+	SDL_InitBlitChannel(&channels[2], srcfmt->Bmask, srcfmt->Bshift,
+	                    srcfmt->Bloss, dstfmt->Bshift, dstfmt->Bloss);
+	SDL_InitBlitChannel(&channels[3], srcfmt->Amask, srcfmt->Ashift,
+	                    srcfmt->Aloss, dstfmt->Ashift, dstfmt->Aloss);
+	return 1;
+}
+
+static __inline__ uint32x4_t SDL_MoveBlitChannel(uint32x4_t p,
+                                                 const SDL_BlitChannel *channel)
+{
+	p = vandq_u32(p, channel->mask);
+	return vshlq_u32(vshlq_u32(p, channel->down), channel->up);
+}
+
+/* Converts four pixels, copying alpha when 'copy_alpha' is set and
+   or-ing in 'alpha' otherwise */
+static __inline__ uint32x4_t SDL_ConvertBlitPixels(uint32x4_t p,
+                                                   const SDL_BlitChannel *channels,
+                                                   int copy_alpha, uint32x4_t alpha)
+{
+	uint32x4_t d;
+
+	d = vorrq_u32(SDL_MoveBlitChannel(p, &channels[0]),
+	              SDL_MoveBlitChannel(p, &channels[1]));
+	d = vorrq_u32(d, SDL_MoveBlitChannel(p, &channels[2]));
+	if ( copy_alpha ) {
+		d = vorrq_u32(d, SDL_MoveBlitChannel(p, &channels[3]));
+	} else {
+		d = vorrq_u32(d, alpha);
+	}
+	return d;
+}
+
+/* The constant alpha BlitNtoN() gives pixels from a source without it */
+static Uint32 SDL_BlitSetAlpha(const SDL_PixelFormat *srcfmt,
+                               const SDL_PixelFormat *dstfmt)
+{
+	if ( !dstfmt->Amask ) {
+		return 0;
+	}
+	return ((Uint32)srcfmt->alpha >> dstfmt->Aloss) << dstfmt->Ashift;
+}
+
+/* Channels are widened the way the lookup tables do it, which is r*255/31
+   and b*255/31 rounded down, computed here as (x*1053)>>7.  The tables
+   split green between the two bytes of the pixel, so the top 3 bits are
+   widened as (g*2040/63), or (g*259)>>3, and the low 3 bits are added in
+   shifted up by 2.  The bits left over in the destination are all set. */
+int SDL_Blit_RGB565_32_NEON(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt)
+{
+	const uint16x8_t mask5 = vdupq_n_u16(0x1F);
+	const uint16x8_t mask6 = vdupq_n_u16(0x3F);
+	const uint16x8_t mask3 = vdupq_n_u16(0x07);
+	const int32x4_t rshift = vdupq_n_s32(dstfmt->Rshift);
+	const int32x4_t gshift = vdupq_n_s32(dstfmt->Gshift);
+	const int32x4_t bshift = vdupq_n_s32(dstfmt->Bshift);
+	const uint32x4_t alpha = vdupq_n_u32(
+		~(dstfmt->Rmask | dstfmt->Gmask | dstfmt->Bmask));
+	uint16x8_t p, r, g, b;
+	uint32x4_t d;
+	int i;
+
+	for ( i = 0; i + 8 <= width; i += 8 ) {
+		p = vld1q_u16((const uint16_t *)src);
+		r = vshrq_n_u16(p, 11);
+		g = vandq_u16(vshrq_n_u16(p, 5), mask6);
+		b = vandq_u16(p, mask5);
+		r = vshrq_n_u16(vmulq_n_u16(r, 1053), 7);
+		g = vaddq_u16(vshrq_n_u16(vmulq_n_u16(vshrq_n_u16(g, 3), 259), 3),
+		              vshlq_n_u16(vandq_u16(g, mask3), 2));
+		b = vshrq_n_u16(vmulq_n_u16(b, 1053), 7);
+
+		d = vorrq_u32(vshlq_u32(vmovl_u16(vget_low_u16(r)), rshift),
+		              vshlq_u32(vmovl_u16(vget_low_u16(g)), gshift));
+		d = vorrq_u32(d, vshlq_u32(vmovl_u16(vget_low_u16(b)), bshift));
+		vst1q_u32((uint32_t *)dst, vorrq_u32(d, alpha));
+
+		d = vorrq_u32(vshlq_u32(vmovl_u16(vget_high_u16(r)), rshift),
+		              vshlq_u32(vmovl_u16(vget_high_u16(g)), gshift));
+		d = vorrq_u32(d, vshlq_u32(vmovl_u16(vget_high_u16(b)), bshift));
+		vst1q_u32((uint32_t *)(dst + 16), vorrq_u32(d, alpha));
+
+		src += 16;
+		dst += 32;
+	}
+	return i;
+}
+
+/* For destinations without alpha the channels are widened by shifting
+   them up, the way BlitNtoN() does it, and the bits left over are clear. */
+int SDL_Blit_RGB565_32X_NEON(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt)
+{
+	const uint16x8_t mask5 = vdupq_n_u16(0x1F);
+	const uint16x8_t mask6 = vdupq_n_u16(0x3F);
+	const int32x4_t rshift = vdupq_n_s32(dstfmt->Rshift);
+	const int32x4_t gshift = vdupq_n_s32(dstfmt->Gshift);
+	const int32x4_t bshift = vdupq_n_s32(dstfmt->Bshift);
+	uint16x8_t p, r, g, b;
+	uint32x4_t d;
+	int i;
+
+	for ( i = 0; i + 8 <= width; i += 8 ) {
+		p = vld1q_u16((const uint16_t *)src);
+		r = vshlq_n_u16(vshrq_n_u16(p, 11), 3);
+		g = vshlq_n_u16(vandq_u16(vshrq_n_u16(p, 5), mask6), 2);
+		b = vshlq_n_u16(vandq_u16(p, mask5), 3);
+
+		d = vorrq_u32(vshlq_u32(vmovl_u16(vget_low_u16(r)), rshift),
+		              vshlq_u32(vmovl_u16(vget_low_u16(g)), gshift));
+		d = vorrq_u32(d, vshlq_u32(vmovl_u16(vget_low_u16(b)), bshift));
+		vst1q_u32((uint32_t *)dst, d);
+
+		d = vorrq_u32(vshlq_u32(vmovl_u16(vget_high_u16(r)), rshift),
+		              vshlq_u32(vmovl_u16(vget_high_u16(g)), gshift));
+		d = vorrq_u32(d, vshlq_u32(vmovl_u16(vget_high_u16(b)), bshift));
+		vst1q_u32((uint32_t *)(dst + 16), d);
+
+		src += 16;
+		dst += 32;
+	}
+	return i;
+}
+
+int SDL_Blit32to16_NEON(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt)
+{
+	SDL_BlitChannel channels[4];
+	const uint32x4_t alpha = vdupq_n_u32(0);
+	uint32x4_t lo, hi;
+	int i;
+
+	if ( !SDL_InitBlitChannels(channels, srcfmt, dstfmt) ) {
+		return 0;
+	}
+	for ( i = 0; i + 8 <= width; i += 8 ) {
+		lo = vld1q_u32((const uint32_t *)src);
+		hi = vld1q_u32((const uint32_t *)(src + 16));
+		lo = SDL_ConvertBlitPixels(lo, channels, 0, alpha);
+		hi = SDL_ConvertBlitPixels(hi, channels, 0, alpha);
+		vst1q_u16((uint16_t *)dst, vcombine_u16(vmovn_u32(lo), vmovn_u32(hi)));
+		src += 32;
+		dst += 16;
+	}
+	return i;
+}
+
+int SDL_Blit32to32_NEON(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt)
+{
+	SDL_BlitChannel channels[4];
+	const int copy_alpha = (srcfmt->Amask && dstfmt->Amask);
+	const uint32x4_t alpha = vdupq_n_u32(SDL_BlitSetAlpha(srcfmt, dstfmt));
+	uint32x4_t p;
+	int i;
+
+	if ( !SDL_InitBlitChannels(channels, srcfmt, dstfmt) ) {
+		return 0;
+	}
+	for ( i = 0; i + 4 <= width; i += 4 ) {
+		p = vld1q_u32((const uint32_t *)src);
+		p = SDL_ConvertBlitPixels(p, channels, copy_alpha, alpha);
+		vst1q_u32((uint32_t *)dst, p);
+		src += 16;
+		dst += 16;
+	}
+	return i;
+}
+
+int SDL_Blit4to4MaskAlpha_NEON(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt)
+{
+	uint32x4_t keep, set, p0, p1;
+	int i;
+
+	if ( dstfmt->Amask ) {
+		keep = vdupq_n_u32(0xFFFFFFFF);
+		set = vdupq_n_u32(SDL_BlitSetAlpha(srcfmt, dstfmt));
+	} else {
+		keep = vdupq_n_u32(srcfmt->Rmask|srcfmt->Gmask|srcfmt->Bmask);
+		set = vdupq_n_u32(0);
+	}
+	for ( i = 0; i + 8 <= width; i += 8 ) {
+		p0 = vld1q_u32((const uint32_t *)src);
+		p1 = vld1q_u32((const uint32_t *)(src + 16));
+		p0 = vorrq_u32(vandq_u32(p0, keep), set);
+		p1 = vorrq_u32(vandq_u32(p1, keep), set);
+		vst1q_u32((uint32_t *)dst, p0);
+		vst1q_u32((uint32_t *)(dst + 16), p1);
+		src += 32;
+		dst += 32;
+	}
+	return i;
+}
+
+/* Pixels matching the colorkey keep the destination */
+int SDL_Blit32to32Key_NEON(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt)
+{
+	SDL_BlitChannel channels[4];
+	const int copy_alpha = (srcfmt->Amask && dstfmt->Amask);
+	const uint32x4_t alpha = vdupq_n_u32(SDL_BlitSetAlpha(srcfmt, dstfmt));
+	const uint32x4_t rgbmask = vdupq_n_u32(~srcfmt->Amask);
+	const uint32x4_t ckey = vdupq_n_u32(srcfmt->colorkey & ~srcfmt->Amask);
+	uint32x4_t p, d, key;
+	int i;
+
+	if ( !SDL_InitBlitChannels(channels, srcfmt, dstfmt) ) {
+		return 0;
+	}
+	for ( i = 0; i + 4 <= width; i += 4 ) {
+		p = vld1q_u32((const uint32_t *)src);
+		d = vld1q_u32((const uint32_t *)dst);
+		key = vceqq_u32(vandq_u32(p, rgbmask), ckey);
+		p = SDL_ConvertBlitPixels(p, channels, copy_alpha, alpha);
+		vst1q_u32((uint32_t *)dst, vbslq_u32(key, d, p));
+		src += 16;
+		dst += 16;
+	}
+	return i;
+}
+
+#endif /* SDL_NEON_BLITTERS */
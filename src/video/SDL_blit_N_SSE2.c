@@ -0,0 +1,302 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* SSE2 row kernels for the N to N blitters
+
+   The C code unpacks each channel to 8 bits and packs it again, which
+   for a channel of a 32-bit pixel comes to ((pixel & mask) >> down) << up.
+   The kernels do that four pixels at a time, with the shift counts worked
+   out from the two formats at the start of each row.
+*/
+
+#include "SDL_video.h"
+#include "SDL_blit_N_SSE2.h"
+
+#if SDL_SSE2_BLITTERS
+
+#include <emmintrin.h>
+
+typedef struct {
+	__m128i mask;
+	__m128i down;
+	__m128i up;
+} SDL_BlitChannel;
+
+static void SDL_InitBlitChannel(SDL_BlitChannel *channel, Uint32 mask,
+                                int srcshift, int srcloss,
+                                int dstshift, int dstloss)
+{
+	int down = srcshift;
+	int up = dstshift;
+
+	if ( dstloss > srcloss ) {
+		down += dstloss - srcloss;
+	} else {
+		up += srcloss - dstloss;
+	}
+	channel->mask = _mm_set1_epi32(mask);
+	channel->down = _mm_cvtsi32_si128(down);
+	channel->up = _mm_cvtsi32_si128(up);
+}
+
+/* Channels wider than 8 bits don't fit the C code, which shifts them by
+   a negative loss, so those formats are all left to it */
+static int SDL_InitBlitChannels(SDL_BlitChannel *channels,
+                                const SDL_PixelFormat *srcfmt,
+                                const SDL_PixelFormat *dstfmt)
+{
+	if ( (srcfmt->Rloss > 8) || (srcfmt->Gloss > 8) ||
+	     (srcfmt->Bloss > 8) || (srcfmt->Aloss > 8) ||
+	     (dstfmt->Rloss > 8) || (dstfmt->Gloss > 8) ||
+	     (dstfmt->Bloss > 8) || (dstfmt->Aloss > 8) ) {
+		return 0;
+	}
+	SDL_InitBlitChannel(&channels[0], srcfmt->Rmask, srcfmt->Rshift,
+	                    srcfmt->Rloss, dstfmt->Rshift, dstfmt->Rloss);
+	SDL_InitBlitChannel(&channels[1], srcfmt->Gmask, srcfmt->Gshift,
+	                    srcfmt->Gloss, dstfmt->Gshift, dstfmt->Gloss);
+	SDL_InitBlitChannel(&channels[2], srcfmt->Bmask, srcfmt->Bshift,
+	                    srcfmt->Bloss, dstfmt->Bshift, dstfmt->Bloss);
+	SDL_InitBlitChannel(&channels[3], srcfmt->Amask, srcfmt->Ashift,
+	                    srcfmt->Aloss, dstfmt->Ashift, dstfmt->Aloss);
+	return 1;
+}
+
+static __inline__ __m128i SDL_MoveBlitChannel(__m128i p,
+                                              const SDL_BlitChannel *channel)
+{
+	p = _mm_and_si128(p, channel->mask);
+	return _mm_sll_epi32(_mm_srl_epi32(p, channel->down), channel->up);
+}
+
+/* Converts four pixels, copying alpha when 'copy_alpha' is set and
+   or-ing in 'alpha' otherwise */
+static __inline__ __m128i SDL_ConvertBlitPixels(__m128i p,
+                                                const SDL_BlitChannel *channels,
+                                                int copy_alpha, __m128i alpha)
+{
+	__m128i d;
+
+	d = _mm_or_si128(SDL_MoveBlitChannel(p, &channels[0]),
+	                 SDL_MoveBlitChannel(p, &channels[1]));
+	d = _mm_or_si128(d, SDL_MoveBlitChannel(p, &channels[2]));
+	if ( copy_alpha ) {
+		d = _mm_or_si128(d, SDL_MoveBlitChannel(p, &channels[3]));
+	} else {
+		d = _mm_or_si128(d, alpha);
+	}
+	return d;
+}
+
+/* The constant alpha BlitNtoN() gives pixels from a source without it */
+static Uint32 SDL_BlitSetAlpha(const SDL_PixelFormat *srcfmt,
+                               const SDL_PixelFormat *dstfmt)
+{
+	if ( !dstfmt->Amask ) {
+		return 0;
+	}
+	return ((Uint32)srcfmt->alpha >> dstfmt->Aloss) << dstfmt->Ashift;
+}
+
+/* Channels are widened the way the lookup tables do it, which is r*255/31
+   and b*255/31 rounded down, computed here as (x*1053)>>7.  The tables
+   split green between the two bytes of the pixel, so the top 3 bits are
+   widened as (g*2040/63), or (g*259)>>3, and the low 3 bits are added in
+   shifted up by 2.  The bits left over in the destination are all set. */
+int SDL_Blit_RGB565_32_SSE2(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt)
+{
+	const __m128i mask5 = _mm_set1_epi16(0x1F);
+	const __m128i mask6 = _mm_set1_epi16(0x3F);
+	const __m128i mask3 = _mm_set1_epi16(0x07);
+	const __m128i scale5 = _mm_set1_epi16(1053);
+	const __m128i scale3 = _mm_set1_epi16(259);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rshift = _mm_cvtsi32_si128(dstfmt->Rshift);
+	const __m128i gshift = _mm_cvtsi32_si128(dstfmt->Gshift);
+	const __m128i bshift = _mm_cvtsi32_si128(dstfmt->Bshift);
+	const __m128i alpha = _mm_set1_epi32(
+		~(dstfmt->Rmask | dstfmt->Gmask | dstfmt->Bmask));
+	__m128i p, r, g, b, d;
+	int i;
+
+	for ( i = 0; i + 8 <= width; i += 8 ) {
+		p = _mm_loadu_si128((const __m128i *)src);
+		r = _mm_srli_epi16(p, 11);
+		g = _mm_and_si128(_mm_srli_epi16(p, 5), mask6);
+		b = _mm_and_si128(p, mask5);
+		r = _mm_srli_epi16(_mm_mullo_epi16(r, scale5), 7);
+		g = _mm_add_epi16(
+			_mm_srli_epi16(_mm_mullo_epi16(_mm_srli_epi16(g, 3), scale3), 3),
+			_mm_slli_epi16(_mm_and_si128(g, mask3), 2));
+		b = _mm_srli_epi16(_mm_mullo_epi16(b, scale5), 7);
+
+		d = _mm_or_si128(_mm_sll_epi32(_mm_unpacklo_epi16(r, zero), rshift),
+		                 _mm_sll_epi32(_mm_unpacklo_epi16(g, zero), gshift));
+		d = _mm_or_si128(d, _mm_sll_epi32(_mm_unpacklo_epi16(b, zero), bshift));
+		_mm_storeu_si128((__m128i *)dst, _mm_or_si128(d, alpha));
+
+		d = _mm_or_si128(_mm_sll_epi32(_mm_unpackhi_epi16(r, zero), rshift),
+		                 _mm_sll_epi32(_mm_unpackhi_epi16(g, zero), gshift));
+		d = _mm_or_si128(d, _mm_sll_epi32(_mm_unpackhi_epi16(b, zero), bshift));
+		_mm_storeu_si128((__m128i *)(dst + 16), _mm_or_si128(d, alpha));
+
+		src += 16;
+		dst += 32;
+	}
+	return i;
+}
+
+/* For destinations without alpha the channels are widened by shifting
+   them up, the way BlitNtoN() does it, and the bits left over are clear. */
+int SDL_Blit_RGB565_32X_SSE2(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt)
+{
+	const __m128i mask5 = _mm_set1_epi16(0x1F);
+	const __m128i mask6 = _mm_set1_epi16(0x3F);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rshift = _mm_cvtsi32_si128(dstfmt->Rshift);
+	const __m128i gshift = _mm_cvtsi32_si128(dstfmt->Gshift);
+	const __m128i bshift = _mm_cvtsi32_si128(dstfmt->Bshift);
+	__m128i p, r, g, b, d;
+	int i;
+
+	for ( i = 0; i + 8 <= width; i += 8 ) {
+		p = _mm_loadu_si128((const __m128i *)src);
+		r = _mm_slli_epi16(_mm_srli_epi16(p, 11), 3);
+		g = _mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(p, 5), mask6), 2);
+		b = _mm_slli_epi16(_mm_and_si128(p, mask5), 3);
+
+		d = _mm_or_si128(_mm_sll_epi32(_mm_unpacklo_epi16(r, zero), rshift),
+		                 _mm_sll_epi32(_mm_unpacklo_epi16(g, zero), gshift));
+		d = _mm_or_si128(d, _mm_sll_epi32(_mm_unpacklo_epi16(b, zero), bshift));
+		_mm_storeu_si128((__m128i *)dst, d);
+
+		d = _mm_or_si128(_mm_sll_epi32(_mm_unpackhi_epi16(r, zero), rshift),
+		                 _mm_sll_epi32(_mm_unpackhi_epi16(g, zero), gshift));
+		d = _mm_or_si128(d, _mm_sll_epi32(_mm_unpackhi_epi16(b, zero), bshift));
+		_mm_storeu_si128((__m128i *)(dst + 16), d);
+
+		src += 16;
+		dst += 32;
+	}
+	return i;
+}
+
+int SDL_Blit32to16_SSE2(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt)
+{
+	SDL_BlitChannel channels[4];
+	const __m128i alpha = _mm_setzero_si128();
+	__m128i lo, hi;
+	int i;
+
+	if ( !SDL_InitBlitChannels(channels, srcfmt, dstfmt) ) {
+		return 0;
+	}
+	for ( i = 0; i + 8 <= width; i += 8 ) {
+		lo = _mm_loadu_si128((const __m128i *)src);
+		hi = _mm_loadu_si128((const __m128i *)(src + 16));
+		lo = SDL_ConvertBlitPixels(lo, channels, 0, alpha);
+		hi = SDL_ConvertBlitPixels(hi, channels, 0, alpha);
+		/* Sign extend the low halves, so the pack doesn't saturate */
+		lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+		hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+		_mm_storeu_si128((__m128i *)dst, _mm_packs_epi32(lo, hi));
+		src += 32;
+		dst += 16;
+	}
+	return i;
+}
+
+int SDL_Blit32to32_SSE2(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt)
+{
+	SDL_BlitChannel channels[4];
+	const int copy_alpha = (srcfmt->Amask && dstfmt->Amask);
+	const __m128i alpha = _mm_set1_epi32(SDL_BlitSetAlpha(srcfmt, dstfmt));
+	__m128i p;
+	int i;
+
+	if ( !SDL_InitBlitChannels(channels, srcfmt, dstfmt) ) {
+		return 0;
+	}
+	for ( i = 0; i + 4 <= width; i += 4 ) {
+		p = _mm_loadu_si128((const __m128i *)src);
+		p = SDL_ConvertBlitPixels(p, channels, copy_alpha, alpha);
+		_mm_storeu_si128((__m128i *)dst, p);
+		src += 16;
+		dst += 16;
+	}
+	return i;
+}
+
+int SDL_Blit4to4MaskAlpha_SSE2(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt)
+{
+	__m128i keep, set, p0, p1;
+	int i;
+
+	if ( dstfmt->Amask ) {
+		keep = _mm_set1_epi32(0xFFFFFFFF);
+		set = _mm_set1_epi32(SDL_BlitSetAlpha(srcfmt, dstfmt));
+	} else {
+		keep = _mm_set1_epi32(srcfmt->Rmask|srcfmt->Gmask|srcfmt->Bmask);
+		set = _mm_setzero_si128();
+	}
+	for ( i = 0; i + 8 <= width; i += 8 ) {
+		p0 = _mm_loadu_si128((const __m128i *)src);
+		p1 = _mm_loadu_si128((const __m128i *)(src + 16));
+		p0 = _mm_or_si128(_mm_and_si128(p0, keep), set);
+		p1 = _mm_or_si128(_mm_and_si128(p1, keep), set);
+		_mm_storeu_si128((__m128i *)dst, p0);
+		_mm_storeu_si128((__m128i *)(dst + 16), p1);
+		src += 32;
+		dst += 32;
+	}
+	return i;
+}
+
+/* Pixels matching the colorkey keep the destination */
+int SDL_Blit32to32Key_SSE2(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt)
+{
+	SDL_BlitChannel channels[4];
+	const int copy_alpha = (srcfmt->Amask && dstfmt->Amask);
+	const __m128i alpha = _mm_set1_epi32(SDL_BlitSetAlpha(srcfmt, dstfmt));
+	const __m128i rgbmask = _mm_set1_epi32(~srcfmt->Amask);
+	const __m128i ckey = _mm_set1_epi32(srcfmt->colorkey & ~srcfmt->Amask);
+	__m128i p, d, key;
+	int i;
+
+	if ( !SDL_InitBlitChannels(channels, srcfmt, dstfmt) ) {
+		return 0;
+	}
+	for ( i = 0; i + 4 <= width; i += 4 ) {
+		p = _mm_loadu_si128((const __m128i *)src);
+		d = _mm_loadu_si128((const __m128i *)dst);
+		key = _mm_cmpeq_epi32(_mm_and_si128(p, rgbmask), ckey);
+		p = SDL_ConvertBlitPixels(p, channels, copy_alpha, alpha);
+		p = _mm_or_si128(_mm_andnot_si128(key, p), _mm_and_si128(key, d));
+		_mm_storeu_si128((__m128i *)dst, p);
+		src += 16;
+		dst += 16;
+	}
+	return i;
+}
+
+#endif /* SDL_SSE2_BLITTERS */
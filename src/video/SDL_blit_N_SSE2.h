@@ -0,0 +1,47 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* SSE2 row kernels for the N to N blitters, giving exactly the same
+   results as the C code.  Each converts whole blocks of pixels at the
+   start of a row, and returns the number of pixels it converted, leaving
+   the rest of the row to the caller.
+*/
+
+#if defined(SDL_ASSEMBLY_ROUTINES) && \
+    (defined(__SSE2__) || defined(_M_X64) || \
+     (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#define SDL_SSE2_BLITTERS	1
+
+/* RGB 5-6-5 to 8-8-8-8, giving the same pixels as the lookup tables */
+extern int SDL_Blit_RGB565_32_SSE2(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt);
+/* RGB 5-6-5 to 8-8-8-8 without alpha, like BlitNtoN() */
+extern int SDL_Blit_RGB565_32X_SSE2(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt);
+/* 32-bit to 16-bit without alpha, like BlitNtoN() */
+extern int SDL_Blit32to16_SSE2(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt);
+/* 32-bit to 32-bit, like BlitNtoN() or BlitNtoNCopyAlpha() */
+extern int SDL_Blit32to32_SSE2(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt);
+/* 32-bit to 32-bit with the same RGB masks, like Blit4to4MaskAlpha() */
+extern int SDL_Blit4to4MaskAlpha_SSE2(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt);
+/* Colorkeyed 32-bit to 32-bit, like BlitNtoNKey() or BlitNtoNKeyCopyAlpha() */
+extern int SDL_Blit32to32Key_SSE2(const Uint8 *src, Uint8 *dst, int width, const SDL_PixelFormat *srcfmt, const SDL_PixelFormat *dstfmt);
+#endif
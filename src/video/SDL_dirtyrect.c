@@ -0,0 +1,259 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#include "SDL_video.h"
+#include "SDL_dirtyrect_c.h"
+
+#define RECT_AREA(r)	((Uint32)(r)->w * (Uint32)(r)->h)
+
+SDL_DirtyRects *SDL_CreateDirtyRects(int w, int h, int align)
+{
+	SDL_DirtyRects *dirty;
+
+	dirty = (SDL_DirtyRects *)SDL_malloc(sizeof(*dirty));
+	if ( dirty == NULL ) {
+		SDL_OutOfMemory();
+		return(NULL);
+	}
+	SDL_memset(dirty, 0, sizeof(*dirty));
+	dirty->maxrects = 16;
+	dirty->rects = (SDL_Rect *)SDL_malloc(dirty->maxrects*sizeof(SDL_Rect));
+	if ( dirty->rects == NULL ) {
+		SDL_free(dirty);
+		SDL_OutOfMemory();
+		return(NULL);
+	}
+	dirty->w = w;
+	dirty->h = h;
+	dirty->align = (align > 0) ? align : 1;
+	return(dirty);
+}
+
+void SDL_FreeDirtyRects(SDL_DirtyRects *dirty)
+{
+	if ( dirty ) {
+		SDL_free(dirty->rects);
+		SDL_free(dirty);
+	}
+}
+
+void SDL_ClearDirtyRects(SDL_DirtyRects *dirty)
+{
+	dirty->numrects = 0;
+	dirty->area = 0;
+	dirty->full = 0;
+}
+
+static void SDL_SetFullDirtyRect(SDL_DirtyRects *dirty)
+{
+	dirty->rects[0].x = 0;
+	dirty->rects[0].y = 0;
+	dirty->rects[0].w = dirty->w;
+	dirty->rects[0].h = dirty->h;
+	dirty->numrects = 1;
+	dirty->area = RECT_AREA(&dirty->rects[0]);
+	dirty->full = 1;
+	++dirty->promotions;
+}
+
+static int SDL_GrowDirtyRects(SDL_DirtyRects *dirty)
+{
+	int maxrects = dirty->maxrects*2;
+	SDL_Rect *rects;
+
+	rects = (SDL_Rect *)SDL_realloc(dirty->rects, maxrects*sizeof(*rects));
+	if ( rects == NULL ) {
+		return(-1);
+	}
+	dirty->rects = rects;
+	dirty->maxrects = maxrects;
+	return(0);
+}
+
+void SDL_AddDirtyRect(SDL_DirtyRects *dirty, const SDL_Rect *rect)
+{
+	int x1, y1, x2, y2;
+	int mask;
+	SDL_Rect r;
+	int i;
+
+	/* Clip to the area */
+	x1 = SDL_max(rect->x, 0);
+	y1 = SDL_max(rect->y, 0);
+	x2 = SDL_min(rect->x+rect->w, dirty->w);
+	y2 = SDL_min(rect->y+rect->h, dirty->h);
+	if ( (x1 >= x2) || (y1 >= y2) ) {
+		return;
+	}
+	dirty->pixels_in += (Uint64)(x2-x1) * (Uint64)(y2-y1);
+	if ( dirty->full ) {
+		return;
+	}
+
+	/* Snap to the alignment grid, without leaving the area */
+	mask = dirty->align - 1;
+	x1 &= ~mask;
+	y1 &= ~mask;
+	x2 = SDL_min((x2+mask) & ~mask, dirty->w);
+	y2 = SDL_min((y2+mask) & ~mask, dirty->h);
+	r.x = (Sint16)x1;
+	r.y = (Sint16)y1;
+	r.w = (Uint16)(x2-x1);
+	r.h = (Uint16)(y2-y1);
+
+	/* Merge with every rectangle where that is cheaper than keeping
+	   both.  The merged rectangle may now be worth merging with ones
+	   already passed over, so start again after each merge.
+	*/
+	i = 0;
+	while ( i < dirty->numrects ) {
+		SDL_Rect *o = &dirty->rects[i];
+		Uint32 merged;
+
+		x1 = SDL_min(r.x, o->x);
+		y1 = SDL_min(r.y, o->y);
+		x2 = SDL_max(r.x+r.w, o->x+o->w);
+		y2 = SDL_max(r.y+r.h, o->y+o->h);
+		merged = (Uint32)(x2-x1) * (Uint32)(y2-y1);
+		if ( merged == RECT_AREA(o) ) {
+			/* Already covered */
+			return;
+		}
+		if ( merged > RECT_AREA(o)+RECT_AREA(&r)+SDL_DIRTY_RECT_COST ) {
+			++i;
+			continue;
+		}
+		dirty->area -= RECT_AREA(o);
+		*o = dirty->rects[--dirty->numrects];
+		r.x = (Sint16)x1;
+		r.y = (Sint16)y1;
+		r.w = (Uint16)(x2-x1);
+		r.h = (Uint16)(y2-y1);
+		i = 0;
+	}
+
+	if ( (dirty->numrects == dirty->maxrects) &&
+	     (SDL_GrowDirtyRects(dirty) < 0) ) {
+		/* Give up on merging, the whole area is safe */
+		SDL_SetFullDirtyRect(dirty);
+		return;
+	}
+	dirty->rects[dirty->numrects++] = r;
+	dirty->area += RECT_AREA(&r);
+
+	if ( dirty->area >= (Uint32)dirty->w * dirty->h / 100 *
+	                    SDL_DIRTY_FULL_PERCENT ) {
+		SDL_SetFullDirtyRect(dirty);
+	}
+}
+
+/* Rectangles that overlap without being worth merging, like a tall thin
+   one crossing a wide flat one, are cut up so no pixel is updated twice.
+   Each rectangle is replaced by the parts of it outside the ones before
+   it, which can't overlap those either.
+*/
+static int SDL_SeparateDirtyRects(SDL_DirtyRects *dirty)
+{
+	SDL_Rect a, b, parts[4];
+	int x1, y1, x2, y2;
+	int i, j, n;
+
+	for ( i = 0; i < dirty->numrects; ++i ) {
+		j = i+1;
+		while ( j < dirty->numrects ) {
+			a = dirty->rects[i];
+			b = dirty->rects[j];
+			x1 = SDL_max(a.x, b.x);
+			y1 = SDL_max(a.y, b.y);
+			x2 = SDL_min(a.x+a.w, b.x+b.w);
+			y2 = SDL_min(a.y+a.h, b.y+b.h);
+			if ( (x1 >= x2) || (y1 >= y2) ) {
+				++j;
+				continue;
+			}
+
+			/* The bands above and below the overlap, then the
+			   pieces to its left and right */
+			n = 0;
+			if ( b.y < y1 ) {
+				parts[n].x = b.x;
+				parts[n].y = b.y;
+				parts[n].w = b.w;
+				parts[n].h = (Uint16)(y1-b.y);
+				++n;
+			}
+			if ( b.y+b.h > y2 ) {
+				parts[n].x = b.x;
+				parts[n].y = (Sint16)y2;
+				parts[n].w = b.w;
+				parts[n].h = (Uint16)(b.y+b.h-y2);
+				++n;
+			}
+			if ( b.x < x1 ) {
+				parts[n].x = b.x;
+				parts[n].y = (Sint16)y1;
+				parts[n].w = (Uint16)(x1-b.x);
+				parts[n].h = (Uint16)(y2-y1);
+				++n;
+			}
+			if ( b.x+b.w > x2 ) {
+				parts[n].x = (Sint16)x2;
+				parts[n].y = (Sint16)y1;
+				parts[n].w = (Uint16)(b.x+b.w-x2);
+				parts[n].h = (Uint16)(y2-y1);
+				++n;
+			}
+
+			/* Put the parts in place of 'b', and look at
+			   whatever ends up at 'j' next */
+			dirty->rects[j] = dirty->rects[--dirty->numrects];
+			while ( n-- > 0 ) {
+				if ( (dirty->numrects == dirty->maxrects) &&
+				     (SDL_GrowDirtyRects(dirty) < 0) ) {
+					return(-1);
+				}
+				dirty->rects[dirty->numrects++] = parts[n];
+			}
+		}
+	}
+	return(0);
+}
+
+void SDL_CommitDirtyRects(SDL_DirtyRects *dirty)
+{
+	int i;
+
+	if ( !dirty->full ) {
+		if ( SDL_SeparateDirtyRects(dirty) < 0 ) {
+			SDL_SetFullDirtyRect(dirty);
+		} else {
+			/* Count what is updated, not what overlapped */
+			dirty->area = 0;
+			for ( i = 0; i < dirty->numrects; ++i ) {
+				dirty->area += RECT_AREA(&dirty->rects[i]);
+			}
+		}
+	}
+	++dirty->frames;
+	dirty->pixels_out += dirty->area;
+}
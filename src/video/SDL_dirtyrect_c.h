@@ -0,0 +1,77 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#ifndef _SDL_dirtyrect_c_h
+#define _SDL_dirtyrect_c_h
+
+/* Dirty rectangle accumulator.
+
+   Rectangles are clipped, snapped to an alignment grid and merged with
+   the ones already collected whenever the merged rectangle costs less
+   to update than the two separate ones.  Once the collected area covers
+   most of the screen, it is replaced by a single full screen rectangle.
+*/
+
+#include "SDL_video.h"
+
+/* Updating a rectangle costs about as much as this many extra pixels,
+   so merging may grow the updated area by up to this amount.
+*/
+#define SDL_DIRTY_RECT_COST	256
+
+/* Above this percentage of coverage the whole area is updated */
+#define SDL_DIRTY_FULL_PERCENT	75
+
+typedef struct SDL_DirtyRects {
+	int w, h;		/* Rectangles are clipped to (0,0,w,h) */
+	int align;		/* Power of two to snap the edges to */
+
+	SDL_Rect *rects;
+	int numrects;
+	int maxrects;
+	Uint32 area;		/* Total area of 'rects', overlaps and all */
+	int full;		/* 'rects' holds the whole area */
+
+	/* Statistics since the accumulator was created */
+	Uint32 frames;		/* Number of committed updates */
+	Uint64 pixels_in;	/* Clipped area of the rectangles added */
+	Uint64 pixels_out;	/* Area of the rectangles committed */
+	Uint32 promotions;	/* Updates promoted to full screen */
+} SDL_DirtyRects;
+
+/* Create an accumulator for a w x h area, snapping to 'align' pixels */
+extern SDL_DirtyRects *SDL_CreateDirtyRects(int w, int h, int align);
+extern void SDL_FreeDirtyRects(SDL_DirtyRects *dirty);
+
+/* Forget the collected rectangles and start a new update */
+extern void SDL_ClearDirtyRects(SDL_DirtyRects *dirty);
+
+/* Add a rectangle to the current update */
+extern void SDL_AddDirtyRect(SDL_DirtyRects *dirty, const SDL_Rect *rect);
+
+/* Finish the current update: dirty->rects and dirty->numrects now hold
+   the rectangles to pass to the driver, none of which overlap.
+*/
+extern void SDL_CommitDirtyRects(SDL_DirtyRects *dirty);
+
+#endif /* _SDL_dirtyrect_c_h */
@@ -29,6 +29,9 @@
 
 #include "SDL_video.h"
 #include "SDL_blit.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_stretch_SSE2.h"
+#include "SDL_stretch_NEON.h"
 
 /* This isn't ready for general consumption yet - it should be folded
    into the general blitting mechanism.
@@ -194,7 +197,8 @@ void copy_row3(Uint8 *src, int src_w, Uint8 *dst, int dst_w)
 	}
 }
 
-/* Perform a stretch blit between two surfaces of the same format.
+/* Perform a stretch blit between two surfaces of the same format, or
+   convert on the way if their depths differ.
    NOTE:  This function is not safe to call from multiple threads!
 */
 int SDL_SoftStretch(SDL_Surface *src, SDL_Rect *srcrect,
@@ -219,8 +223,9 @@ int SDL_SoftStretch(SDL_Surface *src, SDL_Rect *srcrect,
 	const int bpp = dst->format->BytesPerPixel;
 
 	if ( src->format->BitsPerPixel != dst->format->BitsPerPixel ) {
-		SDL_SetError("Only works with same format surfaces");
-		return(-1);
+		/* Convert the format on the way */
+		return(SDL_SoftStretchFilter(src, srcrect, dst, dstrect,
+		                             SDL_STRETCH_NEAREST));
 	}
 
 	/* Verify the blit rectangles */
@@ -356,3 +361,558 @@ int SDL_SoftStretch(SDL_Surface *src, SDL_Rect *srcrect,
 	return(0);
 }
 
+
+/* Filtered stretching, with format conversion
+
+   Each source row the destination needs is converted to 32-bit ARGB and
+   scaled across into a row buffer, once however many destination rows
+   use it.  Each destination row is then blended down from those and
+   packed into the destination format.  No code is generated, so this
+   works where memory can't be both writeable and executable.
+*/
+
+/* Row kernels, which return the number of pixels they did */
+typedef int (*SDL_StretchRowFunc)(const Uint32 *src, Uint32 *dst, int width, const Uint32 *xmap);
+typedef int (*SDL_StretchBlendFunc)(const Uint32 *row0, const Uint32 *row1, Uint32 *dst, int width, int weight);
+typedef int (*SDL_StretchPackFunc)(const Uint32 *src, Uint8 *dst, int width);
+
+/* Each channel value of a format expanded to 8 bits, in its place in an
+   ARGB pixel.  A missing alpha channel reads as opaque.  For palettized
+   formats 'r' holds the whole color.
+*/
+typedef struct {
+	Uint32 r[256];
+	Uint32 g[256];
+	Uint32 b[256];
+	Uint32 a[256];
+} SDL_StretchUnpack;
+
+static Uint32 SDL_ExpandChannel(Uint32 v, int loss)
+{
+	const int bits = 8 - loss;
+	Uint32 x;
+	int shift;
+
+	if ( bits <= 0 ) {
+		return(0);
+	}
+	x = v << loss;
+	for ( shift = bits; shift < 8; shift += bits ) {
+		x |= (v << loss) >> shift;
+	}
+	return(x);
+}
+
+static int SDL_SetupUnpack(SDL_PixelFormat *fmt, SDL_StretchUnpack *t)
+{
+	SDL_Color *colors;
+	int i;
+
+	if ( fmt->palette ) {
+		colors = fmt->palette->colors;
+		for ( i = 0; i < 256; ++i ) {
+			if ( i < fmt->palette->ncolors ) {
+				t->r[i] = 0xFF000000 | ((Uint32)colors[i].r << 16) |
+				          ((Uint32)colors[i].g << 8) | colors[i].b;
+			} else {
+				t->r[i] = 0xFF000000;
+			}
+		}
+		return(0);
+	}
+	if ( fmt->Rloss > 8 || fmt->Gloss > 8 ||
+	     fmt->Bloss > 8 || fmt->Aloss > 8 ) {
+		SDL_SetError("Can't stretch more than 8 bits per channel");
+		return(-1);
+	}
+	for ( i = 0; i < 256; ++i ) {
+		t->r[i] = SDL_ExpandChannel(i, fmt->Rloss) << 16;
+		t->g[i] = SDL_ExpandChannel(i, fmt->Gloss) << 8;
+		t->b[i] = SDL_ExpandChannel(i, fmt->Bloss);
+		t->a[i] = SDL_ExpandChannel(i, fmt->Aloss) << 24;
+	}
+	if ( ! fmt->Amask ) {
+		t->a[0] = 0xFF000000;
+	}
+	return(0);
+}
+
+/* Converts a row to ARGB, with a copy of the last pixel after it so the
+   bilinear kernels can always read a pair */
+static void SDL_UnpackRow(const Uint8 *src, Uint32 *dst, int width,
+                          const SDL_PixelFormat *fmt,
+                          const SDL_StretchUnpack *t)
+{
+	Uint32 pixel;
+	int i;
+
+	switch (fmt->BytesPerPixel) {
+	    case 1:
+		if ( fmt->palette ) {
+			for ( i = 0; i < width; ++i ) {
+				dst[i] = t->r[src[i]];
+			}
+			break;
+		}
+		for ( i = 0; i < width; ++i ) {
+			pixel = src[i];
+			dst[i] = t->r[(pixel & fmt->Rmask) >> fmt->Rshift] |
+			         t->g[(pixel & fmt->Gmask) >> fmt->Gshift] |
+			         t->b[(pixel & fmt->Bmask) >> fmt->Bshift] |
+			         t->a[(pixel & fmt->Amask) >> fmt->Ashift];
+		}
+		break;
+	    case 2:
+		for ( i = 0; i < width; ++i ) {
+			pixel = ((const Uint16 *)src)[i];
+			dst[i] = t->r[(pixel & fmt->Rmask) >> fmt->Rshift] |
+			         t->g[(pixel & fmt->Gmask) >> fmt->Gshift] |
+			         t->b[(pixel & fmt->Bmask) >> fmt->Bshift] |
+			         t->a[(pixel & fmt->Amask) >> fmt->Ashift];
+		}
+		break;
+	    case 3:
+		for ( i = 0; i < width; ++i, src += 3 ) {
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+			pixel = src[0] | (src[1] << 8) | (src[2] << 16);
+#else
+			pixel = (src[0] << 16) | (src[1] << 8) | src[2];
+#endif
+			dst[i] = t->r[(pixel & fmt->Rmask) >> fmt->Rshift] |
+			         t->g[(pixel & fmt->Gmask) >> fmt->Gshift] |
+			         t->b[(pixel & fmt->Bmask) >> fmt->Bshift] |
+			         t->a[(pixel & fmt->Amask) >> fmt->Ashift];
+		}
+		break;
+	    case 4:
+		if ( fmt->Rmask == 0x00FF0000 && fmt->Gmask == 0x0000FF00 &&
+		     fmt->Bmask == 0x000000FF ) {
+			/* Already ARGB or XRGB */
+			if ( fmt->Amask == 0xFF000000 ) {
+				SDL_memcpy(dst, src, width*4);
+			} else {
+				for ( i = 0; i < width; ++i ) {
+					dst[i] = ((const Uint32 *)src)[i] | 0xFF000000;
+				}
+			}
+			break;
+		}
+		for ( i = 0; i < width; ++i ) {
+			pixel = ((const Uint32 *)src)[i];
+			dst[i] = t->r[(pixel & fmt->Rmask) >> fmt->Rshift] |
+			         t->g[(pixel & fmt->Gmask) >> fmt->Gshift] |
+			         t->b[(pixel & fmt->Bmask) >> fmt->Bshift] |
+			         t->a[(pixel & fmt->Amask) >> fmt->Ashift];
+		}
+		break;
+	}
+	dst[width] = dst[width-1];
+}
+
+/* Converts an ARGB row to the destination format, starting at pixel 'i' */
+static void SDL_PackRow(const Uint32 *src, Uint8 *dst, int i, int width,
+                        const SDL_PixelFormat *fmt)
+{
+	Uint32 c, pixel;
+
+	for ( ; i < width; ++i ) {
+		c = src[i];
+		pixel = ((((c >> 16) & 0xFF) >> fmt->Rloss) << fmt->Rshift) |
+		        ((((c >> 8) & 0xFF) >> fmt->Gloss) << fmt->Gshift) |
+		        (((c & 0xFF) >> fmt->Bloss) << fmt->Bshift) |
+		        (((c >> 24) >> fmt->Aloss) << fmt->Ashift);
+		pixel &= fmt->Rmask | fmt->Gmask | fmt->Bmask | fmt->Amask;
+		switch (fmt->BytesPerPixel) {
+		    case 2:
+			((Uint16 *)dst)[i] = (Uint16)pixel;
+			break;
+		    case 3:
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+			dst[i*3+0] = (Uint8)pixel;
+			dst[i*3+1] = (Uint8)(pixel >> 8);
+			dst[i*3+2] = (Uint8)(pixel >> 16);
+#else
+			dst[i*3+0] = (Uint8)(pixel >> 16);
+			dst[i*3+1] = (Uint8)(pixel >> 8);
+			dst[i*3+2] = (Uint8)pixel;
+#endif
+			break;
+		    case 4:
+			((Uint32 *)dst)[i] = pixel;
+			break;
+		    default:
+			dst[i] = (Uint8)pixel;
+			break;
+		}
+	}
+}
+
+/* Blends a and b per channel, weighting b by f out of 256 */
+#define BLEND_ARGB(a, b, f)						\
+	(((((a) & 0x00FF00FF) * (256 - (f)) +				\
+	   ((b) & 0x00FF00FF) * (f)) >> 8) & 0x00FF00FF) |		\
+	(((((a) >> 8) & 0x00FF00FF) * (256 - (f)) +			\
+	  (((b) >> 8) & 0x00FF00FF) * (f)) & 0xFF00FF00)
+
+static void SDL_StretchRowNearest(const Uint32 *src, Uint32 *dst, int width,
+                                  const Uint32 *xmap)
+{
+	int i;
+
+	for ( i = 0; i < width; ++i ) {
+		dst[i] = src[xmap[i] >> 8];
+	}
+}
+
+static void SDL_StretchRowBilinear(const Uint32 *src, Uint32 *dst, int width,
+                                   const Uint32 *xmap)
+{
+	Uint32 x, f;
+	int i;
+
+	for ( i = 0; i < width; ++i ) {
+		x = xmap[i] >> 8;
+		f = xmap[i] & 0xFF;
+		dst[i] = BLEND_ARGB(src[x], src[x+1], f);
+	}
+}
+
+static void SDL_StretchBlendRows(const Uint32 *row0, const Uint32 *row1,
+                                 Uint32 *dst, int width, Uint32 weight)
+{
+	int i;
+
+	for ( i = 0; i < width; ++i ) {
+		dst[i] = BLEND_ARGB(row0[i], row1[i], weight);
+	}
+}
+
+/* The number of source pixels a box filtered pixel averages */
+#define BOX_COUNT(map, i)						\
+	(((map)[(i)+1] >> 8) > ((map)[i] >> 8) ?			\
+	 ((map)[(i)+1] >> 8) - ((map)[i] >> 8) : 1)
+
+/* Averages each run of pixels from src[xmap[i] >> 8] to src[xmap[i+1] >> 8],
+   multiplying by inv[i], which is 65536 over the number of pixels */
+static void SDL_StretchRowBox(const Uint32 *src, Uint32 *dst, int width,
+                              const Uint32 *xmap, const Uint32 *inv)
+{
+	Uint32 r, g, b, a, c;
+	int i, x, n;
+
+	for ( i = 0; i < width; ++i ) {
+		x = xmap[i] >> 8;
+		n = BOX_COUNT(xmap, i);
+		r = g = b = a = 0;
+		while ( n-- ) {
+			c = src[x++];
+			a += c >> 24;
+			r += (c >> 16) & 0xFF;
+			g += (c >> 8) & 0xFF;
+			b += c & 0xFF;
+		}
+		dst[i] = (((a * inv[i] + 0x8000) >> 16) << 24) |
+		         (((r * inv[i] + 0x8000) >> 16) << 16) |
+		         (((g * inv[i] + 0x8000) >> 16) << 8) |
+		         ((b * inv[i] + 0x8000) >> 16);
+	}
+}
+
+/* Works out where each destination pixel comes from: the source pixel
+   in the upper bits of each entry, and the weight of the one after it in
+   the low 8 bits.  Box filtered maps have an extra entry at the end.
+*/
+static void SDL_StretchMap(Uint32 *map, int src_w, int dst_w,
+                           SDL_StretchFilter filter)
+{
+	Uint32 step, pos, last, x;
+	int i;
+
+	step = ((Uint32)src_w << 16) / dst_w;
+	last = (Uint32)(src_w - 1) << 16;
+	pos = (filter == SDL_STRETCH_BOX) ? 0 : (step >> 1);
+	for ( i = 0; i < dst_w; ++i ) {
+		x = pos;
+		if ( filter == SDL_STRETCH_BILINEAR ) {
+			/* Line up the pixel centers */
+			x = (x < 0x8000) ? 0 : (x - 0x8000);
+		}
+		if ( x >= last ) {
+			x = last;
+		}
+		if ( filter == SDL_STRETCH_BILINEAR ) {
+			map[i] = ((x >> 16) << 8) | ((x >> 8) & 0xFF);
+		} else {
+			map[i] = (x >> 16) << 8;
+		}
+		pos += step;
+	}
+	if ( filter == SDL_STRETCH_BOX ) {
+		map[dst_w] = (Uint32)src_w << 8;
+	}
+}
+
+/* The state of a filtered stretch */
+typedef struct {
+	SDL_Surface *src;
+	Uint8 *src_pixels;
+	int src_w;
+	int width;
+	SDL_StretchFilter filter;
+	SDL_StretchUnpack *unpack;
+	Uint32 *xmap;
+	Uint32 *xinv;
+	Uint32 *line;
+	Uint32 *rows[2];
+	int row_index[2];
+	SDL_StretchRowFunc row_kernel;
+} SDL_StretchInfo;
+
+/* Returns source row 'y' converted and scaled across.  Rows are kept by
+   the parity of their index, so the last two stay around for blending. */
+static Uint32 *SDL_StretchGetRow(SDL_StretchInfo *info, int y)
+{
+	const int slot = y & 1;
+	Uint32 *row = info->rows[slot];
+	int done;
+
+	if ( info->row_index[slot] == y ) {
+		return(row);
+	}
+	SDL_UnpackRow(info->src_pixels + y*info->src->pitch, info->line,
+	              info->src_w, info->src->format, info->unpack);
+	switch (info->filter) {
+	    case SDL_STRETCH_BILINEAR:
+		done = 0;
+		if ( info->row_kernel ) {
+			done = info->row_kernel(info->line, row,
+			                        info->width, info->xmap);
+		}
+		SDL_StretchRowBilinear(info->line, row + done,
+		                       info->width - done, info->xmap + done);
+		break;
+	    case SDL_STRETCH_BOX:
+		SDL_StretchRowBox(info->line, row, info->width,
+		                  info->xmap, info->xinv);
+		break;
+	    default:
+		SDL_StretchRowNearest(info->line, row, info->width, info->xmap);
+		break;
+	}
+	info->row_index[slot] = y;
+	return(row);
+}
+
+int SDL_SoftStretchFilter(SDL_Surface *src, SDL_Rect *srcrect,
+                          SDL_Surface *dst, SDL_Rect *dstrect,
+                          SDL_StretchFilter filter)
+{
+	SDL_StretchInfo info;
+	SDL_StretchBlendFunc blend_kernel;
+	SDL_StretchPackFunc pack_kernel;
+	SDL_Rect full_src;
+	SDL_Rect full_dst;
+	SDL_PixelFormat *sf = src->format;
+	SDL_PixelFormat *df = dst->format;
+	Uint8 *mem, *dstp;
+	Uint32 *ymap, *yinv, *out, *acc, *row, *row1, c;
+	int src_locked, dst_locked;
+	int i, y, n, done, src_h, dst_h;
+
+	/* Stretches that don't need converting or filtering copy pixels */
+	if ( filter == SDL_STRETCH_NEAREST &&
+	     sf->BitsPerPixel == df->BitsPerPixel &&
+	     sf->Rmask == df->Rmask && sf->Gmask == df->Gmask &&
+	     sf->Bmask == df->Bmask && sf->Amask == df->Amask ) {
+		return(SDL_SoftStretch(src, srcrect, dst, dstrect));
+	}
+	if ( sf->BitsPerPixel < 8 ) {
+		SDL_SetError("Can't stretch bitmaps");
+		return(-1);
+	}
+	if ( df->palette ) {
+		SDL_SetError("Only stretches by copying to palettized surfaces");
+		return(-1);
+	}
+	if ( df->Rloss > 8 || df->Gloss > 8 || df->Bloss > 8 || df->Aloss > 8 ) {
+		SDL_SetError("Can't stretch more than 8 bits per channel");
+		return(-1);
+	}
+
+	/* Verify the blit rectangles */
+	if ( srcrect ) {
+		if ( (srcrect->x < 0) || (srcrect->y < 0) ||
+		     ((srcrect->x+srcrect->w) > src->w) ||
+		     ((srcrect->y+srcrect->h) > src->h) ) {
+			SDL_SetError("Invalid source blit rectangle");
+			return(-1);
+		}
+	} else {
+		full_src.x = 0;
+		full_src.y = 0;
+		full_src.w = src->w;
+		full_src.h = src->h;
+		srcrect = &full_src;
+	}
+	if ( dstrect ) {
+		if ( (dstrect->x < 0) || (dstrect->y < 0) ||
+		     ((dstrect->x+dstrect->w) > dst->w) ||
+		     ((dstrect->y+dstrect->h) > dst->h) ) {
+			SDL_SetError("Invalid destination blit rectangle");
+			return(-1);
+		}
+	} else {
+		full_dst.x = 0;
+		full_dst.y = 0;
+		full_dst.w = dst->w;
+		full_dst.h = dst->h;
+		dstrect = &full_dst;
+	}
+	if ( !srcrect->w || !srcrect->h || !dstrect->w || !dstrect->h ) {
+		return(0);
+	}
+
+	/* Set up the tables and row buffers */
+	info.src = src;
+	info.src_w = srcrect->w;
+	info.width = dstrect->w;
+	info.filter = filter;
+	src_h = srcrect->h;
+	dst_h = dstrect->h;
+	mem = (Uint8 *)SDL_malloc(sizeof(SDL_StretchUnpack) + sizeof(Uint32) *
+		((info.width+1) + info.width + (dst_h+1) + dst_h +
+		 (info.src_w+1) + 3*info.width + 4*info.width));
+	if ( mem == NULL ) {
+		SDL_OutOfMemory();
+		return(-1);
+	}
+	info.unpack = (SDL_StretchUnpack *)mem;
+	info.xmap = (Uint32 *)(mem + sizeof(SDL_StretchUnpack));
+	info.xinv = info.xmap + info.width+1;
+	ymap = info.xinv + info.width;
+	yinv = ymap + dst_h+1;
+	info.line = yinv + dst_h;
+	info.rows[0] = info.line + info.src_w+1;
+	info.rows[1] = info.rows[0] + info.width;
+	out = info.rows[1] + info.width;
+	acc = out + info.width;
+	info.row_index[0] = -1;
+	info.row_index[1] = -1;
+
+	if ( SDL_SetupUnpack(sf, info.unpack) < 0 ) {
+		SDL_free(mem);
+		return(-1);
+	}
+	SDL_StretchMap(info.xmap, info.src_w, info.width, filter);
+	SDL_StretchMap(ymap, src_h, dst_h, filter);
+	if ( filter == SDL_STRETCH_BOX ) {
+		for ( i = 0; i < info.width; ++i ) {
+			info.xinv[i] = 65536 / BOX_COUNT(info.xmap, i);
+		}
+		for ( y = 0; y < dst_h; ++y ) {
+			yinv[y] = 65536 / BOX_COUNT(ymap, y);
+		}
+	}
+
+	info.row_kernel = NULL;
+	blend_kernel = NULL;
+	pack_kernel = NULL;
+#if SDL_SSE2_BLITTERS
+	if ( SDL_HasSSE2() ) {
+		info.row_kernel = SDL_StretchRowBilinear_SSE2;
+		blend_kernel = SDL_StretchBlendRows_SSE2;
+		pack_kernel = SDL_StretchPackRGB565_SSE2;
+	}
+#endif
+#if SDL_NEON_BLITTERS
+	if ( SDL_HasNEON() ) {
+		info.row_kernel = SDL_StretchRowBilinear_NEON;
+		blend_kernel = SDL_StretchBlendRows_NEON;
+		pack_kernel = SDL_StretchPackRGB565_NEON;
+	}
+#endif
+	if ( df->BytesPerPixel != 2 || df->Rmask != 0xF800 ||
+	     df->Gmask != 0x07E0 || df->Bmask != 0x001F || df->Amask ) {
+		pack_kernel = NULL;
+	}
+
+	/* Lock the destination if it's in hardware */
+	dst_locked = 0;
+	if ( SDL_MUSTLOCK(dst) ) {
+		if ( SDL_LockSurface(dst) < 0 ) {
+			SDL_free(mem);
+			SDL_SetError("Unable to lock destination surface");
+			return(-1);
+		}
+		dst_locked = 1;
+	}
+	/* Lock the source if it's in hardware */
+	src_locked = 0;
+	if ( SDL_MUSTLOCK(src) ) {
+		if ( SDL_LockSurface(src) < 0 ) {
+			if ( dst_locked ) {
+				SDL_UnlockSurface(dst);
+			}
+			SDL_free(mem);
+			SDL_SetError("Unable to lock source surface");
+			return(-1);
+		}
+		src_locked = 1;
+	}
+	info.src_pixels = (Uint8 *)src->pixels + srcrect->y*src->pitch +
+	                  srcrect->x*sf->BytesPerPixel;
+
+	/* Perform the stretch blit */
+	for ( y = 0; y < dst_h; ++y ) {
+		dstp = (Uint8 *)dst->pixels + (dstrect->y+y)*dst->pitch +
+		       dstrect->x*df->BytesPerPixel;
+		row = SDL_StretchGetRow(&info, ymap[y] >> 8);
+		if ( filter == SDL_STRETCH_BILINEAR && (ymap[y] & 0xFF) ) {
+			row1 = SDL_StretchGetRow(&info, (ymap[y] >> 8) + 1);
+			done = 0;
+			if ( blend_kernel ) {
+				done = blend_kernel(row, row1, out,
+				                    info.width, ymap[y] & 0xFF);
+			}
+			SDL_StretchBlendRows(row + done, row1 + done, out + done,
+			                     info.width - done, ymap[y] & 0xFF);
+			row = out;
+		} else if ( filter == SDL_STRETCH_BOX &&
+		            (n = BOX_COUNT(ymap, y)) > 1 ) {
+			SDL_memset(acc, 0, 4*info.width*sizeof(Uint32));
+			for ( ; n; --n ) {
+				row = SDL_StretchGetRow(&info,
+				                        (ymap[y] >> 8) + n-1);
+				for ( i = 0; i < info.width; ++i ) {
+					c = row[i];
+					acc[i*4+0] += c >> 24;
+					acc[i*4+1] += (c >> 16) & 0xFF;
+					acc[i*4+2] += (c >> 8) & 0xFF;
+					acc[i*4+3] += c & 0xFF;
+				}
+			}
+			for ( i = 0; i < info.width; ++i ) {
+				out[i] = (((acc[i*4+0] * yinv[y] + 0x8000) >> 16) << 24) |
+				         (((acc[i*4+1] * yinv[y] + 0x8000) >> 16) << 16) |
+				         (((acc[i*4+2] * yinv[y] + 0x8000) >> 16) << 8) |
+				         ((acc[i*4+3] * yinv[y] + 0x8000) >> 16);
+			}
+			row = out;
+		}
+		done = 0;
+		if ( pack_kernel ) {
+			done = pack_kernel(row, dstp, info.width);
+		}
+		SDL_PackRow(row, dstp, done, info.width, df);
+	}
+
+	/* We need to unlock the surfaces if they're locked */
+	if ( dst_locked ) {
+		SDL_UnlockSurface(dst);
+	}
+	if ( src_locked ) {
+		SDL_UnlockSurface(src);
+	}
+	SDL_free(mem);
+	return(0);
+}
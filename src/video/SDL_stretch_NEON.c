@@ -0,0 +1,107 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* NEON row kernels for the filtered stretch
+
+   Each channel is widened to 16 bits and weighted out of 256, which
+   can't overflow, so the sums and shifts match the C code exactly.
+*/
+
+#include "SDL_video.h"
+#include "SDL_stretch_NEON.h"
+
+#if SDL_NEON_BLITTERS
+
+#include <arm_neon.h>
+
+/* One pixel blended from src[x] and src[x+1], in 16-bit lanes */
+static __inline__ uint16x4_t SDL_StretchPair(const Uint32 *src, Uint32 x)
+{
+	const uint16_t f = x & 0xFF;
+	uint16x8_t p;
+
+	p = vmovl_u8(vld1_u8((const uint8_t *)(src + (x >> 8))));
+	p = vmulq_u16(p, vcombine_u16(vdup_n_u16(256 - f), vdup_n_u16(f)));
+	return vadd_u16(vget_low_u16(p), vget_high_u16(p));
+}
+
+int SDL_StretchRowBilinear_NEON(const Uint32 *src, Uint32 *dst, int width, const Uint32 *xmap)
+{
+	uint8x8_t lo, hi;
+	int i;
+
+	for ( i = 0; i + 4 <= width; i += 4 ) {
+		lo = vshrn_n_u16(vcombine_u16(SDL_StretchPair(src, xmap[i]),
+		                              SDL_StretchPair(src, xmap[i+1])), 8);
+		hi = vshrn_n_u16(vcombine_u16(SDL_StretchPair(src, xmap[i+2]),
+		                              SDL_StretchPair(src, xmap[i+3])), 8);
+		vst1q_u8((uint8_t *)(dst + i), vcombine_u8(lo, hi));
+	}
+	return(i);
+}
+
+int SDL_StretchBlendRows_NEON(const Uint32 *row0, const Uint32 *row1, Uint32 *dst, int width, int weight)
+{
+	const uint16_t w0 = 256 - weight;
+	const uint16_t w1 = weight;
+	uint8x16_t a, b;
+	uint16x8_t lo, hi;
+	int i;
+
+	for ( i = 0; i + 4 <= width; i += 4 ) {
+		a = vld1q_u8((const uint8_t *)(row0 + i));
+		b = vld1q_u8((const uint8_t *)(row1 + i));
+		lo = vmulq_n_u16(vmovl_u8(vget_low_u8(a)), w0);
+		lo = vmlaq_n_u16(lo, vmovl_u8(vget_low_u8(b)), w1);
+		hi = vmulq_n_u16(vmovl_u8(vget_high_u8(a)), w0);
+		hi = vmlaq_n_u16(hi, vmovl_u8(vget_high_u8(b)), w1);
+		vst1q_u8((uint8_t *)(dst + i),
+		         vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+	}
+	return(i);
+}
+
+/* Four pixels packed into RGB565 */
+static __inline__ uint16x4_t SDL_StretchPack565(uint32x4_t p)
+{
+	uint32x4_t v;
+
+	v = vandq_u32(vshrq_n_u32(p, 8), vdupq_n_u32(0xF800));
+	v = vorrq_u32(v, vandq_u32(vshrq_n_u32(p, 5), vdupq_n_u32(0x07E0)));
+	v = vorrq_u32(v, vandq_u32(vshrq_n_u32(p, 3), vdupq_n_u32(0x001F)));
+	return vmovn_u32(v);
+}
+
+int SDL_StretchPackRGB565_NEON(const Uint32 *src, Uint8 *dst, int width)
+{
+	int i;
+
+	for ( i = 0; i + 8 <= width; i += 8 ) {
+		vst1q_u16((uint16_t *)(dst + i*2),
+		          vcombine_u16(SDL_StretchPack565(vld1q_u32(src + i)),
+		                       SDL_StretchPack565(vld1q_u32(src + i + 4))));
+	}
+	return(i);
+}
+
+#endif /* SDL_NEON_BLITTERS */
@@ -0,0 +1,41 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* NEON row kernels for the filtered stretch, working on 32-bit ARGB rows
+   and giving exactly the same results as the C code.  Each handles whole
+   blocks of pixels at the start of a row, and returns the number of
+   pixels it did, leaving the rest of the row to the caller.
+*/
+
+#if defined(SDL_ASSEMBLY_ROUTINES) && \
+    (defined(__ARM_NEON__) || defined(__ARM_NEON))
+#define SDL_NEON_BLITTERS	1
+
+/* Blends each pair of pixels src[x >> 8] and src[(x >> 8) + 1] by the
+   weight in the low 8 bits of each xmap entry */
+extern int SDL_StretchRowBilinear_NEON(const Uint32 *src, Uint32 *dst, int width, const Uint32 *xmap);
+/* Blends two rows, weighting row1 by 'weight' out of 256 */
+extern int SDL_StretchBlendRows_NEON(const Uint32 *row0, const Uint32 *row1, Uint32 *dst, int width, int weight);
+/* Packs a row into RGB565 */
+extern int SDL_StretchPackRGB565_NEON(const Uint32 *src, Uint8 *dst, int width);
+#endif
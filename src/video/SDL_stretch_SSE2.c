@@ -0,0 +1,119 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* SSE2 row kernels for the filtered stretch
+
+   Each channel is widened to 16 bits and weighted out of 256, which
+   can't overflow, so the sums and shifts match the C code exactly.
+*/
+
+#include "SDL_video.h"
+#include "SDL_stretch_SSE2.h"
+
+#if SDL_SSE2_BLITTERS
+
+#include <emmintrin.h>
+
+/* The low 16 bits of each 32-bit lane, packed without saturating */
+static __inline__ __m128i SDL_StretchPack16(__m128i lo, __m128i hi)
+{
+	lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+	hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+	return _mm_packs_epi32(lo, hi);
+}
+
+/* One pixel blended from src[x] and src[x+1], in the low four lanes */
+static __inline__ __m128i SDL_StretchPair(const Uint32 *src, Uint32 x)
+{
+	const int f = x & 0xFF;
+	const int g = 256 - f;
+	__m128i p;
+
+	p = _mm_loadl_epi64((const __m128i *)(src + (x >> 8)));
+	p = _mm_unpacklo_epi8(p, _mm_setzero_si128());
+	p = _mm_mullo_epi16(p, _mm_set_epi16(f, f, f, f, g, g, g, g));
+	return _mm_add_epi16(p, _mm_srli_si128(p, 8));
+}
+
+int SDL_StretchRowBilinear_SSE2(const Uint32 *src, Uint32 *dst, int width, const Uint32 *xmap)
+{
+	__m128i lo, hi;
+	int i;
+
+	for ( i = 0; i + 4 <= width; i += 4 ) {
+		lo = _mm_unpacklo_epi64(SDL_StretchPair(src, xmap[i]),
+		                        SDL_StretchPair(src, xmap[i+1]));
+		hi = _mm_unpacklo_epi64(SDL_StretchPair(src, xmap[i+2]),
+		                        SDL_StretchPair(src, xmap[i+3]));
+		lo = _mm_srli_epi16(lo, 8);
+		hi = _mm_srli_epi16(hi, 8);
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(lo, hi));
+	}
+	return(i);
+}
+
+int SDL_StretchBlendRows_SSE2(const Uint32 *row0, const Uint32 *row1, Uint32 *dst, int width, int weight)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i w0 = _mm_set1_epi16(256 - weight);
+	const __m128i w1 = _mm_set1_epi16(weight);
+	__m128i a, b, lo, hi;
+	int i;
+
+	for ( i = 0; i + 4 <= width; i += 4 ) {
+		a = _mm_loadu_si128((const __m128i *)(row0 + i));
+		b = _mm_loadu_si128((const __m128i *)(row1 + i));
+		lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), w0),
+		                   _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), w1));
+		hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), w0),
+		                   _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), w1));
+		lo = _mm_srli_epi16(lo, 8);
+		hi = _mm_srli_epi16(hi, 8);
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(lo, hi));
+	}
+	return(i);
+}
+
+int SDL_StretchPackRGB565_SSE2(const Uint32 *src, Uint8 *dst, int width)
+{
+	const __m128i rmask = _mm_set1_epi32(0xF800);
+	const __m128i gmask = _mm_set1_epi32(0x07E0);
+	const __m128i bmask = _mm_set1_epi32(0x001F);
+	__m128i p, q;
+	int i;
+
+	for ( i = 0; i + 8 <= width; i += 8 ) {
+		p = _mm_loadu_si128((const __m128i *)(src + i));
+		q = _mm_loadu_si128((const __m128i *)(src + i + 4));
+		p = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(p, 8), rmask),
+		    _mm_or_si128(_mm_and_si128(_mm_srli_epi32(p, 5), gmask),
+		                 _mm_and_si128(_mm_srli_epi32(p, 3), bmask)));
+		q = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(q, 8), rmask),
+		    _mm_or_si128(_mm_and_si128(_mm_srli_epi32(q, 5), gmask),
+		                 _mm_and_si128(_mm_srli_epi32(q, 3), bmask)));
+		_mm_storeu_si128((__m128i *)(dst + i*2), SDL_StretchPack16(p, q));
+	}
+	return(i);
+}
+
+#endif /* SDL_SSE2_BLITTERS */
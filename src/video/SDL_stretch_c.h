@@ -21,7 +21,8 @@
 */
 #include "SDL_config.h"
 
-/* Perform a stretch blit between two surfaces of the same format.
+/* Perform a stretch blit between two surfaces of the same format, or
+   convert on the way if their depths differ.
    NOTE:  This function is not safe to call from multiple threads!
 */
 extern int SDL_SoftStretch(SDL_Surface *src, SDL_Rect *srcrect,
@@ -533,6 +533,187 @@ int SDL_UpperBlit (SDL_Surface *src, SDL_Rect *srcrect,
 	return 0;
 }
 
+/*
+ * Blit a batch of rectangles onto one surface
+ */
+int SDL_BlitSurfaces (SDL_BlitEntry *blits, int numblits, SDL_Surface *dst,
+		      SDL_Rect *dirty, int *numdirty)
+{
+	SDL_BlitEntry *blit, *run, *end;
+	SDL_Surface *src;
+	int srcx, srcy, w, h, dx, dy;
+	int clip_x, clip_y, clip_w, clip_h;
+	int dst_locked;
+	int ndirty;
+	int retval;
+
+	ndirty = 0;
+	if ( numdirty ) {
+		*numdirty = 0;
+	}
+	if ( ! dst ) {
+		SDL_SetError("SDL_BlitSurfaces: passed a NULL surface");
+		return(-1);
+	}
+	if ( dst->locked ) {
+		SDL_SetError("Surfaces must not be locked during blit");
+		return(-1);
+	}
+	end = blits + numblits;
+
+	/* Clip every blit first, the same way SDL_UpperBlit() does */
+	clip_x = dst->clip_rect.x;
+	clip_y = dst->clip_rect.y;
+	clip_w = dst->clip_rect.w;
+	clip_h = dst->clip_rect.h;
+	for ( blit = blits; blit < end; ++blit ) {
+		src = blit->src;
+		if ( ! src ) {
+			SDL_SetError("SDL_BlitSurfaces: passed a NULL surface");
+			return(-1);
+		}
+		if ( src->locked ) {
+			SDL_SetError("Surfaces must not be locked during blit");
+			return(-1);
+		}
+
+		srcx = blit->srcrect.x;
+		w = blit->srcrect.w;
+		if ( srcx < 0 ) {
+			w += srcx;
+			blit->dstrect.x -= srcx;
+			srcx = 0;
+		}
+		if ( w > src->w - srcx ) {
+			w = src->w - srcx;
+		}
+		srcy = blit->srcrect.y;
+		h = blit->srcrect.h;
+		if ( srcy < 0 ) {
+			h += srcy;
+			blit->dstrect.y -= srcy;
+			srcy = 0;
+		}
+		if ( h > src->h - srcy ) {
+			h = src->h - srcy;
+		}
+
+		dx = clip_x - blit->dstrect.x;
+		if ( dx > 0 ) {
+			w -= dx;
+			blit->dstrect.x += dx;
+			srcx += dx;
+		}
+		dx = blit->dstrect.x + w - clip_x - clip_w;
+		if ( dx > 0 ) {
+			w -= dx;
+		}
+		dy = clip_y - blit->dstrect.y;
+		if ( dy > 0 ) {
+			h -= dy;
+			blit->dstrect.y += dy;
+			srcy += dy;
+		}
+		dy = blit->dstrect.y + h - clip_y - clip_h;
+		if ( dy > 0 ) {
+			h -= dy;
+		}
+
+		if ( w > 0 && h > 0 ) {
+			blit->srcrect.x = srcx;
+			blit->srcrect.y = srcy;
+			blit->srcrect.w = blit->dstrect.w = w;
+			blit->srcrect.h = blit->dstrect.h = h;
+		} else {
+			blit->dstrect.w = blit->dstrect.h = 0;
+		}
+	}
+
+	/* Now run them, a run of entries from one source at a time.  The
+	   software blits lock the destination too, but with it already
+	   locked that is only a count, not a trip to the driver.  Hardware
+	   blits need it unlocked.
+	 */
+	retval = 0;
+	dst_locked = 0;
+	for ( blit = blits; blit < end; blit = run ) {
+		src = blit->src;
+		for ( run = blit+1; run < end && run->src == src; ++run ) {
+			/* Find the end of the run */ ;
+		}
+		if ( (src->map->dst != dst) ||
+		     (src->map->dst->format_version != src->map->format_version) ) {
+			if ( SDL_MapSurface(src, dst) < 0 ) {
+				retval = -1;
+				break;
+			}
+		}
+		if ( (src->flags & SDL_HWACCEL) == SDL_HWACCEL ) {
+			if ( dst_locked ) {
+				SDL_UnlockSurface(dst);
+				dst_locked = 0;
+			}
+			for ( ; blit < run && retval == 0; ++blit ) {
+				if ( blit->dstrect.w ) {
+					retval = SDL_LowerBlit(src, &blit->srcrect,
+					                       dst, &blit->dstrect);
+				}
+			}
+		} else {
+			if ( ! dst_locked && SDL_MUSTLOCK(dst) ) {
+				if ( SDL_LockSurface(dst) < 0 ) {
+					retval = -1;
+					break;
+				}
+				dst_locked = 1;
+			}
+			if ( src->map->sw_blit == SDL_SoftBlit ) {
+				retval = SDL_SoftBlitBatch(src, dst, blit, run-blit);
+			} else {
+				/* RLE blits */
+				for ( ; blit < run && retval == 0; ++blit ) {
+					if ( blit->dstrect.w ) {
+						retval = src->map->sw_blit(src,
+						 &blit->srcrect, dst, &blit->dstrect);
+					}
+				}
+			}
+		}
+		if ( retval < 0 ) {
+			break;
+		}
+	}
+	if ( dirty && retval == 0 ) {
+		for ( blit = blits; blit < end; ++blit ) {
+			if ( blit->dstrect.w ) {
+				dirty[ndirty++] = blit->dstrect;
+			}
+		}
+	}
+	if ( dst_locked ) {
+		SDL_UnlockSurface(dst);
+	}
+	if ( numdirty ) {
+		*numdirty = ndirty;
+	}
+	return(retval);
+}
+
+/*
+ * Report which blit routine SDL_LowerBlit() uses between two surfaces
+ */
+const char * SDL_GetBlitName (SDL_Surface *src, SDL_Surface *dst)
+{
+	/* Make sure the blit mapping is valid, as SDL_LowerBlit() does */
+	if ( (src->map->dst != dst) ||
+             (src->map->dst->format_version != src->map->format_version) ) {
+		if ( SDL_MapSurface(src, dst) < 0 ) {
+			return(NULL);
+		}
+	}
+	return(SDL_CalculatedBlitName(src));
+}
+
 static int SDL_FillRect1(SDL_Surface *dst, SDL_Rect *dstrect, Uint32 color)
 {
 	/* FIXME: We have to worry about packing order.. *sigh* */
@@ -258,6 +258,15 @@ struct SDL_VideoDevice {
 	/* Handle any queued OS events */
 	void (*PumpEvents)(_THIS);
 
+	/* Store up to 'maxfds' file descriptors that become readable when
+	   PumpEvents() has new input to process, and return how many were
+	   stored.  Returning 0, or leaving this NULL, means the driver has
+	   to be polled, and SDL_WaitEvent() falls back to short sleeps.
+	   If PumpEvents() has work to do on time as well, the driver lowers
+	   '*timeout' (-1 on entry, no limit) to the ms until it is due.
+	 */
+	int (*GetEventFDs)(_THIS, int *fds, int maxfds, int *timeout);
+
 	/* * * */
 	/* Data common to all drivers */
 	SDL_Surface *screen;
@@ -271,8 +280,12 @@ struct SDL_VideoDevice {
 	int offset_y;
 	SDL_GrabMode input_grab;
 
+	struct SDL_DirtyRects *dirty;	/* Merged SDL_UpdateRects() input */
+
 	/* Driver information flags */
 	int handles_any_size;	/* Driver handles any size video mode */
+	int coalesce_updates;	/* Merge SDL_UpdateRects() rectangles */
+	int update_align;	/* Snap merged rectangles to this many pixels */
 
 	/* * * */
 	/* Data used by the GL drivers */
@@ -341,6 +354,9 @@ extern VideoBootStrap EzX_bootstrap;
 #if SDL_VIDEO_DRIVER_QTOPIA4
 extern VideoBootStrap Qtopia4_bootstrap;
 #endif
+#if SDL_VIDEO_DRIVER_QOFFSCREEN
+extern VideoBootStrap QOFF_bootstrap;
+#endif
 #if SDL_VIDEO_DRIVER_WSCONS
 extern VideoBootStrap WSCONS_bootstrap;
 #endif
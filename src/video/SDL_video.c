@@ -27,6 +27,7 @@
 #include "SDL_sysvideo.h"
 #include "SDL_blit.h"
 #include "SDL_pixels_c.h"
+#include "SDL_dirtyrect_c.h"
 #include "SDL_cursor_c.h"
 #include "../events/SDL_sysevents.h"
 #include "../events/SDL_events_c.h"
@@ -57,6 +58,9 @@ static VideoBootStrap *bootstrap[] = {
 #if SDL_VIDEO_DRIVER_QTOPIA4
         &Qtopia4_bootstrap,
 #endif
+#if SDL_VIDEO_DRIVER_QOFFSCREEN
+	&QOFF_bootstrap,
+#endif
 #if SDL_VIDEO_DRIVER_WSCONS
 	&WSCONS_bootstrap,
 #endif
@@ -222,6 +226,7 @@ int SDL_VideoInit (const char *driver_name, Uint32 flags)
 	video->wm_icon  = NULL;
 	video->offset_x = 0;
 	video->offset_y = 0;
+	video->dirty = NULL;
 	SDL_memset(&video->info, 0, (sizeof video->info));
 	
 	video->displayformatalphapixel = NULL;
@@ -247,6 +252,14 @@ int SDL_VideoInit (const char *driver_name, Uint32 flags)
 	video->gl_config.accelerated = -1; /* not known, don't set */
 	video->gl_config.swap_control = -1; /* not known, don't set */
 	
+	/* Allow rectangle merging to be forced on or off */
+	{
+		const char *envr = SDL_getenv("SDL_VIDEO_COALESCE_RECTS");
+		if ( envr ) {
+			video->coalesce_updates = SDL_atoi(envr);
+		}
+	}
+
 	/* Initialize the video subsystem */
 	SDL_memset(&vformat, 0, sizeof(vformat));
 	if ( video->VideoInit(video, &vformat) < 0 ) {
@@ -1028,6 +1041,22 @@ void SDL_UpdateRect(SDL_Surface *screen, Sint32 x, Sint32 y, Uint32 w, Uint32 h)
 		SDL_UpdateRects(screen, 1, &rect);
 	}
 }
+int SDL_GetUpdateStats (SDL_UpdateStats *stats)
+{
+	SDL_VideoDevice *video = current_video;
+
+	SDL_memset(stats, 0, sizeof(*stats));
+	if ( !video || !video->dirty ) {
+		SDL_SetError("No updates have been merged");
+		return(-1);
+	}
+	stats->frames = video->dirty->frames;
+	stats->pixels_requested = video->dirty->pixels_in;
+	stats->pixels_updated = video->dirty->pixels_out;
+	stats->full_updates = video->dirty->promotions;
+	return(0);
+}
+
 void SDL_UpdateRects (SDL_Surface *screen, int numrects, SDL_Rect *rects)
 {
 	int i;
@@ -1038,6 +1067,28 @@ void SDL_UpdateRects (SDL_Surface *screen, int numrects, SDL_Rect *rects)
 		SDL_SetError("OpenGL active, use SDL_GL_SwapBuffers()");
 		return;
 	}
+	if ( video->coalesce_updates && (numrects > 0) ) {
+		/* Merge overlapping and nearby rectangles before updating */
+		if ( video->dirty &&
+		     ((video->dirty->w != screen->w) ||
+		      (video->dirty->h != screen->h)) ) {
+			SDL_FreeDirtyRects(video->dirty);
+			video->dirty = NULL;
+		}
+		if ( video->dirty == NULL ) {
+			video->dirty = SDL_CreateDirtyRects(screen->w, screen->h,
+			                                    video->update_align);
+		}
+		if ( video->dirty ) {
+			SDL_ClearDirtyRects(video->dirty);
+			for ( i=0; i<numrects; ++i ) {
+				SDL_AddDirtyRect(video->dirty, &rects[i]);
+			}
+			SDL_CommitDirtyRects(video->dirty);
+			numrects = video->dirty->numrects;
+			rects = video->dirty->rects;
+		}
+	}
 	if ( screen == SDL_ShadowSurface ) {
 		/* Blit the shadow surface using saved mapping */
 		SDL_Palette *pal = screen->format->palette;
@@ -1391,6 +1442,18 @@ void SDL_VideoQuit (void)
 			SDL_free(video->wm_icon);
 			video->wm_icon = NULL;
 		}
+		if ( video->dirty != NULL ) {
+#ifdef DEBUG_VIDEO
+			fprintf(stderr,
+			"Merged updates: %u frames, %.0f pixels requested, %.0f updated, %u full screen\n",
+				video->dirty->frames,
+				(double)video->dirty->pixels_in,
+				(double)video->dirty->pixels_out,
+				video->dirty->promotions);
+#endif
+			SDL_FreeDirtyRects(video->dirty);
+			video->dirty = NULL;
+		}
 
 		/* Finish cleaning up video subsystem */
 		video->free(this);
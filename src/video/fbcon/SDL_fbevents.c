@@ -1078,6 +1078,24 @@ void FB_PumpEvents(_THIS)
 	} while ( posted );
 }
 
+int FB_GetEventFDs(_THIS, int *fds, int maxfds, int *timeout)
+{
+	int numfds;
+
+	/* Returning to our console isn't signalled on the descriptors */
+	if ( switched_away ) {
+		return(0);
+	}
+	numfds = 0;
+	if ( (keyboard_fd >= 0) && (numfds < maxfds) ) {
+		fds[numfds++] = keyboard_fd;
+	}
+	if ( (mouse_fd >= 0) && (numfds < maxfds) ) {
+		fds[numfds++] = mouse_fd;
+	}
+	return(numfds);
+}
+
 void FB_InitOSKeymap(_THIS)
 {
 	int i;
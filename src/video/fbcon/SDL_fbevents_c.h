@@ -36,3 +36,4 @@ extern void FB_LeaveGraphicsMode(_THIS);
 
 extern void FB_InitOSKeymap(_THIS);
 extern void FB_PumpEvents(_THIS);
+extern int FB_GetEventFDs(_THIS, int *fds, int maxfds, int *timeout);
@@ -0,0 +1,428 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Offscreen emulation of the Qtopia4 video driver.
+
+   The "framebuffer" is plain memory, or a file mapped into memory, with
+   the same layout as the device screen.  Screen updates go through the
+   same conversion, rotation and presentation code as the Qtopia4 driver,
+   so that code can be profiled and tested on any Linux box:
+
+     SDL_VIDEODRIVER=qoffscreen
+     SDL_QOFFSCREEN_GEOMETRY=240x320	physical screen size
+     SDL_QOFFSCREEN_DEPTH=18		16, 18, 24 or 32
+     SDL_QOFFSCREEN_FILE=/tmp/fb	map this file instead of using memory
+     SDL_QT_INVERT_ROTATION=1		as for the Qtopia4 driver
+*/
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "SDL_video.h"
+#include "SDL_mouse.h"
+#include "../SDL_sysvideo.h"
+#include "../SDL_pixels_c.h"
+#include "../../events/SDL_events_c.h"
+
+#include "SDL_qoffvideo.h"
+
+#define QOFFVID_DRIVER_NAME "qoffscreen"
+
+/* Initialization/Query functions */
+static int QOFF_VideoInit(_THIS, SDL_PixelFormat *vformat);
+static SDL_Rect **QOFF_ListModes(_THIS, SDL_PixelFormat *format, Uint32 flags);
+static SDL_Surface *QOFF_SetVideoMode(_THIS, SDL_Surface *current, int width, int height, int bpp, Uint32 flags);
+static int QOFF_SetColors(_THIS, int firstcolor, int ncolors, SDL_Color *colors);
+static void QOFF_VideoQuit(_THIS);
+
+/* Hardware surface functions */
+static int QOFF_AllocHWSurface(_THIS, SDL_Surface *surface);
+static int QOFF_LockHWSurface(_THIS, SDL_Surface *surface);
+static void QOFF_UnlockHWSurface(_THIS, SDL_Surface *surface);
+static void QOFF_FreeHWSurface(_THIS, SDL_Surface *surface);
+static int QOFF_FlipHWSurface(_THIS, SDL_Surface *surface);
+
+/* etc. */
+static void QOFF_UpdateRects(_THIS, int numrects, SDL_Rect *rects);
+static void QOFF_InitOSKeymap(_THIS);
+static void QOFF_PumpEvents(_THIS);
+
+/* QOFF driver bootstrap functions */
+
+static int QOFF_Available(void)
+{
+	const char *envr = SDL_getenv("SDL_VIDEODRIVER");
+	if ((envr) && (SDL_strcmp(envr, QOFFVID_DRIVER_NAME) == 0)) {
+		return(1);
+	}
+
+	return(0);
+}
+
+static void QOFF_DeleteDevice(SDL_VideoDevice *device)
+{
+	SDL_free(device->hidden);
+	SDL_free(device);
+}
+
+static SDL_VideoDevice *QOFF_CreateDevice(int devindex)
+{
+	SDL_VideoDevice *device;
+
+	/* Initialize all variables that we clean on shutdown */
+	device = (SDL_VideoDevice *)SDL_malloc(sizeof(SDL_VideoDevice));
+	if ( device ) {
+		SDL_memset(device, 0, (sizeof *device));
+		device->hidden = (struct SDL_PrivateVideoData *)
+				SDL_malloc((sizeof *device->hidden));
+	}
+	if ( (device == NULL) || (device->hidden == NULL) ) {
+		SDL_OutOfMemory();
+		if ( device ) {
+			SDL_free(device);
+		}
+		return(0);
+	}
+	SDL_memset(device->hidden, 0, (sizeof *device->hidden));
+
+	/* Set the function pointers */
+	device->VideoInit = QOFF_VideoInit;
+	device->ListModes = QOFF_ListModes;
+	device->SetVideoMode = QOFF_SetVideoMode;
+	device->CreateYUVOverlay = NULL;
+	device->SetColors = QOFF_SetColors;
+	device->UpdateRects = QOFF_UpdateRects;
+	device->VideoQuit = QOFF_VideoQuit;
+	device->AllocHWSurface = QOFF_AllocHWSurface;
+	device->CheckHWBlit = NULL;
+	device->FillHWRect = NULL;
+	device->SetHWColorKey = NULL;
+	device->SetHWAlpha = NULL;
+	device->LockHWSurface = QOFF_LockHWSurface;
+	device->UnlockHWSurface = QOFF_UnlockHWSurface;
+	device->FlipHWSurface = QOFF_FlipHWSurface;
+	device->FreeHWSurface = QOFF_FreeHWSurface;
+	device->SetCaption = NULL;
+	device->SetIcon = NULL;
+	device->IconifyWindow = NULL;
+	device->GrabInput = NULL;
+	device->GetWMInfo = NULL;
+	device->InitOSKeymap = QOFF_InitOSKeymap;
+	device->PumpEvents = QOFF_PumpEvents;
+
+	device->free = QOFF_DeleteDevice;
+
+	/* Same update handling as the Qtopia4 driver */
+	device->coalesce_updates = 1;
+	device->update_align = QB_TILE_SIZE;
+
+	return device;
+}
+
+VideoBootStrap QOFF_bootstrap = {
+	QOFFVID_DRIVER_NAME, "Offscreen Qtopia4 framebuffer emulation",
+	QOFF_Available, QOFF_CreateDevice
+};
+
+
+static int QOFF_OpenFramebuffer(_THIS)
+{
+	QB_Buffer *screen = &this->hidden->screen;
+	const char *envr;
+	size_t size;
+	int bpp;
+
+	screen->w = 240;
+	screen->h = 320;
+	screen->depth = 18;
+	envr = SDL_getenv("SDL_QOFFSCREEN_GEOMETRY");
+	if ( envr ) {
+		SDL_sscanf(envr, "%dx%d", &screen->w, &screen->h);
+	}
+	envr = SDL_getenv("SDL_QOFFSCREEN_DEPTH");
+	if ( envr ) {
+		screen->depth = SDL_atoi(envr);
+	}
+	bpp = QB_BytesPerPixel(screen->depth);
+	if ( (screen->w <= 0) || (screen->h <= 0) || !bpp ) {
+		SDL_SetError("Unsupported framebuffer %dx%dx%d",
+		             screen->w, screen->h, screen->depth);
+		return(-1);
+	}
+	screen->pitch = screen->w * bpp;
+	size = screen->pitch * screen->h;
+
+	envr = SDL_getenv("SDL_QOFFSCREEN_FILE");
+	if ( envr ) {
+		int fd = open(envr, O_RDWR|O_CREAT|O_TRUNC, 0644);
+		if ( fd < 0 ) {
+			SDL_SetError("Unable to open %s", envr);
+			return(-1);
+		}
+		if ( ftruncate(fd, size) < 0 ) {
+			close(fd);
+			SDL_SetError("Unable to resize %s", envr);
+			return(-1);
+		}
+		screen->pixels = (Uint8 *)mmap(NULL, size, PROT_READ|PROT_WRITE,
+		                               MAP_SHARED, fd, 0);
+		close(fd);
+		if ( screen->pixels == (Uint8 *)MAP_FAILED ) {
+			screen->pixels = NULL;
+			SDL_SetError("Unable to memory map %s", envr);
+			return(-1);
+		}
+		this->hidden->mapsize = size;
+	} else {
+		screen->pixels = (Uint8 *)SDL_malloc(size);
+		if ( screen->pixels == NULL ) {
+			SDL_OutOfMemory();
+			return(-1);
+		}
+		SDL_memset(screen->pixels, 0, size);
+	}
+	return(0);
+}
+
+int QOFF_VideoInit(_THIS, SDL_PixelFormat *vformat)
+{
+	QB_Buffer *screen = &this->hidden->screen;
+
+	if ( QOFF_OpenFramebuffer(this) < 0 ) {
+		return(-1);
+	}
+
+	/* Like the Qtopia4 driver, SDL draws RGB565 in portrait or
+	   landscape orientation */
+	this->hidden->modes[0].w = screen->w;
+	this->hidden->modes[0].h = screen->h;
+	this->hidden->modes[1].w = screen->h;
+	this->hidden->modes[1].h = screen->w;
+	this->hidden->modelist[0] = &this->hidden->modes[0];
+	this->hidden->modelist[1] = &this->hidden->modes[1];
+	this->hidden->modelist[2] = NULL;
+
+	vformat->BitsPerPixel = 16;
+	vformat->BytesPerPixel = 2;
+	vformat->Rmask = 0xF800;
+	vformat->Gmask = 0x07E0;
+	vformat->Bmask = 0x001F;
+
+	this->info.current_w = screen->w;
+	this->info.current_h = screen->h;
+
+	/* We're done! */
+	return(0);
+}
+
+SDL_Rect **QOFF_ListModes(_THIS, SDL_PixelFormat *format, Uint32 flags)
+{
+	if ( format->BitsPerPixel != 16 ) {
+		return((SDL_Rect **)0);
+	}
+	if ( (flags & SDL_FULLSCREEN) == SDL_FULLSCREEN ) {
+		return(this->hidden->modelist);
+	}
+	return((SDL_Rect **)-1);
+}
+
+static void QOFF_FreeBuffers(_THIS)
+{
+	if ( this->hidden->presenter ) {
+		QB_DestroyPresenter(this->hidden->presenter);
+		this->hidden->presenter = NULL;
+	}
+	SDL_free(this->hidden->buffers[0]);
+	SDL_free(this->hidden->buffers[1]);
+	this->hidden->buffers[0] = NULL;
+	this->hidden->buffers[1] = NULL;
+	this->hidden->current = 0;
+}
+
+SDL_Surface *QOFF_SetVideoMode(_THIS, SDL_Surface *current,
+				int width, int height, int bpp, Uint32 flags)
+{
+	QB_Buffer *screen = &this->hidden->screen;
+	const char *envr;
+	int i, nbuffers;
+
+	QOFF_FreeBuffers(this);
+
+	if ( (width <= screen->w) && (height <= screen->h) ) {
+		this->hidden->rotation = QB_NO_ROTATION;
+		current->w = screen->w;
+		current->h = screen->h;
+	} else if ( (width <= screen->h) && (height <= screen->w) ) {
+		envr = SDL_getenv("SDL_QT_INVERT_ROTATION");
+		if ( envr && SDL_atoi(envr) ) {
+			this->hidden->rotation = QB_COUNTERCLOCKWISE;
+		} else {
+			this->hidden->rotation = QB_CLOCKWISE;
+		}
+		current->w = screen->h;
+		current->h = screen->w;
+	} else {
+		SDL_SetError("Unsupported resolution, %dx%d", width, height);
+		return(NULL);
+	}
+
+	/* Allocate the new pixel format for the screen */
+	if ( ! SDL_ReallocFormat(current, 16, 0xF800, 0x07E0, 0x001F, 0) ) {
+		SDL_SetError("Couldn't allocate new pixel format for requested mode");
+		return(NULL);
+	}
+
+	current->flags = flags & SDL_FULLSCREEN;
+	current->pitch = (current->w * 2 + 3) & ~3;
+
+	nbuffers = (flags & SDL_DOUBLEBUF) ? 2 : 1;
+	for ( i = 0; i < nbuffers; ++i ) {
+		this->hidden->buffers[i] = (Uint8 *)SDL_malloc(current->pitch * current->h);
+		if ( this->hidden->buffers[i] == NULL ) {
+			QOFF_FreeBuffers(this);
+			SDL_SetError("Couldn't allocate buffer for requested mode");
+			return(NULL);
+		}
+		SDL_memset(this->hidden->buffers[i], 0, current->pitch * current->h);
+	}
+	if ( nbuffers == 2 ) {
+		/* QOFF_FreeBuffers() stops it before the buffers go away */
+		this->hidden->presenter = QB_CreatePresenter();
+		current->flags |= SDL_HWSURFACE | SDL_DOUBLEBUF;
+	}
+	current->pixels = this->hidden->buffers[0];
+
+	/* We're done */
+	return(current);
+}
+
+/* We don't actually allow hardware surfaces other than the main one */
+static int QOFF_AllocHWSurface(_THIS, SDL_Surface *surface)
+{
+	return(-1);
+}
+static void QOFF_FreeHWSurface(_THIS, SDL_Surface *surface)
+{
+	return;
+}
+
+static int QOFF_LockHWSurface(_THIS, SDL_Surface *surface)
+{
+	return(0);
+}
+
+static void QOFF_UnlockHWSurface(_THIS, SDL_Surface *surface)
+{
+	return;
+}
+
+static void QOFF_GetBuffer(_THIS, int index, QB_Buffer *buffer)
+{
+	buffer->pixels = this->hidden->buffers[index];
+	buffer->w = this->screen->w;
+	buffer->h = this->screen->h;
+	buffer->pitch = this->screen->pitch;
+	buffer->depth = 16;
+}
+
+static int QOFF_FlipHWSurface(_THIS, SDL_Surface *surface)
+{
+	QB_Buffer src;
+	SDL_Rect area;
+	int shown;
+
+	if ( this->hidden->presenter ) {
+		QB_WaitPresent(this->hidden->presenter);
+	}
+
+	shown = this->hidden->current;
+	this->hidden->current = !shown;
+	surface->pixels = this->hidden->buffers[this->hidden->current];
+
+	QOFF_GetBuffer(this, shown, &src);
+	area.x = 0;
+	area.y = 0;
+	area.w = src.w;
+	area.h = src.h;
+	if ( !this->hidden->presenter ||
+	     QB_PresentAsync(this->hidden->presenter, &src,
+	                     &this->hidden->screen, this->hidden->rotation,
+	                     &area, 1) < 0 ) {
+		QB_BlitRect(&src, &this->hidden->screen,
+		            this->hidden->rotation, &area);
+	}
+	return(0);
+}
+
+static void QOFF_UpdateRects(_THIS, int numrects, SDL_Rect *rects)
+{
+	QB_Buffer src;
+	int i;
+
+	if ( this->hidden->buffers[0] == NULL ) {
+		return;
+	}
+	if ( this->hidden->presenter ) {
+		QB_WaitPresent(this->hidden->presenter);
+	}
+	QOFF_GetBuffer(this, this->hidden->current, &src);
+	for ( i = 0; i < numrects; ++i ) {
+		QB_BlitRect(&src, &this->hidden->screen,
+		            this->hidden->rotation, &rects[i]);
+	}
+}
+
+int QOFF_SetColors(_THIS, int firstcolor, int ncolors, SDL_Color *colors)
+{
+	/* There is no palette */
+	return(0);
+}
+
+static void QOFF_InitOSKeymap(_THIS)
+{
+	/* do nothing. */
+}
+
+static void QOFF_PumpEvents(_THIS)
+{
+	/* do nothing. */
+}
+
+/* Note:  If we are terminated, this could be called in the middle of
+   another SDL video routine -- notably UpdateRects.
+*/
+void QOFF_VideoQuit(_THIS)
+{
+	QOFF_FreeBuffers(this);
+	if ( this->screen ) {
+		this->screen->pixels = NULL;
+	}
+	if ( this->hidden->mapsize ) {
+		munmap(this->hidden->screen.pixels, this->hidden->mapsize);
+	} else {
+		SDL_free(this->hidden->screen.pixels);
+	}
+	this->hidden->screen.pixels = NULL;
+	this->hidden->mapsize = 0;
+}
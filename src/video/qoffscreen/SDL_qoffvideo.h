@@ -0,0 +1,52 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#ifndef _SDL_qoffvideo_h
+#define _SDL_qoffvideo_h
+
+#include "../SDL_sysvideo.h"
+#include "../qtopia4/SDL_qblit.h"
+#include "../qtopia4/SDL_qpresent.h"
+
+/* Hidden "this" pointer for the video functions */
+#define _THIS	SDL_VideoDevice *this
+
+
+/* Private display data */
+
+struct SDL_PrivateVideoData {
+    /* The emulated device framebuffer */
+    QB_Buffer screen;
+    size_t mapsize;		/* non-zero if screen.pixels is a mapped file */
+
+    /* The RGB565 surface(s) SDL draws into, and how they are rotated */
+    QB_Rotation rotation;
+    Uint8 *buffers[2];
+    int current;		/* index of the buffer SDL draws into */
+    QB_Presenter *presenter;	/* converts the other one when flipping */
+
+    SDL_Rect modes[2];
+    SDL_Rect *modelist[3];
+};
+
+#endif /* _SDL_qoffvideo_h */
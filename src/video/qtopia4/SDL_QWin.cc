@@ -45,21 +45,41 @@
 
 SDL_QWin::SDL_QWin(QWidget * parent, Qt::WindowFlags f)
   : QWidget(parent, f), 
-  rotationMode(NoRotation), backBuffer(NULL), useRightMouseButton(false)
+  rotationMode(NoRotation), backBuffer(NULL), frontBuffer(NULL),
+  presenter(NULL), useRightMouseButton(false)
 {
   painter = new QDirectPainter(this, QDirectPainter::Reserved); 
   painter->setGeometry(QApplication::desktop()->screenGeometry());
     // TODO: Find out how to avoid reserving the whole screen
-  vmem = QDirectPainter::frameBuffer();
+  screen.pixels = QDirectPainter::frameBuffer();
+  screen.w = QDirectPainter::screenWidth();
+  screen.h = QDirectPainter::screenHeight();
+  screen.pitch = QDirectPainter::linestep();
+  screen.depth = QDirectPainter::screenDepth();
 }
 
 SDL_QWin::~SDL_QWin() {
+  finishFlip(true);
+  if (presenter)
+    QB_DestroyPresenter(presenter);
   delete backBuffer;
+  delete frontBuffer;
 }
 
-void SDL_QWin::setBackBuffer(SDL_QWin::Rotation new_rotation, QImage *new_buffer) {
-  int w = QDirectPainter::screenWidth();
-  int h = QDirectPainter::screenHeight();
+static void imageToBuffer(QImage *image, QB_Buffer *buffer) {
+  buffer->pixels = image->bits();
+  buffer->w = image->width();
+  buffer->h = image->height();
+  buffer->pitch = image->bytesPerLine();
+  buffer->depth = 16;
+}
+
+void SDL_QWin::setBackBuffer(SDL_QWin::Rotation new_rotation, QImage *new_buffer,
+                             QImage *new_second) {
+  finishFlip(true);
+
+  int w = screen.w;
+  int h = screen.h;
   rotationMode = new_rotation;
   switch (rotationMode) {
     case NoRotation:
@@ -79,7 +99,13 @@ void SDL_QWin::setBackBuffer(SDL_QWin::Rotation new_rotation, QImage *new_buffer
   }      
   toScreen = toSDL.inverted();
   delete backBuffer;
+  delete frontBuffer;
   backBuffer = new_buffer;
+  frontBuffer = new_second;
+
+  // Started with the first double buffered mode and kept until close
+  if (frontBuffer && !presenter)
+    presenter = QB_CreatePresenter();
 }
 
 /**
@@ -139,138 +165,68 @@ void SDL_QWin::mouseReleaseEvent(QMouseEvent *e) {
      mousePosition.x(), mousePosition.y());
 }
 
-void SDL_QWin::flushRegion(const QRegion &region) {
+void SDL_QWin::convertRegion(QImage *buffer, const QRegion &region) {
+  QB_Buffer src;
+  imageToBuffer(buffer, &src);
+
   painter->startPainting();
 
   foreach(const QRect &rect, region.rects()) {
-    /* next - special for 18bpp framebuffer */
-    /* so any other - back off */
-
-#if 1 // Disable rotation for now
-    // 18 bpp - really 3 bytes per pixel
-    if (rotationMode==Clockwise) {
-      QRect rs = backBuffer->rect();
-      QRect rd;
-
-      int id, jd;
-
-      if (rect.y() + rect.height() > 240) {
-        rs.setRect(rect.y(), 240 - rect.width() - rect.x(), rect.height(), rect.width());
-        rd = rect;
-        jd = rect.y() + rect.height() - 1;
-        id = rect.x();
-      } else {
-        rs = rect;
-        rd.setRect(rect.y(), 320 - rect.width() - rect.x(), rect.height(), rect.width());
-        jd = 319 - rect.x();
-        id = rect.y();
-      }
-
-      //printf("rs: %d %d %d %d\n", rs.x(), rs.y(), rs.width(), rs.height());
-      //printf("rd: %d %d %d %d\n", rd.x(), rd.y(), rd.width(), rd.height());
-      //printf("id: %d, jd: %d\n", id, jd);
-
-      int ii = id, jj;
-      uchar *src0 = backBuffer->bits();
-      uchar *dst0 = vmem;
-      uchar *dst, *src;
-
-      src += rs.y() * backBuffer->bytesPerLine() + rs.x() * 2;
-
-      int is_lim = rs.y() + rs.height();
-      int dst_offset = jd * 720 + id * 3;
-      int src_offset = rs.y() * backBuffer->bytesPerLine() + rs.x() * 2;
-
-      for (int ii = rs.y(); ii < is_lim;
-           dst_offset += 3, src_offset += backBuffer->bytesPerLine(), ii++) {
-        dst = dst0 + dst_offset;
-        src = src0 + src_offset;
-        for (int j = 0; j < rs.width(); j++) {
-          unsigned short tmp = ((unsigned short)(src[1] & 0xf8)) << 2;
-          dst[0] = src[0] << 1;
-          dst[1] = ((src[0] & 0x80) >> 7) | ((src[1] & 0x7) << 1) | (tmp & 0xff);
-          dst[2] = (tmp & 0x300) >> 8;
-          dst -= 720;
-          src += 2;
-        }
-      }
-      //printf("done\n");
-    } else if (rotationMode==CounterClockwise) {
-      QRect rs = backBuffer->rect();
-      QRect rd;
-
-      int id, jd;
-
-      if (rect.y() + rect.height() > 240) {
-        rs.setRect(rect.y(), 240 - rect.width() - rect.x(), rect.height(), rect.width());
-        rd = rect;
-        jd = rect.y();
-        id = rect.x() + rect.width() - 1;
-      } else {
-        rs = rect;
-        rd.setRect(rect.y(), 320 - rect.width() - rect.x(), rect.height(), rect.width());
-        jd = rect.x();
-        id = 239 - rect.y();
-      }
-
-      int ii = id, jj;
-      uchar *src0 = backBuffer->bits();
-      uchar *dst0 = vmem;
-      uchar *dst, *src;
-
-      src += rs.y() * backBuffer->bytesPerLine() + rs.x() * 2;
-
-      int is_lim = rs.y() + rs.height();
-      int dst_offset = jd * 720 + id * 3;
-      int src_offset = rs.y() * backBuffer->bytesPerLine() + rs.x() * 2;
-
-      for (int ii = rs.y(); ii < is_lim;
-           dst_offset -= 3, src_offset += backBuffer->bytesPerLine(), ii++) {
-        dst = dst0 + dst_offset;
-        src = src0 + src_offset;
-        for (int j = 0; j < rs.width(); j++) {
-          unsigned short tmp = ((unsigned short)(src[1] & 0xf8)) << 2;
-          dst[0] = src[0] << 1;
-          dst[1] = ((src[0] & 0x80) >> 7) | ((src[1] & 0x7) << 1) | (tmp & 0xff);
-          dst[2] = (tmp & 0x300) >> 8;
-          dst += 720;
-          src += 2;
-        }
-      }
-    } else
-#endif
-    {
-      uchar *src0 = backBuffer->bits();
-      uchar *dst0 = vmem;
-      uchar *dst, *src;
-
-      int is_lim = rect.y() + rect.height();
-      int s_offset = rect.y() * backBuffer->bytesPerLine() + rect.x() * 2;
-      int offset = rect.y() * 720 + rect.x() * 3;
-
-      for (int ii = rect.y(); ii < is_lim; ii++, offset += 720,
-           s_offset += backBuffer->bytesPerLine()) {
-        dst = dst0 + offset;
-        src = src0 + s_offset;
-        for (int j = 0; j < rect.width(); j++) {
-          unsigned short tmp = ((unsigned short)(src[1] & 0xf8)) << 2;
-          dst[0] = src[0] << 1;
-          dst[1] = ((src[0] & 0x80) >> 7) | ((src[1] & 0x7) << 1) | (tmp & 0xff);
-          dst[2] = (tmp & 0x300) >> 8;
-          src += 2;
-          dst += 3;
-        }
-      }
-    }
+    SDL_Rect area;
+    area.x = rect.x();
+    area.y = rect.y();
+    area.w = rect.width();
+    area.h = rect.height();
+    QB_BlitRect(&src, &screen, static_cast<QB_Rotation>(rotationMode), &area);
   }
 
   painter->endPainting(toScreen.map(region));
 }
 
+void SDL_QWin::flushRegion(const QRegion &region) {
+  finishFlip(true);
+  convertRegion(backBuffer, region);
+}
+
+uchar *SDL_QWin::flip() {
+  finishFlip(true);
+
+  QImage *shown = backBuffer;
+  backBuffer = frontBuffer;
+  frontBuffer = shown;
+
+  QB_Buffer src;
+  imageToBuffer(frontBuffer, &src);
+  SDL_Rect area;
+  area.x = 0;
+  area.y = 0;
+  area.w = src.w;
+  area.h = src.h;
+
+  flipRegion = QRegion(frontBuffer->rect());
+  painter->startPainting();
+  if (!presenter || QB_PresentAsync(presenter, &src, &screen,
+        static_cast<QB_Rotation>(rotationMode), &area, 1) < 0) {
+    QB_BlitRect(&src, &screen, static_cast<QB_Rotation>(rotationMode), &area);
+    painter->endPainting(toScreen.map(flipRegion));
+  }
+  return backBuffer->bits();
+}
+
+void SDL_QWin::finishFlip(bool wait) {
+  if (!presenter)
+    return;
+  if (wait ? QB_WaitPresent(presenter) : QB_PollPresent(presenter))
+    painter->endPainting(toScreen.map(flipRegion));
+}
+
 // This paints the current buffer to the screen, when desired.
 void SDL_QWin::paintEvent(QPaintEvent *ev) {
-  if(backBuffer) 
-    flushRegion(toSDL.map(QRegion(ev->rect())));
+  finishFlip(true);
+  // When double buffered, the buffer on screen is the front one
+  QImage *shown = frontBuffer ? frontBuffer : backBuffer;
+  if(shown) 
+    convertRegion(shown, toSDL.map(QRegion(ev->rect())));
 }
 
 void SDL_QWin::keyEvent(bool pressed, QKeyEvent *e) {
@@ -33,6 +33,8 @@
 
 extern "C" {
 #include "../../events/SDL_events_c.h"
+#include "SDL_qblit.h"
+#include "SDL_qpresent.h"
 };
 
 class SDL_QWin : public QWidget {
@@ -50,9 +52,11 @@ public:
   
   /**
    * Instruct window to use \a buffer as framebuffer and assume 
-   * that screen is rotated according to \a rotation
+   * that screen is rotated according to \a rotation.
+   * If \a second is given, the screen is double buffered and
+   * flip() swaps the two.
    */
-  void setBackBuffer(Rotation rotation, QImage *buffer);
+  void setBackBuffer(Rotation rotation, QImage *buffer, QImage *second = 0);
   
   /**
    * Update screen contents from SDL buffer.
@@ -60,6 +64,19 @@ public:
    */
   void flushRegion(const QRegion& region);
 
+  /**
+   * Double buffering: show the back buffer and return the pixels of
+   * the new one. The conversion runs in a background thread and
+   * the display stays locked until finishFlip() sees it complete.
+   */
+  uchar *flip();
+
+  /**
+   * Release the display once the last flip has been converted.
+   * If \a wait is false, return at once when it is still running.
+   */
+  void finishFlip(bool wait);
+
   inline QPoint getMousePosition() const {
     return mousePosition;
   }
@@ -76,14 +93,23 @@ protected:
   void keyReleaseEvent(QKeyEvent *e) { keyEvent(false, e); }
 private:
   void keyEvent(bool pressed, QKeyEvent *e);
+  void convertRegion(QImage *buffer, const QRegion &region);
   void init();
   void suspend();
   void resume();
 
-  uchar *vmem; // FIXME: no need to store it (use QDirectPainter::framebuffer instead)
+  QB_Buffer screen; // Framebuffer as returned by QDirectPainter
   QDirectPainter *painter;
   QImage *backBuffer;
 
+  /**
+   * Double buffering: the buffer on screen, and the thread that
+   * converts it while SDL draws into backBuffer.
+   */
+  QImage *frontBuffer;
+  QB_Presenter *presenter;
+  QRegion flipRegion;
+
   /**
    * Matrices to transform coordinates between SDL and screen systems.
    */
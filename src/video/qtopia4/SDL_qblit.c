@@ -0,0 +1,345 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2006 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#include "SDL_video.h"
+#include "SDL_endian.h"
+#include "SDL_qblit.h"
+
+/* Converts a row of 'width' RGB565 pixels to the framebuffer format */
+typedef void (*QB_RowFunc)(Uint8 *dst, const Uint16 *src, int width);
+
+static void QB_Row565(Uint8 *dst, const Uint16 *src, int width)
+{
+	SDL_memcpy(dst, src, width * 2);
+}
+
+/* 18 bpp: the 5 bit red and blue components go to the top of their
+   6 bit fields, green is copied as is.  The pixel is stored in three
+   bytes, least significant first.
+*/
+static void QB_Row666(Uint8 *dst, const Uint16 *src, int width)
+{
+	while ( width-- ) {
+		Uint32 p = *src++;
+		p = ((p & 0x07FF) << 1) | ((p & 0xF800) << 2);
+		dst[0] = (Uint8)p;
+		dst[1] = (Uint8)(p >> 8);
+		dst[2] = (Uint8)(p >> 16);
+		dst += 3;
+	}
+}
+
+#define RGB565_TO_RGB888(p) \
+	((((p) & 0xF800) << 8) | (((p) & 0xE000) << 3) | \
+	 (((p) & 0x07E0) << 5) | (((p) & 0x0600) >> 1) | \
+	 (((p) & 0x001F) << 3) | (((p) & 0x001C) >> 2))
+
+static void QB_Row888(Uint8 *dst, const Uint16 *src, int width)
+{
+	while ( width-- ) {
+		Uint32 p = *src++;
+		p = RGB565_TO_RGB888(p);
+		dst[0] = (Uint8)p;
+		dst[1] = (Uint8)(p >> 8);
+		dst[2] = (Uint8)(p >> 16);
+		dst += 3;
+	}
+}
+
+static void QB_Row8888(Uint8 *dst, const Uint16 *src, int width)
+{
+	Uint32 *d = (Uint32 *)dst;
+	while ( width-- ) {
+		Uint32 p = *src++;
+		*d++ = RGB565_TO_RGB888(p);
+	}
+}
+
+/* The fast converters look up each half of the source pixel in a 256
+   entry table and OR the results together, so the tables stay small
+   enough to live in the data cache.  The packed 3 byte formats are
+   written four pixels (three words) at a time once the destination is
+   word aligned.
+*/
+#define QB_LUT4(f, n)	f(n), f((n)+1), f((n)+2), f((n)+3)
+#define QB_LUT16(f, n)	QB_LUT4(f, n), QB_LUT4(f, (n)+4), \
+			QB_LUT4(f, (n)+8), QB_LUT4(f, (n)+12)
+#define QB_LUT64(f, n)	QB_LUT16(f, n), QB_LUT16(f, (n)+16), \
+			QB_LUT16(f, (n)+32), QB_LUT16(f, (n)+48)
+#define QB_LUT256(f)	QB_LUT64(f, 0), QB_LUT64(f, 64), \
+			QB_LUT64(f, 128), QB_LUT64(f, 192)
+
+#define QB_LO666(b)	((Uint32)(b) << 1)
+#define QB_HI666(b)	((((Uint32)(b) & 0x07) << 9) | (((Uint32)(b) & 0xF8) << 10))
+#define QB_LO888(b)	(RGB565_TO_RGB888((Uint32)(b)))
+#define QB_HI888(b)	(RGB565_TO_RGB888((Uint32)(b) << 8))
+
+static const Uint32 QB_lo666[256] = { QB_LUT256(QB_LO666) };
+static const Uint32 QB_hi666[256] = { QB_LUT256(QB_HI666) };
+static const Uint32 QB_lo888[256] = { QB_LUT256(QB_LO888) };
+static const Uint32 QB_hi888[256] = { QB_LUT256(QB_HI888) };
+
+#define QB_LOOKUP(lo, hi, p)	(lo[(p) & 0xFF] | hi[(p) >> 8])
+
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+static void QB_RowPacked(Uint8 *dst, const Uint16 *src, int width,
+                         const Uint32 *lo, const Uint32 *hi)
+{
+	Uint32 *d;
+	Uint32 p0, p1, p2, p3;
+
+	/* Align the destination to a word boundary */
+	while ( width && ((uintptr_t)dst & 3) ) {
+		p0 = *src++;
+		p0 = QB_LOOKUP(lo, hi, p0);
+		dst[0] = (Uint8)p0;
+		dst[1] = (Uint8)(p0 >> 8);
+		dst[2] = (Uint8)(p0 >> 16);
+		dst += 3;
+		--width;
+	}
+
+	d = (Uint32 *)dst;
+	while ( width >= 4 ) {
+		p0 = QB_LOOKUP(lo, hi, src[0]);
+		p1 = QB_LOOKUP(lo, hi, src[1]);
+		p2 = QB_LOOKUP(lo, hi, src[2]);
+		p3 = QB_LOOKUP(lo, hi, src[3]);
+		d[0] = p0 | (p1 << 24);
+		d[1] = (p1 >> 8) | (p2 << 16);
+		d[2] = (p2 >> 16) | (p3 << 8);
+		d += 3;
+		src += 4;
+		width -= 4;
+	}
+
+	dst = (Uint8 *)d;
+	while ( width-- ) {
+		p0 = *src++;
+		p0 = QB_LOOKUP(lo, hi, p0);
+		dst[0] = (Uint8)p0;
+		dst[1] = (Uint8)(p0 >> 8);
+		dst[2] = (Uint8)(p0 >> 16);
+		dst += 3;
+	}
+}
+
+static void QB_Row666LUT(Uint8 *dst, const Uint16 *src, int width)
+{
+	QB_RowPacked(dst, src, width, QB_lo666, QB_hi666);
+}
+
+static void QB_Row888LUT(Uint8 *dst, const Uint16 *src, int width)
+{
+	QB_RowPacked(dst, src, width, QB_lo888, QB_hi888);
+}
+#else
+/* The word packing above assumes little endian words */
+#define QB_Row666LUT	QB_Row666
+#define QB_Row888LUT	QB_Row888
+#endif /* SDL_BYTEORDER == SDL_LIL_ENDIAN */
+
+static void QB_Row8888LUT(Uint8 *dst, const Uint16 *src, int width)
+{
+	Uint32 *d = (Uint32 *)dst;
+	Uint32 p0, p1;
+
+	while ( width >= 2 ) {
+		p0 = src[0];
+		p1 = src[1];
+		d[0] = QB_LOOKUP(QB_lo888, QB_hi888, p0);
+		d[1] = QB_LOOKUP(QB_lo888, QB_hi888, p1);
+		d += 2;
+		src += 2;
+		width -= 2;
+	}
+	if ( width ) {
+		p0 = *src;
+		*d = QB_LOOKUP(QB_lo888, QB_hi888, p0);
+	}
+}
+
+/* Row converters for each framebuffer depth.  The scalar versions are
+   the reference the table driven ones must match bit for bit.
+*/
+static const struct {
+	int depth;
+	QB_RowFunc scalar;
+	QB_RowFunc fast;
+} QB_rowfuncs[] = {
+	{ 16, QB_Row565, QB_Row565 },
+	{ 18, QB_Row666, QB_Row666LUT },
+	{ 24, QB_Row888, QB_Row888LUT },
+	{ 32, QB_Row8888, QB_Row8888LUT }
+};
+
+static QB_RowFunc QB_GetRowFunc(int depth)
+{
+	static int use_scalar = -1;
+	const char *envr;
+	unsigned i;
+
+	if ( use_scalar < 0 ) {
+		/* Provide an override for testing .. */
+		envr = SDL_getenv("SDL_QT_SCALAR_BLIT");
+		use_scalar = (envr && SDL_atoi(envr));
+	}
+	for ( i = 0; i < SDL_arraysize(QB_rowfuncs); ++i ) {
+		if ( QB_rowfuncs[i].depth == depth ) {
+			return use_scalar ? QB_rowfuncs[i].scalar
+			                  : QB_rowfuncs[i].fast;
+		}
+	}
+	return NULL;
+}
+
+int QB_BytesPerPixel(int depth)
+{
+	switch (depth) {
+	    case 16:
+		return 2;
+	    case 18:
+	    case 24:
+		return 3;
+	    case 32:
+		return 4;
+	}
+	return 0;
+}
+
+/* Convert the destination rectangle (x,y,w,h) of a rotated screen.
+   Every destination row of a tile is a column of the source: it is
+   gathered into a small line buffer and then converted in one go.
+*/
+static void QB_BlitRotated(const QB_Buffer *src, QB_Buffer *dst,
+                           QB_Rotation rotation, QB_RowFunc convert,
+                           int x, int y, int w, int h)
+{
+	Uint16 line[QB_TILE_SIZE];
+	int bpp = QB_BytesPerPixel(dst->depth);
+	int tx, ty, tw, th;
+	int row, i;
+
+	for ( ty = y; ty < y+h; ty += QB_TILE_SIZE ) {
+		th = SDL_min(QB_TILE_SIZE, y+h-ty);
+		for ( tx = x; tx < x+w; tx += QB_TILE_SIZE ) {
+			tw = SDL_min(QB_TILE_SIZE, x+w-tx);
+			for ( row = ty; row < ty+th; ++row ) {
+				const Uint8 *srcp;
+				int step;
+
+				if ( rotation == QB_CLOCKWISE ) {
+					/* dst (x,y) <- src (src->w-1-y, x) */
+					srcp = src->pixels + tx*src->pitch +
+					       (src->w-1-row)*2;
+					step = src->pitch;
+				} else {
+					/* dst (x,y) <- src (y, src->h-1-x) */
+					srcp = src->pixels +
+					       (src->h-1-tx)*src->pitch + row*2;
+					step = -src->pitch;
+				}
+				for ( i = 0; i < tw; ++i ) {
+					line[i] = *(const Uint16 *)srcp;
+					srcp += step;
+				}
+				convert(dst->pixels + row*dst->pitch + tx*bpp,
+				        line, tw);
+			}
+		}
+	}
+}
+
+int QB_BlitRect(const QB_Buffer *src, QB_Buffer *dst,
+                QB_Rotation rotation, const SDL_Rect *area)
+{
+	QB_RowFunc convert;
+	int x, y, w, h;
+	int dx, dy, dw, dh;
+
+	convert = QB_GetRowFunc(dst->depth);
+	if ( (src->depth != 16) || !convert ) {
+		SDL_SetError("Unsupported framebuffer depth %d", dst->depth);
+		return(-1);
+	}
+
+	/* Clip to the source */
+	x = SDL_max(area->x, 0);
+	y = SDL_max(area->y, 0);
+	w = SDL_min(area->x+area->w, src->w) - x;
+	h = SDL_min(area->y+area->h, src->h) - y;
+	if ( (w <= 0) || (h <= 0) ) {
+		return(0);
+	}
+
+	/* Map to screen coordinates */
+	switch (rotation) {
+	    case QB_CLOCKWISE:
+		dx = y;
+		dy = src->w - x - w;
+		dw = h;
+		dh = w;
+		break;
+	    case QB_COUNTERCLOCKWISE:
+		dx = src->h - y - h;
+		dy = x;
+		dw = h;
+		dh = w;
+		break;
+	    default:
+		dx = x;
+		dy = y;
+		dw = w;
+		dh = h;
+		break;
+	}
+
+	/* Clip to the screen */
+	if ( dx < 0 ) {
+		dw += dx;
+		dx = 0;
+	}
+	if ( dy < 0 ) {
+		dh += dy;
+		dy = 0;
+	}
+	dw = SDL_min(dx+dw, dst->w) - dx;
+	dh = SDL_min(dy+dh, dst->h) - dy;
+	if ( (dw <= 0) || (dh <= 0) ) {
+		return(0);
+	}
+
+	if ( rotation == QB_NO_ROTATION ) {
+		const Uint8 *srcp = src->pixels + dy*src->pitch + dx*2;
+		Uint8 *dstp = dst->pixels + dy*dst->pitch +
+		              dx*QB_BytesPerPixel(dst->depth);
+		while ( dh-- ) {
+			convert(dstp, (const Uint16 *)srcp, dw);
+			srcp += src->pitch;
+			dstp += dst->pitch;
+		}
+	} else {
+		QB_BlitRotated(src, dst, rotation, convert, dx, dy, dw, dh);
+	}
+	return(0);
+}
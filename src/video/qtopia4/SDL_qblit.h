@@ -0,0 +1,70 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2006 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#ifndef _SDL_qblit_h
+#define _SDL_qblit_h
+
+/* Copies the RGB565 shadow surface to the device framebuffer, converting
+   to the framebuffer depth and applying the screen rotation on the way.
+*/
+
+#include "SDL_video.h"
+
+/* Screen rotation, values match SDL_QWin::Rotation */
+typedef enum {
+	QB_NO_ROTATION = 0,
+	QB_CLOCKWISE = 1,
+	QB_COUNTERCLOCKWISE = 2
+} QB_Rotation;
+
+/* A block of pixels: either the shadow surface or the framebuffer.
+   For the framebuffer, w and h are the physical (unrotated) dimensions.
+   Supported depths are 16 (RGB565), 18 (RGB666 packed in 3 bytes),
+   24 (RGB888) and 32 (XRGB8888).  The shadow surface is always 16.
+*/
+typedef struct QB_Buffer {
+	Uint8 *pixels;
+	int w, h;
+	int pitch;
+	int depth;
+} QB_Buffer;
+
+/* Rotated blits are done in square tiles of this many pixels, so that
+   both the source columns and the destination rows of a tile stay in
+   the cache while it is being converted.
+*/
+#define QB_TILE_SIZE	16
+
+/* Returns the number of bytes a pixel occupies at the given depth,
+   or 0 if the depth is not supported.
+*/
+extern int QB_BytesPerPixel(int depth);
+
+/* Convert the rectangle 'area' of 'src' (in shadow surface coordinates)
+   to 'dst', rotating it according to 'rotation'.  The area is clipped
+   to both buffers.  Returns 0, or -1 if either depth is unsupported.
+*/
+extern int QB_BlitRect(const QB_Buffer *src, QB_Buffer *dst,
+                       QB_Rotation rotation, const SDL_Rect *area);
+
+#endif /* _SDL_qblit_h */
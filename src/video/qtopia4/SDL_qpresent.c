@@ -0,0 +1,187 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2006 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#include "SDL_thread.h"
+#include "SDL_mutex.h"
+#include "SDL_qpresent.h"
+
+enum {
+	QB_PRESENT_IDLE,	/* nothing queued */
+	QB_PRESENT_BUSY,	/* the thread is converting a frame */
+	QB_PRESENT_DONE		/* finished, but not yet reported */
+};
+
+struct QB_Presenter {
+	SDL_Thread *thread;
+	SDL_mutex *lock;
+	SDL_cond *wake;		/* a frame was queued, or quit was set */
+	SDL_cond *done;		/* the frame in flight was converted */
+	int state;
+	int quit;
+
+	/* The frame being converted */
+	QB_Buffer src;
+	QB_Buffer dst;
+	QB_Rotation rotation;
+	SDL_Rect *rects;
+	int numrects;
+	int maxrects;
+};
+
+static int SDLCALL QB_PresentThread(void *data)
+{
+	QB_Presenter *presenter = (QB_Presenter *)data;
+	int i;
+
+	SDL_mutexP(presenter->lock);
+	for ( ; ; ) {
+		while ( (presenter->state != QB_PRESENT_BUSY) &&
+		        !presenter->quit ) {
+			SDL_CondWait(presenter->wake, presenter->lock);
+		}
+		if ( presenter->state != QB_PRESENT_BUSY ) {
+			break;
+		}
+		SDL_mutexV(presenter->lock);
+
+		/* Nobody touches the frame description while we're busy */
+		for ( i = 0; i < presenter->numrects; ++i ) {
+			QB_BlitRect(&presenter->src, &presenter->dst,
+			            presenter->rotation, &presenter->rects[i]);
+		}
+
+		SDL_mutexP(presenter->lock);
+		presenter->state = QB_PRESENT_DONE;
+		SDL_CondSignal(presenter->done);
+	}
+	SDL_mutexV(presenter->lock);
+	return(0);
+}
+
+QB_Presenter *QB_CreatePresenter(void)
+{
+	QB_Presenter *presenter;
+
+	presenter = (QB_Presenter *)SDL_malloc(sizeof(*presenter));
+	if ( presenter == NULL ) {
+		SDL_OutOfMemory();
+		return(NULL);
+	}
+	SDL_memset(presenter, 0, sizeof(*presenter));
+
+	presenter->lock = SDL_CreateMutex();
+	presenter->wake = SDL_CreateCond();
+	presenter->done = SDL_CreateCond();
+	if ( !presenter->lock || !presenter->wake || !presenter->done ) {
+		QB_DestroyPresenter(presenter);
+		return(NULL);
+	}
+	presenter->thread = SDL_CreateThread(QB_PresentThread, presenter);
+	if ( presenter->thread == NULL ) {
+		QB_DestroyPresenter(presenter);
+		return(NULL);
+	}
+	return(presenter);
+}
+
+void QB_DestroyPresenter(QB_Presenter *presenter)
+{
+	if ( presenter->thread ) {
+		SDL_mutexP(presenter->lock);
+		presenter->quit = 1;
+		SDL_CondSignal(presenter->wake);
+		SDL_mutexV(presenter->lock);
+		SDL_WaitThread(presenter->thread, NULL);
+	}
+	if ( presenter->done ) {
+		SDL_DestroyCond(presenter->done);
+	}
+	if ( presenter->wake ) {
+		SDL_DestroyCond(presenter->wake);
+	}
+	if ( presenter->lock ) {
+		SDL_DestroyMutex(presenter->lock);
+	}
+	SDL_free(presenter->rects);
+	SDL_free(presenter);
+}
+
+int QB_PresentAsync(QB_Presenter *presenter,
+                    const QB_Buffer *src, QB_Buffer *dst,
+                    QB_Rotation rotation,
+                    const SDL_Rect *rects, int numrects)
+{
+	SDL_mutexP(presenter->lock);
+	while ( presenter->state == QB_PRESENT_BUSY ) {
+		SDL_CondWait(presenter->done, presenter->lock);
+	}
+	if ( numrects > presenter->maxrects ) {
+		SDL_Rect *newrects;
+
+		newrects = (SDL_Rect *)SDL_realloc(presenter->rects,
+		                                   numrects*sizeof(*rects));
+		if ( newrects == NULL ) {
+			SDL_mutexV(presenter->lock);
+			SDL_OutOfMemory();
+			return(-1);
+		}
+		presenter->rects = newrects;
+		presenter->maxrects = numrects;
+	}
+	SDL_memcpy(presenter->rects, rects, numrects*sizeof(*rects));
+	presenter->numrects = numrects;
+	presenter->src = *src;
+	presenter->dst = *dst;
+	presenter->rotation = rotation;
+	presenter->state = QB_PRESENT_BUSY;
+	SDL_CondSignal(presenter->wake);
+	SDL_mutexV(presenter->lock);
+	return(0);
+}
+
+int QB_WaitPresent(QB_Presenter *presenter)
+{
+	int completed;
+
+	SDL_mutexP(presenter->lock);
+	while ( presenter->state == QB_PRESENT_BUSY ) {
+		SDL_CondWait(presenter->done, presenter->lock);
+	}
+	completed = (presenter->state == QB_PRESENT_DONE);
+	presenter->state = QB_PRESENT_IDLE;
+	SDL_mutexV(presenter->lock);
+	return(completed);
+}
+
+int QB_PollPresent(QB_Presenter *presenter)
+{
+	int completed;
+
+	SDL_mutexP(presenter->lock);
+	completed = (presenter->state == QB_PRESENT_DONE);
+	if ( completed ) {
+		presenter->state = QB_PRESENT_IDLE;
+	}
+	SDL_mutexV(presenter->lock);
+	return(completed);
+}
@@ -0,0 +1,67 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2006 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#ifndef _SDL_qpresent_h
+#define _SDL_qpresent_h
+
+/* Background framebuffer conversion for double buffered screens.
+
+   The presenter owns a thread that runs QB_BlitRect() on a list of
+   rectangles while the application draws the next frame into the other
+   back buffer.  Only one frame is in flight at a time.
+*/
+
+#include "SDL_video.h"
+#include "SDL_qblit.h"
+
+typedef struct QB_Presenter QB_Presenter;
+
+/* Create the presenter and start its thread, or return NULL.
+   Without a presenter, callers convert each frame with QB_BlitRect()
+   before the flip returns, which is slower but gives the same result.
+*/
+extern QB_Presenter *QB_CreatePresenter(void);
+
+/* Finish the frame in flight, then stop the thread and free everything */
+extern void QB_DestroyPresenter(QB_Presenter *presenter);
+
+/* Queue 'rects' of 'src' for conversion to 'dst' and return at once.
+   The rectangles are copied, but both buffers must stay untouched until
+   QB_WaitPresent() or QB_PollPresent() reports the frame as done.
+   If a frame is still in flight, this waits for it first.
+   Returns 0, or -1 if the rectangle list couldn't be allocated.
+*/
+extern int QB_PresentAsync(QB_Presenter *presenter,
+                           const QB_Buffer *src, QB_Buffer *dst,
+                           QB_Rotation rotation,
+                           const SDL_Rect *rects, int numrects);
+
+/* Block until the frame in flight, if any, has been converted.
+   Returns 1 if a frame completed since the last call, 0 otherwise.
+*/
+extern int QB_WaitPresent(QB_Presenter *presenter);
+
+/* Like QB_WaitPresent(), but never blocks: returns 0 while busy */
+extern int QB_PollPresent(QB_Presenter *presenter);
+
+#endif /* _SDL_qpresent_h */
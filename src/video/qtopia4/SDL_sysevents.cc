@@ -38,6 +38,10 @@ extern "C" {
       return;
     }
     qApp->processEvents();
+    /* Release the display if a background flip has completed */
+    if (SDL_Win) {
+      SDL_Win->finishFlip(false);
+    }
   }
 
   void QT_InitOSKeymap(_THIS) {}
@@ -67,6 +67,7 @@ extern "C" {
   static int QT_LockHWSurface(_THIS, SDL_Surface *surface);
   static void QT_UnlockHWSurface(_THIS, SDL_Surface *surface);
   static void QT_FreeHWSurface(_THIS, SDL_Surface *surface);
+  static int QT_FlipHWSurface(_THIS, SDL_Surface *surface);
 
   static int QT_ToggleFullScreen(_THIS, int fullscreen);
 
@@ -118,7 +119,7 @@ extern "C" {
     device->SetHWAlpha = NULL;
     device->LockHWSurface = QT_LockHWSurface;
     device->UnlockHWSurface = QT_UnlockHWSurface;
-    device->FlipHWSurface = NULL;
+    device->FlipHWSurface = QT_FlipHWSurface;
     device->FreeHWSurface = QT_FreeHWSurface;
     device->SetIcon = NULL;
     device->SetCaption = QT_SetWMCaption;
@@ -137,6 +138,8 @@ extern "C" {
 
     /* Set the driver flags */
     device->handles_any_size = 0;
+    device->coalesce_updates = 1;
+    device->update_align = QB_TILE_SIZE;
 
     return device;
   }
@@ -201,7 +204,8 @@ extern "C" {
     // For now we hardcode the current depth because anything else
     // might as well be emulated by SDL rather than by EzX.
 
-    QSize desktop_size(240, 320);// = qApp->desktop()->size();
+    QSize desktop_size(QDirectPainter::screenWidth(),
+                       QDirectPainter::screenHeight());
     QT_AddMode(_this, ((vformat->BitsPerPixel+7)/8)-1,
                desktop_size.width(), desktop_size.height());
     QT_AddMode(_this, ((vformat->BitsPerPixel+7)/8)-1,
@@ -303,7 +307,9 @@ extern "C" {
   SDL_Surface *QT_SetVideoMode(_THIS, SDL_Surface *current,
                                int width, int height, int bpp, Uint32 flags) {
     QImage *qimage;
-    QSize desktop_size(240, 320);// = qApp->desktop()->size();
+    QImage *second = NULL;
+    QSize desktop_size(QDirectPainter::screenWidth(),
+                       QDirectPainter::screenHeight());
 
     current->flags = 0; //SDL_FULLSCREEN; // We always run fullscreen.
     SDL_QWin::Rotation rotation = SDL_QWin::NoRotation;
@@ -335,9 +341,21 @@ extern "C" {
       delete qimage;
       return(NULL);
     }
+    /* Double buffering: the second image is converted to the screen
+       in the background while the application draws into the first */
+    if ( flags & SDL_DOUBLEBUF ) {
+      second = new QImage(current->w, current->h, QImage::Format_RGB16);
+      if (second->isNull()) {
+        SDL_SetError("Couldn't create screen bitmap");
+        delete qimage;
+        delete second;
+        return(NULL);
+      }
+      current->flags |= SDL_HWSURFACE | SDL_DOUBLEBUF;
+    }
     current->pitch = qimage->bytesPerLine();
     current->pixels = (void *)qimage->bits();
-    SDL_Win->setBackBuffer(rotation, qimage);
+    SDL_Win->setBackBuffer(rotation, qimage, second);
     _this->UpdateRects = QT_NormalUpdate;
     /* We're done */
     return(current);
@@ -368,13 +386,21 @@ extern "C" {
     return;
   }
   static int QT_LockHWSurface(_THIS, SDL_Surface *surface) {
-    SDL_Win->repaint();
+    /* The back buffer of a double buffered screen is never on screen */
+    if ( !(surface->flags & SDL_DOUBLEBUF) ) {
+      SDL_Win->repaint();
+    }
     return(0);
   }
   static void QT_UnlockHWSurface(_THIS, SDL_Surface *surface) {
     return;
   }
 
+  static int QT_FlipHWSurface(_THIS, SDL_Surface *surface) {
+    surface->pixels = SDL_Win->flip();
+    return(0);
+  }
+
   static void QT_NormalUpdate(_THIS, int numrects, SDL_Rect *rects) {
     QRegion region;
     for (int i=0; i<numrects; ++i )
@@ -55,6 +55,9 @@
 /* The translation tables from an X11 keysym to a SDL keysym */
 static SDLKey ODD_keymap[256];
 static SDLKey MISC_keymap[256];
+
+/* When the screensaver was last held off */
+static Uint32 screensaverTicks;
 SDLKey X11_TranslateKeycode(Display *display, KeyCode kc);
 
 
@@ -917,7 +920,6 @@ void X11_PumpEvents(_THIS)
 
 	/* Update activity every five seconds to prevent screensaver. --ryan. */
 	if (!allow_screensaver) {
-		static Uint32 screensaverTicks;
 		Uint32 nowTicks = SDL_GetTicks();
 		if ((nowTicks - screensaverTicks) > 5000) {
 			XResetScreenSaver(SDL_Display);
@@ -965,6 +967,38 @@ void X11_PumpEvents(_THIS)
 	}
 }
 
+int X11_GetEventFDs(_THIS, int *fds, int maxfds, int *timeout)
+{
+	Uint32 now;
+	int due;
+
+	if ( maxfds < 1 ) {
+		return(0);
+	}
+	fds[0] = ConnectionNumber(SDL_Display);
+
+	/* Events Xlib already read off the socket won't wake select() */
+	XFlush(SDL_Display);
+	if ( XEventsQueued(SDL_Display, QueuedAlready) ) {
+		*timeout = 0;
+		return(1);
+	}
+
+	/* The screensaver and fullscreen switch work above runs on time */
+	now = SDL_GetTicks();
+	if ( !allow_screensaver ) {
+		due = (int)(screensaverTicks + 5001 - now);
+		*timeout = SDL_max(due, 0);
+	}
+	if ( switch_waiting ) {
+		due = SDL_max((int)(switch_time - now), 0);
+		if ( (*timeout < 0) || (due < *timeout) ) {
+			*timeout = due;
+		}
+	}
+	return(1);
+}
+
 void X11_InitKeymap(void)
 {
 	int i;
@@ -0,0 +1,448 @@
+/*
+ * Times every software blit path SDL picks between surfaces in memory,
+ * over a range of pixel formats, blit modes, sizes and alignments.
+ *
+ * Each line of output names the low level routine that did the blit, as
+ * reported by SDL_GetBlitName(), whether that is one of the generic C
+ * fallbacks, and the speed in megapixels per second.  The output is CSV,
+ * or JSON with -json, so runs from different builds can be compared.
+ *
+ * Run with SDL_BLIT_FEATURES=0 in the environment to time the N to N
+ * blitters without their MMX, SSE2 or NEON versions.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SDL.h"
+
+typedef struct {
+	const char *name;
+	int bpp;
+	Uint32 Rmask, Gmask, Bmask, Amask;
+} Format;
+
+static const Format formats[] = {
+	{ "INDEX1",	1, 0, 0, 0, 0 },
+	{ "INDEX8",	8, 0, 0, 0, 0 },
+	{ "RGB565",	16, 0x0000F800, 0x000007E0, 0x0000001F, 0x00000000 },
+	{ "BGR565",	16, 0x0000001F, 0x000007E0, 0x0000F800, 0x00000000 },
+	{ "RGB555",	16, 0x00007C00, 0x000003E0, 0x0000001F, 0x00000000 },
+	{ "BGR555",	16, 0x0000001F, 0x000003E0, 0x00007C00, 0x00000000 },
+	{ "ARGB4444",	16, 0x00000F00, 0x000000F0, 0x0000000F, 0x0000F000 },
+	{ "RGB888",	24, 0x00FF0000, 0x0000FF00, 0x000000FF, 0x00000000 },
+	{ "BGR888",	24, 0x000000FF, 0x0000FF00, 0x00FF0000, 0x00000000 },
+	{ "XRGB8888",	32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0x00000000 },
+	{ "XBGR8888",	32, 0x000000FF, 0x0000FF00, 0x00FF0000, 0x00000000 },
+	{ "RGBX8888",	32, 0xFF000000, 0x00FF0000, 0x0000FF00, 0x00000000 },
+	{ "BGRX8888",	32, 0x0000FF00, 0x00FF0000, 0xFF000000, 0x00000000 },
+	{ "ARGB8888",	32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000 },
+	{ "ABGR8888",	32, 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000 },
+	{ "RGBA8888",	32, 0xFF000000, 0x00FF0000, 0x0000FF00, 0x000000FF },
+	{ "BGRA8888",	32, 0x0000FF00, 0x00FF0000, 0xFF000000, 0x000000FF },
+};
+#define NUM_FORMATS	(int)(sizeof(formats)/sizeof(formats[0]))
+
+enum {
+	MODE_COPY,
+	MODE_COLORKEY,
+	MODE_COLORKEY_RLE,
+	MODE_ALPHA,
+	MODE_ALPHA_COLORKEY,
+	MODE_PIXELALPHA,
+	MODE_PIXELALPHA_RLE,
+	NUM_MODES
+};
+
+static const char *mode_names[NUM_MODES] = {
+	"copy", "colorkey", "colorkey-rle", "alpha", "alpha-colorkey",
+	"pixelalpha", "pixelalpha-rle"
+};
+
+/* The catch-all C routines, used when nothing better matches */
+static const char *fallbacks[] = {
+	"BlitNtoN", "BlitNtoNCopyAlpha", "BlitNtoNKey", "BlitNtoNKeyCopyAlpha",
+	"BlitNtoNSurfaceAlpha", "BlitNtoNSurfaceAlphaKey", "BlitNtoNPixelAlpha",
+	"BlitNto1", "BlitNto1Key", "BlitNto1SurfaceAlpha",
+	"BlitNto1SurfaceAlphaKey", "BlitNto1PixelAlpha"
+};
+#define NUM_FALLBACKS	(int)(sizeof(fallbacks)/sizeof(fallbacks[0]))
+
+#define MAX_SIZES	8
+
+static int json = 0;
+static int results = 0;
+
+/* Call this instead of exit(), so we can clean up SDL: atexit() is evil. */
+static void quit(int rc)
+{
+	SDL_Quit();
+	exit(rc);
+}
+
+static int is_fallback(const char *name)
+{
+	int i;
+
+	for ( i = 0; i < NUM_FALLBACKS; ++i ) {
+		if ( strcmp(name, fallbacks[i]) == 0 ) {
+			return(1);
+		}
+	}
+	return(0);
+}
+
+static int mode_fits(int mode, const Format *src)
+{
+	switch (mode) {
+	    case MODE_ALPHA:
+	    case MODE_ALPHA_COLORKEY:
+		/* SDL_SRCALPHA means per-pixel alpha on these */
+		return(src->Amask == 0);
+	    case MODE_PIXELALPHA:
+	    case MODE_PIXELALPHA_RLE:
+		return(src->Amask != 0);
+	    default:
+		return(1);
+	}
+}
+
+static void put_pixel(SDL_Surface *surface, int x, int y, Uint32 pixel)
+{
+	Uint8 *p = (Uint8 *)surface->pixels + y*surface->pitch +
+	           x*surface->format->BytesPerPixel;
+
+	switch (surface->format->BytesPerPixel) {
+	    case 1:
+		*p = (Uint8)pixel;
+		break;
+	    case 2:
+		*(Uint16 *)p = (Uint16)pixel;
+		break;
+	    case 3:
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+		p[0] = (Uint8)pixel;
+		p[1] = (Uint8)(pixel >> 8);
+		p[2] = (Uint8)(pixel >> 16);
+#else
+		p[0] = (Uint8)(pixel >> 16);
+		p[1] = (Uint8)(pixel >> 8);
+		p[2] = (Uint8)pixel;
+#endif
+		break;
+	    case 4:
+		*(Uint32 *)p = pixel;
+		break;
+	}
+}
+
+static SDL_Surface *create_surface(const Format *format, int w, int h)
+{
+	SDL_Surface *surface;
+	SDL_Color colors[256];
+	int i;
+
+	surface = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, format->bpp,
+		format->Rmask, format->Gmask, format->Bmask, format->Amask);
+	if ( surface == NULL ) {
+		fprintf(stderr, "Couldn't create %s surface: %s\n",
+						format->name, SDL_GetError());
+		quit(2);
+	}
+	if ( surface->format->palette ) {
+		for ( i = 0; i < 256; ++i ) {
+			colors[i].r = rand();
+			colors[i].g = rand();
+			colors[i].b = rand();
+		}
+		SDL_SetColors(surface, colors, 0, 256);
+	}
+	for ( i = 0; i < surface->pitch*surface->h; ++i ) {
+		((Uint8 *)surface->pixels)[i] = rand();
+	}
+	return(surface);
+}
+
+/* Lay out runs of clear, solid and blended pixels, like a sprite sheet */
+static void fill_source(SDL_Surface *src, int mode, Uint32 key)
+{
+	SDL_PixelFormat *fmt = src->format;
+	Uint32 pixel;
+	int x, y;
+
+	if ( fmt->BitsPerPixel < 8 ) {
+		return;
+	}
+	for ( y = 0; y < src->h; ++y ) {
+		for ( x = 0; x < src->w; ++x ) {
+			pixel = SDL_MapRGB(fmt, rand(), rand(), rand());
+			switch ((x/8 + y/4) % 4) {
+			    case 0:
+				if ( fmt->Amask ) {
+					pixel &= ~fmt->Amask;
+				} else if ( mode != MODE_COPY ) {
+					pixel = key;
+				}
+				break;
+			    case 1:
+				pixel |= fmt->Amask;
+				break;
+			    default:
+				pixel |= rand() & fmt->Amask;
+				break;
+			}
+			if ( pixel == key && (x/8 + y/4) % 4 ) {
+				pixel ^= 1 << fmt->Bshift;
+			}
+			put_pixel(src, x, y, pixel);
+		}
+	}
+}
+
+static void print_result(const Format *src, const Format *dst, int mode,
+                         int w, int h, int offset,
+                         const char *name, double mpixels)
+{
+	const char *path;
+
+	if ( name == NULL ) {
+		path = "unsupported";
+		name = "";
+	} else if ( is_fallback(name) ) {
+		path = "fallback";
+	} else {
+		path = "fast";
+	}
+	if ( json ) {
+		printf("%s\n    { \"src\": \"%s\", \"dst\": \"%s\", "
+		       "\"mode\": \"%s\", \"width\": %d, \"height\": %d, "
+		       "\"offset\": %d, \"blitter\": \"%s\", \"path\": \"%s\", "
+		       "\"mpixels_per_sec\": %.2f }",
+		       results ? "," : "", src->name, dst->name,
+		       mode_names[mode], w, h, offset, name, path, mpixels);
+	} else {
+		printf("%s,%s,%s,%d,%d,%d,%s,%s,%.2f\n",
+		       src->name, dst->name, mode_names[mode], w, h, offset,
+		       name, path, mpixels);
+	}
+	++results;
+	fflush(stdout);
+}
+
+static void run_test(const Format *srcfmt, const Format *dstfmt, int mode,
+                     int w, int h, int offset, Uint32 ms)
+{
+	SDL_Surface *src, *dst;
+	SDL_Rect srcrect, dstrect;
+	Uint32 key;
+	Uint64 start, now, end;
+	double elapsed, pixels;
+	const char *name;
+	int blits;
+
+	src = create_surface(srcfmt, w + offset, h);
+	dst = create_surface(dstfmt, w + offset, h);
+
+	key = SDL_MapRGB(src->format, 0xFF, 0x00, 0xFF);
+	fill_source(src, mode, key);
+	SDL_SetAlpha(src, 0, SDL_ALPHA_OPAQUE);
+	switch (mode) {
+	    case MODE_COLORKEY:
+		SDL_SetColorKey(src, SDL_SRCCOLORKEY, key);
+		break;
+	    case MODE_COLORKEY_RLE:
+		SDL_SetColorKey(src, SDL_SRCCOLORKEY|SDL_RLEACCEL, key);
+		break;
+	    case MODE_ALPHA:
+		SDL_SetAlpha(src, SDL_SRCALPHA, 128);
+		break;
+	    case MODE_ALPHA_COLORKEY:
+		SDL_SetColorKey(src, SDL_SRCCOLORKEY, key);
+		SDL_SetAlpha(src, SDL_SRCALPHA, 128);
+		break;
+	    case MODE_PIXELALPHA:
+		SDL_SetAlpha(src, SDL_SRCALPHA, SDL_ALPHA_OPAQUE);
+		break;
+	    case MODE_PIXELALPHA_RLE:
+		SDL_SetAlpha(src, SDL_SRCALPHA|SDL_RLEACCEL, SDL_ALPHA_OPAQUE);
+		break;
+	}
+
+	/* This sets up the blit, and RLE encodes the source if asked to */
+	name = SDL_GetBlitName(src, dst);
+	if ( name == NULL ) {
+		print_result(srcfmt, dstfmt, mode, w, h, offset, NULL, 0.0);
+		SDL_FreeSurface(src);
+		SDL_FreeSurface(dst);
+		return;
+	}
+
+	srcrect.x = offset;
+	srcrect.y = 0;
+	srcrect.w = w;
+	srcrect.h = h;
+	dstrect = srcrect;
+	SDL_BlitSurface(src, &srcrect, dst, &dstrect);
+
+	/* Blit in batches so the clock isn't read for every tiny blit */
+	blits = 0;
+	start = SDL_GetTicksNS();
+	end = start + (Uint64)ms * 1000000;
+	do {
+		int i;
+		for ( i = 0; i < 16; ++i ) {
+			dstrect = srcrect;
+			SDL_BlitSurface(src, &srcrect, dst, &dstrect);
+		}
+		blits += 16;
+		now = SDL_GetTicksNS();
+	} while ( now < end );
+
+	elapsed = (double)(now - start) / 1000000000.0;
+	pixels = (double)w * h * blits;
+	print_result(srcfmt, dstfmt, mode, w, h, offset, name,
+	             pixels / elapsed / 1000000.0);
+
+	SDL_FreeSurface(src);
+	SDL_FreeSurface(dst);
+}
+
+static const Format *find_format(const char *name)
+{
+	int i;
+
+	for ( i = 0; i < NUM_FORMATS; ++i ) {
+		if ( strcmp(name, formats[i].name) == 0 ) {
+			return(&formats[i]);
+		}
+	}
+	fprintf(stderr, "Unknown format %s\n", name);
+	quit(1);
+	return(NULL);
+}
+
+static int find_mode(const char *name)
+{
+	int i;
+
+	for ( i = 0; i < NUM_MODES; ++i ) {
+		if ( strcmp(name, mode_names[i]) == 0 ) {
+			return(i);
+		}
+	}
+	fprintf(stderr, "Unknown mode %s\n", name);
+	quit(1);
+	return(-1);
+}
+
+static void usage(const char *argv0)
+{
+	int i;
+
+	fprintf(stderr,
+"Usage: %s [-json] [-time ms] [-size WxH]... [-src fmt] [-dst fmt] [-mode m]\n"
+"       [-aligned]\n", argv0);
+	fprintf(stderr, "Formats:");
+	for ( i = 0; i < NUM_FORMATS; ++i ) {
+		fprintf(stderr, " %s", formats[i].name);
+	}
+	fprintf(stderr, "\nModes:");
+	for ( i = 0; i < NUM_MODES; ++i ) {
+		fprintf(stderr, " %s", mode_names[i]);
+	}
+	fprintf(stderr, "\n");
+	quit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	const Format *only_src = NULL;
+	const Format *only_dst = NULL;
+	int only_mode = -1;
+	int widths[MAX_SIZES], heights[MAX_SIZES];
+	int num_sizes = 0;
+	int max_offset = 1;
+	Uint32 ms = 10;
+	int i, s, d, m, size, offset;
+
+	if ( SDL_Init(0) < 0 ) {
+		fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+		return(1);
+	}
+
+	for ( i = 1; i < argc; ++i ) {
+		if ( strcmp(argv[i], "-json") == 0 ) {
+			json = 1;
+		} else if ( strcmp(argv[i], "-aligned") == 0 ) {
+			max_offset = 0;
+		} else if ( i+1 < argc && strcmp(argv[i], "-time") == 0 ) {
+			ms = atoi(argv[++i]);
+		} else if ( i+1 < argc && strcmp(argv[i], "-size") == 0 ) {
+			if ( num_sizes == MAX_SIZES ||
+			     sscanf(argv[++i], "%dx%d", &widths[num_sizes],
+			            &heights[num_sizes]) != 2 ||
+			     widths[num_sizes] <= 0 || heights[num_sizes] <= 0 ) {
+				usage(argv[0]);
+			}
+			++num_sizes;
+		} else if ( i+1 < argc && strcmp(argv[i], "-src") == 0 ) {
+			only_src = find_format(argv[++i]);
+		} else if ( i+1 < argc && strcmp(argv[i], "-dst") == 0 ) {
+			only_dst = find_format(argv[++i]);
+		} else if ( i+1 < argc && strcmp(argv[i], "-mode") == 0 ) {
+			only_mode = find_mode(argv[++i]);
+		} else {
+			usage(argv[0]);
+		}
+	}
+	if ( num_sizes == 0 ) {
+		/* A sprite sized tile and a full screen */
+		widths[0] = 16;
+		heights[0] = 16;
+		widths[1] = 640;
+		heights[1] = 480;
+		num_sizes = 2;
+	}
+
+	fprintf(stderr, "CPU features:%s%s%s%s%s\n",
+	        SDL_HasMMX() ? " MMX" : "", SDL_Has3DNow() ? " 3DNow" : "",
+	        SDL_HasSSE2() ? " SSE2" : "", SDL_HasAltiVec() ? " AltiVec" : "",
+	        SDL_HasNEON() ? " NEON" : "");
+	if ( json ) {
+		printf("[");
+	} else {
+		printf("src,dst,mode,width,height,offset,blitter,path,mpixels_per_sec\n");
+	}
+	for ( s = 0; s < NUM_FORMATS; ++s ) {
+		if ( only_src && only_src != &formats[s] ) {
+			continue;
+		}
+		for ( d = 0; d < NUM_FORMATS; ++d ) {
+			/* We don't blit to less than 8 bits per pixel */
+			if ( formats[d].bpp < 8 ||
+			     (only_dst && only_dst != &formats[d]) ) {
+				continue;
+			}
+			for ( m = 0; m < NUM_MODES; ++m ) {
+				if ( (only_mode >= 0 && only_mode != m) ||
+				     !mode_fits(m, &formats[s]) ) {
+					continue;
+				}
+				for ( size = 0; size < num_sizes; ++size ) {
+					for ( offset = 0; offset <= max_offset; ++offset ) {
+						run_test(&formats[s], &formats[d], m,
+						         widths[size], heights[size],
+						         offset, ms);
+					}
+				}
+			}
+		}
+	}
+	if ( json ) {
+		printf("\n]\n");
+	}
+
+	SDL_Quit();
+	return(0);
+}
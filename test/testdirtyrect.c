@@ -0,0 +1,196 @@
+/*
+ * Checks the rectangles SDL_UpdateRects() passes on to the driver after
+ * merging them, using the offscreen Qtopia4 driver.
+ *
+ * Clusters of overlapping sprite sized rectangles, and thin ones that
+ * cross each other, are updated onto a black framebuffer from a white
+ * screen.  The pixels that turn white are the area the driver converted,
+ * which must cover every rectangle passed in, and must be the same as
+ * the area SDL_GetUpdateStats() says was updated.  Any overlap between
+ * the merged rectangles would be counted twice there.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+
+#define FB_FILE		"testdirtyrect.fb"
+#define WIDTH		320
+#define HEIGHT		240
+#define MAX_RECTS	400
+
+static Uint16 fb[WIDTH*HEIGHT];
+
+/* Black out the framebuffer, it's the file the driver has mapped */
+static int ClearFramebuffer(void)
+{
+	FILE *fp;
+
+	SDL_memset(fb, 0, sizeof(fb));
+	fp = fopen(FB_FILE, "r+b");
+	if ( fp == NULL ) {
+		return(-1);
+	}
+	fwrite(fb, sizeof(fb), 1, fp);
+	fclose(fp);
+	return(0);
+}
+
+static int ReadFramebuffer(void)
+{
+	FILE *fp;
+	size_t n;
+
+	fp = fopen(FB_FILE, "rb");
+	if ( fp == NULL ) {
+		return(-1);
+	}
+	n = fread(fb, sizeof(fb), 1, fp);
+	fclose(fp);
+	return(n == 1 ? 0 : -1);
+}
+
+static void AddRect(SDL_Rect *rects, int *numrects, int x, int y, int w, int h)
+{
+	rects[*numrects].x = x;
+	rects[*numrects].y = y;
+	rects[*numrects].w = w;
+	rects[*numrects].h = h;
+	++*numrects;
+}
+
+/* Sprites piled up around a few points, plus some crossing bars */
+static int MakeRects(SDL_Rect *rects, int frame)
+{
+	int numrects = 0;
+	int clusters = 2 + frame % 4;
+	int i, j, cx, cy;
+
+	for ( i = 0; i < clusters; ++i ) {
+		cx = rand() % (WIDTH-48);
+		cy = rand() % (HEIGHT-48);
+		for ( j = 0; j < 40; ++j ) {
+			AddRect(rects, &numrects,
+			        cx + rand() % 32, cy + rand() % 32,
+			        4 + rand() % 16, 4 + rand() % 16);
+		}
+	}
+	for ( i = 0; i < frame % 3; ++i ) {
+		AddRect(rects, &numrects, rand() % WIDTH, 0, 2, HEIGHT);
+		AddRect(rects, &numrects, 0, rand() % HEIGHT, WIDTH, 2);
+	}
+	/* A few partly off the screen */
+	AddRect(rects, &numrects, -8, rand() % HEIGHT, 20, 20);
+	AddRect(rects, &numrects, WIDTH-12, HEIGHT-12, 24, 24);
+	return(numrects);
+}
+
+static int CheckFrame(SDL_Surface *screen, int frame)
+{
+	SDL_Rect rects[MAX_RECTS];
+	SDL_UpdateStats before, after;
+	Uint64 updated, converted;
+	int numrects;
+	int i, x, y;
+
+	numrects = MakeRects(rects, frame);
+	if ( ClearFramebuffer() < 0 ) {
+		printf("Couldn't write %s\n", FB_FILE);
+		return(-1);
+	}
+	SDL_GetUpdateStats(&before);
+	SDL_UpdateRects(screen, numrects, rects);
+	if ( (SDL_GetUpdateStats(&after) < 0) || (ReadFramebuffer() < 0) ) {
+		printf("Frame %d: no statistics or framebuffer\n", frame);
+		return(-1);
+	}
+	if ( after.frames != before.frames+1 ) {
+		printf("Frame %d: update wasn't counted\n", frame);
+		return(-1);
+	}
+
+	/* Every pixel asked for was updated */
+	for ( i = 0; i < numrects; ++i ) {
+		for ( y = SDL_max(rects[i].y, 0);
+		      y < SDL_min(rects[i].y+rects[i].h, HEIGHT); ++y ) {
+			for ( x = SDL_max(rects[i].x, 0);
+			      x < SDL_min(rects[i].x+rects[i].w, WIDTH); ++x ) {
+				if ( fb[y*WIDTH+x] != 0xFFFF ) {
+					printf("Frame %d: pixel %d,%d of rect %d wasn't updated\n",
+					       frame, x, y, i);
+					return(-1);
+				}
+			}
+		}
+	}
+
+	/* ... and nothing was updated twice */
+	converted = 0;
+	for ( i = 0; i < WIDTH*HEIGHT; ++i ) {
+		if ( fb[i] ) {
+			++converted;
+		}
+	}
+	updated = after.pixels_updated - before.pixels_updated;
+	if ( updated != converted ) {
+		printf("Frame %d: %d rects, %.0f pixels counted as updated, %.0f converted\n",
+		       frame, numrects, (double)updated, (double)converted);
+		return(-1);
+	}
+	return(0);
+}
+
+int main(int argc, char *argv[])
+{
+	SDL_Surface *screen;
+	SDL_UpdateStats stats;
+	int frames = 200;
+	int i, failed = 0;
+
+	SDL_putenv("SDL_VIDEODRIVER=qoffscreen");
+	SDL_putenv("SDL_VIDEO_COALESCE_RECTS=1");
+	SDL_putenv("SDL_QOFFSCREEN_DEPTH=16");
+	SDL_putenv("SDL_QOFFSCREEN_FILE=" FB_FILE);
+	/* Unrotated, so framebuffer pixels are screen pixels */
+	SDL_putenv("SDL_QOFFSCREEN_GEOMETRY=320x240");
+	if ( argc > 1 ) {
+		frames = atoi(argv[1]);
+	}
+	if ( SDL_Init(SDL_INIT_VIDEO) < 0 ) {
+		fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+		return(1);
+	}
+	screen = SDL_SetVideoMode(WIDTH, HEIGHT, 16, SDL_SWSURFACE);
+	if ( screen == NULL ) {
+		fprintf(stderr, "Couldn't set %dx%d video mode: %s\n",
+		        WIDTH, HEIGHT, SDL_GetError());
+		SDL_Quit();
+		return(1);
+	}
+	SDL_FillRect(screen, NULL, 0xFFFF);
+
+	srand(1);
+	for ( i = 0; i < frames; ++i ) {
+		if ( CheckFrame(screen, i) < 0 ) {
+			failed = 1;
+			break;
+		}
+	}
+
+	/* Single rectangle updates are counted too */
+	SDL_UpdateRect(screen, 10, 10, 1, 1);
+	SDL_GetUpdateStats(&stats);
+	if ( !failed && (stats.frames != (Uint32)frames+1) ) {
+		printf("%u updates counted instead of %d\n", stats.frames, frames+1);
+		failed = 1;
+	}
+	printf("%u updates, %.0f pixels requested, %.0f updated, %u full screen\n",
+	       stats.frames, (double)stats.pixels_requested,
+	       (double)stats.pixels_updated, stats.full_updates);
+
+	SDL_Quit();
+	remove(FB_FILE);
+	printf("%s\n", failed ? "FAILED" : "PASSED");
+	return(failed);
+}
@@ -0,0 +1,170 @@
+/*
+ * Checks that the table driven Qtopia4 framebuffer converters give the
+ * same bytes as the scalar ones they replace.
+ *
+ * The same screen and the same rectangles are shown twice through the
+ * offscreen Qtopia4 driver, once with SDL_QT_SCALAR_BLIT=1 and once
+ * with SDL_QT_SCALAR_BLIT=0, for every framebuffer depth and rotation.
+ * The converter is picked once per process, so each run is done in a
+ * child process, and the two framebuffer files are compared.
+ *
+ * The rectangles have odd positions and widths, so the converters
+ * start and end at every alignment within a word.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "SDL.h"
+
+#define FB_WIDTH	240
+#define FB_HEIGHT	320
+#define FB_SIZE		(FB_WIDTH*FB_HEIGHT*4)
+
+static const int depths[] = { 16, 18, 24, 32 };
+
+static Uint8 fb_scalar[FB_SIZE];
+static Uint8 fb_fast[FB_SIZE];
+
+/* Runs in the child: draw random pixels and update random rectangles */
+static int Render(int landscape, int invert)
+{
+	SDL_Surface *screen;
+	SDL_Rect rect;
+	Uint16 *row;
+	int w, h, x, y, i;
+
+	SDL_putenv("SDL_VIDEO_COALESCE_RECTS=0");
+	SDL_putenv(invert ? "SDL_QT_INVERT_ROTATION=1" :
+	                    "SDL_QT_INVERT_ROTATION=0");
+	if ( SDL_Init(SDL_INIT_VIDEO) < 0 ) {
+		fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+		return(1);
+	}
+	w = landscape ? FB_HEIGHT : FB_WIDTH;
+	h = landscape ? FB_WIDTH : FB_HEIGHT;
+	screen = SDL_SetVideoMode(w, h, 16, SDL_SWSURFACE);
+	if ( screen == NULL ) {
+		fprintf(stderr, "Couldn't set %dx%d mode: %s\n",
+		        w, h, SDL_GetError());
+		SDL_Quit();
+		return(1);
+	}
+
+	srand(1);
+	SDL_LockSurface(screen);
+	for ( y = 0; y < h; ++y ) {
+		row = (Uint16 *)((Uint8 *)screen->pixels + y*screen->pitch);
+		for ( x = 0; x < w; ++x ) {
+			row[x] = (Uint16)(rand() >> 3);
+		}
+	}
+	SDL_UnlockSurface(screen);
+
+	for ( i = 0; i < 300; ++i ) {
+		rect.x = rand() % w;
+		rect.y = rand() % h;
+		rect.w = 1 + rand() % 37;
+		rect.h = 1 + rand() % 37;
+		SDL_UpdateRects(screen, 1, &rect);
+	}
+	SDL_Quit();
+	return(0);
+}
+
+static int RunChild(const char *file, int depth, int scalar,
+                    int landscape, int invert)
+{
+	static char file_env[64], depth_env[64];
+	pid_t pid;
+	int status;
+
+	pid = fork();
+	if ( pid < 0 ) {
+		perror("fork");
+		return(-1);
+	}
+	if ( pid == 0 ) {
+		/* putenv() keeps the strings */
+		SDL_snprintf(file_env, sizeof(file_env),
+		             "SDL_QOFFSCREEN_FILE=%s", file);
+		SDL_putenv(file_env);
+		SDL_snprintf(depth_env, sizeof(depth_env),
+		             "SDL_QOFFSCREEN_DEPTH=%d", depth);
+		SDL_putenv(depth_env);
+		SDL_putenv(scalar ? "SDL_QT_SCALAR_BLIT=1" :
+		                    "SDL_QT_SCALAR_BLIT=0");
+		_exit(Render(landscape, invert));
+	}
+	if ( (waitpid(pid, &status, 0) != pid) ||
+	     !WIFEXITED(status) || (WEXITSTATUS(status) != 0) ) {
+		return(-1);
+	}
+	return(0);
+}
+
+static int ReadFile(const char *file, Uint8 *buf, size_t size)
+{
+	FILE *fp;
+	size_t n;
+
+	fp = fopen(file, "rb");
+	if ( fp == NULL ) {
+		return(-1);
+	}
+	n = fread(buf, size, 1, fp);
+	fclose(fp);
+	remove(file);
+	return(n == 1 ? 0 : -1);
+}
+
+static int Compare(int depth, int landscape, int invert)
+{
+	size_t size, i;
+
+	size = FB_WIDTH*FB_HEIGHT*(depth == 16 ? 2 : depth == 32 ? 4 : 3);
+	if ( (RunChild("testqblit-scalar.fb", depth, 1, landscape, invert) < 0) ||
+	     (RunChild("testqblit-fast.fb", depth, 0, landscape, invert) < 0) ||
+	     (ReadFile("testqblit-scalar.fb", fb_scalar, size) < 0) ||
+	     (ReadFile("testqblit-fast.fb", fb_fast, size) < 0) ) {
+		printf("Couldn't render the framebuffer\n");
+		return(-1);
+	}
+	for ( i = 0; i < size; ++i ) {
+		if ( fb_scalar[i] != fb_fast[i] ) {
+			printf("Byte %u differs: %02x scalar, %02x fast\n",
+			       (unsigned)i, fb_scalar[i], fb_fast[i]);
+			return(-1);
+		}
+	}
+	return(0);
+}
+
+int main(int argc, char *argv[])
+{
+	int i, landscape, invert;
+	int failed = 0;
+
+	SDL_putenv("SDL_VIDEODRIVER=qoffscreen");
+	SDL_putenv("SDL_QOFFSCREEN_GEOMETRY=240x320");
+
+	for ( i = 0; i < (int)SDL_arraysize(depths); ++i ) {
+		for ( landscape = 0; landscape <= 1; ++landscape ) {
+			for ( invert = 0; invert <= landscape; ++invert ) {
+				int result = Compare(depths[i], landscape, invert);
+				printf("depth %d, %s: %s\n", depths[i],
+				       !landscape ? "no rotation" :
+				       invert ? "counterclockwise" : "clockwise",
+				       result < 0 ? "FAILED" : "identical");
+				if ( result < 0 ) {
+					failed = 1;
+				}
+			}
+		}
+	}
+	printf("%s\n", failed ? "FAILED" : "PASSED");
+	return(failed);
+}
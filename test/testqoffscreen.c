@@ -0,0 +1,231 @@
+/*
+ * Exercises the offscreen Qtopia4 driver without a display.
+ *
+ * For each framebuffer depth, in portrait and both landscape rotations,
+ * and with single and double buffered modes, an image is blitted to the
+ * screen and shown.  The framebuffer file is then checked pixel by pixel
+ * against the screen, rotated and widened to the framebuffer format.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+
+#define FB_FILE		"testqoffscreen.fb"
+#define FB_WIDTH	240
+#define FB_HEIGHT	320
+
+static const int depths[] = { 16, 18, 24, 32 };
+
+static Uint16 shown[FB_WIDTH*FB_HEIGHT];
+static Uint8 fb[FB_WIDTH*FB_HEIGHT*4];
+
+/* The framebuffer pixel for an RGB565 screen pixel */
+static Uint32 Widen(Uint16 p, int depth)
+{
+	Uint32 r = (p >> 11) & 0x1F;
+	Uint32 g = (p >> 5) & 0x3F;
+	Uint32 b = p & 0x1F;
+
+	switch (depth) {
+	    case 16:
+		return p;
+	    case 18:
+		return ((r << 1) << 12) | (g << 6) | (b << 1);
+	    default:
+		return (((r << 3) | (r >> 2)) << 16) |
+		       (((g << 2) | (g >> 4)) << 8) |
+		       ((b << 3) | (b >> 2));
+	}
+}
+
+static Uint32 ReadPixel(int x, int y, int depth)
+{
+	const Uint8 *p;
+
+	switch (depth) {
+	    case 16:
+		p = fb + (y*FB_WIDTH + x)*2;
+		return *(const Uint16 *)p;
+	    case 18:
+	    case 24:
+		p = fb + (y*FB_WIDTH + x)*3;
+		return p[0] | (p[1] << 8) | (p[2] << 16);
+	    default:
+		p = fb + (y*FB_WIDTH + x)*4;
+		return *(const Uint32 *)p;
+	}
+}
+
+/* Fill the screen with a test image, and keep a copy of what's shown */
+static int DrawScreen(SDL_Surface *screen)
+{
+	SDL_Surface *image;
+	SDL_Rect dst;
+	Uint32 *pixels;
+	Uint16 *row;
+	int x, y;
+
+	image = SDL_CreateRGBSurface(SDL_SWSURFACE, 200, 150, 32,
+	                             0x00FF0000, 0x0000FF00, 0x000000FF, 0);
+	if ( image == NULL ) {
+		return(-1);
+	}
+	for ( y = 0; y < image->h; ++y ) {
+		pixels = (Uint32 *)((Uint8 *)image->pixels + y*image->pitch);
+		for ( x = 0; x < image->w; ++x ) {
+			pixels[x] = ((x * 5) & 0xFF) << 16 |
+			            ((y * 3 + x) & 0xFF) << 8 |
+			            ((x ^ y) & 0xFF);
+		}
+	}
+
+	SDL_FillRect(screen, NULL, SDL_MapRGB(screen->format, 0x20, 0x40, 0x80));
+	dst.x = 7;
+	dst.y = 13;
+	SDL_BlitSurface(image, NULL, screen, &dst);
+
+	/* The blit truncates each channel to 5-6-5 */
+	SDL_LockSurface(screen);
+	for ( y = 0; y < image->h; ++y ) {
+		pixels = (Uint32 *)((Uint8 *)image->pixels + y*image->pitch);
+		row = (Uint16 *)((Uint8 *)screen->pixels +
+		                 (y+dst.y)*screen->pitch) + dst.x;
+		for ( x = 0; x < image->w; ++x ) {
+			Uint32 p = pixels[x];
+			Uint16 expected = (Uint16)(((p >> 8) & 0xF800) |
+			                           ((p >> 5) & 0x07E0) |
+			                           ((p >> 3) & 0x001F));
+			if ( row[x] != expected ) {
+				printf("Blit gave %04x at %d,%d instead of %04x\n",
+				       row[x], x+dst.x, y+dst.y, expected);
+				SDL_UnlockSurface(screen);
+				SDL_FreeSurface(image);
+				return(-1);
+			}
+		}
+	}
+	for ( y = 0; y < screen->h; ++y ) {
+		SDL_memcpy(&shown[y*screen->w],
+		           (Uint8 *)screen->pixels + y*screen->pitch,
+		           screen->w*2);
+	}
+	SDL_UnlockSurface(screen);
+	SDL_FreeSurface(image);
+	return(0);
+}
+
+static int RunTest(int depth, int landscape, int invert, int doublebuf)
+{
+	static char env[64];	/* putenv() keeps the string */
+	SDL_Surface *screen;
+	FILE *fp;
+	int w, h, x, y, fx, fy;
+	Uint32 flags;
+	size_t size;
+
+	SDL_snprintf(env, sizeof(env), "SDL_QOFFSCREEN_DEPTH=%d", depth);
+	SDL_putenv(env);
+	SDL_putenv(invert ? "SDL_QT_INVERT_ROTATION=1" :
+	                    "SDL_QT_INVERT_ROTATION=0");
+	if ( SDL_InitSubSystem(SDL_INIT_VIDEO) < 0 ) {
+		printf("Couldn't initialize video: %s\n", SDL_GetError());
+		return(-1);
+	}
+
+	w = landscape ? FB_HEIGHT : FB_WIDTH;
+	h = landscape ? FB_WIDTH : FB_HEIGHT;
+	flags = doublebuf ? (SDL_HWSURFACE|SDL_DOUBLEBUF) : SDL_SWSURFACE;
+	screen = SDL_SetVideoMode(w, h, 16, flags);
+	if ( (screen == NULL) || (screen->w != w) || (screen->h != h) ) {
+		printf("Couldn't set %dx%d mode: %s\n", w, h, SDL_GetError());
+		SDL_QuitSubSystem(SDL_INIT_VIDEO);
+		return(-1);
+	}
+	if ( DrawScreen(screen) < 0 ) {
+		SDL_QuitSubSystem(SDL_INIT_VIDEO);
+		return(-1);
+	}
+	if ( doublebuf ) {
+		SDL_Flip(screen);
+	} else {
+		SDL_UpdateRect(screen, 0, 0, 0, 0);
+	}
+	/* Shutting down finishes any frame still being converted */
+	SDL_QuitSubSystem(SDL_INIT_VIDEO);
+
+	size = FB_WIDTH*FB_HEIGHT*(depth == 16 ? 2 : depth == 32 ? 4 : 3);
+	fp = fopen(FB_FILE, "rb");
+	if ( (fp == NULL) || (fread(fb, size, 1, fp) != 1) ) {
+		printf("Couldn't read %s\n", FB_FILE);
+		if ( fp ) {
+			fclose(fp);
+		}
+		return(-1);
+	}
+	fclose(fp);
+
+	for ( y = 0; y < h; ++y ) {
+		for ( x = 0; x < w; ++x ) {
+			if ( !landscape ) {
+				fx = x;
+				fy = y;
+			} else if ( !invert ) {
+				fx = y;
+				fy = w-1-x;
+			} else {
+				fx = h-1-y;
+				fy = x;
+			}
+			if ( ReadPixel(fx, fy, depth) !=
+			     Widen(shown[y*w+x], depth) ) {
+				printf("Screen pixel %d,%d is %06x in the framebuffer, expected %06x\n",
+				       x, y, ReadPixel(fx, fy, depth),
+				       Widen(shown[y*w+x], depth));
+				return(-1);
+			}
+		}
+	}
+	return(0);
+}
+
+int main(int argc, char *argv[])
+{
+	int i, landscape, invert, doublebuf;
+	int failed = 0;
+
+	SDL_putenv("SDL_VIDEODRIVER=qoffscreen");
+	SDL_putenv("SDL_QOFFSCREEN_GEOMETRY=240x320");
+	SDL_putenv("SDL_QOFFSCREEN_FILE=" FB_FILE);
+	if ( SDL_Init(0) < 0 ) {
+		fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+		return(1);
+	}
+
+	for ( i = 0; i < (int)SDL_arraysize(depths); ++i ) {
+		for ( landscape = 0; landscape <= 1; ++landscape ) {
+			for ( invert = 0; invert <= landscape; ++invert ) {
+				for ( doublebuf = 0; doublebuf <= 1; ++doublebuf ) {
+					int result = RunTest(depths[i],
+					                 landscape, invert, doublebuf);
+					printf("depth %d, %s, %s: %s\n",
+					       depths[i],
+					       !landscape ? "portrait" :
+					       invert ? "landscape counterclockwise" :
+					                "landscape clockwise",
+					       doublebuf ? "flipped" : "updated",
+					       result < 0 ? "FAILED" : "ok");
+					if ( result < 0 ) {
+						failed = 1;
+					}
+				}
+			}
+		}
+	}
+
+	SDL_Quit();
+	remove(FB_FILE);
+	printf("%s\n", failed ? "FAILED" : "PASSED");
+	return(failed);
+}